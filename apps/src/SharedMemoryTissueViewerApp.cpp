@@ -0,0 +1,147 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/**
+ * @file
+ *
+ * Follows a running simulation that has a SharedMemoryExportModifier, printing a one-line summary of each new
+ * frame (time, numbers of nodes and cells, mean cell area and fraction of labelled cells) until the simulation
+ * finishes. The segment is only read, so any number of viewers can follow one simulation.
+ *
+ * Usage: SharedMemoryTissueViewerApp shared_memory_name [attach_timeout_seconds]
+ *
+ * The name of the segment is written to sharedmemory.txt in the output directory of the simulation.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "ExecutableSupport.hpp"
+#include "Exception.hpp"
+#include "PetscTools.hpp"
+#include "PetscException.hpp"
+
+#include "SharedMemoryTissueReader.hpp"
+
+int main(int argc, char *argv[])
+{
+    // This sets up PETSc and prints out copyright information, etc.
+    ExecutableSupport::StandardStartup(&argc, &argv);
+
+    int exit_code = ExecutableSupport::EXIT_OK;
+
+    try
+    {
+        if (argc < 2 || argc > 3)
+        {
+            ExecutableSupport::PrintError("Usage: SharedMemoryTissueViewerApp shared_memory_name [attach_timeout_seconds]", true);
+            exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
+        }
+        else
+        {
+            const std::string name = argv[1];
+            const double attach_timeout = (argc == 3) ? std::atof(argv[2]) : 10.0;
+
+            // The simulation may not have created the segment yet, so keep trying until the timeout
+            const auto attach_deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(attach_timeout);
+            std::unique_ptr<SharedMemoryTissueReader> p_reader;
+            while (!p_reader)
+            {
+                try
+                {
+                    p_reader.reset(new SharedMemoryTissueReader(name));
+                }
+                catch (const Exception&)
+                {
+                    if (std::chrono::steady_clock::now() > attach_deadline)
+                    {
+                        throw;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                }
+            }
+
+            SharedMemoryTissueReader::Frame frame;
+            uint64_t num_frames_seen = 0;
+            for (;;)
+            {
+                // Read the finished flag first, so that frames published just before it was set are not missed
+                const bool finished = p_reader->IsFinished();
+                if (p_reader->GetNumFramesPublished() > num_frames_seen && p_reader->ReadLatestFrame(frame))
+                {
+                    num_frames_seen = frame.mFrameIndex + 1;
+
+                    double total_area = 0.0;
+                    unsigned num_labelled = 0;
+                    for (unsigned cell = 0; cell < frame.GetNumElements(); ++cell)
+                    {
+                        total_area += frame.mCellVolumes[cell];
+                        num_labelled += frame.mCellLabels[cell];
+                    }
+                    const unsigned num_cells = frame.GetNumElements();
+                    std::cout << "frame " << frame.mFrameIndex
+                              << "\ttime " << frame.mTime
+                              << "\tnodes " << frame.mNodeLocations.size() / p_reader->GetSpaceDimension()
+                              << "\tcells " << num_cells
+                              << "\tmean area " << (num_cells > 0 ? total_area / num_cells : 0.0)
+                              << "\tlabelled fraction " << (num_cells > 0 ? double(num_labelled) / num_cells : 0.0)
+                              << std::endl;
+                }
+                else if (finished)
+                {
+                    break;
+                }
+                else
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+            }
+            std::cout << "Simulation finished after " << p_reader->GetNumFramesPublished() << " frames" << std::endl;
+        }
+    }
+    catch (const Exception& e)
+    {
+        ExecutableSupport::PrintError(e.GetMessage());
+        exit_code = ExecutableSupport::EXIT_ERROR;
+    }
+
+    // End by finalizing PETSc, and returning a suitable exit code.
+    ExecutableSupport::FinalizePetsc();
+    return exit_code;
+}
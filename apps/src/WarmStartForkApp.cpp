@@ -0,0 +1,174 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/**
+ * @file
+ *
+ * Relaxes a tissue once, as in Test01Relaxation in TestCustomVertexSimulations, then continues it in several
+ * variants, each in its own forked process (see WarmStartForker), so the relaxation is paid for once rather than
+ * once per variant.
+ *
+ * Usage: WarmStartForkApp cells_across warm_up_end_time variant_end_time [max_concurrent_variants]
+ *
+ * The warm-up is written to WarmStartFork/WarmUp, and each variant to WarmStartFork/<variant name>.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "ExecutableSupport.hpp"
+#include "Exception.hpp"
+#include "PetscTools.hpp"
+#include "PetscException.hpp"
+
+#include "SmartPointers.hpp"
+
+#include "CellsGenerator.hpp"
+#include "CellVolumesWriter.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "NoCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+#include "FarhadifarForce.hpp"
+#include "OffLatticeSimulation.hpp"
+
+#include "FastVoronoiVertexMeshGenerator.hpp"
+#include "SillyForce.hpp"
+#include "SillySimulationModifier.hpp"
+#include "WarmStartForker.hpp"
+
+int main(int argc, char *argv[])
+{
+    // This sets up PETSc and prints out copyright information, etc.
+    ExecutableSupport::StandardStartup(&argc, &argv);
+
+    int exit_code = ExecutableSupport::EXIT_OK;
+
+    try
+    {
+        if (argc < 4 || argc > 5)
+        {
+            ExecutableSupport::PrintError("Usage: WarmStartForkApp cells_across warm_up_end_time variant_end_time [max_concurrent_variants]", true);
+            exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
+        }
+        else
+        {
+            const unsigned cells_across = std::atoi(argv[1]);
+            const double warm_up_end_time = std::atof(argv[2]);
+            const double variant_end_time = std::atof(argv[3]);
+            const unsigned max_concurrent_variants = (argc == 5) ? std::atoi(argv[4]) : 1u;
+
+            // The warm-up: a tissue relaxing towards equilibrium
+            FastVoronoiVertexMeshGenerator generator(cells_across, cells_across, 1);
+            boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+
+            std::vector<CellPtr> cells;
+            MAKE_PTR(DifferentiatedCellProliferativeType, p_cell_type);
+            CellsGenerator<NoCellCycleModel, 2> cells_generator;
+            cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumElements(), p_cell_type);
+
+            VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+            cell_population.AddCellWriter<CellVolumesWriter>();
+
+            OffLatticeSimulation<2> simulation(cell_population);
+            simulation.SetOutputDirectory("WarmStartFork/WarmUp");
+            simulation.SetEndTime(warm_up_end_time);
+            simulation.SetDt(0.01);
+            simulation.SetSamplingTimestepMultiple(10);
+
+            MAKE_PTR(FarhadifarForce<2>, p_force);
+            p_force->SetAreaElasticityParameter(1.0);
+            p_force->SetPerimeterContractilityParameter(0.04);
+            p_force->SetLineTensionParameter(0.12);
+            p_force->SetBoundaryLineTensionParameter(0.12);
+            simulation.AddForce(p_force);
+
+            simulation.Solve();
+
+            // The variants, each continuing from the relaxed tissue
+            WarmStartForker forker(max_concurrent_variants);
+            auto continue_to_end = [&](const std::string& rName)
+            {
+                simulation.SetOutputDirectory("WarmStartFork/" + rName);
+                simulation.SetEndTime(variant_end_time);
+                simulation.Solve();
+            };
+
+            forker.AddVariant("Reference", 1u, [&]()
+            {
+                continue_to_end("Reference");
+            });
+            forker.AddVariant("SillyForce", 2u, [&]()
+            {
+                MAKE_PTR(SillyForce<2>, p_silly_force);
+                simulation.AddForce(p_silly_force);
+                continue_to_end("SillyForce");
+            });
+            forker.AddVariant("StrongAdhesion", 3u, [&]()
+            {
+                p_force->SetLineTensionParameter(0.06);
+                p_force->SetBoundaryLineTensionParameter(0.06);
+                continue_to_end("StrongAdhesion");
+            });
+            forker.AddVariant("SillySimulationModifier", 4u, [&]()
+            {
+                MAKE_PTR(SillySimulationModifier<2>, p_modifier);
+                simulation.AddSimulationModifier(p_modifier);
+                continue_to_end("SillySimulationModifier");
+            });
+
+            const std::vector<int> exit_statuses = forker.RunVariants();
+            for (unsigned variant = 0; variant < exit_statuses.size(); ++variant)
+            {
+                std::cout << "Variant " << forker.rGetVariantName(variant) << " exited with status "
+                          << exit_statuses[variant] << std::endl;
+                if (exit_statuses[variant] != 0)
+                {
+                    exit_code = ExecutableSupport::EXIT_ERROR;
+                }
+            }
+        }
+    }
+    catch (const Exception& e)
+    {
+        ExecutableSupport::PrintError(e.GetMessage());
+        exit_code = ExecutableSupport::EXIT_ERROR;
+    }
+
+    // End by finalizing PETSc, and returning a suitable exit code.
+    ExecutableSupport::FinalizePetsc();
+    return exit_code;
+}
@@ -0,0 +1,72 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef ABSTRACTNODESUBSETFORCE_HPP_
+#define ABSTRACTNODESUBSETFORCE_HPP_
+
+#include <vector>
+
+#include "AbstractCellPopulation.hpp"
+
+/**
+ * An interface for forces that can compute the force on a subset of the nodes of a cell population at a cost that
+ * scales with the size of the subset, rather than with the size of the population. It is implemented alongside
+ * AbstractForce, and is used by MultiRateNumericalMethod to re-evaluate only those nodes that are due an update.
+ */
+template <unsigned DIM>
+class AbstractNodeSubsetForce
+{
+public:
+    /**
+     * Destructor.
+     */
+    virtual ~AbstractNodeSubsetForce() = default;
+
+    /**
+     * Add the full contribution of this force to the applied force of each of the given nodes, as
+     * AddForceContribution() would. The applied force of every other node must be left unchanged. Quantities of
+     * the whole population, such as its centroid, may be those found by the last call to AddForceContribution(),
+     * so that the cost does not scale with the size of the population.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param rNodeIndices the global indices of the nodes to update
+     * @param rNodeMask indexed by global node index: nonzero for the nodes in rNodeIndices, zero for all others
+     */
+    virtual void AddForceContributionToNodes(AbstractCellPopulation<DIM>& rCellPopulation,
+                                             const std::vector<unsigned>& rNodeIndices,
+                                             const std::vector<unsigned char>& rNodeMask) = 0;
+};
+
+#endif /*ABSTRACTNODESUBSETFORCE_HPP_*/
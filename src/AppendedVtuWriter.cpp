@@ -0,0 +1,310 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "AppendedVtuWriter.hpp"
+
+#include <cstring>
+#include <fstream>
+#include "Exception.hpp"
+#include "ThreadedLoop.hpp"
+
+#ifdef CHASTE_VTK
+#define _BACKWARD_BACKWARD_WARNING_H 1 //Cut out the vtk deprecated warning
+#include <vtkSmartPointer.h>
+#include <vtkZLibDataCompressor.h>
+#endif //CHASTE_VTK
+
+namespace
+{
+    /** The VTK cell type of a polygon. */
+    const uint8_t VTK_POLYGON_TYPE = 7u;
+
+    /** Append the raw bytes of a value to a buffer. */
+    template <typename T>
+    void AppendRaw(std::vector<char>& rBuffer, const T& rValue)
+    {
+        const char* p_bytes = reinterpret_cast<const char*>(&rValue);
+        rBuffer.insert(rBuffer.end(), p_bytes, p_bytes + sizeof(T));
+    }
+}
+
+AppendedVtuWriter::AppendedVtuWriter(bool compress)
+    : mCompress(compress && IsCompressionAvailable())
+{
+}
+
+bool AppendedVtuWriter::IsCompressionAvailable()
+{
+#ifdef CHASTE_VTK
+    return true;
+#else
+    return false;
+#endif //CHASTE_VTK
+}
+
+bool AppendedVtuWriter::IsCompressing() const
+{
+    return mCompress;
+}
+
+void AppendedVtuWriter::SetMinPointsPerThread(unsigned minPointsPerThread)
+{
+    mMinPointsPerThread = minPointsPerThread;
+}
+
+void AppendedVtuWriter::AddArray(const std::string& rName, const std::string& rType, unsigned numComponents,
+                                 const void* pValues, std::size_t numBytes)
+{
+    mArrays.emplace_back();
+    DataArray& r_array = mArrays.back();
+    r_array.mName = rName;
+    r_array.mType = rType;
+    r_array.mNumComponents = numComponents;
+    r_array.mBytes.resize(numBytes);
+    if (numBytes > 0)
+    {
+        memcpy(r_array.mBytes.data(), pValues, numBytes);
+    }
+}
+
+void AppendedVtuWriter::SetPoints(const std::vector<double>& rCoordinates, unsigned spaceDimension)
+{
+    if (spaceDimension == 0 || spaceDimension > 3 || rCoordinates.size() % spaceDimension != 0)
+    {
+        EXCEPTION("The number of coordinates is not a multiple of the space dimension");
+    }
+
+    mArrays.clear();
+    mNumCells = 0u;
+    mNumPoints = rCoordinates.size() / spaceDimension;
+
+    // VTK points always have three coordinates
+    std::vector<double> points(3 * mNumPoints, 0.0);
+    ThreadedLoop::Run(mNumPoints, [&](unsigned begin, unsigned end, unsigned thread)
+    {
+        for (unsigned point = begin; point < end; ++point)
+        {
+            for (unsigned dim = 0; dim < spaceDimension; ++dim)
+            {
+                points[3 * point + dim] = rCoordinates[spaceDimension * point + dim];
+            }
+        }
+    }, mMinPointsPerThread);
+    AddArray("", "Float64", 3, points.data(), points.size() * sizeof(double));
+}
+
+void AppendedVtuWriter::SetPolygons(const std::vector<int64_t>& rConnectivity, const std::vector<int64_t>& rOffsets)
+{
+    if (mArrays.size() != 1u)
+    {
+        EXCEPTION("SetPolygons() must be called once, after SetPoints()");
+    }
+    if (!rOffsets.empty() && rOffsets.back() != static_cast<int64_t>(rConnectivity.size()))
+    {
+        EXCEPTION("The last polygon offset must be the size of the connectivity array");
+    }
+
+    mNumCells = rOffsets.size();
+    const std::vector<uint8_t> types(mNumCells, VTK_POLYGON_TYPE);
+    AddArray("connectivity", "Int64", 1, rConnectivity.data(), rConnectivity.size() * sizeof(int64_t));
+    AddArray("offsets", "Int64", 1, rOffsets.data(), rOffsets.size() * sizeof(int64_t));
+    AddArray("types", "UInt8", 1, types.data(), types.size() * sizeof(uint8_t));
+}
+
+void AppendedVtuWriter::AddCellData(const std::string& rName, const std::vector<double>& rValues)
+{
+    if (mArrays.size() < 4u || rValues.size() != mNumCells)
+    {
+        EXCEPTION("Cell data array " + rName + " must have one value per polygon");
+    }
+    AddArray(rName, "Float64", 1, rValues.data(), rValues.size() * sizeof(double));
+}
+
+void AppendedVtuWriter::AddCellData(const std::string& rName, const std::vector<int32_t>& rValues)
+{
+    if (mArrays.size() < 4u || rValues.size() != mNumCells)
+    {
+        EXCEPTION("Cell data array " + rName + " must have one value per polygon");
+    }
+    AddArray(rName, "Int32", 1, rValues.data(), rValues.size() * sizeof(int32_t));
+}
+
+void AppendedVtuWriter::EncodeArrays()
+{
+    if (!mCompress)
+    {
+        // Each array is just preceded by its size in bytes
+        for (DataArray& r_array : mArrays)
+        {
+            r_array.mEncoded.clear();
+            AppendRaw(r_array.mEncoded, static_cast<uint64_t>(r_array.mBytes.size()));
+        }
+        return;
+    }
+
+#ifdef CHASTE_VTK
+    // Split every array into blocks, so that large arrays are shared between threads too
+    std::vector<std::pair<unsigned, std::size_t> > blocks;
+    for (unsigned i = 0; i < mArrays.size(); ++i)
+    {
+        for (std::size_t start = 0; start < mArrays[i].mBytes.size(); start += BLOCK_SIZE)
+        {
+            blocks.emplace_back(i, start);
+        }
+    }
+
+    // Compressors are created up front, one per thread
+    std::vector<vtkSmartPointer<vtkZLibDataCompressor> > compressors(ThreadedLoop::GetNumThreads());
+    for (auto& rp_compressor : compressors)
+    {
+        rp_compressor = vtkSmartPointer<vtkZLibDataCompressor>::New();
+        rp_compressor->SetCompressionLevel(1); // favour speed; most of the gain is had at the lowest level
+    }
+
+    std::vector<std::vector<char> > compressed_blocks(blocks.size());
+    ThreadedLoop::Run(blocks.size(), [&](unsigned begin, unsigned end, unsigned thread)
+    {
+        for (unsigned block = begin; block < end; ++block)
+        {
+            const DataArray& r_array = mArrays[blocks[block].first];
+            const std::size_t start = blocks[block].second;
+            const std::size_t size = std::min(BLOCK_SIZE, r_array.mBytes.size() - start);
+
+            std::vector<char>& r_compressed = compressed_blocks[block];
+            r_compressed.resize(compressors[thread]->GetMaximumCompressionSpace(size));
+            const std::size_t compressed_size = compressors[thread]->Compress(
+                reinterpret_cast<const unsigned char*>(r_array.mBytes.data() + start), size,
+                reinterpret_cast<unsigned char*>(r_compressed.data()), r_compressed.size());
+            if (compressed_size == 0)
+            {
+                EXCEPTION("Compression of VTU data array " + r_array.mName + " failed");
+            }
+            r_compressed.resize(compressed_size);
+        }
+    });
+
+    // Each array is preceded by a header giving the number of blocks and their sizes
+    unsigned block = 0;
+    for (DataArray& r_array : mArrays)
+    {
+        const uint64_t num_blocks = (r_array.mBytes.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        r_array.mEncoded.clear();
+        AppendRaw(r_array.mEncoded, num_blocks);
+        AppendRaw(r_array.mEncoded, static_cast<uint64_t>(BLOCK_SIZE));
+        AppendRaw(r_array.mEncoded, static_cast<uint64_t>(r_array.mBytes.size() % BLOCK_SIZE));
+        for (uint64_t i = 0; i < num_blocks; ++i)
+        {
+            AppendRaw(r_array.mEncoded, static_cast<uint64_t>(compressed_blocks[block + i].size()));
+        }
+        for (uint64_t i = 0; i < num_blocks; ++i)
+        {
+            r_array.mEncoded.insert(r_array.mEncoded.end(), compressed_blocks[block + i].begin(),
+                                    compressed_blocks[block + i].end());
+        }
+        block += num_blocks;
+    }
+#endif //CHASTE_VTK
+}
+
+void AppendedVtuWriter::Write(const std::string& rFilePath)
+{
+    if (mArrays.size() < 4u)
+    {
+        EXCEPTION("SetPoints() and SetPolygons() must be called before writing a VTU file");
+    }
+
+    EncodeArrays();
+
+    std::ofstream file(rFilePath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        EXCEPTION("Could not open VTU file " + rFilePath);
+    }
+
+    uint64_t offset = 0;
+    auto write_array_element = [&](const DataArray& rArray)
+    {
+        file << "        <DataArray type=\"" << rArray.mType << "\"";
+        if (!rArray.mName.empty())
+        {
+            file << " Name=\"" << rArray.mName << "\"";
+        }
+        file << " NumberOfComponents=\"" << rArray.mNumComponents << "\" format=\"appended\" offset=\"" << offset << "\"/>\n";
+        offset += rArray.mEncoded.size() + (mCompress ? 0u : rArray.mBytes.size());
+    };
+
+    file << "<?xml version=\"1.0\"?>\n";
+    file << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\"";
+    if (mCompress)
+    {
+        file << " compressor=\"vtkZLibDataCompressor\"";
+    }
+    file << ">\n";
+    file << "  <UnstructuredGrid>\n";
+    file << "    <Piece NumberOfPoints=\"" << mNumPoints << "\" NumberOfCells=\"" << mNumCells << "\">\n";
+    file << "      <Points>\n";
+    write_array_element(mArrays[0]);
+    file << "      </Points>\n";
+    file << "      <Cells>\n";
+    for (unsigned i = 1; i < 4; ++i)
+    {
+        write_array_element(mArrays[i]);
+    }
+    file << "      </Cells>\n";
+    file << "      <CellData>\n";
+    for (unsigned i = 4; i < mArrays.size(); ++i)
+    {
+        write_array_element(mArrays[i]);
+    }
+    file << "      </CellData>\n";
+    file << "    </Piece>\n";
+    file << "  </UnstructuredGrid>\n";
+    file << "  <AppendedData encoding=\"raw\">\n   _";
+    for (const DataArray& r_array : mArrays)
+    {
+        file.write(r_array.mEncoded.data(), r_array.mEncoded.size());
+        if (!mCompress)
+        {
+            file.write(r_array.mBytes.data(), r_array.mBytes.size());
+        }
+    }
+    file << "\n  </AppendedData>\n";
+    file << "</VTKFile>\n";
+
+    if (!file)
+    {
+        EXCEPTION("Error writing VTU file " + rFilePath);
+    }
+}
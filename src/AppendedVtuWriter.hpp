@@ -0,0 +1,180 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef APPENDEDVTUWRITER_HPP_
+#define APPENDEDVTUWRITER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Writes a polygonal unstructured grid as a VTK XML (.vtu) file in which all data arrays are stored as raw binary in
+ * a single appended section, rather than as ASCII or base64 text. This is much faster both to write and for ParaView
+ * to load than the text output of VtkMeshWriter.
+ *
+ * If Chaste was built with VTK, each array is split into blocks which are compressed with vtkZLibDataCompressor;
+ * otherwise the arrays are stored uncompressed. In either case the encoding and compression of all arrays is shared
+ * between worker threads by ThreadedLoop.
+ */
+class AppendedVtuWriter
+{
+private:
+
+    /** An array of values to be written. */
+    struct DataArray
+    {
+        /** The name of the array, or empty for the point coordinates. */
+        std::string mName;
+
+        /** The VTK name of the type of each value, e.g. Float64. */
+        std::string mType;
+
+        /** The number of components of each tuple. */
+        unsigned mNumComponents;
+
+        /** The values, as raw bytes. */
+        std::vector<char> mBytes;
+
+        /**
+         * The encoded values, as written to the appended section. If not compressing, this is just the header, and
+         * is followed by mBytes.
+         */
+        std::vector<char> mEncoded;
+    };
+
+    /** Whether to compress the arrays. */
+    bool mCompress;
+
+    /** The minimum number of points given to each worker thread when copying the coordinates. Defaults to 4096. */
+    unsigned mMinPointsPerThread = 4096u;
+
+    /** The number of points. */
+    unsigned mNumPoints = 0u;
+
+    /** The number of cells. */
+    unsigned mNumCells = 0u;
+
+    /** The point coordinates, connectivity, offsets and cell types, followed by the cell data arrays. */
+    std::vector<DataArray> mArrays;
+
+    /**
+     * Add an array.
+     *
+     * @param rName the name of the array
+     * @param rType the VTK type name of the values
+     * @param numComponents the number of components of each tuple
+     * @param pValues pointer to the values
+     * @param numBytes the size of the values in bytes
+     */
+    void AddArray(const std::string& rName, const std::string& rType, unsigned numComponents,
+                  const void* pValues, std::size_t numBytes);
+
+    /**
+     * Encode every array, compressing them if required.
+     */
+    void EncodeArrays();
+
+public:
+
+    /** The number of bytes in each compressed block, as used by VTK. */
+    static constexpr std::size_t BLOCK_SIZE = 32768u;
+
+    /**
+     * Constructor.
+     *
+     * @param compress whether to compress the arrays, if compression is available (defaults to true)
+     */
+    AppendedVtuWriter(bool compress = true);
+
+    /**
+     * @return whether Chaste was built with VTK, and hence whether compressed output is available
+     */
+    static bool IsCompressionAvailable();
+
+    /**
+     * @return whether the arrays will be compressed
+     */
+    bool IsCompressing() const;
+
+    /**
+     * Set the minimum number of points given to each worker thread when copying the coordinates. Compression is
+     * always shared between threads block by block.
+     *
+     * @param minPointsPerThread the minimum number of points per thread
+     */
+    void SetMinPointsPerThread(unsigned minPointsPerThread);
+
+    /**
+     * Set the point coordinates, removing any previous geometry and data.
+     *
+     * @param rCoordinates the coordinates, point by point
+     * @param spaceDimension the number of coordinates of each point; missing coordinates are written as zero
+     */
+    void SetPoints(const std::vector<double>& rCoordinates, unsigned spaceDimension);
+
+    /**
+     * Set the polygonal cells. Must be called after SetPoints().
+     *
+     * @param rConnectivity the point indices of every cell, cell by cell
+     * @param rOffsets for each cell, the offset in rConnectivity of the end of its point indices
+     */
+    void SetPolygons(const std::vector<int64_t>& rConnectivity, const std::vector<int64_t>& rOffsets);
+
+    /**
+     * Add a cell data array. Must be called after SetPolygons().
+     *
+     * @param rName the name of the array
+     * @param rValues one value per cell
+     */
+    void AddCellData(const std::string& rName, const std::vector<double>& rValues);
+
+    /**
+     * Add a cell data array. Must be called after SetPolygons().
+     *
+     * @param rName the name of the array
+     * @param rValues one value per cell
+     */
+    void AddCellData(const std::string& rName, const std::vector<int32_t>& rValues);
+
+    /**
+     * Encode and write the grid.
+     *
+     * @param rFilePath the full path of the file
+     */
+    void Write(const std::string& rFilePath);
+};
+
+#endif /*APPENDEDVTUWRITER_HPP_*/
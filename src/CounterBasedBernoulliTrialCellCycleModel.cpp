@@ -0,0 +1,153 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "CounterBasedBernoulliTrialCellCycleModel.hpp"
+
+#include <climits>
+#include "CellLabel.hpp"
+#include "CounterBasedRandomNumberGenerator.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+
+CounterBasedBernoulliTrialCellCycleModel::CounterBasedBernoulliTrialCellCycleModel()
+    : AbstractCellCycleModel(),
+      mLastTrialTimeStep(UINT_MAX)
+{
+}
+
+CounterBasedBernoulliTrialCellCycleModel::CounterBasedBernoulliTrialCellCycleModel(const CounterBasedBernoulliTrialCellCycleModel& rModel)
+   : AbstractCellCycleModel(rModel),
+     mDivisionProbability(rModel.mDivisionProbability),
+     mLabelledDivisionProbability(rModel.mLabelledDivisionProbability),
+     mMinimumDivisionAge(rModel.mMinimumDivisionAge),
+     mLastTrialTimeStep(rModel.mLastTrialTimeStep)
+{
+    /*
+     * Initialize only those member variables defined in this class.
+     *
+     * The member variables mBirthTime, mReadyToDivide and mDimension
+     * are initialized in the AbstractCellCycleModel constructor.
+     */
+}
+
+bool CounterBasedBernoulliTrialCellCycleModel::ReadyToDivide()
+{
+    assert(mpCell != nullptr);
+
+    const unsigned time_step = SimulationTime::Instance()->GetTimeStepsElapsed();
+    if (!mReadyToDivide && mLastTrialTimeStep != time_step)
+    {
+        mLastTrialTimeStep = time_step;
+
+        if (GetAge() > mMinimumDivisionAge
+            && !(mpCell->GetCellProliferativeType()->IsType<DifferentiatedCellProliferativeType>()))
+        {
+            const double division_probability = mpCell->HasCellProperty<CellLabel>() ? mLabelledDivisionProbability
+                                                                                     : mDivisionProbability;
+
+            CounterBasedRandomStream stream = CounterBasedRandomNumberGenerator::Instance()->GetStream(
+                mpCell->GetCellId(), time_step, CounterBasedRandomNumberGenerator::CELL_CYCLE_STREAM);
+            if (stream.ranf() < division_probability * SimulationTime::Instance()->GetTimeStep())
+            {
+                mReadyToDivide = true;
+            }
+        }
+    }
+    return mReadyToDivide;
+}
+
+void CounterBasedBernoulliTrialCellCycleModel::ResetForDivision()
+{
+    AbstractCellCycleModel::ResetForDivision();
+    mLastTrialTimeStep = UINT_MAX;
+}
+
+AbstractCellCycleModel* CounterBasedBernoulliTrialCellCycleModel::CreateCellCycleModel()
+{
+    return new CounterBasedBernoulliTrialCellCycleModel(*this);
+}
+
+double CounterBasedBernoulliTrialCellCycleModel::GetDivisionProbability() const
+{
+    return mDivisionProbability;
+}
+
+void CounterBasedBernoulliTrialCellCycleModel::SetDivisionProbability(double divisionProbability)
+{
+    mDivisionProbability = divisionProbability;
+}
+
+double CounterBasedBernoulliTrialCellCycleModel::GetLabelledDivisionProbability() const
+{
+    return mLabelledDivisionProbability;
+}
+
+void CounterBasedBernoulliTrialCellCycleModel::SetLabelledDivisionProbability(double labelledDivisionProbability)
+{
+    mLabelledDivisionProbability = labelledDivisionProbability;
+}
+
+double CounterBasedBernoulliTrialCellCycleModel::GetMinimumDivisionAge() const
+{
+    return mMinimumDivisionAge;
+}
+
+void CounterBasedBernoulliTrialCellCycleModel::SetMinimumDivisionAge(double minimumDivisionAge)
+{
+    mMinimumDivisionAge = minimumDivisionAge;
+}
+
+double CounterBasedBernoulliTrialCellCycleModel::GetAverageTransitCellCycleTime()
+{
+    return mMinimumDivisionAge + 1.0 / mDivisionProbability;
+}
+
+double CounterBasedBernoulliTrialCellCycleModel::GetAverageStemCellCycleTime()
+{
+    return mMinimumDivisionAge + 1.0 / mDivisionProbability;
+}
+
+void CounterBasedBernoulliTrialCellCycleModel::OutputCellCycleModelParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<DivisionProbability>" << mDivisionProbability << "</DivisionProbability>\n";
+    *rParamsFile << "\t\t\t<LabelledDivisionProbability>" << mLabelledDivisionProbability << "</LabelledDivisionProbability>\n";
+    *rParamsFile << "\t\t\t<MinimumDivisionAge>" << mMinimumDivisionAge << "</MinimumDivisionAge>\n";
+
+    // Call method on direct parent class
+    AbstractCellCycleModel::OutputCellCycleModelParameters(rParamsFile);
+}
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+CHASTE_CLASS_EXPORT(CounterBasedBernoulliTrialCellCycleModel)
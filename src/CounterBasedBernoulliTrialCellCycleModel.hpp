@@ -0,0 +1,190 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef COUNTERBASEDBERNOULLITRIALCELLCYCLEMODEL_HPP_
+#define COUNTERBASEDBERNOULLITRIALCELLCYCLEMODEL_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "AbstractCellCycleModel.hpp"
+
+/**
+ * A cell-cycle model in which, like LabelDependentBernoulliTrialCellCycleModel, a cell older than the minimum
+ * division age divides at each time step with probability p*dt, where p depends on whether the cell is labelled.
+ * Differentiated cells never divide.
+ *
+ * The trial uses the CounterBasedRandomNumberGenerator stream of the cell at the current time step, rather than
+ * RandomNumberGenerator, and its outcome is cached for the time step. ReadyToDivide() therefore only touches the
+ * state of its own cell, so the readiness of all cells may be evaluated in parallel (see
+ * ParallelDivisionReadinessModifier) with results independent of the order or number of threads, and calling it more
+ * than once per time step does not change the division rate.
+ */
+class CounterBasedBernoulliTrialCellCycleModel : public AbstractCellCycleModel
+{
+private:
+
+    /** The probability per unit time that an unlabelled cell divides. Defaults to 0.1. */
+    double mDivisionProbability = 0.1;
+
+    /** The probability per unit time that a labelled cell divides. Defaults to 0.1. */
+    double mLabelledDivisionProbability = 0.1;
+
+    /** The minimum age at which a cell may divide. Defaults to 1. */
+    double mMinimumDivisionAge = 1.0;
+
+    /** The time step at which the last division trial was made, or UINT_MAX if none has been made since birth. */
+    unsigned mLastTrialTimeStep;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the cell-cycle model, never used directly - boost uses this.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellCycleModel>(*this);
+        archive & mDivisionProbability;
+        archive & mLabelledDivisionProbability;
+        archive & mMinimumDivisionAge;
+        archive & mLastTrialTimeStep;
+    }
+
+protected:
+
+    /**
+     * Protected copy-constructor for use by CreateCellCycleModel().
+     *
+     * @param rModel the cell cycle model to copy.
+     */
+    CounterBasedBernoulliTrialCellCycleModel(const CounterBasedBernoulliTrialCellCycleModel& rModel);
+
+public:
+
+    /**
+     * Constructor.
+     */
+    CounterBasedBernoulliTrialCellCycleModel();
+
+    /**
+     * Overridden ReadyToDivide() method.
+     *
+     * Makes the division trial for the current time step, unless it has already been made.
+     *
+     * @return whether the cell is ready to divide
+     */
+    virtual bool ReadyToDivide();
+
+    /**
+     * Overridden ResetForDivision() method.
+     *
+     * Allows a new trial to be made by each daughter cell.
+     */
+    virtual void ResetForDivision();
+
+    /**
+     * Overridden builder method to create new copies of this cell-cycle model.
+     *
+     * @return a new cell-cycle model
+     */
+    AbstractCellCycleModel* CreateCellCycleModel();
+
+    /**
+     * @return mDivisionProbability
+     */
+    double GetDivisionProbability() const;
+
+    /**
+     * Set mDivisionProbability.
+     *
+     * @param divisionProbability the new value of mDivisionProbability
+     */
+    void SetDivisionProbability(double divisionProbability);
+
+    /**
+     * @return mLabelledDivisionProbability
+     */
+    double GetLabelledDivisionProbability() const;
+
+    /**
+     * Set mLabelledDivisionProbability.
+     *
+     * @param labelledDivisionProbability the new value of mLabelledDivisionProbability
+     */
+    void SetLabelledDivisionProbability(double labelledDivisionProbability);
+
+    /**
+     * @return mMinimumDivisionAge
+     */
+    double GetMinimumDivisionAge() const;
+
+    /**
+     * Set mMinimumDivisionAge.
+     *
+     * @param minimumDivisionAge the new value of mMinimumDivisionAge
+     */
+    void SetMinimumDivisionAge(double minimumDivisionAge);
+
+    /**
+     * Overridden GetAverageTransitCellCycleTime() method.
+     *
+     * @return the average of mMinimumDivisionAge and the expected waiting time of an unlabelled cell
+     */
+    double GetAverageTransitCellCycleTime();
+
+    /**
+     * Overridden GetAverageStemCellCycleTime() method.
+     *
+     * @return the average of mMinimumDivisionAge and the expected waiting time of an unlabelled cell
+     */
+    double GetAverageStemCellCycleTime();
+
+    /**
+     * Overridden OutputCellCycleModelParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    virtual void OutputCellCycleModelParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+// Declare identifier for the serializer
+CHASTE_CLASS_EXPORT(CounterBasedBernoulliTrialCellCycleModel)
+
+#endif /*COUNTERBASEDBERNOULLITRIALCELLCYCLEMODEL_HPP_*/
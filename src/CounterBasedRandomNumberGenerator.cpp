@@ -0,0 +1,192 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "CounterBasedRandomNumberGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include "SimulationTime.hpp"
+
+CounterBasedRandomStream::CounterBasedRandomStream(uint64_t seed, unsigned cellId, unsigned timeStep, unsigned purpose)
+    : mKey{{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)}},
+      mCounter{{cellId, timeStep, purpose, 0u}},
+      mBlock{{0u, 0u, 0u, 0u}}
+{
+}
+
+std::array<uint32_t, 4> CounterBasedRandomStream::Philox4x32(std::array<uint32_t, 4> counter, std::array<uint32_t, 2> key)
+{
+    for (unsigned round = 0; round < 10; ++round)
+    {
+        if (round > 0)
+        {
+            key[0] += 0x9E3779B9u;
+            key[1] += 0xBB67AE85u;
+        }
+        const uint64_t product_0 = static_cast<uint64_t>(0xD2511F53u) * counter[0];
+        const uint64_t product_1 = static_cast<uint64_t>(0xCD9E8D57u) * counter[2];
+        counter = {{static_cast<uint32_t>(product_1 >> 32) ^ counter[1] ^ key[0],
+                    static_cast<uint32_t>(product_1),
+                    static_cast<uint32_t>(product_0 >> 32) ^ counter[3] ^ key[1],
+                    static_cast<uint32_t>(product_0)}};
+    }
+    return counter;
+}
+
+uint32_t CounterBasedRandomStream::NextUnsigned()
+{
+    if (mBlockPosition == 4u)
+    {
+        mBlock = Philox4x32(mCounter, mKey);
+        ++mCounter[3];
+        mBlockPosition = 0u;
+    }
+    return mBlock[mBlockPosition++];
+}
+
+double CounterBasedRandomStream::ranf()
+{
+    // 27 + 26 random bits, offset by half a unit so that neither 0 nor 1 is returned
+    const double high = NextUnsigned() >> 5;
+    const double low = NextUnsigned() >> 6;
+    return (high * 67108864.0 + low + 0.5) / 9007199254740992.0;
+}
+
+double CounterBasedRandomStream::StandardNormalRandomDeviate()
+{
+    if (mHasSpareNormal)
+    {
+        mHasSpareNormal = false;
+        return mSpareNormal;
+    }
+
+    // The Box-Muller transform uses a fixed number of values, unlike the polar method
+    const double radius = std::sqrt(-2.0 * std::log(ranf()));
+    const double angle = 2.0 * M_PI * ranf();
+    mSpareNormal = radius * std::sin(angle);
+    mHasSpareNormal = true;
+    return radius * std::cos(angle);
+}
+
+double CounterBasedRandomStream::NormalRandomDeviate(double mean, double stdDev)
+{
+    return mean + stdDev * StandardNormalRandomDeviate();
+}
+
+double CounterBasedRandomStream::ExponentialRandomDeviate(double mean)
+{
+    return -mean * std::log(ranf());
+}
+
+double CounterBasedRandomStream::VonMisesRandomDeviate(double mean, double concentration)
+{
+    // For very small concentrations the distribution is uniform
+    if (concentration < 1e-6)
+    {
+        return mean + M_PI * (2.0 * ranf() - 1.0);
+    }
+
+    const double tau = 1.0 + std::sqrt(1.0 + 4.0 * concentration * concentration);
+    const double rho = (tau - std::sqrt(2.0 * tau)) / (2.0 * concentration);
+    const double r = (1.0 + rho * rho) / (2.0 * rho);
+
+    while (true)
+    {
+        const double z = std::cos(M_PI * ranf());
+        const double f = (1.0 + r * z) / (r + z);
+        const double c = concentration * (r - f);
+        const double u_2 = ranf();
+        const double u_3 = ranf();
+
+        if (c * (2.0 - c) > u_2 || std::log(c / u_2) + 1.0 - c >= 0.0)
+        {
+            const double theta = std::acos(std::max(-1.0, std::min(1.0, f)));
+            return (u_3 > 0.5) ? mean + theta : mean - theta;
+        }
+    }
+}
+
+CounterBasedRandomNumberGenerator* CounterBasedRandomNumberGenerator::mpInstance = nullptr;
+
+CounterBasedRandomNumberGenerator* CounterBasedRandomNumberGenerator::Instance()
+{
+    if (mpInstance == nullptr)
+    {
+        mpInstance = new CounterBasedRandomNumberGenerator();
+    }
+    return mpInstance;
+}
+
+void CounterBasedRandomNumberGenerator::Destroy()
+{
+    delete mpInstance;
+    mpInstance = nullptr;
+}
+
+void CounterBasedRandomNumberGenerator::Reseed(uint64_t seed)
+{
+    mSeed = seed;
+}
+
+uint64_t CounterBasedRandomNumberGenerator::GetSeed() const
+{
+    return mSeed;
+}
+
+CounterBasedRandomStream CounterBasedRandomNumberGenerator::GetStream(unsigned cellId, unsigned timeStep, unsigned purpose) const
+{
+    return CounterBasedRandomStream(mSeed, cellId, timeStep, purpose);
+}
+
+CounterBasedRandomStream CounterBasedRandomNumberGenerator::GetStream(CellPtr pCell, unsigned purpose) const
+{
+    return CounterBasedRandomStream(mSeed, pCell->GetCellId(), SimulationTime::Instance()->GetTimeStepsElapsed(), purpose);
+}
+
+unsigned CounterBasedRandomNumberGenerator::LabelCells(const std::vector<CellPtr>& rCells,
+                                                       boost::shared_ptr<AbstractCellProperty> pLabel,
+                                                       double probability) const
+{
+    unsigned num_labelled = 0;
+    for (const CellPtr& p_cell : rCells)
+    {
+        if (GetStream(p_cell, LABELLING_STREAM).ranf() < probability)
+        {
+            p_cell->AddCellProperty(pLabel);
+            ++num_labelled;
+        }
+    }
+    return num_labelled;
+}
@@ -0,0 +1,230 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef COUNTERBASEDRANDOMNUMBERGENERATOR_HPP_
+#define COUNTERBASEDRANDOMNUMBERGENERATOR_HPP_
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "AbstractCellProperty.hpp"
+#include "Cell.hpp"
+
+/**
+ * A stream of random numbers for one decision about one cell, generated by the Philox4x32-10 counter-based generator
+ * (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC11).
+ *
+ * Unlike RandomNumberGenerator, a stream holds no shared state: its numbers are a pure function of the seed, cell ID,
+ * time step and purpose it was created with. Streams may therefore be created and used on any number of threads, in
+ * any order, with bitwise identical results. Streams are cheap to create and should be discarded after use.
+ *
+ * Streams are obtained from CounterBasedRandomNumberGenerator::GetStream().
+ */
+class CounterBasedRandomStream
+{
+private:
+
+    /** The Philox key: the seed. */
+    std::array<uint32_t, 2> mKey;
+
+    /** The Philox counter: cell ID, time step, purpose, and the number of blocks generated so far. */
+    std::array<uint32_t, 4> mCounter;
+
+    /** The most recently generated block of four 32-bit values. */
+    std::array<uint32_t, 4> mBlock;
+
+    /** The number of values of mBlock used so far. */
+    unsigned mBlockPosition = 4u;
+
+    /** Whether mSpareNormal holds the second deviate from the last Box-Muller transform. */
+    bool mHasSpareNormal = false;
+
+    /** The second deviate from the last Box-Muller transform. */
+    double mSpareNormal = 0.0;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param seed the seed
+     * @param cellId the cell ID
+     * @param timeStep the time step
+     * @param purpose an identifier for the decision being made
+     */
+    CounterBasedRandomStream(uint64_t seed, unsigned cellId, unsigned timeStep, unsigned purpose);
+
+    /**
+     * The Philox4x32-10 bijection.
+     *
+     * @param counter the counter
+     * @param key the key
+     * @return four pseudo-random 32-bit values
+     */
+    static std::array<uint32_t, 4> Philox4x32(std::array<uint32_t, 4> counter, std::array<uint32_t, 2> key);
+
+    /**
+     * @return the next pseudo-random 32-bit value
+     */
+    uint32_t NextUnsigned();
+
+    /**
+     * @return a uniformly distributed random number in the open interval (0, 1), with 53 random bits
+     */
+    double ranf();
+
+    /**
+     * @return a random number from the standard normal distribution
+     */
+    double StandardNormalRandomDeviate();
+
+    /**
+     * @param mean the mean
+     * @param stdDev the standard deviation
+     * @return a random number from a normal distribution
+     */
+    double NormalRandomDeviate(double mean, double stdDev);
+
+    /**
+     * @param mean the mean
+     * @return a random number from an exponential distribution
+     */
+    double ExponentialRandomDeviate(double mean);
+
+    /**
+     * Generate an angle from a von Mises distribution, using the rejection algorithm of Best and Fisher (1979).
+     *
+     * @param mean the mean angle
+     * @param concentration the concentration parameter
+     * @return an angle in (mean - pi, mean + pi]
+     */
+    double VonMisesRandomDeviate(double mean, double concentration);
+};
+
+/**
+ * A singleton holding the seed from which CounterBasedRandomStream objects are created, keyed by cell ID, time step
+ * and purpose.
+ *
+ * This replaces the use of RandomNumberGenerator for cell-level stochastic decisions (such as labelling, division
+ * trials and division directions), so that those decisions can be made in parallel and do not change when the order
+ * in which cells are visited changes.
+ */
+class CounterBasedRandomNumberGenerator
+{
+private:
+
+    /** The single instance of the class. */
+    static CounterBasedRandomNumberGenerator* mpInstance;
+
+    /** The seed. */
+    uint64_t mSeed = 0u;
+
+protected:
+
+    /**
+     * Protected constructor. Use Instance() to access the generator.
+     */
+    CounterBasedRandomNumberGenerator() = default;
+
+public:
+
+    /** Purpose of streams for general use. */
+    static constexpr unsigned GENERAL_STREAM = 0u;
+
+    /** Purpose of streams used to label cells. */
+    static constexpr unsigned LABELLING_STREAM = 1u;
+
+    /** Purpose of streams used by cell-cycle models. */
+    static constexpr unsigned CELL_CYCLE_STREAM = 2u;
+
+    /** Purpose of streams used by division rules. */
+    static constexpr unsigned DIVISION_DIRECTION_STREAM = 3u;
+
+    /**
+     * The generator is created the first time this is called, which must not happen on two threads at once; code
+     * that draws from streams on worker threads should call this first on the calling thread.
+     *
+     * @return a pointer to the generator object
+     */
+    static CounterBasedRandomNumberGenerator* Instance();
+
+    /**
+     * Destroy the current generator. It will be recreated, with seed zero, the next time Instance() is called.
+     */
+    static void Destroy();
+
+    /**
+     * Set the seed.
+     *
+     * @param seed the new seed
+     */
+    void Reseed(uint64_t seed);
+
+    /**
+     * @return the seed
+     */
+    uint64_t GetSeed() const;
+
+    /**
+     * @param cellId the cell ID
+     * @param timeStep the time step
+     * @param purpose an identifier for the decision being made (defaults to GENERAL_STREAM)
+     * @return the stream for the given cell, time step and purpose
+     */
+    CounterBasedRandomStream GetStream(unsigned cellId, unsigned timeStep, unsigned purpose = GENERAL_STREAM) const;
+
+    /**
+     * @param pCell the cell
+     * @param purpose an identifier for the decision being made
+     * @return the stream for the given cell and purpose, at the current time step of SimulationTime
+     */
+    CounterBasedRandomStream GetStream(CellPtr pCell, unsigned purpose) const;
+
+    /**
+     * Give each of the given cells a property, such as a CellLabel, with the given probability. Each decision is
+     * drawn from the LABELLING_STREAM of the cell at the current time step, so which cells are labelled depends only
+     * on the seed and the cell IDs, and not on the order of rCells or on any use of RandomNumberGenerator.
+     *
+     * @param rCells the cells
+     * @param pLabel the property to add
+     * @param probability the probability that each cell is labelled
+     * @return the number of cells labelled
+     */
+    unsigned LabelCells(const std::vector<CellPtr>& rCells, boost::shared_ptr<AbstractCellProperty> pLabel,
+                        double probability) const;
+};
+
+#endif /*COUNTERBASEDRANDOMNUMBERGENERATOR_HPP_*/
@@ -0,0 +1,213 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "ElementColouring.hpp"
+
+template<unsigned DIM>
+const unsigned ElementColouring<DIM>::UNCOLOURED;
+
+template<unsigned DIM>
+void ElementColouring<DIM>::ColourElement(MutableVertexMesh<DIM, DIM>& rMesh, unsigned elemIndex)
+{
+    VertexElement<DIM, DIM>* p_element = rMesh.GetElement(elemIndex);
+
+    mColourUsed.assign(mElementsByColour.size() + 1, 0u);
+    for (unsigned local_index = 0; local_index < p_element->GetNumNodes(); ++local_index)
+    {
+        for (const unsigned other_index : p_element->GetNode(local_index)->rGetContainingElementIndices())
+        {
+            const unsigned other_colour = mColours[other_index];
+            if (other_index != elemIndex && other_colour != UNCOLOURED)
+            {
+                if (other_colour >= mColourUsed.size())
+                {
+                    mColourUsed.resize(other_colour + 1, 0u);
+                }
+                mColourUsed[other_colour] = 1u;
+            }
+        }
+    }
+
+    // Keeping the old colour where possible leaves the neighbours' colours, and the colour lists, mostly unchanged
+    unsigned& r_colour = mColours[elemIndex];
+    if (r_colour == UNCOLOURED || (r_colour < mColourUsed.size() && mColourUsed[r_colour]))
+    {
+        r_colour = 0;
+        while (r_colour < mColourUsed.size() && mColourUsed[r_colour])
+        {
+            ++r_colour;
+        }
+    }
+}
+
+template<unsigned DIM>
+unsigned ElementColouring<DIM>::Update(MutableVertexMesh<DIM, DIM>& rMesh)
+{
+    const unsigned num_all_elements = rMesh.GetNumAllElements();
+    bool lists_changed = (num_all_elements != mColours.size());
+    mColours.resize(num_all_elements, UNCOLOURED);
+    mElementNodes.resize(num_all_elements);
+
+    mChangedElements.clear();
+    for (unsigned elem_index = 0; elem_index < num_all_elements; ++elem_index)
+    {
+        VertexElement<DIM, DIM>* p_element = rMesh.GetElement(elem_index);
+        std::vector<unsigned>& r_nodes = mElementNodes[elem_index];
+        if (p_element->IsDeleted())
+        {
+            if (mColours[elem_index] != UNCOLOURED)
+            {
+                mColours[elem_index] = UNCOLOURED;
+                r_nodes.clear();
+                lists_changed = true;
+            }
+            continue;
+        }
+
+        const unsigned num_nodes = p_element->GetNumNodes();
+        bool changed = (mColours[elem_index] == UNCOLOURED || r_nodes.size() != num_nodes);
+        for (unsigned local_index = 0; !changed && local_index < num_nodes; ++local_index)
+        {
+            changed = (r_nodes[local_index] != p_element->GetNodeGlobalIndex(local_index));
+        }
+        if (changed)
+        {
+            r_nodes.resize(num_nodes);
+            for (unsigned local_index = 0; local_index < num_nodes; ++local_index)
+            {
+                r_nodes[local_index] = p_element->GetNodeGlobalIndex(local_index);
+            }
+            mChangedElements.push_back(elem_index);
+        }
+    }
+
+    // Elements are recoloured one at a time, so each sees the colours already given to the others
+    for (const unsigned elem_index : mChangedElements)
+    {
+        const unsigned old_colour = mColours[elem_index];
+        ColourElement(rMesh, elem_index);
+        lists_changed = lists_changed || (mColours[elem_index] != old_colour);
+    }
+    mNumRecolouredElements = mChangedElements.size();
+
+    if (lists_changed)
+    {
+        for (auto& r_elements : mElementsByColour)
+        {
+            r_elements.clear();
+        }
+        for (unsigned elem_index = 0; elem_index < num_all_elements; ++elem_index)
+        {
+            const unsigned colour = mColours[elem_index];
+            if (colour != UNCOLOURED)
+            {
+                if (colour >= mElementsByColour.size())
+                {
+                    mElementsByColour.resize(colour + 1);
+                }
+                mElementsByColour[colour].push_back(elem_index);
+            }
+        }
+        while (!mElementsByColour.empty() && mElementsByColour.back().empty())
+        {
+            mElementsByColour.pop_back();
+        }
+    }
+
+    return mNumRecolouredElements;
+}
+
+template<unsigned DIM>
+void ElementColouring<DIM>::Clear()
+{
+    mColours.clear();
+    mElementNodes.clear();
+    mElementsByColour.clear();
+    mNumRecolouredElements = 0u;
+}
+
+template<unsigned DIM>
+unsigned ElementColouring<DIM>::GetNumColours() const
+{
+    return mElementsByColour.size();
+}
+
+template<unsigned DIM>
+const std::vector<unsigned>& ElementColouring<DIM>::rGetElementsOfColour(unsigned colour) const
+{
+    return mElementsByColour.at(colour);
+}
+
+template<unsigned DIM>
+unsigned ElementColouring<DIM>::GetColour(unsigned elemIndex) const
+{
+    return (elemIndex < mColours.size()) ? mColours[elemIndex] : UNCOLOURED;
+}
+
+template<unsigned DIM>
+unsigned ElementColouring<DIM>::GetNumRecolouredElements() const
+{
+    return mNumRecolouredElements;
+}
+
+template<unsigned DIM>
+bool ElementColouring<DIM>::IsValid(MutableVertexMesh<DIM, DIM>& rMesh) const
+{
+    for (auto elem_iter = rMesh.GetElementIteratorBegin(); elem_iter != rMesh.GetElementIteratorEnd(); ++elem_iter)
+    {
+        const unsigned elem_index = elem_iter->GetIndex();
+        const unsigned colour = GetColour(elem_index);
+        if (colour == UNCOLOURED)
+        {
+            return false;
+        }
+        for (unsigned local_index = 0; local_index < elem_iter->GetNumNodes(); ++local_index)
+        {
+            for (const unsigned other_index : elem_iter->GetNode(local_index)->rGetContainingElementIndices())
+            {
+                if (other_index != elem_index && GetColour(other_index) == colour)
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Explicit instantiation
+template class ElementColouring<1>;
+template class ElementColouring<2>;
+template class ElementColouring<3>;
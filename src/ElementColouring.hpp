@@ -0,0 +1,136 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef ELEMENTCOLOURING_HPP_
+#define ELEMENTCOLOURING_HPP_
+
+#include <vector>
+
+#include "MutableVertexMesh.hpp"
+
+/**
+ * A colouring of the elements of a vertex mesh in which no two elements that share a node have the same colour.
+ * The elements of one colour therefore touch disjoint sets of nodes, so a loop over them that adds to per-node
+ * quantities can be split between threads with no locks or atomics; see ParallelElementForceScatter.
+ *
+ * The colouring is kept up to date incrementally. Update() compares the nodes of each element with those seen
+ * last time, and recolours only the elements whose nodes have changed, as happens after a division, a T1 or T2
+ * swap, or a renumbering. This is enough: two elements can only start to share a node if at least one of them
+ * gains it. Each recoloured element keeps its colour if it is still free, and otherwise takes the smallest colour
+ * not used by an element it shares a node with.
+ */
+template<unsigned DIM>
+class ElementColouring
+{
+public:
+
+    /** The colour of an element that is deleted or has not been coloured. */
+    static const unsigned UNCOLOURED = static_cast<unsigned>(-1);
+
+private:
+
+    /** The colour of each element, indexed by element index. */
+    std::vector<unsigned> mColours;
+
+    /** The global indices of the nodes of each element when it was last coloured, indexed by element index. */
+    std::vector<std::vector<unsigned> > mElementNodes;
+
+    /** The indices of the elements of each colour, in increasing order. */
+    std::vector<std::vector<unsigned> > mElementsByColour;
+
+    /** The number of elements recoloured by the last call to Update(). */
+    unsigned mNumRecolouredElements = 0u;
+
+    /** Reused buffer of the indices of the elements whose nodes have changed. */
+    std::vector<unsigned> mChangedElements;
+
+    /** Reused buffer of flags marking the colours used by the neighbours of an element. */
+    std::vector<unsigned char> mColourUsed;
+
+    /**
+     * Give an element a colour not used by any element it shares a node with.
+     *
+     * @param rMesh the mesh
+     * @param elemIndex the index of the element
+     */
+    void ColourElement(MutableVertexMesh<DIM, DIM>& rMesh, unsigned elemIndex);
+
+public:
+
+    /**
+     * Bring the colouring up to date with the mesh.
+     *
+     * @param rMesh the mesh
+     * @return the number of elements recoloured
+     */
+    unsigned Update(MutableVertexMesh<DIM, DIM>& rMesh);
+
+    /**
+     * Forget the colouring, so that the next call to Update() colours every element afresh.
+     */
+    void Clear();
+
+    /**
+     * @return the number of colours
+     */
+    unsigned GetNumColours() const;
+
+    /**
+     * @param colour a colour
+     * @return the indices of the elements of that colour, in increasing order
+     */
+    const std::vector<unsigned>& rGetElementsOfColour(unsigned colour) const;
+
+    /**
+     * @param elemIndex the index of an element
+     * @return its colour, or UNCOLOURED
+     */
+    unsigned GetColour(unsigned elemIndex) const;
+
+    /**
+     * @return the number of elements recoloured by the last call to Update()
+     */
+    unsigned GetNumRecolouredElements() const;
+
+    /**
+     * Check the colouring against the mesh, without changing it.
+     *
+     * @param rMesh the mesh
+     * @return whether every element is coloured and no two elements sharing a node have the same colour
+     */
+    bool IsValid(MutableVertexMesh<DIM, DIM>& rMesh) const;
+};
+
+#endif /*ELEMENTCOLOURING_HPP_*/
@@ -0,0 +1,468 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "FastVoronoiVertexMeshGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "CounterBasedRandomNumberGenerator.hpp"
+#include "Exception.hpp"
+#include "ThreadedLoop.hpp"
+
+namespace
+{
+    /** A point in the plane. */
+    typedef std::array<double, 2> Point;
+
+    /**
+     * @param x a coordinate
+     * @param period the period
+     * @return x wrapped into [0, period)
+     */
+    double Wrap(double x, double period)
+    {
+        x -= period * std::floor(x / period);
+        return (x < period) ? x : 0.0;
+    }
+
+    /**
+     * @param rPolygon a polygon
+     * @return the square of the greatest distance of a vertex of the polygon from the origin
+     */
+    double MaxSquaredRadius(const std::vector<Point>& rPolygon)
+    {
+        double max_squared_radius = 0.0;
+        for (const Point& r_vertex : rPolygon)
+        {
+            max_squared_radius = std::max(max_squared_radius, r_vertex[0] * r_vertex[0] + r_vertex[1] * r_vertex[1]);
+        }
+        return max_squared_radius;
+    }
+
+    /**
+     * @param rPolygon a polygon, with anticlockwise vertices
+     * @return the centroid of the polygon
+     */
+    Point Centroid(const std::vector<Point>& rPolygon)
+    {
+        double twice_area = 0.0;
+        Point sum = {0.0, 0.0};
+        const unsigned num_vertices = rPolygon.size();
+        for (unsigned i = 0; i < num_vertices; ++i)
+        {
+            const Point& r_a = rPolygon[i];
+            const Point& r_b = rPolygon[(i + 1) % num_vertices];
+            const double cross = r_a[0] * r_b[1] - r_b[0] * r_a[1];
+            twice_area += cross;
+            sum[0] += (r_a[0] + r_b[0]) * cross;
+            sum[1] += (r_a[1] + r_b[1]) * cross;
+        }
+        return {sum[0] / (3.0 * twice_area), sum[1] / (3.0 * twice_area)};
+    }
+}
+
+FastVoronoiVertexMeshGenerator::FastVoronoiVertexMeshGenerator(unsigned numElementsX,
+                                                               unsigned numElementsY,
+                                                               unsigned numRelaxationSteps,
+                                                               double elementTargetArea,
+                                                               SeedLayout seedLayout,
+                                                               double jitter,
+                                                               uint64_t seed)
+    : mNumElementsX(numElementsX),
+      mNumElementsY(numElementsY)
+{
+    if (numElementsX < 2 || numElementsY < 2)
+    {
+        EXCEPTION("Need at least 2 by 2 cells");
+    }
+    if (elementTargetArea <= 0.0)
+    {
+        EXCEPTION("Specified target area must be strictly positive");
+    }
+    if (jitter < 0.0)
+    {
+        EXCEPTION("The jitter of the seeds must be non-negative");
+    }
+
+    const unsigned num_seeds = numElementsX * numElementsY;
+    mSeeds.resize(num_seeds);
+
+    if (seedLayout == JITTERED_HONEYCOMB)
+    {
+        // Alternate rows are offset by half a spacing; the box is periodic in y if numElementsY is even
+        const double spacing = std::sqrt(2.0 * elementTargetArea / std::sqrt(3.0));
+        const double row_spacing = 0.5 * std::sqrt(3.0) * spacing;
+        mWidth = numElementsX * spacing;
+        mHeight = numElementsY * row_spacing;
+
+        ThreadedLoop::Run(num_seeds, [&](unsigned begin, unsigned end, unsigned thread)
+        {
+            for (unsigned index = begin; index < end; ++index)
+            {
+                const unsigned row = index / numElementsX;
+                const unsigned column = index % numElementsX;
+
+                CounterBasedRandomStream stream(seed, index, 0u, CounterBasedRandomNumberGenerator::GENERAL_STREAM);
+                const double angle = 2.0 * M_PI * stream.ranf();
+                const double radius = jitter * spacing * std::sqrt(stream.ranf());
+
+                mSeeds[index] = {Wrap((column + 0.25 + 0.5 * (row % 2)) * spacing + radius * std::cos(angle), mWidth),
+                                 Wrap((row + 0.5) * row_spacing + radius * std::sin(angle), mHeight)};
+            }
+        });
+    }
+    else
+    {
+        const double spacing = std::sqrt(elementTargetArea);
+        mWidth = numElementsX * spacing;
+        mHeight = numElementsY * spacing;
+
+        ThreadedLoop::Run(num_seeds, [&](unsigned begin, unsigned end, unsigned thread)
+        {
+            for (unsigned index = begin; index < end; ++index)
+            {
+                CounterBasedRandomStream stream(seed, index, 0u, CounterBasedRandomNumberGenerator::GENERAL_STREAM);
+                const double x = mWidth * stream.ranf();
+                mSeeds[index] = {Wrap(x, mWidth), Wrap(mHeight * stream.ranf(), mHeight)};
+            }
+        });
+    }
+
+    // Buckets hold about one seed each
+    const double bucket_size = std::sqrt(elementTargetArea);
+    mNumBucketsX = std::max(1u, static_cast<unsigned>(mWidth / bucket_size));
+    mNumBucketsY = std::max(1u, static_cast<unsigned>(mHeight / bucket_size));
+    BucketSeeds();
+
+    for (unsigned step = 0; step < numRelaxationSteps; ++step)
+    {
+        RelaxSeeds();
+    }
+
+    BuildMesh();
+}
+
+void FastVoronoiVertexMeshGenerator::BucketSeeds()
+{
+    const double bucket_width = mWidth / mNumBucketsX;
+    const double bucket_height = mHeight / mNumBucketsY;
+    const unsigned num_buckets = mNumBucketsX * mNumBucketsY;
+
+    // A counting sort, keeping the seeds in each bucket in index order
+    std::vector<unsigned> seed_buckets(mSeeds.size());
+    mBucketStarts.assign(num_buckets + 1, 0u);
+    for (unsigned index = 0; index < mSeeds.size(); ++index)
+    {
+        const unsigned bucket_x = std::min(mNumBucketsX - 1, static_cast<unsigned>(mSeeds[index][0] / bucket_width));
+        const unsigned bucket_y = std::min(mNumBucketsY - 1, static_cast<unsigned>(mSeeds[index][1] / bucket_height));
+        seed_buckets[index] = bucket_y * mNumBucketsX + bucket_x;
+        ++mBucketStarts[seed_buckets[index] + 1];
+    }
+    for (unsigned bucket = 0; bucket < num_buckets; ++bucket)
+    {
+        mBucketStarts[bucket + 1] += mBucketStarts[bucket];
+    }
+
+    std::vector<unsigned> next_slot(mBucketStarts.begin(), mBucketStarts.end() - 1);
+    mBucketSeeds.resize(mSeeds.size());
+    for (unsigned index = 0; index < mSeeds.size(); ++index)
+    {
+        mBucketSeeds[next_slot[seed_buckets[index]]++] = index;
+    }
+}
+
+void FastVoronoiVertexMeshGenerator::ClipCell(VoronoiCell& rCell, VoronoiCell& rScratch,
+                                              const Point& rNormal, double offset, unsigned neighbour)
+{
+    rScratch.mVertices.clear();
+    rScratch.mNeighbours.clear();
+    const unsigned num_vertices = rCell.mVertices.size();
+    for (unsigned i = 0; i < num_vertices; ++i)
+    {
+        const Point& r_a = rCell.mVertices[i];
+        const Point& r_b = rCell.mVertices[(i + 1) % num_vertices];
+        const double f_a = r_a[0] * rNormal[0] + r_a[1] * rNormal[1] - offset;
+        const double f_b = r_b[0] * rNormal[0] + r_b[1] * rNormal[1] - offset;
+
+        // Where the edge leaves the half-plane, the cell continues along the new edge
+        if (f_a <= 0.0)
+        {
+            rScratch.mVertices.push_back(r_a);
+            rScratch.mNeighbours.push_back((f_a == 0.0 && f_b > 0.0) ? neighbour : rCell.mNeighbours[i]);
+        }
+        if ((f_a < 0.0 && f_b > 0.0) || (f_a > 0.0 && f_b < 0.0))
+        {
+            const double t = f_a / (f_a - f_b);
+            rScratch.mVertices.push_back({r_a[0] + t * (r_b[0] - r_a[0]), r_a[1] + t * (r_b[1] - r_a[1])});
+            rScratch.mNeighbours.push_back(f_a < 0.0 ? neighbour : rCell.mNeighbours[i]);
+        }
+    }
+    std::swap(rCell, rScratch);
+}
+
+void FastVoronoiVertexMeshGenerator::CalculateCell(unsigned seedIndex, VoronoiCell& rCell, VoronoiCell& rScratch) const
+{
+    const Point& r_seed = mSeeds[seedIndex];
+    const double bucket_width = mWidth / mNumBucketsX;
+    const double bucket_height = mHeight / mNumBucketsY;
+    const double min_bucket_size = std::min(bucket_width, bucket_height);
+    const int bucket_x = std::min(mNumBucketsX - 1, static_cast<unsigned>(r_seed[0] / bucket_width));
+    const int bucket_y = std::min(mNumBucketsY - 1, static_cast<unsigned>(r_seed[1] / bucket_height));
+
+    // Start from a square that contains the cell, whatever the size of the box
+    const double half_width = std::max(mWidth, mHeight);
+    rCell.mVertices.assign({{-half_width, -half_width}, {half_width, -half_width},
+                            {half_width, half_width}, {-half_width, half_width}});
+    rCell.mNeighbours.assign(4, UINT_MAX);
+    double max_squared_radius = MaxSquaredRadius(rCell.mVertices);
+
+    for (int ring = 0; ; ++ring)
+    {
+        /*
+         * Seeds in buckets in this ring are further than (ring - 1) bucket sizes from the seed, and a seed can only
+         * cut the cell if it is less than twice the greatest radius of the cell away.
+         */
+        const double min_distance = (ring - 1) * min_bucket_size;
+        if (ring > 1 && min_distance * min_distance >= 4.0 * max_squared_radius)
+        {
+            break;
+        }
+
+        for (int offset_y = -ring; offset_y <= ring; ++offset_y)
+        {
+            // Only visit the edge of the square of buckets
+            const int step_x = (offset_y == -ring || offset_y == ring) ? 1 : std::max(1, 2 * ring);
+            for (int offset_x = -ring; offset_x <= ring; offset_x += step_x)
+            {
+                // Wrap the bucket into the box, keeping the periodic image it came from
+                const int unwrapped_x = bucket_x + offset_x;
+                const int unwrapped_y = bucket_y + offset_y;
+                const int image_x = (unwrapped_x >= 0) ? unwrapped_x / static_cast<int>(mNumBucketsX)
+                                                       : -((-unwrapped_x - 1) / static_cast<int>(mNumBucketsX)) - 1;
+                const int image_y = (unwrapped_y >= 0) ? unwrapped_y / static_cast<int>(mNumBucketsY)
+                                                       : -((-unwrapped_y - 1) / static_cast<int>(mNumBucketsY)) - 1;
+                const unsigned bucket = (unwrapped_y - image_y * static_cast<int>(mNumBucketsY)) * mNumBucketsX
+                                        + (unwrapped_x - image_x * static_cast<int>(mNumBucketsX));
+
+                for (unsigned slot = mBucketStarts[bucket]; slot < mBucketStarts[bucket + 1]; ++slot)
+                {
+                    const unsigned other_index = mBucketSeeds[slot];
+                    if (other_index == seedIndex && image_x == 0 && image_y == 0)
+                    {
+                        continue;
+                    }
+
+                    const Point separation = {mSeeds[other_index][0] + image_x * mWidth - r_seed[0],
+                                              mSeeds[other_index][1] + image_y * mHeight - r_seed[1]};
+                    const double squared_distance = separation[0] * separation[0] + separation[1] * separation[1];
+                    if (squared_distance < 4.0 * max_squared_radius)
+                    {
+                        // Keep the side of the perpendicular bisector nearer this seed
+                        const bool is_shared = (image_x == 0 && image_y == 0);
+                        ClipCell(rCell, rScratch, separation, 0.5 * squared_distance, is_shared ? other_index : UINT_MAX);
+                        max_squared_radius = MaxSquaredRadius(rCell.mVertices);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void FastVoronoiVertexMeshGenerator::RelaxSeeds()
+{
+    std::vector<Point> relaxed_seeds(mSeeds.size());
+    ThreadedLoop::Run(mSeeds.size(), [&](unsigned begin, unsigned end, unsigned thread)
+    {
+        VoronoiCell cell;
+        VoronoiCell scratch;
+        for (unsigned index = begin; index < end; ++index)
+        {
+            CalculateCell(index, cell, scratch);
+            const Point centroid = Centroid(cell.mVertices);
+            relaxed_seeds[index] = {Wrap(mSeeds[index][0] + centroid[0], mWidth),
+                                    Wrap(mSeeds[index][1] + centroid[1], mHeight)};
+        }
+    });
+
+    mSeeds.swap(relaxed_seeds);
+    BucketSeeds();
+}
+
+void FastVoronoiVertexMeshGenerator::BuildMesh()
+{
+    const unsigned num_elements = mSeeds.size();
+
+    std::vector<VoronoiCell> cells(num_elements);
+    ThreadedLoop::Run(num_elements, [&](unsigned begin, unsigned end, unsigned thread)
+    {
+        VoronoiCell scratch;
+        for (unsigned index = begin; index < end; ++index)
+        {
+            CalculateCell(index, cells[index], scratch);
+            for (Point& r_vertex : cells[index].mVertices)
+            {
+                r_vertex[0] += mSeeds[index][0];
+                r_vertex[1] += mSeeds[index][1];
+            }
+        }
+    });
+
+    /*
+     * Neighbouring cells compute their shared vertices separately. A vertex is looked for among the nodes of the
+     * cells on either side of it that have already been added, and is merged with any node closer than a tolerance
+     * far larger than rounding error. This also collapses any edges shorter than the tolerance.
+     */
+    const double spacing = std::sqrt(mWidth * mHeight / num_elements);
+    const double tolerance = 1e-6 * spacing;
+
+    std::vector<Point> node_locations;
+    node_locations.reserve(2 * num_elements + 2 * (mNumElementsX + mNumElementsY));
+
+    std::vector<std::vector<unsigned> > element_node_indices(num_elements);
+    auto find_node = [&](unsigned neighbour, unsigned elemIndex, const Point& rLocation)
+    {
+        if (neighbour < elemIndex)
+        {
+            for (unsigned node_index : element_node_indices[neighbour])
+            {
+                const double dx = node_locations[node_index][0] - rLocation[0];
+                const double dy = node_locations[node_index][1] - rLocation[1];
+                if (dx * dx + dy * dy < tolerance * tolerance)
+                {
+                    return node_index;
+                }
+            }
+        }
+        return UINT_MAX;
+    };
+
+    for (unsigned elem_index = 0; elem_index < num_elements; ++elem_index)
+    {
+        const VoronoiCell& r_cell = cells[elem_index];
+        std::vector<unsigned>& r_node_indices = element_node_indices[elem_index];
+        const unsigned num_vertices = r_cell.mVertices.size();
+        r_node_indices.reserve(num_vertices);
+        for (unsigned i = 0; i < num_vertices; ++i)
+        {
+            const Point& r_vertex = r_cell.mVertices[i];
+            // Try the cells on either side of the vertex first, then any other neighbour, in case of degeneracy
+            unsigned node_index = find_node(r_cell.mNeighbours[(i + num_vertices - 1) % num_vertices], elem_index, r_vertex);
+            if (node_index == UINT_MAX)
+            {
+                node_index = find_node(r_cell.mNeighbours[i], elem_index, r_vertex);
+            }
+            for (unsigned j = 0; node_index == UINT_MAX && j < num_vertices; ++j)
+            {
+                node_index = find_node(r_cell.mNeighbours[j], elem_index, r_vertex);
+            }
+            if (node_index == UINT_MAX && !r_node_indices.empty())
+            {
+                const double dx = node_locations[r_node_indices.back()][0] - r_vertex[0];
+                const double dy = node_locations[r_node_indices.back()][1] - r_vertex[1];
+                if (dx * dx + dy * dy < tolerance * tolerance)
+                {
+                    node_index = r_node_indices.back();
+                }
+            }
+            if (node_index == UINT_MAX)
+            {
+                node_index = node_locations.size();
+                node_locations.push_back(r_vertex);
+            }
+
+            if (r_node_indices.empty() || r_node_indices.back() != node_index)
+            {
+                r_node_indices.push_back(node_index);
+            }
+        }
+        if (r_node_indices.size() > 1 && r_node_indices.front() == r_node_indices.back())
+        {
+            r_node_indices.pop_back();
+        }
+    }
+    std::vector<VoronoiCell>().swap(cells);
+
+    // Every vertex inside the tissue is shared by at least three cells
+    std::vector<unsigned> num_containing_elements(node_locations.size(), 0u);
+    for (const auto& r_node_indices : element_node_indices)
+    {
+        for (unsigned node_index : r_node_indices)
+        {
+            ++num_containing_elements[node_index];
+        }
+    }
+
+    std::vector<Node<2>*> nodes(node_locations.size());
+    for (unsigned node_index = 0; node_index < node_locations.size(); ++node_index)
+    {
+        nodes[node_index] = new Node<2>(node_index, num_containing_elements[node_index] < 3,
+                                        node_locations[node_index][0], node_locations[node_index][1]);
+    }
+
+    std::vector<VertexElement<2,2>*> elements(num_elements);
+    std::vector<Node<2>*> element_nodes;
+    for (unsigned elem_index = 0; elem_index < num_elements; ++elem_index)
+    {
+        element_nodes.clear();
+        for (unsigned node_index : element_node_indices[elem_index])
+        {
+            element_nodes.push_back(nodes[node_index]);
+        }
+        elements[elem_index] = new VertexElement<2,2>(elem_index, element_nodes);
+    }
+
+    mpMesh.reset(new MutableVertexMesh<2,2>(nodes, elements));
+}
+
+boost::shared_ptr<MutableVertexMesh<2,2> > FastVoronoiVertexMeshGenerator::GetMesh()
+{
+    return mpMesh;
+}
+
+double FastVoronoiVertexMeshGenerator::GetWidth() const
+{
+    return mWidth;
+}
+
+double FastVoronoiVertexMeshGenerator::GetHeight() const
+{
+    return mHeight;
+}
+
+const std::vector<std::array<double, 2> >& FastVoronoiVertexMeshGenerator::rGetSeeds() const
+{
+    return mSeeds;
+}
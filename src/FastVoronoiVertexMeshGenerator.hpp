@@ -0,0 +1,205 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef FASTVORONOIVERTEXMESHGENERATOR_HPP_
+#define FASTVORONOIVERTEXMESHGENERATOR_HPP_
+
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include "MutableVertexMesh.hpp"
+
+/**
+ * Generates the same kind of mesh as VoronoiVertexMeshGenerator, a numElementsX by numElementsY patch of Voronoi
+ * cells with a ragged boundary and a given mean element area, but fast enough for tissues of millions of cells.
+ *
+ * Seeds are placed on a jittered honeycomb, or uniformly at random, in a periodic box. The Voronoi cell of each seed
+ * is found by clipping a square with the bisectors of nearby seeds, found in rings of buckets around the seed until
+ * no further seed can cut the cell, so building the tessellation takes time proportional to the number of cells.
+ * Cells are independent, so they are built on multiple threads (see ThreadedLoop), as are the Lloyd relaxation
+ * steps, which move each seed to the centroid of its cell.
+ *
+ * The mesh has one element for each seed, with the shape of its cell in the periodic tessellation. Elements that
+ * are neighbours only across the periodic boundary do not share nodes, so the mesh boundary is ragged, as for
+ * VoronoiVertexMeshGenerator.
+ *
+ * Random numbers come from CounterBasedRandomStream, so the mesh depends only on the arguments to the constructor:
+ * not on the state of RandomNumberGenerator, nor on the number of threads.
+ */
+class FastVoronoiVertexMeshGenerator
+{
+public:
+
+    /** How to place the seeds. */
+    enum SeedLayout
+    {
+        /** On a honeycomb, each moved by a random displacement in a disc of radius jitter times the seed spacing. */
+        JITTERED_HONEYCOMB,
+        /** Uniformly at random. */
+        UNIFORM_RANDOM
+    };
+
+private:
+
+    /** The Voronoi cell of a seed. */
+    struct VoronoiCell
+    {
+        /** The vertices, in anticlockwise order. */
+        std::vector<std::array<double, 2> > mVertices;
+
+        /**
+         * For each vertex, the index of the seed across the edge to the next vertex, or UINT_MAX if that edge is
+         * shared only across the periodic boundary.
+         */
+        std::vector<unsigned> mNeighbours;
+    };
+
+    /** The number of elements in the x direction. */
+    unsigned mNumElementsX;
+
+    /** The number of elements in the y direction. */
+    unsigned mNumElementsY;
+
+    /** The width of the periodic box. */
+    double mWidth;
+
+    /** The height of the periodic box. */
+    double mHeight;
+
+    /** The locations of the seeds, in [0, mWidth) x [0, mHeight). */
+    std::vector<std::array<double, 2> > mSeeds;
+
+    /** The number of buckets in the x direction. */
+    unsigned mNumBucketsX;
+
+    /** The number of buckets in the y direction. */
+    unsigned mNumBucketsY;
+
+    /** The offset into mBucketSeeds of the seeds in each bucket, with a final entry for the end. */
+    std::vector<unsigned> mBucketStarts;
+
+    /** The indices of the seeds in each bucket in turn. */
+    std::vector<unsigned> mBucketSeeds;
+
+    /** The mesh. */
+    boost::shared_ptr<MutableVertexMesh<2,2> > mpMesh;
+
+    /**
+     * Sort the seeds into buckets.
+     */
+    void BucketSeeds();
+
+    /**
+     * Clip a Voronoi cell with the half-plane of points p satisfying p.normal <= offset.
+     *
+     * @param rCell the cell, which is replaced with the clipped cell
+     * @param rScratch working space
+     * @param rNormal the normal of the half-plane
+     * @param offset the offset of the half-plane
+     * @param neighbour the neighbour to record for the new edge
+     */
+    static void ClipCell(VoronoiCell& rCell, VoronoiCell& rScratch,
+                         const std::array<double, 2>& rNormal, double offset, unsigned neighbour);
+
+    /**
+     * Calculate the Voronoi cell of a seed in the periodic tessellation, relative to the seed.
+     *
+     * @param seedIndex the index of the seed
+     * @param rCell filled with the cell
+     * @param rScratch working space
+     */
+    void CalculateCell(unsigned seedIndex, VoronoiCell& rCell, VoronoiCell& rScratch) const;
+
+    /**
+     * Move every seed to the centroid of its Voronoi cell.
+     */
+    void RelaxSeeds();
+
+    /**
+     * Build the mesh from the Voronoi cells of the seeds.
+     */
+    void BuildMesh();
+
+public:
+
+    /**
+     * Constructor. Generates the mesh.
+     *
+     * @param numElementsX the number of elements in the x direction
+     * @param numElementsY the number of elements in the y direction
+     * @param numRelaxationSteps the number of Lloyd relaxation steps
+     * @param elementTargetArea the mean area of the elements (defaults to 1.0)
+     * @param seedLayout how to place the seeds (defaults to JITTERED_HONEYCOMB)
+     * @param jitter for JITTERED_HONEYCOMB, the maximum displacement of a seed as a fraction of the seed spacing (defaults to 0.3)
+     * @param seed the random seed (defaults to 0)
+     */
+    FastVoronoiVertexMeshGenerator(unsigned numElementsX,
+                                   unsigned numElementsY,
+                                   unsigned numRelaxationSteps,
+                                   double elementTargetArea = 1.0,
+                                   SeedLayout seedLayout = JITTERED_HONEYCOMB,
+                                   double jitter = 0.3,
+                                   uint64_t seed = 0u);
+
+    /**
+     * Destructor.
+     */
+    virtual ~FastVoronoiVertexMeshGenerator() = default;
+
+    /**
+     * @return a shared pointer to the mesh
+     */
+    boost::shared_ptr<MutableVertexMesh<2,2> > GetMesh();
+
+    /**
+     * @return the width of the periodic box in which the seeds lie
+     */
+    double GetWidth() const;
+
+    /**
+     * @return the height of the periodic box in which the seeds lie
+     */
+    double GetHeight() const;
+
+    /**
+     * @return the seed of each element, after relaxation
+     */
+    const std::vector<std::array<double, 2> >& rGetSeeds() const;
+};
+
+#endif /*FASTVORONOIVERTEXMESHGENERATOR_HPP_*/
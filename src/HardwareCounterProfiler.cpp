@@ -0,0 +1,395 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "HardwareCounterProfiler.hpp"
+
+#include "Exception.hpp"
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif // __linux__
+
+HardwareCounterProfiler* HardwareCounterProfiler::mpInstance = nullptr;
+
+HardwareCounterProfiler::ScopedPhase::ScopedPhase(const char* pName)
+{
+    HardwareCounterProfiler* p_profiler = HardwareCounterProfiler::Instance();
+    if (p_profiler->mEnabled)
+    {
+        mpProfiler = p_profiler;
+        mPhaseIndex = p_profiler->GetPhaseIndex(pName);
+        mEpoch = p_profiler->mEpoch;
+        p_profiler->mOpenPhases.push_back(mPhaseIndex);
+
+        // Read last, so the set-up above is not counted
+        p_profiler->Read(mStart);
+    }
+}
+
+HardwareCounterProfiler::ScopedPhase::~ScopedPhase()
+{
+    // The profiler may have been disabled or reset during the phase, in which case the phase is dropped
+    if (mpProfiler != nullptr && mpProfiler == mpInstance && mpProfiler->mEnabled && mpProfiler->mEpoch == mEpoch)
+    {
+        Reading end;
+        mpProfiler->Read(end);
+        mpProfiler->Accumulate(mPhaseIndex, mStart, end);
+
+        // Phases held by pointers need not end in the reverse order to which they started
+        std::vector<unsigned>& r_open_phases = mpProfiler->mOpenPhases;
+        for (unsigned i = r_open_phases.size(); i-- > 0;)
+        {
+            if (r_open_phases[i] == mPhaseIndex)
+            {
+                r_open_phases.erase(r_open_phases.begin() + i);
+                break;
+            }
+        }
+    }
+}
+
+HardwareCounterProfiler::HardwareCounterProfiler()
+    : mCountedThread(std::thread::id())
+{
+    for (unsigned counter = 0; counter < NUM_COUNTERS; ++counter)
+    {
+        mFileDescriptors[counter] = -1;
+        mReadPositions[counter] = 0u;
+        mCounterWasOpened[counter] = false;
+    }
+}
+
+HardwareCounterProfiler::~HardwareCounterProfiler()
+{
+    CloseCounters();
+}
+
+HardwareCounterProfiler* HardwareCounterProfiler::Instance()
+{
+    if (mpInstance == nullptr)
+    {
+        mpInstance = new HardwareCounterProfiler();
+    }
+    return mpInstance;
+}
+
+void HardwareCounterProfiler::Destroy()
+{
+    delete mpInstance;
+    mpInstance = nullptr;
+}
+
+std::string HardwareCounterProfiler::GetCounterName(unsigned counter)
+{
+    static const char* const names[NUM_COUNTERS] = {
+        "cycles", "instructions", "l1d_read_misses", "llc_misses", "branch_misses"
+    };
+    if (counter >= NUM_COUNTERS)
+    {
+        EXCEPTION("Unknown hardware counter " << counter);
+    }
+    return names[counter];
+}
+
+void HardwareCounterProfiler::OpenCounters()
+{
+#ifdef __linux__
+    const uint32_t types[NUM_COUNTERS] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE
+    };
+    const uint64_t configs[NUM_COUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    int leader = -1;
+    for (unsigned counter = 0; counter < NUM_COUNTERS; ++counter)
+    {
+        perf_event_attr attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = types[counter];
+        attributes.config = configs[counter];
+        attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attributes.disabled = (leader < 0) ? 1 : 0;
+
+        // User space only, which is all that is allowed at the default paranoia level
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+
+        // This thread, on any CPU; a counter the hardware lacks is simply left out
+        const int file_descriptor = syscall(__NR_perf_event_open, &attributes, 0, -1, leader, 0);
+        if (file_descriptor >= 0)
+        {
+            mFileDescriptors[counter] = file_descriptor;
+            mReadPositions[counter] = mNumOpenCounters++;
+            mCounterWasOpened[counter] = true;
+            if (leader < 0)
+            {
+                leader = file_descriptor;
+            }
+        }
+    }
+
+    if (leader >= 0)
+    {
+        ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif // __linux__
+}
+
+void HardwareCounterProfiler::CloseCounters()
+{
+#ifdef __linux__
+    // Members of the group are closed before the leader
+    for (unsigned counter = NUM_COUNTERS; counter-- > 0;)
+    {
+        if (mFileDescriptors[counter] >= 0)
+        {
+            close(mFileDescriptors[counter]);
+        }
+    }
+#endif // __linux__
+    for (unsigned counter = 0; counter < NUM_COUNTERS; ++counter)
+    {
+        mFileDescriptors[counter] = -1;
+    }
+    mNumOpenCounters = 0u;
+}
+
+void HardwareCounterProfiler::Read(Reading& rReading)
+{
+#ifdef __linux__
+    if (mNumOpenCounters > 0u)
+    {
+        // The layout of a group read: number of counters, times enabled and running, then the values
+        uint64_t buffer[3 + NUM_COUNTERS];
+        int leader = -1;
+        for (unsigned counter = 0; counter < NUM_COUNTERS && leader < 0; ++counter)
+        {
+            leader = mFileDescriptors[counter];
+        }
+        if (read(leader, buffer, (3 + mNumOpenCounters) * sizeof(uint64_t)) == static_cast<ssize_t>((3 + mNumOpenCounters) * sizeof(uint64_t)))
+        {
+            rReading.mTimeEnabled = buffer[1];
+            rReading.mTimeRunning = buffer[2];
+            for (unsigned counter = 0; counter < NUM_COUNTERS; ++counter)
+            {
+                if (mFileDescriptors[counter] >= 0)
+                {
+                    rReading.mValues[counter] = buffer[3 + mReadPositions[counter]];
+                }
+            }
+        }
+    }
+#endif // __linux__
+    rReading.mTime = std::chrono::steady_clock::now();
+}
+
+void HardwareCounterProfiler::Accumulate(unsigned phaseIndex, const Reading& rStart, const Reading& rEnd)
+{
+    PhaseData& r_phase = mPhases[phaseIndex];
+    r_phase.mNumCalls++;
+    r_phase.mWallTime += std::chrono::duration<double>(rEnd.mTime - rStart.mTime).count();
+
+    // If the counters were only counting for part of the phase, extrapolate to the whole phase
+    const uint64_t time_running = rEnd.mTimeRunning - rStart.mTimeRunning;
+    const double scale = (time_running > 0u) ? double(rEnd.mTimeEnabled - rStart.mTimeEnabled) / time_running : 0.0;
+    for (unsigned counter = 0; counter < NUM_COUNTERS; ++counter)
+    {
+        if (mFileDescriptors[counter] >= 0)
+        {
+            r_phase.mCounts[counter] += scale * double(rEnd.mValues[counter] - rStart.mValues[counter]);
+        }
+    }
+}
+
+unsigned HardwareCounterProfiler::GetPhaseIndex(const char* pName)
+{
+    auto iter = mPhaseIndices.find(pName);
+    if (iter == mPhaseIndices.end())
+    {
+        iter = mPhaseIndices.emplace(pName, mPhases.size()).first;
+        mPhases.emplace_back();
+        mPhases.back().mName = pName;
+    }
+    return iter->second;
+}
+
+void HardwareCounterProfiler::Enable()
+{
+    if (!mEnabled)
+    {
+        OpenCounters();
+        mEnabled = true;
+        ++mEpoch;
+        mCountedThread = std::this_thread::get_id();
+    }
+}
+
+void HardwareCounterProfiler::Disable()
+{
+    if (mEnabled)
+    {
+        mCountedThread = std::thread::id();
+        CloseCounters();
+        mEnabled = false;
+        ++mEpoch;
+        mOpenPhases.clear();
+    }
+}
+
+bool HardwareCounterProfiler::IsEnabled() const
+{
+    return mEnabled;
+}
+
+bool HardwareCounterProfiler::IsCounterAvailable(unsigned counter) const
+{
+    return counter < NUM_COUNTERS && mFileDescriptors[counter] >= 0;
+}
+
+bool HardwareCounterProfiler::WasCounterOpened(unsigned counter) const
+{
+    return counter < NUM_COUNTERS && mCounterWasOpened[counter];
+}
+
+void HardwareCounterProfiler::Reset()
+{
+    mPhases.clear();
+    mPhaseIndices.clear();
+    mOpenPhases.clear();
+    ++mEpoch;
+
+    // Only the counters open now contribute to the new totals
+    for (unsigned counter = 0; counter < NUM_COUNTERS; ++counter)
+    {
+        mCounterWasOpened[counter] = (mFileDescriptors[counter] >= 0);
+    }
+}
+
+void HardwareCounterProfiler::NoteWorkerThreads()
+{
+    // Other threads only read mCountedThread, which they never match
+    HardwareCounterProfiler* p_profiler = mpInstance;
+    if (p_profiler != nullptr && p_profiler->mCountedThread.load() == std::this_thread::get_id())
+    {
+        for (unsigned phase_index : p_profiler->mOpenPhases)
+        {
+            p_profiler->mPhases[phase_index].mUsedWorkerThreads = true;
+        }
+    }
+}
+
+const std::vector<HardwareCounterProfiler::PhaseData>& HardwareCounterProfiler::rGetPhases() const
+{
+    return mPhases;
+}
+
+const HardwareCounterProfiler::PhaseData& HardwareCounterProfiler::rGetPhase(const std::string& rName) const
+{
+    auto iter = mPhaseIndices.find(rName);
+    if (iter == mPhaseIndices.end())
+    {
+        EXCEPTION("No hardware counter totals for phase " + rName);
+    }
+    return mPhases[iter->second];
+}
+
+bool HardwareCounterProfiler::HasPhase(const std::string& rName) const
+{
+    return mPhaseIndices.find(rName) != mPhaseIndices.end();
+}
+
+void HardwareCounterProfiler::WriteReport(std::ostream& rStream) const
+{
+    rStream << "# phase\tcalls\twall_time";
+    for (unsigned counter = 0; counter < NUM_COUNTERS; ++counter)
+    {
+        rStream << "\t" << GetCounterName(counter);
+    }
+    rStream << "\tinstructions_per_cycle\tl1d_read_misses_per_kilo_instruction\tllc_misses_per_kilo_instruction"
+            << "\tbranch_misses_per_kilo_instruction\tcounted_threads\n";
+
+    for (const PhaseData& r_phase : mPhases)
+    {
+        rStream << r_phase.mName << "\t" << r_phase.mNumCalls << "\t" << r_phase.mWallTime;
+        for (unsigned counter = 0; counter < NUM_COUNTERS; ++counter)
+        {
+            rStream << "\t";
+            if (WasCounterOpened(counter))
+            {
+                rStream << static_cast<uint64_t>(r_phase.mCounts[counter] + 0.5);
+            }
+            else
+            {
+                rStream << "n/a";
+            }
+        }
+
+        const double instructions = r_phase.mCounts[INSTRUCTIONS];
+        const bool have_instructions = WasCounterOpened(INSTRUCTIONS) && instructions > 0.0;
+        rStream << "\t";
+        if (have_instructions && WasCounterOpened(CYCLES) && r_phase.mCounts[CYCLES] > 0.0)
+        {
+            rStream << instructions / r_phase.mCounts[CYCLES];
+        }
+        else
+        {
+            rStream << "n/a";
+        }
+        for (unsigned counter : {L1D_READ_MISSES, LLC_MISSES, BRANCH_MISSES})
+        {
+            rStream << "\t";
+            if (have_instructions && WasCounterOpened(counter))
+            {
+                rStream << 1000.0 * r_phase.mCounts[counter] / instructions;
+            }
+            else
+            {
+                rStream << "n/a";
+            }
+        }
+        rStream << "\t" << (r_phase.mUsedWorkerThreads ? "main_thread_only" : "all") << "\n";
+    }
+}
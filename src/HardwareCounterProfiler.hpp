@@ -0,0 +1,329 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef HARDWARECOUNTERPROFILER_HPP_
+#define HARDWARECOUNTERPROFILER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * A singleton that measures named phases of a simulation with the CPU's hardware performance counters, read with
+ * the Linux perf_event_open() interface: cycles, instructions, L1 data cache read misses, last level cache misses and
+ * branch mispredictions, as well as wall time. The instructions per cycle and misses per thousand instructions of a
+ * phase show whether it is limited by memory (low instructions per cycle, many cache misses) or by computation.
+ *
+ * Profiling is off until Enable() is called, usually by a HardwareCounterProfilerModifier; while it is off, a
+ * ScopedPhase costs a single test. Phases are marked in the code with a ScopedPhase, for example
+ *
+ *     HardwareCounterProfiler::ScopedPhase phase("SillyForce::AddForceContribution");
+ *
+ * and their counts are accumulated over all calls. Phases may be nested, in which case the counts of the outer phase
+ * include those of the inner one. Only the calling thread is counted, so phases should be marked on the main thread;
+ * the work of threads started by ThreadedLoop within a phase is not included. ThreadedLoop notes when it runs work on
+ * other threads, and such phases are labelled "main_thread_only" in the report: their wall times cover all the
+ * threads, but their counts only the main thread.
+ *
+ * If the counters cannot be opened (on systems other than Linux, or where /proc/sys/kernel/perf_event_paranoid
+ * forbids it, as in many containers), only wall times and numbers of calls are recorded; IsCounterAvailable() says
+ * which counters are in use, and WasCounterOpened() which were in use at any time since the totals were reset, so
+ * which totals can still be read once profiling is disabled. When the kernel has to share the counters between too many events, counts are scaled up
+ * by the fraction of time each was running.
+ */
+class HardwareCounterProfiler
+{
+public:
+
+    /** The hardware counters, in the order of the columns of the report. */
+    enum Counter
+    {
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_READ_MISSES,
+        LLC_MISSES,
+        BRANCH_MISSES,
+        NUM_COUNTERS
+    };
+
+    /** The totals of a phase. */
+    struct PhaseData
+    {
+        /** The name of the phase. */
+        std::string mName;
+
+        /** The number of times the phase was entered. */
+        unsigned mNumCalls = 0u;
+
+        /** The total wall time, in seconds. */
+        double mWallTime = 0.0;
+
+        /** The total of each counter, or zero for counters that are not available. */
+        double mCounts[NUM_COUNTERS] = {};
+
+        /** Whether ThreadedLoop ran work on other threads during the phase, which the counts do not include. */
+        bool mUsedWorkerThreads = false;
+    };
+
+private:
+
+    /** The values of the counters and the clock at one moment. */
+    struct Reading
+    {
+        /** The wall clock. */
+        std::chrono::steady_clock::time_point mTime;
+
+        /** The time for which the counters were enabled, in nanoseconds. */
+        uint64_t mTimeEnabled = 0u;
+
+        /** The time for which the counters were counting, in nanoseconds. */
+        uint64_t mTimeRunning = 0u;
+
+        /** The value of each counter that is open. */
+        uint64_t mValues[NUM_COUNTERS] = {};
+    };
+
+public:
+
+    /**
+     * Measures a phase from construction to destruction, if profiling is enabled.
+     */
+    class ScopedPhase
+    {
+    private:
+
+        /** The profiler, or nullptr if profiling was disabled on construction. */
+        HardwareCounterProfiler* mpProfiler = nullptr;
+
+        /** The index of the phase. */
+        unsigned mPhaseIndex = 0u;
+
+        /** The epoch of the profiler when the phase started. */
+        unsigned mEpoch = 0u;
+
+        /** The reading at the start of the phase. */
+        Reading mStart;
+
+    public:
+
+        /**
+         * Constructor. Starts measuring the phase.
+         *
+         * @param pName the name of the phase
+         */
+        ScopedPhase(const char* pName);
+
+        /**
+         * Destructor. Adds the counts since construction to the totals of the phase.
+         */
+        ~ScopedPhase();
+
+        /** Phases cannot be copied. */
+        ScopedPhase(const ScopedPhase&) = delete;
+
+        /** Phases cannot be copied. @return this */
+        ScopedPhase& operator=(const ScopedPhase&) = delete;
+    };
+
+private:
+
+    /** The single instance of the class. */
+    static HardwareCounterProfiler* mpInstance;
+
+    /** Whether profiling is enabled. */
+    bool mEnabled = false;
+
+    /** The file descriptor of each counter, or -1 if it is not open. The first open counter leads the group. */
+    int mFileDescriptors[NUM_COUNTERS];
+
+    /** The position of each open counter in a group read. */
+    unsigned mReadPositions[NUM_COUNTERS];
+
+    /** The number of counters open. */
+    unsigned mNumOpenCounters = 0u;
+
+    /** Whether each counter has been open since the totals were last reset, which Disable() does not change. */
+    bool mCounterWasOpened[NUM_COUNTERS];
+
+    /** The totals of each phase, in the order the phases were first entered. */
+    std::vector<PhaseData> mPhases;
+
+    /** The index in mPhases of each phase name. */
+    std::map<std::string, unsigned> mPhaseIndices;
+
+    /** The indices in mPhases of the phases being measured, in the order they were entered. */
+    std::vector<unsigned> mOpenPhases;
+
+    /** The thread that enabled profiling, which is the one counted, or no thread while profiling is disabled. */
+    std::atomic<std::thread::id> mCountedThread;
+
+    /**
+     * Incremented whenever the counters are opened or closed or the totals are reset, so that phases spanning any of
+     * these are dropped.
+     */
+    unsigned mEpoch = 0u;
+
+    /**
+     * Protected constructor. Use Instance() to access the profiler.
+     */
+    HardwareCounterProfiler();
+
+    /**
+     * Destructor. Closes the counters.
+     */
+    ~HardwareCounterProfiler();
+
+    /**
+     * Open as many of the counters as possible, as one group counting the calling thread in user space.
+     */
+    void OpenCounters();
+
+    /**
+     * Close the counters.
+     */
+    void CloseCounters();
+
+    /**
+     * Read the clock and the counters.
+     *
+     * @param rReading filled with the values
+     */
+    void Read(Reading& rReading);
+
+    /**
+     * Add the counts between two readings to the totals of a phase.
+     *
+     * @param phaseIndex the index of the phase
+     * @param rStart the reading at the start of the phase
+     * @param rEnd the reading at the end of the phase
+     */
+    void Accumulate(unsigned phaseIndex, const Reading& rStart, const Reading& rEnd);
+
+    /**
+     * @param pName the name of a phase
+     * @return its index in mPhases, adding it if necessary
+     */
+    unsigned GetPhaseIndex(const char* pName);
+
+public:
+
+    /**
+     * @return the single instance of the profiler
+     */
+    static HardwareCounterProfiler* Instance();
+
+    /**
+     * Destroy the profiler, closing the counters and discarding the totals.
+     */
+    static void Destroy();
+
+    /**
+     * @param counter a counter
+     * @return its name, as used in the report
+     */
+    static std::string GetCounterName(unsigned counter);
+
+    /**
+     * Start profiling, opening the counters. Does nothing if profiling is already enabled.
+     */
+    void Enable();
+
+    /**
+     * Stop profiling, closing the counters. The totals are kept.
+     */
+    void Disable();
+
+    /**
+     * @return whether profiling is enabled
+     */
+    bool IsEnabled() const;
+
+    /**
+     * @param counter a counter
+     * @return whether it is being counted
+     */
+    bool IsCounterAvailable(unsigned counter) const;
+
+    /**
+     * @param counter a counter
+     * @return whether it has been counted at any time since the totals were last reset, even if profiling has since
+     * been disabled
+     */
+    bool WasCounterOpened(unsigned counter) const;
+
+    /**
+     * Discard the totals of every phase.
+     */
+    void Reset();
+
+    /**
+     * Note that work of the phases being measured is running on threads other than the counted one, so their counts
+     * are incomplete. Called by ThreadedLoop; does nothing unless called on the counted thread.
+     */
+    static void NoteWorkerThreads();
+
+    /**
+     * @return the totals of each phase, in the order the phases were first entered
+     */
+    const std::vector<PhaseData>& rGetPhases() const;
+
+    /**
+     * @param rName the name of a phase
+     * @return the totals of the phase
+     */
+    const PhaseData& rGetPhase(const std::string& rName) const;
+
+    /**
+     * @param rName the name of a phase
+     * @return whether the phase has been entered since the totals were last reset
+     */
+    bool HasPhase(const std::string& rName) const;
+
+    /**
+     * Write a table of the totals of each phase, with instructions per cycle and misses per thousand instructions.
+     * Counters that have not been opened since the totals were last reset are written as "n/a". The last column,
+     * counted_threads, is "main_thread_only" for phases that ran work on ThreadedLoop workers and "all" otherwise.
+     *
+     * @param rStream the stream to write to
+     */
+    void WriteReport(std::ostream& rStream) const;
+};
+
+#endif /*HARDWARECOUNTERPROFILER_HPP_*/
@@ -0,0 +1,177 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "HardwareCounterProfilerModifier.hpp"
+
+#include <iostream>
+
+#include "AbstractCellBasedSimulation.hpp"
+#include "Exception.hpp"
+#include "OutputFileHandler.hpp"
+#include "Warnings.hpp"
+
+template<unsigned DIM>
+HardwareCounterProfilerModifier<DIM>::HardwareCounterProfilerModifier()
+    : AbstractCellBasedSimulationModifier<DIM>()
+{
+}
+
+template<unsigned DIM>
+bool HardwareCounterProfilerModifier<DIM>::GetPrintReport() const
+{
+    return mPrintReport;
+}
+
+template<unsigned DIM>
+void HardwareCounterProfilerModifier<DIM>::SetPrintReport(bool printReport)
+{
+    mPrintReport = printReport;
+}
+
+template<unsigned DIM>
+void HardwareCounterProfilerModifier<DIM>::SetSimulation(AbstractCellBasedSimulation<DIM,DIM>* pSimulation)
+{
+    mpSimulation = pSimulation;
+}
+
+template<unsigned DIM>
+void HardwareCounterProfilerModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    // An "Output" phase still open was started for output that did not happen, and has measured a whole time step
+    if (mpOutputPhase)
+    {
+        WARN_ONCE_ONLY("HardwareCounterProfilerModifier expected output at a time step without any, so its \"Output\" phase is not reliable");
+        mpOutputPhase.reset();
+    }
+
+    // The simulation writes its results straight after the last modifier's UpdateAtEndOfTimeStep()
+    const unsigned time_step = SimulationTime::Instance()->GetTimeStepsElapsed();
+    if (mpSimulation != nullptr && mOutputInterval > 0u && (time_step - mStartTimeStep) % mOutputInterval == 0u)
+    {
+        mpOutputPhase.reset(new HardwareCounterProfiler::ScopedPhase("Output"));
+    }
+}
+
+template<unsigned DIM>
+void HardwareCounterProfilerModifier<DIM>::UpdateAtEndOfOutputTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (mpSimulation == nullptr)
+    {
+        return;
+    }
+
+    if (mOutputInterval == 0u)
+    {
+        mOutputInterval = SimulationTime::Instance()->GetTimeStepsElapsed() - mStartTimeStep;
+    }
+    else if (!mpOutputPhase)
+    {
+        // Output at a time step that is not a multiple of the first one
+        WARN_ONCE_ONLY("HardwareCounterProfilerModifier did not expect output at this time step, so its \"Output\" phase is not reliable");
+    }
+    mpOutputPhase.reset();
+}
+
+template<unsigned DIM>
+void HardwareCounterProfilerModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    if (mpSimulation != nullptr)
+    {
+        // A modifier after this one would have its UpdateAtEndOfTimeStep() counted as output
+        const auto& r_modifiers = *(mpSimulation->GetSimulationModifiers());
+        if (r_modifiers.empty() || r_modifiers.back().get() != this)
+        {
+            EXCEPTION("HardwareCounterProfilerModifier must be the last modifier added to the simulation to measure its output");
+        }
+    }
+
+    mOutputDirectory = outputDirectory;
+    mStartTimeStep = SimulationTime::Instance()->GetTimeStepsElapsed();
+    mOutputInterval = 0u;
+
+    HardwareCounterProfiler* p_profiler = HardwareCounterProfiler::Instance();
+    mWasEnabled = p_profiler->IsEnabled();
+    p_profiler->Enable();
+    p_profiler->Reset();
+
+    mpSolvePhase.reset(new HardwareCounterProfiler::ScopedPhase("Solve"));
+}
+
+template<unsigned DIM>
+void HardwareCounterProfilerModifier<DIM>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    mpOutputPhase.reset();
+    mpSolvePhase.reset();
+
+    HardwareCounterProfiler* p_profiler = HardwareCounterProfiler::Instance();
+
+    OutputFileHandler output_file_handler(mOutputDirectory, false);
+    out_stream p_report_file = output_file_handler.OpenOutputFile("hardwarecounters.dat");
+    p_profiler->WriteReport(*p_report_file);
+    p_report_file->close();
+
+    if (mPrintReport)
+    {
+        std::cout << "\nHardware counters by phase:\n";
+        p_profiler->WriteReport(std::cout);
+        if (!p_profiler->WasCounterOpened(HardwareCounterProfiler::CYCLES))
+        {
+            std::cout << "Hardware counters are not available here (see /proc/sys/kernel/perf_event_paranoid)\n";
+        }
+    }
+
+    if (!mWasEnabled)
+    {
+        p_profiler->Disable();
+    }
+}
+
+template<unsigned DIM>
+void HardwareCounterProfilerModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<PrintReport>" << mPrintReport << "</PrintReport>\n";
+
+    // Call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class HardwareCounterProfilerModifier<1>;
+template class HardwareCounterProfilerModifier<2>;
+template class HardwareCounterProfilerModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(HardwareCounterProfilerModifier)
@@ -0,0 +1,198 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef HARDWARECOUNTERPROFILERMODIFIER_HPP_
+#define HARDWARECOUNTERPROFILERMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include <memory>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "HardwareCounterProfiler.hpp"
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+class AbstractCellBasedSimulation;
+
+/**
+ * A modifier that turns on the HardwareCounterProfiler for the duration of Solve(), and reports the totals of each
+ * phase at the end, in the file hardwarecounters.dat in the output directory and on standard output.
+ *
+ * The phases marked in the project classes are SillyForce::AddForceContribution, the squash of
+ * SillySimulationModifier, the CalculateCellDivisionVector() methods of the project division rules, and the writing
+ * of the project output modifiers. In addition this modifier measures "Solve", from SetupSolve() to
+ * UpdateAtEndOfSolve(), against which the others can be compared.
+ *
+ * If the simulation is given with SetSimulation(), the modifier also measures "Output", covering the writing of the
+ * results files of the cell population and the UpdateAtEndOfOutputTimeStep() methods of all the modifiers. A
+ * simulation has no hook just before it writes its results, so the phase is started in UpdateAtEndOfTimeStep(),
+ * and SetupSolve() throws unless this modifier is the last one in the simulation. The interval between output time
+ * steps is found from the first one, which is therefore not included in "Output"; a warning is given if later output
+ * does not follow that interval.
+ *
+ * A phase with few instructions per cycle and many last level cache misses per thousand instructions is limited by
+ * memory, and will benefit from better data layout more than from vectorisation or threads.
+ */
+template<unsigned DIM>
+class HardwareCounterProfilerModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+private:
+
+    /** Whether to write the report to standard output as well as to file. Defaults to true. */
+    bool mPrintReport = true;
+
+    /** The output directory of the current simulation. */
+    std::string mOutputDirectory;
+
+    /** The simulation whose output is measured, or nullptr if output is not measured. Not archived. */
+    AbstractCellBasedSimulation<DIM,DIM>* mpSimulation = nullptr;
+
+    /** The time step at which the current simulation started. */
+    unsigned mStartTimeStep = 0u;
+
+    /** The number of time steps between output time steps, or 0 until the first output time step. */
+    unsigned mOutputInterval = 0u;
+
+    /** The "Solve" phase, while a simulation is running. */
+    std::unique_ptr<HardwareCounterProfiler::ScopedPhase> mpSolvePhase;
+
+    /** The "Output" phase, while results are being written. */
+    std::unique_ptr<HardwareCounterProfiler::ScopedPhase> mpOutputPhase;
+
+    /** Whether the profiler was enabled before SetupSolve(), in which case it is left enabled. */
+    bool mWasEnabled = false;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & mPrintReport;
+    }
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    HardwareCounterProfilerModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~HardwareCounterProfilerModifier() = default;
+
+    /**
+     * @return mPrintReport
+     */
+    bool GetPrintReport() const;
+
+    /**
+     * Set mPrintReport.
+     *
+     * @param printReport the new value of mPrintReport
+     */
+    void SetPrintReport(bool printReport);
+
+    /**
+     * Set the simulation this modifier belongs to, so that its output is measured in the "Output" phase. The
+     * simulation is not archived, so must be set again on a simulation that has been loaded.
+     *
+     * @param pSimulation the simulation, to which this modifier must be added last, or nullptr to stop measuring
+     * output
+     */
+    void SetSimulation(AbstractCellBasedSimulation<DIM,DIM>* pSimulation);
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Starts the "Output" phase if output is measured and this is an output time step.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden UpdateAtEndOfOutputTimeStep() method.
+     *
+     * Ends the "Output" phase.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfOutputTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Enables the profiler, discards any earlier totals and starts the "Solve" phase. Throws if a simulation has been
+     * set and this modifier is not the last one in it.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden UpdateAtEndOfSolve() method.
+     *
+     * Ends the "Solve" phase, writes the report and disables the profiler. The totals remain available from
+     * HardwareCounterProfiler::Instance() until the next simulation.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(HardwareCounterProfilerModifier)
+
+#endif /*HARDWARECOUNTERPROFILERMODIFIER_HPP_*/
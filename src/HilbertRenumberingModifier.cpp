@@ -0,0 +1,344 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "HilbertRenumberingModifier.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+#include "VertexBasedCellPopulation.hpp"
+#include "VertexElementMap.hpp"
+
+namespace
+{
+    /**
+     * @param rKeys a key for each item
+     * @return the indices of the items sorted by key, with ties broken by index
+     */
+    std::vector<unsigned> SortByKey(const std::vector<uint64_t>& rKeys)
+    {
+        std::vector<unsigned> order(rKeys.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [&rKeys](unsigned a, unsigned b)
+        {
+            return rKeys[a] < rKeys[b] || (rKeys[a] == rKeys[b] && a < b);
+        });
+        return order;
+    }
+}
+
+template<unsigned DIM>
+HilbertRenumberingModifier<DIM>::HilbertRenumberingModifier()
+    : AbstractCellBasedSimulationModifier<DIM>()
+{
+}
+
+template<unsigned DIM>
+uint64_t HilbertRenumberingModifier<DIM>::CalculateHilbertIndex(uint32_t x, uint32_t y)
+{
+    uint64_t index = 0u;
+    for (uint32_t s = 1u << 15; s > 0u; s >>= 1)
+    {
+        const uint32_t rx = (x & s) ? 1u : 0u;
+        const uint32_t ry = (y & s) ? 1u : 0u;
+        index += static_cast<uint64_t>(s) * s * ((3u * rx) ^ ry);
+
+        // Rotate the lower bits into the orientation of the quadrant
+        if (ry == 0u)
+        {
+            if (rx == 1u)
+            {
+                x = s - 1u - (x & (s - 1u));
+                y = s - 1u - (y & (s - 1u));
+            }
+            std::swap(x, y);
+        }
+    }
+    return index;
+}
+
+template<unsigned DIM>
+double HilbertRenumberingModifier<DIM>::CalculateLocalityMetric(MutableVertexMesh<DIM,DIM>& rMesh)
+{
+    double total_gap = 0.0;
+    unsigned num_gaps = 0u;
+    for (auto elem_iter = rMesh.GetElementIteratorBegin(); elem_iter != rMesh.GetElementIteratorEnd(); ++elem_iter)
+    {
+        const unsigned num_nodes = elem_iter->GetNumNodes();
+        for (unsigned local_index = 0; local_index < num_nodes; ++local_index)
+        {
+            const unsigned index_a = elem_iter->GetNodeGlobalIndex(local_index);
+            const unsigned index_b = elem_iter->GetNodeGlobalIndex((local_index + 1) % num_nodes);
+            total_gap += (index_a > index_b) ? index_a - index_b : index_b - index_a;
+        }
+        num_gaps += num_nodes;
+    }
+    return (num_gaps > 0u) ? total_gap / num_gaps : 0.0;
+}
+
+template<unsigned DIM>
+bool HilbertRenumberingModifier<DIM>::RenumberMesh(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if constexpr (DIM != 2)
+    {
+        EXCEPTION("HilbertRenumberingModifier is to be used with a 2D VertexBasedCellPopulation only");
+    }
+    else
+    {
+        auto& r_population = static_cast<VertexBasedCellPopulation<DIM>&>(rCellPopulation);
+        MutableVertexMesh<DIM,DIM>& r_mesh = r_population.rGetMesh();
+
+        const unsigned num_nodes = r_mesh.GetNumNodes();
+        const unsigned num_elements = r_mesh.GetNumElements();
+        if (num_nodes != r_mesh.GetNumAllNodes() || num_elements != r_mesh.GetNumAllElements() || num_nodes == 0u)
+        {
+            return false;
+        }
+
+        // Scale node locations to the integer grid on which the Hilbert curve is defined
+        c_vector<double, DIM> lower = r_mesh.GetNode(0)->rGetLocation();
+        c_vector<double, DIM> upper = lower;
+        for (unsigned node_index = 0; node_index < num_nodes; ++node_index)
+        {
+            const c_vector<double, DIM>& r_location = r_mesh.GetNode(node_index)->rGetLocation();
+            for (unsigned dim = 0; dim < DIM; ++dim)
+            {
+                lower[dim] = std::min(lower[dim], r_location[dim]);
+                upper[dim] = std::max(upper[dim], r_location[dim]);
+            }
+        }
+        const double scale = 65535.0 / std::max(std::max(upper[0] - lower[0], upper[1] - lower[1]), 1e-12);
+        auto hilbert_index = [&](const c_vector<double, DIM>& rLocation)
+        {
+            return CalculateHilbertIndex(static_cast<uint32_t>(scale * (rLocation[0] - lower[0])),
+                                         static_cast<uint32_t>(scale * (rLocation[1] - lower[1])));
+        };
+
+        // Nodes are ordered by their own location, and elements by the mean location of their nodes
+        std::vector<uint64_t> node_keys(num_nodes);
+        for (unsigned node_index = 0; node_index < num_nodes; ++node_index)
+        {
+            node_keys[node_index] = hilbert_index(r_mesh.GetNode(node_index)->rGetLocation());
+        }
+
+        std::vector<uint64_t> element_keys(num_elements);
+        for (unsigned elem_index = 0; elem_index < num_elements; ++elem_index)
+        {
+            VertexElement<DIM,DIM>* p_element = r_mesh.GetElement(elem_index);
+            c_vector<double, DIM> mean_location = zero_vector<double>(DIM);
+            for (unsigned local_index = 0; local_index < p_element->GetNumNodes(); ++local_index)
+            {
+                mean_location += p_element->GetNode(local_index)->rGetLocation();
+            }
+            element_keys[elem_index] = hilbert_index(mean_location / static_cast<double>(p_element->GetNumNodes()));
+        }
+
+        const std::vector<unsigned> node_order = SortByKey(node_keys);
+        const std::vector<unsigned> element_order = SortByKey(element_keys);
+
+        std::vector<unsigned> new_element_indices(num_elements);
+        for (unsigned new_index = 0; new_index < num_elements; ++new_index)
+        {
+            new_element_indices[element_order[new_index]] = new_index;
+        }
+
+        // Note the new element of each cell before any indices change
+        std::vector<std::pair<CellPtr, unsigned> > cell_locations;
+        cell_locations.reserve(r_population.GetNumRealCells());
+        for (auto cell_iter = r_population.Begin(); cell_iter != r_population.End(); ++cell_iter)
+        {
+            cell_locations.emplace_back(*cell_iter, new_element_indices[r_population.GetLocationIndexUsingCell(*cell_iter)]);
+        }
+
+        /*
+         * The mesh does not allow its nodes and elements to be reordered in place, so a copy of each is added in the
+         * new order, after the existing ones, and the originals are deleted. Removing the deleted nodes and elements
+         * then leaves the copies numbered in the new order, as after a ReMesh(). The copies are also allocated in the
+         * new order, which keeps neighbouring nodes close together on the heap.
+         */
+        std::vector<Node<DIM>*> new_nodes(num_nodes);
+        for (unsigned new_index = 0; new_index < num_nodes; ++new_index)
+        {
+            Node<DIM>* p_old_node = r_mesh.GetNode(node_order[new_index]);
+            Node<DIM>* p_new_node = new Node<DIM>(num_nodes + new_index, p_old_node->rGetLocation(), p_old_node->IsBoundaryNode());
+            if (p_old_node->HasNodeAttributes())
+            {
+                for (double attribute : p_old_node->rGetNodeAttributes())
+                {
+                    p_new_node->AddNodeAttribute(attribute);
+                }
+                p_new_node->SetRegion(p_old_node->GetRegion());
+                p_new_node->SetRadius(p_old_node->GetRadius());
+                p_new_node->SetIsParticle(p_old_node->IsParticle());
+                p_new_node->AddAppliedForceContribution(p_old_node->rGetAppliedForce());
+            }
+            r_mesh.AddNode(p_new_node);
+            new_nodes[node_order[new_index]] = p_new_node;
+        }
+
+        for (unsigned new_index = 0; new_index < num_elements; ++new_index)
+        {
+            VertexElement<DIM,DIM>* p_old_element = r_mesh.GetElement(element_order[new_index]);
+            std::vector<Node<DIM>*> element_nodes(p_old_element->GetNumNodes());
+            for (unsigned local_index = 0; local_index < element_nodes.size(); ++local_index)
+            {
+                element_nodes[local_index] = new_nodes[p_old_element->GetNodeGlobalIndex(local_index)];
+            }
+            auto p_new_element = new VertexElement<DIM,DIM>(num_elements + new_index, element_nodes);
+            for (unsigned i = 0; i < p_old_element->GetNumElementAttributes(); ++i)
+            {
+                p_new_element->AddElementAttribute(p_old_element->rGetElementAttributes()[i]);
+            }
+            r_mesh.AddElement(p_new_element);
+        }
+
+        // Deleting an element also deletes any of its nodes that are in no other element, so check before deleting
+        for (unsigned elem_index = 0; elem_index < num_elements; ++elem_index)
+        {
+            r_mesh.DeleteElementPriorToReMesh(elem_index);
+        }
+        for (unsigned node_index = 0; node_index < num_nodes; ++node_index)
+        {
+            if (!r_mesh.GetNode(node_index)->IsDeleted())
+            {
+                r_mesh.DeleteNodePriorToReMesh(node_index);
+            }
+        }
+
+        VertexElementMap element_map(r_mesh.GetNumAllElements());
+        r_mesh.RemoveDeletedNodesAndElements(element_map);
+
+        for (auto& r_cell_location : cell_locations)
+        {
+            r_population.SetCellUsingLocationIndex(r_cell_location.second, r_cell_location.first);
+        }
+
+        mBaselineLocalityMetric = CalculateLocalityMetric(r_mesh);
+        ++mNumRenumberings;
+        return true;
+    }
+}
+
+template<unsigned DIM>
+unsigned HilbertRenumberingModifier<DIM>::GetRenumberingInterval() const
+{
+    return mRenumberingInterval;
+}
+
+template<unsigned DIM>
+void HilbertRenumberingModifier<DIM>::SetRenumberingInterval(unsigned renumberingInterval)
+{
+    mRenumberingInterval = renumberingInterval;
+}
+
+template<unsigned DIM>
+unsigned HilbertRenumberingModifier<DIM>::GetLocalityCheckInterval() const
+{
+    return mLocalityCheckInterval;
+}
+
+template<unsigned DIM>
+void HilbertRenumberingModifier<DIM>::SetLocalityCheckInterval(unsigned localityCheckInterval)
+{
+    mLocalityCheckInterval = localityCheckInterval;
+}
+
+template<unsigned DIM>
+double HilbertRenumberingModifier<DIM>::GetDegradationThreshold() const
+{
+    return mDegradationThreshold;
+}
+
+template<unsigned DIM>
+void HilbertRenumberingModifier<DIM>::SetDegradationThreshold(double degradationThreshold)
+{
+    mDegradationThreshold = degradationThreshold;
+}
+
+template<unsigned DIM>
+unsigned HilbertRenumberingModifier<DIM>::GetNumRenumberings() const
+{
+    return mNumRenumberings;
+}
+
+template<unsigned DIM>
+void HilbertRenumberingModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    const unsigned time_step = SimulationTime::Instance()->GetTimeStepsElapsed();
+
+    if (mRenumberingInterval > 0u && time_step % mRenumberingInterval == 0u)
+    {
+        RenumberMesh(rCellPopulation);
+    }
+    else if (mLocalityCheckInterval > 0u && time_step % mLocalityCheckInterval == 0u)
+    {
+        auto& r_mesh = static_cast<VertexBasedCellPopulation<DIM>&>(rCellPopulation).rGetMesh();
+        if (CalculateLocalityMetric(r_mesh) > mDegradationThreshold * mBaselineLocalityMetric)
+        {
+            RenumberMesh(rCellPopulation);
+        }
+    }
+}
+
+template<unsigned DIM>
+void HilbertRenumberingModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    if (DIM != 2 || dynamic_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation) == nullptr)
+    {
+        EXCEPTION("HilbertRenumberingModifier is to be used with a 2D VertexBasedCellPopulation only");
+    }
+
+    RenumberMesh(rCellPopulation);
+}
+
+template<unsigned DIM>
+void HilbertRenumberingModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<RenumberingInterval>" << mRenumberingInterval << "</RenumberingInterval>\n";
+    *rParamsFile << "\t\t\t<LocalityCheckInterval>" << mLocalityCheckInterval << "</LocalityCheckInterval>\n";
+    *rParamsFile << "\t\t\t<DegradationThreshold>" << mDegradationThreshold << "</DegradationThreshold>\n";
+
+    // Call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class HilbertRenumberingModifier<1>;
+template class HilbertRenumberingModifier<2>;
+template class HilbertRenumberingModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(HilbertRenumberingModifier)
@@ -0,0 +1,216 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef HILBERTRENUMBERINGMODIFIER_HPP_
+#define HILBERTRENUMBERINGMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include <cstdint>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "MutableVertexMesh.hpp"
+
+/**
+ * A modifier that renumbers the nodes and elements of the mesh of a 2D vertex-based cell population in the order in
+ * which they lie along a Hilbert curve, so that nodes and elements that are close in space are also close in memory.
+ *
+ * Divisions append new nodes and elements to the end of the mesh, and T1 and T3 swaps connect nodes with distant
+ * indices, so without renumbering loops over nodes and elements increasingly jump around in memory.
+ *
+ * The mesh is renumbered when the simulation starts, and then at the end of a time step either
+ *  - every mRenumberingInterval time steps, if this is non-zero; or
+ *  - every mLocalityCheckInterval time steps, if the locality metric (see CalculateLocalityMetric()) exceeds
+ *    mDegradationThreshold times its value just after the last renumbering.
+ *
+ * The mapping from cells to elements is updated to match. Note that any output that lists nodes or elements by index
+ * (e.g. the standard results files) follows the new numbering from the time step at which it changes.
+ *
+ * Renumbering replaces every node and element by a copy, using only the public methods of MutableVertexMesh, so as
+ * after a ReMesh() any pointers to them held elsewhere are no longer valid.
+ */
+template<unsigned DIM>
+class HilbertRenumberingModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+private:
+
+    /** The number of time steps between unconditional renumberings, or zero to renumber only on degradation. Defaults to zero. */
+    unsigned mRenumberingInterval = 0u;
+
+    /** The number of time steps between checks of the locality metric. Defaults to 100. */
+    unsigned mLocalityCheckInterval = 100u;
+
+    /** The factor by which the locality metric may grow before the mesh is renumbered. Defaults to 1.5. */
+    double mDegradationThreshold = 1.5;
+
+    /** The locality metric just after the last renumbering. */
+    double mBaselineLocalityMetric = 0.0;
+
+    /** The number of times the mesh has been renumbered. */
+    unsigned mNumRenumberings = 0u;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & mRenumberingInterval;
+        archive & mLocalityCheckInterval;
+        archive & mDegradationThreshold;
+        archive & mBaselineLocalityMetric;
+        archive & mNumRenumberings;
+    }
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    HilbertRenumberingModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~HilbertRenumberingModifier() = default;
+
+    /**
+     * @param x a coordinate, scaled to [0, 65535]
+     * @param y a coordinate, scaled to [0, 65535]
+     * @return the distance of the point (x, y) along a Hilbert curve filling the square [0, 65535]^2
+     */
+    static uint64_t CalculateHilbertIndex(uint32_t x, uint32_t y);
+
+    /**
+     * Calculate a measure of how scattered the node indices of the mesh are: the mean absolute difference between
+     * the indices of adjacent nodes of each element.
+     *
+     * @param rMesh the mesh
+     * @return the locality metric
+     */
+    static double CalculateLocalityMetric(MutableVertexMesh<DIM,DIM>& rMesh);
+
+    /**
+     * Renumber the nodes and elements of the mesh of the cell population along a Hilbert curve, and update the
+     * mapping from cells to elements.
+     *
+     * The mesh is not renumbered if it contains deleted nodes or elements that have not yet been removed.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @return whether the mesh was renumbered
+     */
+    bool RenumberMesh(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * @return mRenumberingInterval
+     */
+    unsigned GetRenumberingInterval() const;
+
+    /**
+     * Set mRenumberingInterval.
+     *
+     * @param renumberingInterval the new value of mRenumberingInterval
+     */
+    void SetRenumberingInterval(unsigned renumberingInterval);
+
+    /**
+     * @return mLocalityCheckInterval
+     */
+    unsigned GetLocalityCheckInterval() const;
+
+    /**
+     * Set mLocalityCheckInterval.
+     *
+     * @param localityCheckInterval the new value of mLocalityCheckInterval
+     */
+    void SetLocalityCheckInterval(unsigned localityCheckInterval);
+
+    /**
+     * @return mDegradationThreshold
+     */
+    double GetDegradationThreshold() const;
+
+    /**
+     * Set mDegradationThreshold.
+     *
+     * @param degradationThreshold the new value of mDegradationThreshold
+     */
+    void SetDegradationThreshold(double degradationThreshold);
+
+    /**
+     * @return mNumRenumberings
+     */
+    unsigned GetNumRenumberings() const;
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Renumbers the mesh if it is due.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Checks the cell population is a 2D vertex-based one, and renumbers the mesh.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(HilbertRenumberingModifier)
+
+#endif /*HILBERTRENUMBERINGMODIFIER_HPP_*/
@@ -0,0 +1,373 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "InSituStatisticsModifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "CellLabel.hpp"
+#include "OutputFileHandler.hpp"
+#include "ThreadedLoop.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+namespace
+{
+    /** Partial sums of the statistics over the cells handled by one thread. */
+    template<unsigned DIM>
+    struct PartialStatistics
+    {
+        /** The sum of cell areas. */
+        double mAreaSum = 0.0;
+
+        /** The sum of squared cell areas. */
+        double mSquaredAreaSum = 0.0;
+
+        /** The area histogram. */
+        std::vector<unsigned> mAreaHistogram;
+
+        /** The polygon class distribution. */
+        std::vector<unsigned> mPolygonClassCounts;
+
+        /** The length of edges shared by a labelled and an unlabelled cell. */
+        double mHeterotypicLength = 0.0;
+
+        /** The length of edges shared by two cells. */
+        double mSharedLength = 0.0;
+
+        /** The sum of cell centroids. */
+        c_vector<double, DIM> mCentroidSum = zero_vector<double>(DIM);
+    };
+}
+
+template<unsigned DIM>
+InSituStatisticsModifier<DIM>::InSituStatisticsModifier()
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      mInitialCentroid(zero_vector<double>(DIM)),
+      mCentroidDrift(zero_vector<double>(DIM))
+{
+}
+
+template<unsigned DIM>
+unsigned InSituStatisticsModifier<DIM>::GetNumAreaBins() const
+{
+    return mNumAreaBins;
+}
+
+template<unsigned DIM>
+void InSituStatisticsModifier<DIM>::SetNumAreaBins(unsigned numAreaBins)
+{
+    mNumAreaBins = numAreaBins;
+}
+
+template<unsigned DIM>
+double InSituStatisticsModifier<DIM>::GetMaxHistogramArea() const
+{
+    return mMaxHistogramArea;
+}
+
+template<unsigned DIM>
+void InSituStatisticsModifier<DIM>::SetMaxHistogramArea(double maxHistogramArea)
+{
+    mMaxHistogramArea = maxHistogramArea;
+}
+
+template<unsigned DIM>
+unsigned InSituStatisticsModifier<DIM>::GetMaxPolygonClass() const
+{
+    return mMaxPolygonClass;
+}
+
+template<unsigned DIM>
+void InSituStatisticsModifier<DIM>::SetMaxPolygonClass(unsigned maxPolygonClass)
+{
+    mMaxPolygonClass = maxPolygonClass;
+}
+
+template<unsigned DIM>
+unsigned InSituStatisticsModifier<DIM>::GetNumCells() const
+{
+    return mNumCells;
+}
+
+template<unsigned DIM>
+double InSituStatisticsModifier<DIM>::GetMeanArea() const
+{
+    return mMeanArea;
+}
+
+template<unsigned DIM>
+double InSituStatisticsModifier<DIM>::GetAreaStandardDeviation() const
+{
+    return mAreaStandardDeviation;
+}
+
+template<unsigned DIM>
+const std::vector<unsigned>& InSituStatisticsModifier<DIM>::rGetAreaHistogram() const
+{
+    return mAreaHistogram;
+}
+
+template<unsigned DIM>
+const std::vector<unsigned>& InSituStatisticsModifier<DIM>::rGetPolygonClassCounts() const
+{
+    return mPolygonClassCounts;
+}
+
+template<unsigned DIM>
+double InSituStatisticsModifier<DIM>::GetHeterotypicBoundaryFraction() const
+{
+    return mHeterotypicBoundaryFraction;
+}
+
+template<unsigned DIM>
+const c_vector<double, DIM>& InSituStatisticsModifier<DIM>::rGetCentroidDrift() const
+{
+    return mCentroidDrift;
+}
+
+template<unsigned DIM>
+void InSituStatisticsModifier<DIM>::Sample(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    auto& r_population = static_cast<VertexBasedCellPopulation<DIM>&>(rCellPopulation);
+    MutableVertexMesh<DIM,DIM>& r_mesh = r_population.rGetMesh();
+
+    // Look up the element and label of each cell first, as the population's maps are not safe to read concurrently
+    std::vector<unsigned> element_indices;
+    std::vector<bool> is_labelled(r_mesh.GetNumAllElements(), false);
+    element_indices.reserve(r_population.GetNumRealCells());
+    for (const CellPtr& rp_cell : r_population.rGetCells())
+    {
+        if (!rp_cell->IsDead())
+        {
+            const unsigned elem_index = r_population.GetLocationIndexUsingCell(rp_cell);
+            element_indices.push_back(elem_index);
+            is_labelled[elem_index] = rp_cell->HasCellProperty<CellLabel>();
+        }
+    }
+
+    const unsigned num_threads = ThreadedLoop::GetNumThreads();
+    std::vector<PartialStatistics<DIM> > partials(num_threads);
+    ThreadedLoop::Run(element_indices.size(), [&](unsigned begin, unsigned end, unsigned thread)
+    {
+        PartialStatistics<DIM>& r_partial = partials[thread];
+        r_partial.mAreaHistogram.assign(mNumAreaBins, 0u);
+        r_partial.mPolygonClassCounts.assign(mMaxPolygonClass + 1, 0u);
+
+        for (unsigned i = begin; i < end; ++i)
+        {
+            const unsigned elem_index = element_indices[i];
+            VertexElement<DIM,DIM>* p_element = r_mesh.GetElement(elem_index);
+
+            const double area = r_mesh.GetVolumeOfElement(elem_index);
+            r_partial.mAreaSum += area;
+            r_partial.mSquaredAreaSum += area * area;
+            const double scaled_area = mNumAreaBins * std::max(0.0, area) / mMaxHistogramArea;
+            ++r_partial.mAreaHistogram[(scaled_area < mNumAreaBins) ? static_cast<unsigned>(scaled_area) : mNumAreaBins - 1];
+
+            r_partial.mCentroidSum += r_mesh.GetCentroidOfElement(elem_index);
+
+            // Find the cell on the other side of each edge, counting the length of each shared edge from one side only
+            unsigned num_neighbours = 0;
+            const unsigned num_nodes = p_element->GetNumNodes();
+            for (unsigned local_index = 0; local_index < num_nodes; ++local_index)
+            {
+                Node<DIM>* p_node_a = p_element->GetNode(local_index);
+                Node<DIM>* p_node_b = p_element->GetNode((local_index + 1) % num_nodes);
+                const std::set<unsigned>& r_elements_b = p_node_b->rGetContainingElementIndices();
+                for (unsigned other_index : p_node_a->rGetContainingElementIndices())
+                {
+                    if (other_index != elem_index && r_elements_b.count(other_index) > 0)
+                    {
+                        ++num_neighbours;
+                        if (other_index > elem_index)
+                        {
+                            const double length = norm_2(r_mesh.GetVectorFromAtoB(p_node_a->rGetLocation(), p_node_b->rGetLocation()));
+                            r_partial.mSharedLength += length;
+                            if (is_labelled[elem_index] != is_labelled[other_index])
+                            {
+                                r_partial.mHeterotypicLength += length;
+                            }
+                        }
+                        break;
+                    }
+                }
+            }
+            ++r_partial.mPolygonClassCounts[std::min(num_neighbours, mMaxPolygonClass)];
+        }
+    });
+
+    // Combine the partial sums in thread order
+    PartialStatistics<DIM> total;
+    total.mAreaHistogram.assign(mNumAreaBins, 0u);
+    total.mPolygonClassCounts.assign(mMaxPolygonClass + 1, 0u);
+    for (const auto& r_partial : partials)
+    {
+        total.mAreaSum += r_partial.mAreaSum;
+        total.mSquaredAreaSum += r_partial.mSquaredAreaSum;
+        for (unsigned bin = 0; bin < r_partial.mAreaHistogram.size(); ++bin)
+        {
+            total.mAreaHistogram[bin] += r_partial.mAreaHistogram[bin];
+        }
+        for (unsigned polygon_class = 0; polygon_class < r_partial.mPolygonClassCounts.size(); ++polygon_class)
+        {
+            total.mPolygonClassCounts[polygon_class] += r_partial.mPolygonClassCounts[polygon_class];
+        }
+        total.mHeterotypicLength += r_partial.mHeterotypicLength;
+        total.mSharedLength += r_partial.mSharedLength;
+        total.mCentroidSum += r_partial.mCentroidSum;
+    }
+
+    mNumCells = element_indices.size();
+    mMeanArea = (mNumCells > 0u) ? total.mAreaSum / mNumCells : 0.0;
+    mAreaStandardDeviation = (mNumCells > 0u) ? std::sqrt(std::max(0.0, total.mSquaredAreaSum / mNumCells - mMeanArea * mMeanArea)) : 0.0;
+    mAreaHistogram = total.mAreaHistogram;
+    mPolygonClassCounts = total.mPolygonClassCounts;
+    mHeterotypicBoundaryFraction = (total.mSharedLength > 0.0) ? total.mHeterotypicLength / total.mSharedLength : 0.0;
+
+    const c_vector<double, DIM> centroid = (mNumCells > 0u) ? c_vector<double, DIM>(total.mCentroidSum / static_cast<double>(mNumCells))
+                                                            : c_vector<double, DIM>(zero_vector<double>(DIM));
+    if (mLastSampleTime < 0.0)
+    {
+        mInitialCentroid = centroid;
+    }
+    mCentroidDrift = centroid - mInitialCentroid;
+
+    const double time = SimulationTime::Instance()->GetTime();
+    *mpStatisticsFile << time << "\t" << mNumCells << "\t" << mMeanArea << "\t" << mAreaStandardDeviation;
+    for (unsigned count : mAreaHistogram)
+    {
+        *mpStatisticsFile << "\t" << count;
+    }
+    for (unsigned count : mPolygonClassCounts)
+    {
+        *mpStatisticsFile << "\t" << count;
+    }
+    *mpStatisticsFile << "\t" << mHeterotypicBoundaryFraction;
+    for (unsigned dim = 0; dim < DIM; ++dim)
+    {
+        *mpStatisticsFile << "\t" << mCentroidDrift[dim];
+    }
+    *mpStatisticsFile << "\n";
+    mpStatisticsFile->flush();
+
+    mLastSampleTime = time;
+}
+
+template<unsigned DIM>
+void InSituStatisticsModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+}
+
+template<unsigned DIM>
+void InSituStatisticsModifier<DIM>::UpdateAtEndOfOutputTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (mpStatisticsFile)
+    {
+        Sample(rCellPopulation);
+    }
+}
+
+template<unsigned DIM>
+void InSituStatisticsModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    if (DIM != 2 || dynamic_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation) == nullptr)
+    {
+        EXCEPTION("InSituStatisticsModifier is to be used with a 2D VertexBasedCellPopulation only");
+    }
+    if (mNumAreaBins == 0u || mMaxHistogramArea <= 0.0)
+    {
+        EXCEPTION("The area histogram of InSituStatisticsModifier must have a positive number of bins and upper limit");
+    }
+
+    OutputFileHandler output_file_handler(outputDirectory, false);
+    mpStatisticsFile = output_file_handler.OpenOutputFile("insitustatistics.dat");
+
+    // The header names every column, so the file can be read without knowing the parameters
+    *mpStatisticsFile << "# time\tnum_cells\tmean_area\tarea_sd";
+    for (unsigned bin = 0; bin < mNumAreaBins; ++bin)
+    {
+        *mpStatisticsFile << "\tarea_bin_" << bin * mMaxHistogramArea / mNumAreaBins;
+    }
+    for (unsigned polygon_class = 0; polygon_class <= mMaxPolygonClass; ++polygon_class)
+    {
+        *mpStatisticsFile << "\tneighbours_" << polygon_class;
+    }
+    *mpStatisticsFile << "\theterotypic_boundary_fraction";
+    for (unsigned dim = 0; dim < DIM; ++dim)
+    {
+        *mpStatisticsFile << "\tcentroid_drift_" << dim;
+    }
+    *mpStatisticsFile << "\n";
+
+    mLastSampleTime = -1.0;
+    Sample(rCellPopulation);
+}
+
+template<unsigned DIM>
+void InSituStatisticsModifier<DIM>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (!mpStatisticsFile)
+    {
+        return;
+    }
+
+    if (SimulationTime::Instance()->GetTime() > mLastSampleTime)
+    {
+        Sample(rCellPopulation);
+    }
+    mpStatisticsFile->close();
+    mpStatisticsFile.reset();
+}
+
+template<unsigned DIM>
+void InSituStatisticsModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<NumAreaBins>" << mNumAreaBins << "</NumAreaBins>\n";
+    *rParamsFile << "\t\t\t<MaxHistogramArea>" << mMaxHistogramArea << "</MaxHistogramArea>\n";
+    *rParamsFile << "\t\t\t<MaxPolygonClass>" << mMaxPolygonClass << "</MaxPolygonClass>\n";
+
+    // Call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class InSituStatisticsModifier<1>;
+template class InSituStatisticsModifier<2>;
+template class InSituStatisticsModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(InSituStatisticsModifier)
@@ -0,0 +1,266 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef INSITUSTATISTICSMODIFIER_HPP_
+#define INSITUSTATISTICSMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include <vector>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+
+/**
+ * A modifier that computes summary statistics of a 2D vertex-based cell population at each output time step, and
+ * writes them as one line of the file insitustatistics.dat in the output directory. This replaces writing per-cell
+ * data with writers such as CellVolumesWriter and reducing it afterwards: the size of the output does not grow with
+ * the number of cells.
+ *
+ * The statistics are:
+ *  - the number of cells, and the mean and standard deviation of their areas;
+ *  - a histogram of cell areas, with mNumAreaBins equal bins on [0, mMaxHistogramArea), the last of which also
+ *    counts larger cells;
+ *  - the polygon class distribution: the number of cells with each number of neighbours (cells that share an edge)
+ *    from 0 to mMaxPolygonClass, the last of which also counts cells with more neighbours;
+ *  - the heterotypic boundary fraction: the fraction of the total length of edges shared by two cells that is
+ *    shared by a labelled and an unlabelled cell (see CellLabel);
+ *  - the centroid drift: the displacement of the centroid of the population since the start of the simulation.
+ *
+ * The per-cell work is split across threads with ThreadedLoop, each of which reduces into its own partial sums.
+ */
+template<unsigned DIM>
+class InSituStatisticsModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+private:
+
+    /** The number of bins in the area histogram. Defaults to 20. */
+    unsigned mNumAreaBins = 20u;
+
+    /** The upper limit of the area histogram. Defaults to 2.0. */
+    double mMaxHistogramArea = 2.0;
+
+    /** The largest polygon class counted separately. Defaults to 10. */
+    unsigned mMaxPolygonClass = 10u;
+
+    /** The number of cells at the last sample. */
+    unsigned mNumCells = 0u;
+
+    /** The mean cell area at the last sample. */
+    double mMeanArea = 0.0;
+
+    /** The standard deviation of cell area at the last sample. */
+    double mAreaStandardDeviation = 0.0;
+
+    /** The area histogram at the last sample. */
+    std::vector<unsigned> mAreaHistogram;
+
+    /** The polygon class distribution at the last sample. */
+    std::vector<unsigned> mPolygonClassCounts;
+
+    /** The heterotypic boundary fraction at the last sample. */
+    double mHeterotypicBoundaryFraction = 0.0;
+
+    /** The centroid of the population at the start of the simulation. */
+    c_vector<double, DIM> mInitialCentroid;
+
+    /** The centroid drift at the last sample. */
+    c_vector<double, DIM> mCentroidDrift;
+
+    /** The time of the last sample. */
+    double mLastSampleTime = -1.0;
+
+    /** The statistics file, while a simulation is running. */
+    out_stream mpStatisticsFile;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & mNumAreaBins;
+        archive & mMaxHistogramArea;
+        archive & mMaxPolygonClass;
+    }
+
+    /**
+     * Compute the statistics and write them to the statistics file.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void Sample(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    InSituStatisticsModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~InSituStatisticsModifier() = default;
+
+    /**
+     * @return mNumAreaBins
+     */
+    unsigned GetNumAreaBins() const;
+
+    /**
+     * Set mNumAreaBins.
+     *
+     * @param numAreaBins the new value of mNumAreaBins
+     */
+    void SetNumAreaBins(unsigned numAreaBins);
+
+    /**
+     * @return mMaxHistogramArea
+     */
+    double GetMaxHistogramArea() const;
+
+    /**
+     * Set mMaxHistogramArea.
+     *
+     * @param maxHistogramArea the new value of mMaxHistogramArea
+     */
+    void SetMaxHistogramArea(double maxHistogramArea);
+
+    /**
+     * @return mMaxPolygonClass
+     */
+    unsigned GetMaxPolygonClass() const;
+
+    /**
+     * Set mMaxPolygonClass.
+     *
+     * @param maxPolygonClass the new value of mMaxPolygonClass
+     */
+    void SetMaxPolygonClass(unsigned maxPolygonClass);
+
+    /**
+     * @return the number of cells at the last sample
+     */
+    unsigned GetNumCells() const;
+
+    /**
+     * @return the mean cell area at the last sample
+     */
+    double GetMeanArea() const;
+
+    /**
+     * @return the standard deviation of cell area at the last sample
+     */
+    double GetAreaStandardDeviation() const;
+
+    /**
+     * @return the area histogram at the last sample
+     */
+    const std::vector<unsigned>& rGetAreaHistogram() const;
+
+    /**
+     * @return the polygon class distribution at the last sample
+     */
+    const std::vector<unsigned>& rGetPolygonClassCounts() const;
+
+    /**
+     * @return the heterotypic boundary fraction at the last sample
+     */
+    double GetHeterotypicBoundaryFraction() const;
+
+    /**
+     * @return the centroid drift at the last sample
+     */
+    const c_vector<double, DIM>& rGetCentroidDrift() const;
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Does nothing: statistics are computed at output time steps only.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden UpdateAtEndOfOutputTimeStep() method.
+     *
+     * Computes and writes the statistics.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfOutputTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Checks the cell population is a 2D vertex-based one, opens the statistics file, and computes and writes the
+     * statistics of the initial state.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden UpdateAtEndOfSolve() method.
+     *
+     * Computes and writes the statistics of the final state, unless it fell on an output time step, and closes the file.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(InSituStatisticsModifier)
+
+#endif /*INSITUSTATISTICSMODIFIER_HPP_*/
@@ -0,0 +1,311 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "LabelPairDifferentialAdhesionForce.hpp"
+
+#include <algorithm>
+#include <climits>
+#include "CellLabel.hpp"
+
+template <unsigned DIM>
+LabelPairDifferentialAdhesionForce<DIM>::LabelPairDifferentialAdhesionForce()
+        : NagaiHondaDifferentialAdhesionForce<DIM>()
+{
+    UpdateAdhesionMatrix();
+}
+
+template <unsigned DIM>
+void LabelPairDifferentialAdhesionForce<DIM>::UpdateAdhesionMatrix()
+{
+    const double cell_cell = this->GetNagaiHondaCellCellAdhesionEnergyParameter();
+    const double labelled_cell = this->GetNagaiHondaLabelledCellCellAdhesionEnergyParameter();
+    const double labelled_labelled = this->GetNagaiHondaLabelledCellLabelledCellAdhesionEnergyParameter();
+    const double cell_boundary = this->GetNagaiHondaCellBoundaryAdhesionEnergyParameter();
+    const double labelled_boundary = this->GetNagaiHondaLabelledCellBoundaryAdhesionEnergyParameter();
+
+    mAdhesionMatrix[0][0] = cell_cell;
+    mAdhesionMatrix[0][1] = labelled_cell;
+    mAdhesionMatrix[1][0] = labelled_cell;
+    mAdhesionMatrix[1][1] = labelled_labelled;
+    mAdhesionMatrix[0][BOUNDARY_INDEX] = cell_boundary;
+    mAdhesionMatrix[BOUNDARY_INDEX][0] = cell_boundary;
+    mAdhesionMatrix[1][BOUNDARY_INDEX] = labelled_boundary;
+    mAdhesionMatrix[BOUNDARY_INDEX][1] = labelled_boundary;
+    mAdhesionMatrix[BOUNDARY_INDEX][BOUNDARY_INDEX] = cell_boundary;
+}
+
+template <unsigned DIM>
+void LabelPairDifferentialAdhesionForce<DIM>::UpdateLabelBitmask(VertexBasedCellPopulation<DIM>& rCellPopulation)
+{
+    mLabelBitmask.assign(rCellPopulation.rGetMesh().GetNumAllElements(), 0u);
+
+    for (auto cell_iter = rCellPopulation.Begin(); cell_iter != rCellPopulation.End(); ++cell_iter)
+    {
+        const unsigned elem_index = rCellPopulation.GetLocationIndexUsingCell(*cell_iter);
+        mLabelBitmask[elem_index] = cell_iter->template HasCellProperty<CellLabel>() ? 1u : 0u;
+    }
+}
+
+template <unsigned DIM>
+unsigned LabelPairDifferentialAdhesionForce<DIM>::GetOtherElementSharingEdge(Node<DIM>* pNodeA,
+                                                                             Node<DIM>* pNodeB,
+                                                                             unsigned elemIndex)
+{
+    // Each node is contained in only a handful of elements, so a linear scan beats a set intersection
+    const std::set<unsigned>& r_elements_b = pNodeB->rGetContainingElementIndices();
+    for (const unsigned other_index : pNodeA->rGetContainingElementIndices())
+    {
+        if (other_index != elemIndex && r_elements_b.find(other_index) != r_elements_b.end())
+        {
+            return other_index;
+        }
+    }
+    return UINT_MAX;
+}
+
+template <unsigned DIM>
+void LabelPairDifferentialAdhesionForce<DIM>::AddForceContributionFromElements(VertexBasedCellPopulation<DIM>& rCellPopulation,
+                                                                               const std::vector<unsigned>& rElementIndices,
+                                                                               const std::vector<unsigned char>* pNodeMask)
+{
+    MutableVertexMesh<DIM, DIM>& r_mesh = rCellPopulation.rGetMesh();
+
+    UpdateAdhesionMatrix();
+
+    const double deformation_parameter = this->GetNagaiHondaDeformationEnergyParameter();
+    const double membrane_parameter = this->GetNagaiHondaMembraneSurfaceEnergyParameter();
+
+    /*
+     * First pass over elements: compute the prefactors of the area and perimeter gradients in the energy
+     * gradient, i.e. -2*lambda*(A - A0) and 2*beta*(P - P0), once per element.
+     */
+    const unsigned num_all_elements = r_mesh.GetNumAllElements();
+    mAreaPrefactors.resize(num_all_elements);
+    mPerimeterPrefactors.resize(num_all_elements);
+
+    for (const unsigned elem_index : rElementIndices)
+    {
+        double target_area = 0.0;
+        try
+        {
+            target_area = rCellPopulation.GetCellUsingLocationIndex(elem_index)->GetCellData()->GetItem("target area");
+        }
+        catch (Exception&)
+        {
+            EXCEPTION("You need to add an AbstractTargetAreaModifier to the simulation in order to use LabelPairDifferentialAdhesionForce");
+        }
+
+        const double area = r_mesh.GetVolumeOfElement(elem_index);
+        const double perimeter = r_mesh.GetSurfaceAreaOfElement(elem_index);
+        const double target_perimeter = 2.0 * sqrt(M_PI * target_area);
+
+        mAreaPrefactors[elem_index] = -2.0 * deformation_parameter * (area - target_area);
+        mPerimeterPrefactors[elem_index] = 2.0 * membrane_parameter * (perimeter - target_perimeter);
+    }
+
+    /*
+     * Second pass over edges. Every term in the energy gradient splits into per-edge pieces: the area gradient at
+     * a node is half the rotated vector between its neighbours, which is the sum of half the rotated vectors
+     * along its two edges, and the perimeter and adhesion gradients are unit vectors along each edge. An internal
+     * edge is visited from both of its elements; we only process it from the element with the lower index,
+     * adding the contributions of both elements at once.
+     */
+    for (const unsigned elem_index : rElementIndices)
+    {
+        VertexElement<DIM, DIM>* p_element = r_mesh.GetElement(elem_index);
+        const unsigned num_nodes_elem = p_element->GetNumNodes();
+
+        for (unsigned local_index = 0; local_index < num_nodes_elem; local_index++)
+        {
+            Node<DIM>* p_node_a = p_element->GetNode(local_index);
+            Node<DIM>* p_node_b = p_element->GetNode((local_index + 1) % num_nodes_elem);
+
+            const bool update_a = (pNodeMask == nullptr) || (*pNodeMask)[p_node_a->GetIndex()];
+            const bool update_b = (pNodeMask == nullptr) || (*pNodeMask)[p_node_b->GetIndex()];
+            if (!update_a && !update_b)
+            {
+                continue;
+            }
+
+            const unsigned other_index = GetOtherElementSharingEdge(p_node_a, p_node_b, elem_index);
+            const bool is_boundary_edge = (other_index == UINT_MAX);
+
+            if (!is_boundary_edge && other_index < elem_index)
+            {
+                continue;
+            }
+
+            const c_vector<double, DIM> edge = r_mesh.GetVectorFromAtoB(p_node_a->rGetLocation(), p_node_b->rGetLocation());
+            const c_vector<double, DIM> unit_edge = edge / norm_2(edge);
+
+            c_vector<double, DIM> half_rotated_edge;
+            half_rotated_edge[0] = 0.5 * edge[1];
+            half_rotated_edge[1] = -0.5 * edge[0];
+
+            const unsigned label_this = mLabelBitmask[elem_index];
+            const unsigned label_other = is_boundary_edge ? BOUNDARY_INDEX : mLabelBitmask[other_index];
+
+            // The parent class counts the adhesion of an internal edge once from each of its two elements
+            const double adhesion = (is_boundary_edge ? 1.0 : 2.0) * mAdhesionMatrix[label_this][label_other];
+
+            double tension = adhesion + mPerimeterPrefactors[elem_index];
+            double area_prefactor = mAreaPrefactors[elem_index];
+            if (!is_boundary_edge)
+            {
+                // The edge runs the other way around the neighbouring element, flipping its area gradient
+                tension += mPerimeterPrefactors[other_index];
+                area_prefactor -= mAreaPrefactors[other_index];
+            }
+
+            const c_vector<double, DIM> area_contribution = area_prefactor * half_rotated_edge;
+            if (update_a)
+            {
+                mNodeForces[p_node_a->GetIndex()] += area_contribution + tension * unit_edge;
+            }
+            if (update_b)
+            {
+                mNodeForces[p_node_b->GetIndex()] += area_contribution - tension * unit_edge;
+            }
+        }
+    }
+}
+
+template <unsigned DIM>
+void LabelPairDifferentialAdhesionForce<DIM>::AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation)
+{
+    // Throw an exception message if not using a VertexBasedCellPopulation
+    if (dynamic_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation) == nullptr)
+    {
+        EXCEPTION("LabelPairDifferentialAdhesionForce is to be used with a VertexBasedCellPopulation only");
+    }
+
+    if constexpr (DIM != 2)
+    {
+        NagaiHondaDifferentialAdhesionForce<DIM>::AddForceContribution(rCellPopulation);
+    }
+    else
+    {
+        auto p_cell_population = static_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation);
+        MutableVertexMesh<DIM, DIM>& r_mesh = p_cell_population->rGetMesh();
+
+        mElementIndices.clear();
+        for (auto elem_iter = r_mesh.GetElementIteratorBegin(); elem_iter != r_mesh.GetElementIteratorEnd(); ++elem_iter)
+        {
+            mElementIndices.push_back(elem_iter->GetIndex());
+        }
+
+        UpdateLabelBitmask(*p_cell_population);
+        mNodeForces.assign(r_mesh.GetNumAllNodes(), zero_vector<double>(DIM));
+        AddForceContributionFromElements(*p_cell_population, mElementIndices, nullptr);
+
+        for (auto node_iter = r_mesh.GetNodeIteratorBegin(); node_iter != r_mesh.GetNodeIteratorEnd(); ++node_iter)
+        {
+            node_iter->AddAppliedForceContribution(mNodeForces[node_iter->GetIndex()]);
+        }
+    }
+}
+
+template <unsigned DIM>
+void LabelPairDifferentialAdhesionForce<DIM>::AddForceContributionToNodes(AbstractCellPopulation<DIM>& rCellPopulation,
+                                                                          const std::vector<unsigned>& rNodeIndices,
+                                                                          const std::vector<unsigned char>& rNodeMask)
+{
+    // Throw an exception message if not using a VertexBasedCellPopulation
+    if (dynamic_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation) == nullptr)
+    {
+        EXCEPTION("LabelPairDifferentialAdhesionForce is to be used with a VertexBasedCellPopulation only");
+    }
+
+    if constexpr (DIM != 2)
+    {
+        EXCEPTION("LabelPairDifferentialAdhesionForce can only update a subset of nodes in 2D");
+    }
+    else
+    {
+        auto p_cell_population = static_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation);
+        MutableVertexMesh<DIM, DIM>& r_mesh = p_cell_population->rGetMesh();
+
+        /*
+         * The force on a node depends only on the elements that contain it. Both elements sharing an edge contain
+         * its end nodes, so the lower-index rule of the edge pass still visits every edge of these elements once.
+         * Visiting the elements in increasing index order sums the contributions in the same order as
+         * AddForceContribution().
+         */
+        mElementIndices.clear();
+        for (const unsigned node_index : rNodeIndices)
+        {
+            const std::set<unsigned>& r_elements = r_mesh.GetNode(node_index)->rGetContainingElementIndices();
+            mElementIndices.insert(mElementIndices.end(), r_elements.begin(), r_elements.end());
+        }
+        std::sort(mElementIndices.begin(), mElementIndices.end());
+        mElementIndices.erase(std::unique(mElementIndices.begin(), mElementIndices.end()), mElementIndices.end());
+
+        // Only the labels of the visited elements are needed
+        mLabelBitmask.resize(r_mesh.GetNumAllElements());
+        for (const unsigned elem_index : mElementIndices)
+        {
+            CellPtr p_cell = p_cell_population->GetCellUsingLocationIndex(elem_index);
+            mLabelBitmask[elem_index] = p_cell->HasCellProperty<CellLabel>() ? 1u : 0u;
+        }
+
+        mNodeForces.resize(r_mesh.GetNumAllNodes());
+        for (const unsigned node_index : rNodeIndices)
+        {
+            mNodeForces[node_index] = zero_vector<double>(DIM);
+        }
+        AddForceContributionFromElements(*p_cell_population, mElementIndices, &rNodeMask);
+
+        for (const unsigned node_index : rNodeIndices)
+        {
+            r_mesh.GetNode(node_index)->AddAppliedForceContribution(mNodeForces[node_index]);
+        }
+    }
+}
+
+template <unsigned DIM>
+void LabelPairDifferentialAdhesionForce<DIM>::OutputForceParameters(out_stream& rParamsFile)
+{
+    // No new parameters to output, so just call method on direct parent class
+    NagaiHondaDifferentialAdhesionForce<DIM>::OutputForceParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class LabelPairDifferentialAdhesionForce<1>;
+template class LabelPairDifferentialAdhesionForce<2>;
+template class LabelPairDifferentialAdhesionForce<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(LabelPairDifferentialAdhesionForce)
@@ -0,0 +1,190 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef LABELPAIRDIFFERENTIALADHESIONFORCE_HPP_
+#define LABELPAIRDIFFERENTIALADHESIONFORCE_HPP_
+
+#include <boost/serialization/base_object.hpp>
+#include "ChasteSerialization.hpp"
+#include "Exception.hpp"
+
+#include "AbstractNodeSubsetForce.hpp"
+#include "NagaiHondaDifferentialAdhesionForce.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+#include <iostream>
+#include <vector>
+
+/**
+ * A drop-in replacement for NagaiHondaDifferentialAdhesionForce that produces the same forces at a fraction of
+ * the cost.
+ *
+ * The parent class evaluates the force node by node, and for every edge of every element containing the node it
+ * looks up the CellLabel property of each cell sharing that edge, so each label is queried many times per time step.
+ * Here the label of each cell is looked up once per call and stored in a compact per-element bitmask, the seven
+ * adhesion parameters are gathered into a small matrix indexed by the label of each side of an edge, and the energy
+ * gradient is assembled by visiting each edge of the mesh exactly once.
+ *
+ * The parameters are set using the methods inherited from NagaiHondaDifferentialAdhesionForce.
+ *
+ * In 2D the force can also be computed on a subset of the nodes, visiting only the elements that contain them (see
+ * AbstractNodeSubsetForce).
+ */
+template <unsigned DIM>
+class LabelPairDifferentialAdhesionForce : public NagaiHondaDifferentialAdhesionForce<DIM>, public AbstractNodeSubsetForce<DIM>
+{
+    friend class TestProjectForces;
+
+private:
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template <class Archive>
+    void serialize(Archive& archive, const unsigned int version)
+    {
+        archive& boost::serialization::base_object<NagaiHondaDifferentialAdhesionForce<DIM> >(*this);
+    }
+
+protected:
+    /** Index used in the adhesion matrix for the (absent) cell on the far side of a boundary edge. */
+    static const unsigned BOUNDARY_INDEX = 2u;
+
+    /**
+     * Adhesion energy parameters indexed by the label (0 unlabelled, 1 labelled, 2 boundary) of the cells on each
+     * side of an edge. Refreshed from the parent class parameters at the start of each call to
+     * AddForceContribution(), as these may be changed at any time.
+     */
+    double mAdhesionMatrix[3][3];
+
+    /** Label bitmask, indexed by element index: 1 if the corresponding cell has a CellLabel, 0 otherwise. */
+    std::vector<unsigned char> mLabelBitmask;
+
+    /** Reused buffer of the indices of the elements visited by a call, in increasing order. */
+    std::vector<unsigned> mElementIndices;
+
+    /** Reused buffer of the area gradient prefactor of each element, indexed by element index. */
+    std::vector<double> mAreaPrefactors;
+
+    /** Reused buffer of the perimeter gradient prefactor of each element, indexed by element index. */
+    std::vector<double> mPerimeterPrefactors;
+
+    /** Reused buffer of the force on each node, indexed by node index. */
+    std::vector<c_vector<double, DIM> > mNodeForces;
+
+    /**
+     * Fill mAdhesionMatrix from the parameters held by the parent classes.
+     */
+    void UpdateAdhesionMatrix();
+
+    /**
+     * Refresh mLabelBitmask, querying the property collection of each cell exactly once.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void UpdateLabelBitmask(VertexBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Find the element, other than the given one, that shares the edge between two nodes.
+     *
+     * @param pNodeA the first node of the edge
+     * @param pNodeB the second node of the edge
+     * @param elemIndex the index of an element known to contain the edge
+     * @return the index of the other element, or UINT_MAX if the edge is on the boundary
+     */
+    unsigned GetOtherElementSharingEdge(Node<DIM>* pNodeA, Node<DIM>* pNodeB, unsigned elemIndex);
+
+    /**
+     * Add the force from the given elements to mNodeForces, in 2D. The entries of mLabelBitmask for these elements
+     * must be up to date, and the entries of mNodeForces for the nodes that are updated must have been zeroed.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param rElementIndices the indices of the elements, in increasing order
+     * @param pNodeMask if not nullptr, indexed by global node index: only nodes with a nonzero entry are updated
+     */
+    void AddForceContributionFromElements(VertexBasedCellPopulation<DIM>& rCellPopulation,
+                                          const std::vector<unsigned>& rElementIndices,
+                                          const std::vector<unsigned char>* pNodeMask);
+
+public:
+    /**
+     * Constructor.
+     */
+    LabelPairDifferentialAdhesionForce();
+
+    /**
+     * Destructor.
+     */
+    virtual ~LabelPairDifferentialAdhesionForce() = default;
+
+    /**
+     * Overridden AddForceContribution() method.
+     *
+     * Calculates the force on each node in the vertex-based cell population based on the differential adhesion
+     * variant of the Nagai-Honda energy function. In 1D and 3D this simply defers to the parent class.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Overridden AddForceContributionToNodes() method.
+     *
+     * As AddForceContribution(), but for the given nodes only. Only implemented in 2D.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param rNodeIndices the global indices of the nodes to update
+     * @param rNodeMask indexed by global node index: nonzero for the nodes in rNodeIndices
+     */
+    virtual void AddForceContributionToNodes(AbstractCellPopulation<DIM>& rCellPopulation,
+                                             const std::vector<unsigned>& rNodeIndices,
+                                             const std::vector<unsigned char>& rNodeMask);
+
+    /**
+     * Overridden OutputForceParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputForceParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(LabelPairDifferentialAdhesionForce)
+
+#endif /*LABELPAIRDIFFERENTIALADHESIONFORCE_HPP_*/
@@ -0,0 +1,356 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "LiveMetricsModifier.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "CellBasedEventHandler.hpp"
+#include "Exception.hpp"
+#include "OutputFileHandler.hpp"
+
+namespace
+{
+    /** The phases reported, with the CellBasedEventHandler events that time them. */
+    const std::pair<const char*, unsigned> PHASES[] = {
+        {"death", CellBasedEventHandler::DEATH},
+        {"birth", CellBasedEventHandler::BIRTH},
+        {"update_topology", CellBasedEventHandler::UPDATETOPOLOGY},
+        {"force", CellBasedEventHandler::FORCE},
+        {"position", CellBasedEventHandler::POSITION},
+        {"update_cell_population", CellBasedEventHandler::UPDATECELLPOPULATION},
+        {"output", CellBasedEventHandler::OUTPUT}
+    };
+
+    /** @return a monotonic wall-clock time in seconds */
+    double WallTimeNow()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /** @return the resident set size of this process in bytes, or 0 if it cannot be read */
+    unsigned long long ResidentSetBytes()
+    {
+        std::ifstream statm("/proc/self/statm");
+        unsigned long long size_pages = 0;
+        unsigned long long resident_pages = 0;
+        if (!(statm >> size_pages >> resident_pages))
+        {
+            return 0;
+        }
+        return resident_pages * static_cast<unsigned long long>(sysconf(_SC_PAGESIZE));
+    }
+}
+
+template<unsigned DIM>
+LiveMetricsModifier<DIM>::LiveMetricsModifier()
+    : AbstractCellBasedSimulationModifier<DIM>()
+{
+    static_assert(sizeof(PHASES) / sizeof(PHASES[0]) == NUM_PHASES, "Phase table and NUM_PHASES disagree");
+    for (auto& r_phase_time : mPhaseTimes)
+    {
+        r_phase_time.store(0.0);
+    }
+}
+
+template<unsigned DIM>
+LiveMetricsModifier<DIM>::~LiveMetricsModifier()
+{
+    StopServer();
+}
+
+template<unsigned DIM>
+const std::string& LiveMetricsModifier<DIM>::rGetSocketPath() const
+{
+    return mSocketPath;
+}
+
+template<unsigned DIM>
+void LiveMetricsModifier<DIM>::SetSocketPath(const std::string& rSocketPath)
+{
+    mSocketPath = rSocketPath;
+}
+
+template<unsigned DIM>
+unsigned LiveMetricsModifier<DIM>::GetPhaseSampleInterval() const
+{
+    return mPhaseSampleInterval;
+}
+
+template<unsigned DIM>
+void LiveMetricsModifier<DIM>::SetPhaseSampleInterval(unsigned phaseSampleInterval)
+{
+    assert(phaseSampleInterval > 0);
+    mPhaseSampleInterval = phaseSampleInterval;
+}
+
+template<unsigned DIM>
+const std::string& LiveMetricsModifier<DIM>::rGetActiveSocketPath() const
+{
+    return mActiveSocketPath;
+}
+
+template<unsigned DIM>
+void LiveMetricsModifier<DIM>::SamplePhaseTimes()
+{
+    if (CellBasedEventHandler::IsEnabled())
+    {
+        for (unsigned phase = 0; phase < NUM_PHASES; ++phase)
+        {
+            mPhaseTimes[phase].store(CellBasedEventHandler::GetElapsedTime(PHASES[phase].second), std::memory_order_relaxed);
+        }
+        mTotalTime.store(CellBasedEventHandler::GetElapsedTime(CellBasedEventHandler::EVERYTHING), std::memory_order_relaxed);
+    }
+}
+
+template<unsigned DIM>
+void LiveMetricsModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    // Only a handful of relaxed atomic stores on the hot path; all the work is done by the server thread
+    SimulationTime* p_time = SimulationTime::Instance();
+    const unsigned time_steps_elapsed = p_time->GetTimeStepsElapsed();
+
+    mSimulationTime.store(p_time->GetTime(), std::memory_order_relaxed);
+    mNumCells.store(rCellPopulation.rGetCells().size(), std::memory_order_relaxed);
+    mNumNodes.store(rCellPopulation.GetNumNodes(), std::memory_order_relaxed);
+    mTimeStepsElapsed.store(time_steps_elapsed, std::memory_order_relaxed);
+
+    if (time_steps_elapsed % mPhaseSampleInterval == 0)
+    {
+        SamplePhaseTimes();
+    }
+}
+
+template<unsigned DIM>
+void LiveMetricsModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    // A previous Solve() may have left a server running
+    StopServer();
+
+    mActiveSocketPath = mSocketPath;
+    if (mActiveSocketPath.empty())
+    {
+        OutputFileHandler output_file_handler(outputDirectory, false);
+        mActiveSocketPath = output_file_handler.GetOutputDirectoryFullPath() + "metrics.sock";
+    }
+
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (mActiveSocketPath.size() >= sizeof(address.sun_path))
+    {
+        EXCEPTION("Socket path " + mActiveSocketPath + " is too long for a Unix domain socket; use SetSocketPath() to choose a shorter one");
+    }
+    strncpy(address.sun_path, mActiveSocketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    mListeningSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (mListeningSocket < 0)
+    {
+        EXCEPTION("Could not create metrics socket: " + std::string(strerror(errno)));
+    }
+
+    unlink(mActiveSocketPath.c_str());
+    if (bind(mListeningSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || listen(mListeningSocket, 8) != 0)
+    {
+        const std::string error = strerror(errno);
+        close(mListeningSocket);
+        mListeningSocket = -1;
+        EXCEPTION("Could not listen on metrics socket " + mActiveSocketPath + ": " + error);
+    }
+
+    SimulationTime* p_time = SimulationTime::Instance();
+    mWallTimeAtStart.store(WallTimeNow());
+    mSimulationTime.store(p_time->GetTime());
+    mTimeStepsAtStart.store(p_time->GetTimeStepsElapsed());
+    mTimeStepsElapsed.store(p_time->GetTimeStepsElapsed());
+    mTotalTimeSteps.store(p_time->GetTotalNumberOfTimeSteps());
+    mNumCells.store(rCellPopulation.rGetCells().size());
+    mNumNodes.store(rCellPopulation.GetNumNodes());
+    mFinished.store(false);
+    SamplePhaseTimes();
+
+    mStopRequested.store(false);
+    mServerThread = std::thread(&LiveMetricsModifier<DIM>::ServeMetrics, this);
+}
+
+template<unsigned DIM>
+void LiveMetricsModifier<DIM>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    SamplePhaseTimes();
+    mFinished.store(true);
+    StopServer();
+}
+
+template<unsigned DIM>
+void LiveMetricsModifier<DIM>::StopServer()
+{
+    if (mServerThread.joinable())
+    {
+        mStopRequested.store(true);
+        mServerThread.join();
+    }
+    if (mListeningSocket >= 0)
+    {
+        close(mListeningSocket);
+        mListeningSocket = -1;
+        unlink(mActiveSocketPath.c_str());
+    }
+}
+
+template<unsigned DIM>
+void LiveMetricsModifier<DIM>::ServeMetrics()
+{
+    // The recent rate is measured over windows of a couple of seconds, so it reflects stalls promptly
+    double window_start_time = WallTimeNow();
+    unsigned window_start_steps = mTimeStepsElapsed.load(std::memory_order_relaxed);
+    double recent_steps_per_second = 0.0;
+
+    while (!mStopRequested.load())
+    {
+        pollfd listening_poll = {mListeningSocket, POLLIN, 0};
+        const int num_ready = poll(&listening_poll, 1, 250);
+
+        const double now = WallTimeNow();
+        if (now - window_start_time >= 2.0)
+        {
+            const unsigned steps = mTimeStepsElapsed.load(std::memory_order_relaxed);
+            recent_steps_per_second = (steps - window_start_steps) / (now - window_start_time);
+            window_start_time = now;
+            window_start_steps = steps;
+        }
+
+        if (num_ready > 0 && (listening_poll.revents & POLLIN))
+        {
+            const int connection = accept(mListeningSocket, nullptr, nullptr);
+            if (connection >= 0)
+            {
+                // Give the client a moment to send its request, which we read and ignore
+                pollfd connection_poll = {connection, POLLIN, 0};
+                if (poll(&connection_poll, 1, 100) > 0)
+                {
+                    char request[1024];
+                    static_cast<void>(recv(connection, request, sizeof(request), MSG_DONTWAIT));
+                }
+
+                const std::string body = FormatMetrics(recent_steps_per_second);
+                std::ostringstream response;
+                response << "HTTP/1.0 200 OK\r\n"
+                         << "Content-Type: text/plain; version=0.0.4\r\n"
+                         << "Content-Length: " << body.size() << "\r\n"
+                         << "Connection: close\r\n\r\n"
+                         << body;
+
+                const std::string message = response.str();
+                size_t num_sent = 0;
+                while (num_sent < message.size())
+                {
+                    const ssize_t result = send(connection, message.data() + num_sent, message.size() - num_sent, MSG_NOSIGNAL);
+                    if (result <= 0)
+                    {
+                        break;
+                    }
+                    num_sent += result;
+                }
+                close(connection);
+            }
+        }
+    }
+}
+
+template<unsigned DIM>
+std::string LiveMetricsModifier<DIM>::FormatMetrics(double recentStepsPerSecond)
+{
+    const double elapsed_wall_time = WallTimeNow() - mWallTimeAtStart.load();
+    const unsigned steps = mTimeStepsElapsed.load(std::memory_order_relaxed);
+    const unsigned total_steps = mTotalTimeSteps.load(std::memory_order_relaxed);
+    const unsigned steps_this_run = steps - mTimeStepsAtStart.load(std::memory_order_relaxed);
+    const double steps_per_second = (elapsed_wall_time > 0.0) ? steps_this_run / elapsed_wall_time : 0.0;
+
+    std::ostringstream metrics;
+    metrics << "chaste_simulation_time " << mSimulationTime.load(std::memory_order_relaxed) << "\n";
+    metrics << "chaste_time_steps_elapsed " << steps << "\n";
+    metrics << "chaste_time_steps_total " << total_steps << "\n";
+    metrics << "chaste_wall_time_seconds " << elapsed_wall_time << "\n";
+    metrics << "chaste_steps_per_second " << steps_per_second << "\n";
+    metrics << "chaste_recent_steps_per_second " << recentStepsPerSecond << "\n";
+    metrics << "chaste_num_cells " << mNumCells.load(std::memory_order_relaxed) << "\n";
+    metrics << "chaste_num_nodes " << mNumNodes.load(std::memory_order_relaxed) << "\n";
+    metrics << "chaste_resident_set_bytes " << ResidentSetBytes() << "\n";
+
+    if (steps_per_second > 0.0 && total_steps >= steps)
+    {
+        metrics << "chaste_eta_seconds " << (total_steps - steps) / steps_per_second << "\n";
+    }
+
+    const double total_time = mTotalTime.load(std::memory_order_relaxed);
+    for (unsigned phase = 0; phase < NUM_PHASES; ++phase)
+    {
+        const double share = (total_time > 0.0) ? mPhaseTimes[phase].load(std::memory_order_relaxed) / total_time : 0.0;
+        metrics << "chaste_phase_time_share{phase=\"" << PHASES[phase].first << "\"} " << share << "\n";
+    }
+
+    metrics << "chaste_finished " << (mFinished.load() ? 1 : 0) << "\n";
+    return metrics.str();
+}
+
+template<unsigned DIM>
+void LiveMetricsModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<SocketPath>" << mSocketPath << "</SocketPath>\n";
+    *rParamsFile << "\t\t\t<PhaseSampleInterval>" << mPhaseSampleInterval << "</PhaseSampleInterval>\n";
+
+    // Call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class LiveMetricsModifier<1>;
+template class LiveMetricsModifier<2>;
+template class LiveMetricsModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(LiveMetricsModifier)
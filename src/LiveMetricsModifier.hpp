@@ -0,0 +1,239 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef LIVEMETRICSMODIFIER_HPP_
+#define LIVEMETRICSMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/string.hpp>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+/**
+ * A modifier that serves live metrics about a running simulation over a Unix domain socket, so that a job scheduler
+ * can spot stalled or slow runs without parsing output files.
+ *
+ * At the end of each time step the modifier stores the simulation time, the number of time steps, cells and nodes
+ * in atomic variables; every mPhaseSampleInterval steps it also copies the accumulated time of each phase from
+ * CellBasedEventHandler. Everything else (rates, resident set size, estimated time to completion, and formatting)
+ * is done on a background thread, which answers each connection to the socket with a plain-text HTTP response, e.g.
+ *
+ *     curl --unix-socket <output directory>/metrics.sock http://localhost/metrics
+ *
+ * The socket is created when the simulation starts and removed when it finishes.
+ */
+template<unsigned DIM>
+class LiveMetricsModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+private:
+
+    /** The path of the socket. If empty, a socket called metrics.sock is created in the output directory. */
+    std::string mSocketPath;
+
+    /** The number of time steps between samples of the per-phase timings. Defaults to 100. */
+    unsigned mPhaseSampleInterval = 100u;
+
+    /** The path of the socket in use, once SetupSolve() has been called. */
+    std::string mActiveSocketPath;
+
+    /** File descriptor of the listening socket, or -1 if the server is not running. */
+    int mListeningSocket = -1;
+
+    /** The thread that answers requests. */
+    std::thread mServerThread;
+
+    /** Set to ask the server thread to stop. */
+    std::atomic<bool> mStopRequested{false};
+
+    /** The wall-clock time, in seconds since the epoch, at which SetupSolve() was called. */
+    std::atomic<double> mWallTimeAtStart{0.0};
+
+    /** The current simulation time. */
+    std::atomic<double> mSimulationTime{0.0};
+
+    /** The number of time steps elapsed when SetupSolve() was called, for runs that continue a previous Solve(). */
+    std::atomic<unsigned> mTimeStepsAtStart{0u};
+
+    /** The number of time steps elapsed. */
+    std::atomic<unsigned> mTimeStepsElapsed{0u};
+
+    /** The total number of time steps in the simulation. */
+    std::atomic<unsigned> mTotalTimeSteps{0u};
+
+    /** The number of cells. */
+    std::atomic<unsigned> mNumCells{0u};
+
+    /** The number of nodes. */
+    std::atomic<unsigned> mNumNodes{0u};
+
+    /** Whether UpdateAtEndOfSolve() has been called. */
+    std::atomic<bool> mFinished{false};
+
+    /** The number of phases for which timings are reported. */
+    static const unsigned NUM_PHASES = 7u;
+
+    /** Accumulated time in milliseconds of each phase, as last sampled from CellBasedEventHandler. */
+    std::atomic<double> mPhaseTimes[NUM_PHASES];
+
+    /** Accumulated time in milliseconds of the whole simulation, as last sampled from CellBasedEventHandler. */
+    std::atomic<double> mTotalTime{0.0};
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & mSocketPath;
+        archive & mPhaseSampleInterval;
+    }
+
+    /**
+     * Copy the accumulated phase timings from CellBasedEventHandler into the atomic variables.
+     */
+    void SamplePhaseTimes();
+
+    /**
+     * The body of the server thread: accept connections until asked to stop.
+     */
+    void ServeMetrics();
+
+    /**
+     * Format the current metrics.
+     *
+     * @param recentStepsPerSecond the rate of time steps over the last few seconds
+     * @return the metrics in the Prometheus text exposition format
+     */
+    std::string FormatMetrics(double recentStepsPerSecond);
+
+    /**
+     * Stop the server thread, if running, and remove the socket.
+     */
+    void StopServer();
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    LiveMetricsModifier();
+
+    /**
+     * Destructor. Stops the server thread if it is still running.
+     */
+    virtual ~LiveMetricsModifier();
+
+    /**
+     * @return mSocketPath
+     */
+    const std::string& rGetSocketPath() const;
+
+    /**
+     * Set mSocketPath.
+     *
+     * @param rSocketPath the path of the socket; if empty, metrics.sock in the output directory is used
+     */
+    void SetSocketPath(const std::string& rSocketPath);
+
+    /**
+     * @return mPhaseSampleInterval
+     */
+    unsigned GetPhaseSampleInterval() const;
+
+    /**
+     * Set mPhaseSampleInterval.
+     *
+     * @param phaseSampleInterval the new value of mPhaseSampleInterval
+     */
+    void SetPhaseSampleInterval(unsigned phaseSampleInterval);
+
+    /**
+     * @return the path of the socket in use, which is only known once the simulation has been set up
+     */
+    const std::string& rGetActiveSocketPath() const;
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Stores the current metrics.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Creates the socket and starts the server thread.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden UpdateAtEndOfSolve() method.
+     *
+     * Stops the server thread and removes the socket.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(LiveMetricsModifier)
+
+#endif /*LIVEMETRICSMODIFIER_HPP_*/
@@ -0,0 +1,298 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "MemoryAccountingModifier.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "BernoulliTrialCellCycleModel.hpp"
+#include "CellData.hpp"
+#include "CounterBasedBernoulliTrialCellCycleModel.hpp"
+#include "Exception.hpp"
+#include "LabelDependentBernoulliTrialCellCycleModel.hpp"
+#include "NoCellCycleModel.hpp"
+#include "NodeAttributes.hpp"
+#include "NullSrnModel.hpp"
+#include "OutputFileHandler.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+namespace
+{
+    /** Approximate heap footprint of one node of a std::set or std::map with small keys and values. */
+    const std::size_t TREE_NODE_BYTES = 48u;
+
+    /** Approximate heap footprint of one node of a std::list of shared pointers. */
+    const std::size_t LIST_NODE_BYTES = 32u;
+
+    /** Approximate heap footprint of the control block of a boost::shared_ptr. */
+    const std::size_t SHARED_POINTER_CONTROL_BYTES = 32u;
+
+    /** Approximate heap footprint of one item of CellData, a std::map from a short std::string to a double. */
+    const std::size_t CELL_DATA_ITEM_BYTES = 96u;
+
+    /**
+     * @param rKey a field of /proc/self/status whose value is given in kB, e.g. VmRSS
+     * @return the value in bytes, or 0 if it cannot be read
+     */
+    std::size_t ReadProcStatusBytes(const std::string& rKey)
+    {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line))
+        {
+            if (line.compare(0, rKey.size() + 1, rKey + ":") == 0)
+            {
+                std::istringstream value(line.substr(rKey.size() + 1));
+                std::size_t kilobytes = 0;
+                value >> kilobytes;
+                return 1024u * kilobytes;
+            }
+        }
+        return 0u;
+    }
+
+    /**
+     * @param rDirectory a directory
+     * @return the total size of the regular files in the directory and its subdirectories
+     */
+    std::size_t DirectoryBytes(const std::string& rDirectory)
+    {
+        std::size_t total = 0u;
+        std::error_code error;
+        for (std::filesystem::recursive_directory_iterator iter(rDirectory, error), end; !error && iter != end; iter.increment(error))
+        {
+            if (iter->is_regular_file(error))
+            {
+                total += iter->file_size(error);
+            }
+        }
+        return total;
+    }
+}
+
+template<unsigned DIM>
+MemoryAccountingModifier<DIM>::MemoryAccountingModifier()
+    : AbstractCellBasedSimulationModifier<DIM>()
+{
+    RegisterModelType<NoCellCycleModel>();
+    RegisterModelType<BernoulliTrialCellCycleModel>();
+    RegisterModelType<LabelDependentBernoulliTrialCellCycleModel>();
+    RegisterModelType<CounterBasedBernoulliTrialCellCycleModel>();
+    RegisterModelType<NullSrnModel>();
+}
+
+template<unsigned DIM>
+std::string MemoryAccountingModifier<DIM>::GetSubsystemName(unsigned subsystem)
+{
+    static const char* const names[NUM_MEMORY_SUBSYSTEMS] = {
+        "nodes", "elements", "cells", "cell_cycle_models", "output_on_disk", "resident_set", "peak_resident_set"
+    };
+    if (subsystem >= NUM_MEMORY_SUBSYSTEMS)
+    {
+        EXCEPTION("Unknown memory subsystem " << subsystem);
+    }
+    return names[subsystem];
+}
+
+template<unsigned DIM>
+std::size_t MemoryAccountingModifier<DIM>::GetLatestBytes(unsigned subsystem) const
+{
+    assert(subsystem < NUM_MEMORY_SUBSYSTEMS);
+    return mLatestBytes[subsystem];
+}
+
+template<unsigned DIM>
+std::size_t MemoryAccountingModifier<DIM>::GetPeakBytes(unsigned subsystem) const
+{
+    assert(subsystem < NUM_MEMORY_SUBSYSTEMS);
+    return mPeakBytes[subsystem];
+}
+
+template<unsigned DIM>
+double MemoryAccountingModifier<DIM>::GetPeakTime(unsigned subsystem) const
+{
+    assert(subsystem < NUM_MEMORY_SUBSYSTEMS);
+    return mPeakTimes[subsystem];
+}
+
+template<unsigned DIM>
+void MemoryAccountingModifier<DIM>::Sample(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    std::size_t bytes[NUM_MEMORY_SUBSYSTEMS] = {};
+
+    // Nodes, including any that have been deleted but not yet removed from the mesh
+    AbstractMesh<DIM,DIM>& r_mesh = rCellPopulation.rGetMesh();
+    for (unsigned node_index = 0; node_index < r_mesh.GetNumAllNodes(); ++node_index)
+    {
+        Node<DIM>* p_node = r_mesh.GetNode(node_index);
+        bytes[NODES] += sizeof(Node<DIM>) + sizeof(Node<DIM>*) + p_node->GetNumContainingElements() * TREE_NODE_BYTES;
+        if (p_node->HasNodeAttributes())
+        {
+            bytes[NODES] += sizeof(NodeAttributes<DIM>);
+        }
+    }
+
+    // Elements, for vertex meshes
+    if (auto p_vertex_population = dynamic_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation))
+    {
+        MutableVertexMesh<DIM,DIM>& r_vertex_mesh = p_vertex_population->rGetMesh();
+        for (unsigned elem_index = 0; elem_index < r_vertex_mesh.GetNumAllElements(); ++elem_index)
+        {
+            VertexElement<DIM,DIM>* p_element = r_vertex_mesh.GetElement(elem_index);
+            bytes[ELEMENTS] += sizeof(VertexElement<DIM,DIM>) + sizeof(VertexElement<DIM,DIM>*)
+                               + p_element->GetNumNodes() * sizeof(Node<DIM>*)
+                               + p_element->GetNumFaces() * (sizeof(VertexElement<DIM-1,DIM>*) + sizeof(bool));
+        }
+    }
+
+    // Cells, with their entries in the population's cell list and location maps, and their models
+    for (const CellPtr& rp_cell : rCellPopulation.rGetCells())
+    {
+        bytes[CELLS] += sizeof(Cell) + SHARED_POINTER_CONTROL_BYTES + LIST_NODE_BYTES + 2 * TREE_NODE_BYTES
+                        + rp_cell->rGetCellPropertyCollection().GetSize() * TREE_NODE_BYTES;
+        if (rp_cell->HasCellProperty<CellData>())
+        {
+            bytes[CELLS] += sizeof(CellData) + SHARED_POINTER_CONTROL_BYTES
+                            + rp_cell->GetCellData()->GetNumItems() * CELL_DATA_ITEM_BYTES;
+        }
+
+        bytes[CELL_CYCLE_MODELS] += GetModelSize(*(rp_cell->GetCellCycleModel()), sizeof(AbstractCellCycleModel))
+                                    + GetModelSize(*(rp_cell->GetSrnModel()), sizeof(AbstractSrnModel));
+    }
+
+    bytes[OUTPUT_ON_DISK] = DirectoryBytes(mOutputDirectoryFullPath);
+    bytes[RESIDENT_SET] = ReadProcStatusBytes("VmRSS");
+    bytes[PEAK_RESIDENT_SET] = ReadProcStatusBytes("VmHWM");
+
+    const double time = SimulationTime::Instance()->GetTime();
+    *mpTimelineFile << time;
+    for (unsigned subsystem = 0; subsystem < NUM_MEMORY_SUBSYSTEMS; ++subsystem)
+    {
+        *mpTimelineFile << "\t" << bytes[subsystem];
+
+        mLatestBytes[subsystem] = bytes[subsystem];
+        if (bytes[subsystem] > mPeakBytes[subsystem])
+        {
+            mPeakBytes[subsystem] = bytes[subsystem];
+            mPeakTimes[subsystem] = time;
+        }
+    }
+    *mpTimelineFile << "\n";
+    mpTimelineFile->flush();
+
+    mLastSampleTime = time;
+}
+
+template<unsigned DIM>
+void MemoryAccountingModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+}
+
+template<unsigned DIM>
+void MemoryAccountingModifier<DIM>::UpdateAtEndOfOutputTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (mpTimelineFile)
+    {
+        Sample(rCellPopulation);
+    }
+}
+
+template<unsigned DIM>
+void MemoryAccountingModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    mOutputDirectory = outputDirectory;
+    OutputFileHandler output_file_handler(outputDirectory, false);
+    mOutputDirectoryFullPath = output_file_handler.GetOutputDirectoryFullPath();
+
+    mpTimelineFile = output_file_handler.OpenOutputFile("memoryusage.dat");
+    *mpTimelineFile << "# time";
+    for (unsigned subsystem = 0; subsystem < NUM_MEMORY_SUBSYSTEMS; ++subsystem)
+    {
+        *mpTimelineFile << "\t" << GetSubsystemName(subsystem);
+    }
+    *mpTimelineFile << "\n";
+
+    std::fill(mPeakBytes, mPeakBytes + NUM_MEMORY_SUBSYSTEMS, 0u);
+    std::fill(mPeakTimes, mPeakTimes + NUM_MEMORY_SUBSYSTEMS, 0.0);
+    mLastSampleTime = -1.0;
+
+    Sample(rCellPopulation);
+}
+
+template<unsigned DIM>
+void MemoryAccountingModifier<DIM>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (!mpTimelineFile)
+    {
+        return;
+    }
+
+    // The final state is sampled here unless it fell on an output time step
+    if (SimulationTime::Instance()->GetTime() > mLastSampleTime)
+    {
+        Sample(rCellPopulation);
+    }
+    mpTimelineFile->close();
+    mpTimelineFile.reset();
+
+    OutputFileHandler output_file_handler(mOutputDirectory, false);
+    out_stream p_summary_file = output_file_handler.OpenOutputFile("memorysummary.txt");
+    *p_summary_file << "# subsystem\tpeak_bytes\tpeak_time\n";
+    for (unsigned subsystem = 0; subsystem < NUM_MEMORY_SUBSYSTEMS; ++subsystem)
+    {
+        *p_summary_file << GetSubsystemName(subsystem) << "\t" << mPeakBytes[subsystem] << "\t" << mPeakTimes[subsystem] << "\n";
+    }
+    p_summary_file->close();
+}
+
+template<unsigned DIM>
+void MemoryAccountingModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    // No parameters to output, so just call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class MemoryAccountingModifier<1>;
+template class MemoryAccountingModifier<2>;
+template class MemoryAccountingModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(MemoryAccountingModifier)
@@ -0,0 +1,239 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MEMORYACCOUNTINGMODIFIER_HPP_
+#define MEMORYACCOUNTINGMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include <map>
+#include <string>
+#include <typeindex>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+
+/**
+ * A modifier that estimates, at each output time step, the number of bytes held by each part of a simulation, so that
+ * the cause of growing memory use (e.g. during proliferation) can be identified.
+ *
+ * The estimates count the objects owned by the mesh and cell population, and the containers that index them, using
+ * the sizes of the classes involved together with typical heap overheads of standard containers:
+ *  - NODES: Node objects, their attributes and the sets of containing elements;
+ *  - ELEMENTS: the elements of a vertex mesh, with their node and face lists;
+ *  - CELLS: Cell objects, their properties, CellData and the population's lists and location maps;
+ *  - CELL_CYCLE_MODELS: cell-cycle and SRN models, whose sizes are looked up by dynamic type in a registry (see
+ *    RegisterModelType()); unregistered types are counted at the size of their abstract base class.
+ *
+ * In addition, the modifier records the total size of the files in the output directory (OUTPUT_ON_DISK, which
+ * includes results files and any checkpoint archives), and the resident set size and its high-water mark as reported
+ * by the kernel, which may be compared with the sum of the estimates.
+ *
+ * A timeline of these values is written to memoryusage.dat in the output directory, and the peak of each, with the
+ * time at which it occurred, is written to memorysummary.txt when the simulation finishes.
+ */
+template<unsigned DIM>
+class MemoryAccountingModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+public:
+
+    /** The quantities recorded, in the order of the columns of the timeline. */
+    enum MemorySubsystem
+    {
+        NODES,
+        ELEMENTS,
+        CELLS,
+        CELL_CYCLE_MODELS,
+        OUTPUT_ON_DISK,
+        RESIDENT_SET,
+        PEAK_RESIDENT_SET,
+        NUM_MEMORY_SUBSYSTEMS
+    };
+
+private:
+
+    /** The size in bytes of each registered cell-cycle or SRN model type. */
+    std::map<std::type_index, std::size_t> mModelSizes;
+
+    /** The output directory, relative to where Chaste output is stored, once SetupSolve() has been called. */
+    std::string mOutputDirectory;
+
+    /** The full path of the output directory, once SetupSolve() has been called. */
+    std::string mOutputDirectoryFullPath;
+
+    /** The timeline file. */
+    out_stream mpTimelineFile;
+
+    /** The most recent value of each quantity, in bytes. */
+    std::size_t mLatestBytes[NUM_MEMORY_SUBSYSTEMS] = {};
+
+    /** The peak value of each quantity, in bytes. */
+    std::size_t mPeakBytes[NUM_MEMORY_SUBSYSTEMS] = {};
+
+    /** The simulation time at which each peak occurred. */
+    double mPeakTimes[NUM_MEMORY_SUBSYSTEMS] = {};
+
+    /** The simulation time of the last sample, or a negative value if none has been taken. */
+    double mLastSampleTime = -1.0;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+    }
+
+    /**
+     * @param rModel a cell-cycle or SRN model
+     * @param defaultSize the size to use if the type of the model has not been registered
+     * @return the size of the model
+     */
+    template<typename MODEL>
+    std::size_t GetModelSize(const MODEL& rModel, std::size_t defaultSize) const
+    {
+        auto iter = mModelSizes.find(std::type_index(typeid(rModel)));
+        return (iter == mModelSizes.end()) ? defaultSize : iter->second;
+    }
+
+    /**
+     * Estimate the memory used by each subsystem, update the peaks and write a line of the timeline.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void Sample(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+public:
+
+    /**
+     * Default constructor. Registers the sizes of the cell-cycle and SRN models used in this project.
+     */
+    MemoryAccountingModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~MemoryAccountingModifier() = default;
+
+    /**
+     * Register the size of a cell-cycle or SRN model class, so that models of that type are counted accurately.
+     */
+    template<typename MODEL>
+    void RegisterModelType()
+    {
+        mModelSizes[std::type_index(typeid(MODEL))] = sizeof(MODEL);
+    }
+
+    /**
+     * @param subsystem the quantity
+     * @return the name of the quantity, as used in the output files
+     */
+    static std::string GetSubsystemName(unsigned subsystem);
+
+    /**
+     * @param subsystem the quantity
+     * @return its most recently sampled value, in bytes
+     */
+    std::size_t GetLatestBytes(unsigned subsystem) const;
+
+    /**
+     * @param subsystem the quantity
+     * @return its peak value, in bytes
+     */
+    std::size_t GetPeakBytes(unsigned subsystem) const;
+
+    /**
+     * @param subsystem the quantity
+     * @return the simulation time at which its peak value occurred
+     */
+    double GetPeakTime(unsigned subsystem) const;
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Does nothing: memory use is sampled at output time steps only.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden UpdateAtEndOfOutputTimeStep() method.
+     *
+     * Samples the memory use.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfOutputTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Opens the timeline and samples the initial memory use.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden UpdateAtEndOfSolve() method.
+     *
+     * Samples the final memory use, closes the timeline and writes the peak of each quantity.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(MemoryAccountingModifier)
+
+#endif /*MEMORYACCOUNTINGMODIFIER_HPP_*/
@@ -0,0 +1,384 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "MultiRateNumericalMethod.hpp"
+
+#include <algorithm>
+#include "AbstractNodeSubsetForce.hpp"
+#include "Exception.hpp"
+#include "SimulationTime.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+MultiRateNumericalMethod<ELEMENT_DIM, SPACE_DIM>::MultiRateNumericalMethod()
+    : AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM>()
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned MultiRateNumericalMethod<ELEMENT_DIM, SPACE_DIM>::GetNumRateClasses() const
+{
+    return mNumRateClasses;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void MultiRateNumericalMethod<ELEMENT_DIM, SPACE_DIM>::SetNumRateClasses(unsigned numRateClasses)
+{
+    if (numRateClasses == 0 || numRateClasses > 16)
+    {
+        EXCEPTION("The number of rate classes must be between 1 and 16");
+    }
+    mNumRateClasses = numRateClasses;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double MultiRateNumericalMethod<ELEMENT_DIM, SPACE_DIM>::GetQuiescentSpeed() const
+{
+    return mQuiescentSpeed;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void MultiRateNumericalMethod<ELEMENT_DIM, SPACE_DIM>::SetQuiescentSpeed(double quiescentSpeed)
+{
+    if (quiescentSpeed < 0.0)
+    {
+        EXCEPTION("The quiescent speed must be non-negative");
+    }
+    mQuiescentSpeed = quiescentSpeed;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned MultiRateNumericalMethod<ELEMENT_DIM, SPACE_DIM>::GetSyncInterval() const
+{
+    return mSyncInterval;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void MultiRateNumericalMethod<ELEMENT_DIM, SPACE_DIM>::SetSyncInterval(unsigned syncInterval)
+{
+    mSyncInterval = syncInterval;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+const std::vector<unsigned char>& MultiRateNumericalMethod<ELEMENT_DIM, SPACE_DIM>::rGetRateClasses() const
+{
+    return mRateClasses;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+uint64_t MultiRateNumericalMethod<ELEMENT_DIM, SPACE_DIM>::GetNumNodeForceEvaluations() const
+{
+    return mNumNodeForceEvaluations;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+uint64_t MultiRateNumericalMethod<ELEMENT_DIM, SPACE_DIM>::GetNumNodeUpdates() const
+{
+    return mNumNodeUpdates;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned MultiRateNumericalMethod<ELEMENT_DIM, SPACE_DIM>::GetNumFullEvaluations() const
+{
+    return mNumFullEvaluations;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+bool MultiRateNumericalMethod<ELEMENT_DIM, SPACE_DIM>::ForcesSupportNodeSubsets()
+{
+    for (auto& p_force : *(this->mpForceCollection))
+    {
+        if (dynamic_cast<AbstractNodeSubsetForce<SPACE_DIM>*>(p_force.get()) == nullptr)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+bool MultiRateNumericalMethod<ELEMENT_DIM, SPACE_DIM>::UpdateMeshCounts(MutableVertexMesh<SPACE_DIM, SPACE_DIM>& rMesh)
+{
+    // Division, death and T2 swaps change the numbers of nodes and elements; T1 and T3 swaps are recorded
+    const std::vector<unsigned> mesh_counts = {rMesh.GetNumAllNodes(),
+                                               rMesh.GetNumNodes(),
+                                               rMesh.GetNumAllElements(),
+                                               rMesh.GetNumElements(),
+                                               static_cast<unsigned>(rMesh.GetLocationsOfT1Swaps().size()),
+                                               static_cast<unsigned>(rMesh.GetLocationsOfT3Swaps().size())};
+    const bool has_changed = (mesh_counts != mMeshCounts);
+    mMeshCounts = mesh_counts;
+    return has_changed;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+bool MultiRateNumericalMethod<ELEMENT_DIM, SPACE_DIM>::UpdateTopologySignature(MutableVertexMesh<SPACE_DIM, SPACE_DIM>& rMesh)
+{
+    const unsigned num_all_elements = rMesh.GetNumAllElements();
+    bool has_changed = (mElementSignatures.size() != num_all_elements);
+    mElementSignatures.resize(num_all_elements, 0u);
+
+    // Every swap, division or removal changes the number of nodes of some element, and renumbering changes the
+    // indices of its nodes
+    for (auto elem_iter = rMesh.GetElementIteratorBegin(); elem_iter != rMesh.GetElementIteratorEnd(); ++elem_iter)
+    {
+        const unsigned num_nodes = elem_iter->GetNumNodes();
+        uint64_t signature = num_nodes;
+        for (unsigned local_index = 0; local_index < num_nodes; ++local_index)
+        {
+            signature = signature * 0x9E3779B97F4A7C15ull + elem_iter->GetNodeGlobalIndex(local_index);
+        }
+
+        uint64_t& r_stored = mElementSignatures[elem_iter->GetIndex()];
+        if (r_stored != signature)
+        {
+            r_stored = signature;
+            has_changed = true;
+        }
+    }
+    return has_changed;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned MultiRateNumericalMethod<ELEMENT_DIM, SPACE_DIM>::CalculateRateClass(double speed) const
+{
+    unsigned rate_class = 0;
+    double threshold = mQuiescentSpeed;
+    while (rate_class + 1 < mNumRateClasses && speed < threshold)
+    {
+        ++rate_class;
+        threshold *= 0.5;
+    }
+    return rate_class;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void MultiRateNumericalMethod<ELEMENT_DIM, SPACE_DIM>::LimitRateClassesByNeighbours(MutableVertexMesh<SPACE_DIM, SPACE_DIM>& rMesh)
+{
+    // Find the fastest class of each element before changing any node, so the result does not depend on the order
+    mElementRateClasses.resize(rMesh.GetNumAllElements());
+    for (auto elem_iter = rMesh.GetElementIteratorBegin(); elem_iter != rMesh.GetElementIteratorEnd(); ++elem_iter)
+    {
+        unsigned char fastest = mNumRateClasses - 1;
+        for (unsigned local_index = 0; local_index < elem_iter->GetNumNodes(); ++local_index)
+        {
+            fastest = std::min(fastest, mRateClasses[elem_iter->GetNodeGlobalIndex(local_index)]);
+        }
+        mElementRateClasses[elem_iter->GetIndex()] = fastest;
+    }
+
+    for (auto elem_iter = rMesh.GetElementIteratorBegin(); elem_iter != rMesh.GetElementIteratorEnd(); ++elem_iter)
+    {
+        const unsigned char limit = mElementRateClasses[elem_iter->GetIndex()] + 1;
+        for (unsigned local_index = 0; local_index < elem_iter->GetNumNodes(); ++local_index)
+        {
+            unsigned char& r_rate_class = mRateClasses[elem_iter->GetNodeGlobalIndex(local_index)];
+            r_rate_class = std::min(r_rate_class, limit);
+        }
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void MultiRateNumericalMethod<ELEMENT_DIM, SPACE_DIM>::UpdateAllNodePositions(double dt)
+{
+    if constexpr (ELEMENT_DIM != SPACE_DIM)
+    {
+        EXCEPTION("MultiRateNumericalMethod is to be used with a VertexBasedCellPopulation only");
+    }
+    else
+    {
+        auto p_population = dynamic_cast<VertexBasedCellPopulation<SPACE_DIM>*>(this->mpCellPopulation);
+        if (p_population == nullptr || this->mUseUpdateNodeLocation)
+        {
+            EXCEPTION("MultiRateNumericalMethod is to be used with a VertexBasedCellPopulation only");
+        }
+        MutableVertexMesh<SPACE_DIM, SPACE_DIM>& r_mesh = p_population->rGetMesh();
+        const unsigned num_all_nodes = r_mesh.GetNumAllNodes();
+
+        const bool supports_subsets = ForcesSupportNodeSubsets();
+        if (supports_subsets && mSyncInterval == 1u && mNumRateClasses > 1u)
+        {
+            EXCEPTION("MultiRateNumericalMethod would evaluate every force on every step with a sync interval of 1; "
+                      "set it to the sampling timestep multiple of the simulation with SetSyncInterval()");
+        }
+        const unsigned step = SimulationTime::Instance()->GetTimeStepsElapsed();
+        const bool counts_changed = UpdateMeshCounts(r_mesh);
+        bool is_full_evaluation = counts_changed || !supports_subsets
+                                  || (mNodesByClass.size() != mNumRateClasses)
+                                  || (step % (1u << (mNumRateClasses - 1)) == 0)
+                                  || (mSyncInterval > 0 && (step + 1) % mSyncInterval == 0);
+
+        // Move a node by its pending displacement and one step of its new damped force
+        auto move_node = [&](unsigned nodeIndex, Node<SPACE_DIM>* pNode, bool hasPending,
+                             const c_vector<double, SPACE_DIM>& rNewDampedForce)
+        {
+            c_vector<double, SPACE_DIM> displacement = dt * rNewDampedForce;
+            double elapsed_time = dt;
+            if (hasPending && mNextMoveSteps[nodeIndex] < step)
+            {
+                const unsigned num_pending_steps = step - mNextMoveSteps[nodeIndex];
+                displacement += (num_pending_steps * dt) * mDampedForces[nodeIndex];
+                elapsed_time += num_pending_steps * dt;
+            }
+
+            // In the vertex-based case, the displacement may be scaled if the cell rearrangement threshold is exceeded
+            this->DetectStepSizeExceptions(nodeIndex, displacement, elapsed_time);
+
+            c_vector<double, SPACE_DIM> new_location = pNode->rGetLocation() + displacement;
+            this->SafeNodePositionUpdate(nodeIndex, new_location);
+
+            mDampedForces[nodeIndex] = rNewDampedForce;
+            mNextMoveSteps[nodeIndex] = step + 1;
+        };
+
+        mActiveNodeIndices.clear();
+        if (!is_full_evaluation)
+        {
+            // Class k is due on steps that are a multiple of 2^k, so the due classes are 0 to some K
+            for (unsigned rate_class = 0; rate_class < mNumRateClasses && step % (1u << rate_class) == 0; ++rate_class)
+            {
+                mActiveNodeIndices.insert(mActiveNodeIndices.end(), mNodesByClass[rate_class].begin(), mNodesByClass[rate_class].end());
+                mNodesByClass[rate_class].clear();
+            }
+
+            // A node replaced since the last full evaluation, for example by renumbering, has no valid stored force
+            for (const unsigned node_index : mActiveNodeIndices)
+            {
+                if (r_mesh.GetNode(node_index) != mNodes[node_index])
+                {
+                    is_full_evaluation = true;
+                    break;
+                }
+            }
+        }
+
+        if (is_full_evaluation)
+        {
+            const bool topology_changed = UpdateTopologySignature(r_mesh) || counts_changed
+                                          || (mRateClasses.size() != num_all_nodes);
+
+            // The nodes at the last full evaluation are needed below, so the new ones are recorded as they are moved
+            mNodes.resize(num_all_nodes, nullptr);
+            mRateClasses.resize(num_all_nodes, 0u);
+            mDampedForces.resize(num_all_nodes, zero_vector<double>(SPACE_DIM));
+            mNextMoveSteps.resize(num_all_nodes, step);
+            mNodeMask.resize(num_all_nodes, 0u);
+
+            std::vector<c_vector<double, SPACE_DIM> > forces = this->ComputeForcesIncludingDamping();
+
+            unsigned index = 0;
+            for (auto node_iter = r_mesh.GetNodeIteratorBegin(); node_iter != r_mesh.GetNodeIteratorEnd(); ++node_iter, ++index)
+            {
+                const unsigned node_index = node_iter->GetIndex();
+                Node<SPACE_DIM>* p_node = &(*node_iter);
+                move_node(node_index, p_node, mNodes[node_index] == p_node, forces[index]);
+                mNodes[node_index] = p_node;
+
+                // After a topology change every node starts again in the fastest class
+                const unsigned previous_class = topology_changed ? 0u : mRateClasses[node_index];
+                mRateClasses[node_index] = std::min(CalculateRateClass(norm_2(forces[index])), previous_class + 1u);
+                mActiveNodeIndices.push_back(node_index);
+            }
+            ++mNumFullEvaluations;
+
+            if (supports_subsets)
+            {
+                LimitRateClassesByNeighbours(r_mesh);
+            }
+
+            mNodesByClass.resize(mNumRateClasses);
+            for (std::vector<unsigned>& r_nodes : mNodesByClass)
+            {
+                r_nodes.clear();
+            }
+            for (const unsigned node_index : mActiveNodeIndices)
+            {
+                mNodesByClass[mRateClasses[node_index]].push_back(node_index);
+            }
+        }
+        else
+        {
+            for (const unsigned node_index : mActiveNodeIndices)
+            {
+                mNodeMask[node_index] = 1u;
+                r_mesh.GetNode(node_index)->ClearAppliedForce();
+            }
+
+            // The applied force of every other node still holds the force it is moving with
+            for (auto& p_force : *(this->mpForceCollection))
+            {
+                dynamic_cast<AbstractNodeSubsetForce<SPACE_DIM>*>(p_force.get())->AddForceContributionToNodes(*p_population, mActiveNodeIndices, mNodeMask);
+            }
+
+            // Nodes may become faster at once, but only one class slower per evaluation
+            for (const unsigned node_index : mActiveNodeIndices)
+            {
+                mNodeMask[node_index] = 0u;
+                Node<SPACE_DIM>* p_node = r_mesh.GetNode(node_index);
+                const c_vector<double, SPACE_DIM> damped_force = p_node->rGetAppliedForce() / p_population->GetDampingConstant(node_index);
+                move_node(node_index, p_node, true, damped_force);
+
+                const unsigned rate_class = std::min(CalculateRateClass(norm_2(damped_force)), mRateClasses[node_index] + 1u);
+                mRateClasses[node_index] = rate_class;
+                mNodesByClass[rate_class].push_back(node_index);
+            }
+        }
+        mNumNodeForceEvaluations += mActiveNodeIndices.size();
+        mNumNodeUpdates += r_mesh.GetNumNodes();
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void MultiRateNumericalMethod<ELEMENT_DIM, SPACE_DIM>::OutputNumericalMethodParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<NumRateClasses>" << mNumRateClasses << "</NumRateClasses>\n";
+    *rParamsFile << "\t\t\t<QuiescentSpeed>" << mQuiescentSpeed << "</QuiescentSpeed>\n";
+    *rParamsFile << "\t\t\t<SyncInterval>" << mSyncInterval << "</SyncInterval>\n";
+
+    // Call method on direct parent class
+    AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM>::OutputNumericalMethodParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class MultiRateNumericalMethod<1,1>;
+template class MultiRateNumericalMethod<1,2>;
+template class MultiRateNumericalMethod<2,2>;
+template class MultiRateNumericalMethod<1,3>;
+template class MultiRateNumericalMethod<2,3>;
+template class MultiRateNumericalMethod<3,3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(MultiRateNumericalMethod)
@@ -0,0 +1,280 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MULTIRATENUMERICALMETHOD_HPP_
+#define MULTIRATENUMERICALMETHOD_HPP_
+
+#include <boost/serialization/base_object.hpp>
+#include "ChasteSerialization.hpp"
+
+#include "AbstractNumericalMethod.hpp"
+#include "MutableVertexMesh.hpp"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * A multi-rate forward Euler numerical method for vertex-based simulations in which most of the tissue is quiescent.
+ *
+ * Each node is assigned to one of mNumRateClasses rate classes according to the speed (damped force) it had when
+ * its force was last evaluated, and the force on a node in class k is only re-evaluated on time steps that are a
+ * multiple of 2^k. A node moving at least mQuiescentSpeed is in class 0 and is evaluated every step; each halving
+ * of the speed below that moves a node one class slower, so every node moves roughly the same distance between
+ * evaluations of its force.
+ *
+ * A node only moves when its force is evaluated, by the displacement its previous force would have produced over
+ * the steps since it last moved plus one step of its new force, so the work on a step scales with the number of
+ * nodes due on that step. Between evaluations a slow node lags its forward Euler position by at most about
+ * 2 dt mQuiescentSpeed.
+ *
+ * To keep the slower classes safe:
+ *  - a node becomes faster as soon as its evaluated speed requires it, but becomes at most one class slower per
+ *    evaluation;
+ *  - at each full evaluation, a node is made at most one class slower than the fastest node of the elements
+ *    containing it, so quiescent nodes next to active regions are evaluated often;
+ *  - every force is evaluated in full, and every node moved, on any time step that is a multiple of
+ *    2^(mNumRateClasses - 1), on every step whose results are output if mSyncInterval is the sampling timestep
+ *    multiple of the simulation, and on the first step after a change in the numbers of nodes or elements of the
+ *    mesh, a T1 or T3 swap, or the replacement of a node due on that step. Any other change in the topology or
+ *    numbering of the mesh is found at the next full evaluation, by comparing the nodes of every element.
+ *
+ * Forces are evaluated on a subset of the nodes through AbstractNodeSubsetForce. If any force in the simulation
+ * does not implement it, every force is evaluated in full on every step and the method reduces to forward Euler.
+ *
+ * The method cannot see the sampling timestep multiple of the simulation, so it must be passed to SetSyncInterval().
+ * With the default interval of 1 every step would be a full evaluation, so UpdateAllNodePositions() throws if the
+ * interval has not been changed while the forces could be evaluated on subsets of the nodes.
+ */
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM=ELEMENT_DIM>
+class MultiRateNumericalMethod : public AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM>
+{
+private:
+
+    /** The number of rate classes. Defaults to 4, i.e. nodes are evaluated every 1, 2, 4 or 8 steps. */
+    unsigned mNumRateClasses = 4u;
+
+    /** The speed at or above which a node is evaluated every step. Defaults to 0.01. */
+    double mQuiescentSpeed = 0.01;
+
+    /**
+     * If positive, every force is evaluated in full on the steps after which the number of time steps elapsed is a
+     * multiple of this, which are the steps whose results are output if it is the sampling timestep multiple of the
+     * simulation. Defaults to 1, the default sampling timestep multiple, with which every step is a full evaluation
+     * and which is therefore not accepted once the forces can be evaluated on subsets of the nodes.
+     */
+    unsigned mSyncInterval = 1u;
+
+    /** The rate class of each node, indexed by node index. */
+    std::vector<unsigned char> mRateClasses;
+
+    /** The last evaluated force divided by the damping constant of each node, indexed by node index. */
+    std::vector<c_vector<double, SPACE_DIM> > mDampedForces;
+
+    /** The first time step whose displacement has not yet been applied to each node, indexed by node index. */
+    std::vector<unsigned> mNextMoveSteps;
+
+    /** The node with each index at the last full evaluation, used to detect nodes that have been replaced. */
+    std::vector<Node<SPACE_DIM>*> mNodes;
+
+    /** The indices of the nodes in each rate class. */
+    std::vector<std::vector<unsigned> > mNodesByClass;
+
+    /** Indexed by node index: nonzero for the nodes evaluated on the current step, and zero between steps. */
+    std::vector<unsigned char> mNodeMask;
+
+    /** The indices of the nodes evaluated on the current step. */
+    std::vector<unsigned> mActiveNodeIndices;
+
+    /** The numbers of nodes, elements, T1 swaps and T3 swaps of the mesh on the last step, in that order. */
+    std::vector<unsigned> mMeshCounts;
+
+    /** The rate class of the fastest node of each element, indexed by element index. */
+    std::vector<unsigned char> mElementRateClasses;
+
+    /** A signature of the nodes of each element, indexed by element index, used to detect topology changes. */
+    std::vector<uint64_t> mElementSignatures;
+
+    /** The total number of evaluations of the force on a node. */
+    uint64_t mNumNodeForceEvaluations = 0u;
+
+    /** The total number of node time steps integrated. */
+    uint64_t mNumNodeUpdates = 0u;
+
+    /** The number of full evaluations of the forces. */
+    unsigned mNumFullEvaluations = 0u;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM> >(*this);
+        archive & mNumRateClasses;
+        archive & mQuiescentSpeed;
+        archive & mSyncInterval;
+    }
+
+    /**
+     * @return whether every force in the simulation implements AbstractNodeSubsetForce
+     */
+    bool ForcesSupportNodeSubsets();
+
+    /**
+     * Compare the numbers of nodes, elements and swaps of the mesh with those stored on the last call, and store
+     * the new ones. This is cheap enough to do on every step.
+     *
+     * @param rMesh the mesh of the cell population
+     * @return whether any of them has changed since the last call
+     */
+    bool UpdateMeshCounts(MutableVertexMesh<SPACE_DIM, SPACE_DIM>& rMesh);
+
+    /**
+     * Compare the element signatures with those stored on the last call, and store the new ones. This visits
+     * every element, so is only done on full evaluations.
+     *
+     * @param rMesh the mesh of the cell population
+     * @return whether the topology or numbering of the mesh has changed since the last call
+     */
+    bool UpdateTopologySignature(MutableVertexMesh<SPACE_DIM, SPACE_DIM>& rMesh);
+
+    /**
+     * @param speed the speed of a node
+     * @return the rate class that speed alone would place the node in
+     */
+    unsigned CalculateRateClass(double speed) const;
+
+    /**
+     * Limit the rate class of each node to one class slower than the fastest node of the elements containing it.
+     *
+     * @param rMesh the mesh of the cell population
+     */
+    void LimitRateClassesByNeighbours(MutableVertexMesh<SPACE_DIM, SPACE_DIM>& rMesh);
+
+public:
+
+    /**
+     * Constructor.
+     */
+    MultiRateNumericalMethod();
+
+    /**
+     * Destructor.
+     */
+    virtual ~MultiRateNumericalMethod() = default;
+
+    /**
+     * @return mNumRateClasses
+     */
+    unsigned GetNumRateClasses() const;
+
+    /**
+     * Set mNumRateClasses.
+     *
+     * @param numRateClasses the new value of mNumRateClasses, from 1 to 16
+     */
+    void SetNumRateClasses(unsigned numRateClasses);
+
+    /**
+     * @return mQuiescentSpeed
+     */
+    double GetQuiescentSpeed() const;
+
+    /**
+     * Set mQuiescentSpeed.
+     *
+     * @param quiescentSpeed the new value of mQuiescentSpeed
+     */
+    void SetQuiescentSpeed(double quiescentSpeed);
+
+    /**
+     * @return mSyncInterval
+     */
+    unsigned GetSyncInterval() const;
+
+    /**
+     * Set mSyncInterval.
+     *
+     * @param syncInterval the new value of mSyncInterval, normally the sampling timestep multiple of the
+     *     simulation; 0 disables these additional full evaluations
+     */
+    void SetSyncInterval(unsigned syncInterval);
+
+    /**
+     * @return the rate class of each node, indexed by node index
+     */
+    const std::vector<unsigned char>& rGetRateClasses() const;
+
+    /**
+     * @return the total number of evaluations of the force on a node
+     */
+    uint64_t GetNumNodeForceEvaluations() const;
+
+    /**
+     * @return the total number of node time steps integrated, which is the number of force evaluations that
+     * forward Euler would have needed
+     */
+    uint64_t GetNumNodeUpdates() const;
+
+    /**
+     * @return the number of time steps on which the forces were evaluated in full
+     */
+    unsigned GetNumFullEvaluations() const;
+
+    /**
+     * Overridden UpdateAllNodePositions() method.
+     *
+     * @param dt Time step size
+     */
+    virtual void UpdateAllNodePositions(double dt);
+
+    /**
+     * Overridden OutputNumericalMethodParameters() method.
+     *
+     * @param rParamsFile Reference to the parameter output filestream
+     */
+    virtual void OutputNumericalMethodParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(MultiRateNumericalMethod)
+
+#endif /*MULTIRATENUMERICALMETHOD_HPP_*/
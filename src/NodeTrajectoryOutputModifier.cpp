@@ -0,0 +1,136 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "NodeTrajectoryOutputModifier.hpp"
+#include "HardwareCounterProfiler.hpp"
+#include "OutputFileHandler.hpp"
+
+template<unsigned DIM>
+NodeTrajectoryOutputModifier<DIM>::NodeTrajectoryOutputModifier()
+    : AbstractCellBasedSimulationModifier<DIM>()
+{
+}
+
+template<unsigned DIM>
+unsigned NodeTrajectoryOutputModifier<DIM>::GetKeyframeInterval() const
+{
+    return mKeyframeInterval;
+}
+
+template<unsigned DIM>
+void NodeTrajectoryOutputModifier<DIM>::SetKeyframeInterval(unsigned keyframeInterval)
+{
+    mKeyframeInterval = keyframeInterval;
+}
+
+template<unsigned DIM>
+double NodeTrajectoryOutputModifier<DIM>::GetQuantum() const
+{
+    return mQuantum;
+}
+
+template<unsigned DIM>
+void NodeTrajectoryOutputModifier<DIM>::SetQuantum(double quantum)
+{
+    mQuantum = quantum;
+}
+
+template<unsigned DIM>
+void NodeTrajectoryOutputModifier<DIM>::WriteSample(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    HardwareCounterProfiler::ScopedPhase phase("NodeTrajectoryOutputModifier::WriteSample");
+    mCoordinates.clear();
+    for (auto node_iter = rCellPopulation.rGetMesh().GetNodeIteratorBegin();
+         node_iter != rCellPopulation.rGetMesh().GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        const c_vector<double, DIM>& r_location = node_iter->rGetLocation();
+        mCoordinates.insert(mCoordinates.end(), r_location.begin(), r_location.end());
+    }
+
+    mpWriter->WriteSample(SimulationTime::Instance()->GetTime(), mCoordinates);
+}
+
+template<unsigned DIM>
+void NodeTrajectoryOutputModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+}
+
+template<unsigned DIM>
+void NodeTrajectoryOutputModifier<DIM>::UpdateAtEndOfOutputTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (mpWriter)
+    {
+        WriteSample(rCellPopulation);
+    }
+}
+
+template<unsigned DIM>
+void NodeTrajectoryOutputModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    OutputFileHandler output_file_handler(outputDirectory, false);
+    mpWriter.reset(new NodeTrajectoryWriter(output_file_handler.GetOutputDirectoryFullPath() + "nodetrajectory.ctrj",
+                                            DIM, mKeyframeInterval, mQuantum));
+    WriteSample(rCellPopulation);
+}
+
+template<unsigned DIM>
+void NodeTrajectoryOutputModifier<DIM>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (mpWriter)
+    {
+        mpWriter->Close();
+        mpWriter.reset();
+    }
+}
+
+template<unsigned DIM>
+void NodeTrajectoryOutputModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<KeyframeInterval>" << mKeyframeInterval << "</KeyframeInterval>\n";
+    *rParamsFile << "\t\t\t<Quantum>" << mQuantum << "</Quantum>\n";
+
+    // Call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class NodeTrajectoryOutputModifier<1>;
+template class NodeTrajectoryOutputModifier<2>;
+template class NodeTrajectoryOutputModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(NodeTrajectoryOutputModifier)
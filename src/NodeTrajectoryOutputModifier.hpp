@@ -0,0 +1,179 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef NODETRAJECTORYOUTPUTMODIFIER_HPP_
+#define NODETRAJECTORYOUTPUTMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "NodeTrajectoryWriter.hpp"
+
+/**
+ * A modifier that records the location of every node at each output time step, using the compact delta-encoded
+ * format of NodeTrajectoryWriter, to the file nodetrajectory.ctrj in the output directory.
+ *
+ * The file can be read back, sample by sample, with NodeTrajectoryReader. Nodes are stored in node iterator order;
+ * whenever the number of nodes changes, a keyframe is written.
+ */
+template<unsigned DIM>
+class NodeTrajectoryOutputModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+private:
+
+    /** The number of samples between keyframes. Defaults to 10. */
+    unsigned mKeyframeInterval = 10u;
+
+    /** The quantum to which node coordinates are rounded. Defaults to 1e-6. */
+    double mQuantum = 1e-6;
+
+    /** The writer, while a simulation is running. */
+    boost::shared_ptr<NodeTrajectoryWriter> mpWriter;
+
+    /** Reused buffer of node coordinates. */
+    std::vector<double> mCoordinates;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & mKeyframeInterval;
+        archive & mQuantum;
+    }
+
+    /**
+     * Write the current node locations as a sample.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void WriteSample(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    NodeTrajectoryOutputModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~NodeTrajectoryOutputModifier() = default;
+
+    /**
+     * @return mKeyframeInterval
+     */
+    unsigned GetKeyframeInterval() const;
+
+    /**
+     * Set mKeyframeInterval.
+     *
+     * @param keyframeInterval the new value of mKeyframeInterval
+     */
+    void SetKeyframeInterval(unsigned keyframeInterval);
+
+    /**
+     * @return mQuantum
+     */
+    double GetQuantum() const;
+
+    /**
+     * Set mQuantum.
+     *
+     * @param quantum the new value of mQuantum
+     */
+    void SetQuantum(double quantum);
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Does nothing: samples are written at output time steps only.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden UpdateAtEndOfOutputTimeStep() method.
+     *
+     * Writes a sample.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfOutputTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Creates the file and writes the initial node locations.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden UpdateAtEndOfSolve() method.
+     *
+     * Writes the index and closes the file.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(NodeTrajectoryOutputModifier)
+
+#endif /*NODETRAJECTORYOUTPUTMODIFIER_HPP_*/
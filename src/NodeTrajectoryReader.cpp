@@ -0,0 +1,257 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "NodeTrajectoryReader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include "Exception.hpp"
+#include "NodeTrajectoryWriter.hpp"
+
+namespace
+{
+    /** Read a fixed-width value written by NodeTrajectoryWriter. */
+    template <typename T>
+    T ReadRaw(std::ifstream& rFile)
+    {
+        T value;
+        rFile.read(reinterpret_cast<char*>(&value), sizeof(T));
+        return value;
+    }
+
+    /** @return the signed value of a zigzag-encoded integer */
+    int64_t DecodeZigzag(uint64_t value)
+    {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1u);
+    }
+}
+
+NodeTrajectoryReader::NodeTrajectoryReader(const std::string& rFilePath)
+    : mFile(rFilePath, std::ios::in | std::ios::binary)
+{
+    if (!mFile.is_open())
+    {
+        EXCEPTION("Could not open node trajectory file " + rFilePath);
+    }
+
+    char magic[sizeof(NodeTrajectoryWriter::FILE_MAGIC)];
+    mFile.read(magic, sizeof(magic));
+    if (!mFile || memcmp(magic, NodeTrajectoryWriter::FILE_MAGIC, sizeof(magic)) != 0)
+    {
+        EXCEPTION(rFilePath + " is not a node trajectory file");
+    }
+    mSpaceDimension = ReadRaw<uint32_t>(mFile);
+    mKeyframeInterval = ReadRaw<uint32_t>(mFile);
+    mQuantum = ReadRaw<double>(mFile);
+
+    mFile.seekg(0, std::ios::end);
+    const uint64_t file_size = mFile.tellg();
+
+    if (!ReadIndex(file_size))
+    {
+        ScanFrames(file_size);
+    }
+}
+
+uint64_t NodeTrajectoryReader::ReadVarint()
+{
+    uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+        const int byte = mFile.get();
+        if (byte == std::char_traits<char>::eof())
+        {
+            EXCEPTION("Unexpected end of node trajectory file");
+        }
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return value;
+        }
+    }
+    EXCEPTION("Corrupt variable-length integer in node trajectory file");
+}
+
+bool NodeTrajectoryReader::ReadIndex(uint64_t fileSize)
+{
+    const uint64_t header_size = sizeof(NodeTrajectoryWriter::FILE_MAGIC) + 2 * sizeof(uint32_t) + sizeof(double);
+    const uint64_t footer_size = sizeof(uint64_t) + sizeof(NodeTrajectoryWriter::INDEX_MAGIC);
+    if (fileSize < header_size + footer_size)
+    {
+        return false;
+    }
+
+    mFile.clear();
+    mFile.seekg(fileSize - footer_size);
+    const uint64_t index_offset = ReadRaw<uint64_t>(mFile);
+    char magic[sizeof(NodeTrajectoryWriter::INDEX_MAGIC)];
+    mFile.read(magic, sizeof(magic));
+    if (!mFile || memcmp(magic, NodeTrajectoryWriter::INDEX_MAGIC, sizeof(magic)) != 0
+        || index_offset < header_size || index_offset > fileSize - footer_size)
+    {
+        return false;
+    }
+
+    mFile.seekg(index_offset);
+    mNumSamples = ReadVarint();
+    const uint64_t num_keyframes = ReadVarint();
+    for (uint64_t keyframe = 0; keyframe < num_keyframes; ++keyframe)
+    {
+        mKeyframeOffsets.push_back(ReadRaw<uint64_t>(mFile));
+        mKeyframeSamples.push_back(ReadVarint());
+        mKeyframeTimes.push_back(ReadRaw<double>(mFile));
+    }
+    return bool(mFile);
+}
+
+void NodeTrajectoryReader::ScanFrames(uint64_t fileSize)
+{
+    mNumSamples = 0;
+    mKeyframeOffsets.clear();
+    mKeyframeSamples.clear();
+    mKeyframeTimes.clear();
+
+    const uint64_t header_size = sizeof(NodeTrajectoryWriter::FILE_MAGIC) + 2 * sizeof(uint32_t) + sizeof(double);
+    mFile.clear();
+    mFile.seekg(header_size);
+
+    // Stop at the first incomplete frame, which is what a killed simulation leaves behind
+    try
+    {
+        while (static_cast<uint64_t>(mFile.tellg()) < fileSize)
+        {
+            const uint64_t offset = mFile.tellg();
+            const uint8_t type = ReadRaw<uint8_t>(mFile);
+            const double time = ReadRaw<double>(mFile);
+            ReadVarint(); // number of nodes
+            const uint64_t payload_size = ReadVarint();
+            if (!mFile || static_cast<uint64_t>(mFile.tellg()) + payload_size > fileSize)
+            {
+                break;
+            }
+            if (type == NodeTrajectoryWriter::KEYFRAME)
+            {
+                mKeyframeOffsets.push_back(offset);
+                mKeyframeSamples.push_back(mNumSamples);
+                mKeyframeTimes.push_back(time);
+            }
+            else if (type != NodeTrajectoryWriter::DELTA_FRAME)
+            {
+                break;
+            }
+            mFile.seekg(payload_size, std::ios::cur);
+            ++mNumSamples;
+        }
+    }
+    catch (Exception&)
+    {
+    }
+    mFile.clear();
+}
+
+unsigned NodeTrajectoryReader::GetSpaceDimension() const
+{
+    return mSpaceDimension;
+}
+
+double NodeTrajectoryReader::GetQuantum() const
+{
+    return mQuantum;
+}
+
+unsigned NodeTrajectoryReader::GetNumSamples() const
+{
+    return mNumSamples;
+}
+
+unsigned NodeTrajectoryReader::GetNumKeyframes() const
+{
+    return mKeyframeOffsets.size();
+}
+
+unsigned NodeTrajectoryReader::GetKeyframeSample(unsigned keyframe) const
+{
+    return mKeyframeSamples.at(keyframe);
+}
+
+double NodeTrajectoryReader::GetKeyframeTime(unsigned keyframe) const
+{
+    return mKeyframeTimes.at(keyframe);
+}
+
+double NodeTrajectoryReader::ReadSample(unsigned sample, std::vector<double>& rCoordinates)
+{
+    if (sample >= mNumSamples)
+    {
+        EXCEPTION("Sample " << sample << " requested from a node trajectory with " << mNumSamples << " samples");
+    }
+
+    // Find the last keyframe at or before the requested sample
+    const unsigned keyframe = std::upper_bound(mKeyframeSamples.begin(), mKeyframeSamples.end(), sample) - mKeyframeSamples.begin() - 1;
+
+    mFile.clear();
+    mFile.seekg(mKeyframeOffsets[keyframe]);
+
+    std::vector<int64_t> quantised;
+    double time = 0.0;
+    for (unsigned current = mKeyframeSamples[keyframe]; current <= sample; ++current)
+    {
+        const uint8_t type = ReadRaw<uint8_t>(mFile);
+        time = ReadRaw<double>(mFile);
+        const uint64_t num_coordinates = ReadVarint() * mSpaceDimension;
+        ReadVarint(); // payload size
+
+        if (type == NodeTrajectoryWriter::KEYFRAME)
+        {
+            quantised.assign(num_coordinates, 0);
+        }
+        else if (num_coordinates != quantised.size())
+        {
+            EXCEPTION("Corrupt delta frame in node trajectory file");
+        }
+
+        for (auto& r_value : quantised)
+        {
+            r_value += DecodeZigzag(ReadVarint());
+        }
+    }
+
+    rCoordinates.resize(quantised.size());
+    for (unsigned i = 0; i < quantised.size(); ++i)
+    {
+        rCoordinates[i] = quantised[i] * mQuantum;
+    }
+    return time;
+}
@@ -0,0 +1,147 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef NODETRAJECTORYREADER_HPP_
+#define NODETRAJECTORYREADER_HPP_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * Reads node trajectory files written by NodeTrajectoryWriter, reconstructing any sample by decoding the nearest
+ * preceding keyframe and the delta frames that follow it.
+ */
+class NodeTrajectoryReader
+{
+private:
+
+    /** The file being read. */
+    std::ifstream mFile;
+
+    /** The space dimension. */
+    unsigned mSpaceDimension;
+
+    /** The number of samples between keyframes. */
+    unsigned mKeyframeInterval;
+
+    /** The quantum to which coordinates were rounded. */
+    double mQuantum;
+
+    /** The number of samples in the file. */
+    unsigned mNumSamples = 0u;
+
+    /** File offset of each keyframe. */
+    std::vector<uint64_t> mKeyframeOffsets;
+
+    /** Sample number of each keyframe. */
+    std::vector<unsigned> mKeyframeSamples;
+
+    /** Time of each keyframe. */
+    std::vector<double> mKeyframeTimes;
+
+    /**
+     * @return the next variable-length integer in the file
+     */
+    uint64_t ReadVarint();
+
+    /**
+     * Read the index written by NodeTrajectoryWriter::Close().
+     *
+     * @param fileSize the size of the file in bytes
+     * @return whether a valid index was found
+     */
+    bool ReadIndex(uint64_t fileSize);
+
+    /**
+     * Build the index by scanning every frame, for files that were not closed properly.
+     *
+     * @param fileSize the size of the file in bytes
+     */
+    void ScanFrames(uint64_t fileSize);
+
+public:
+
+    /**
+     * Constructor. Opens the file and reads (or rebuilds) the keyframe index.
+     *
+     * @param rFilePath the full path of the file
+     */
+    NodeTrajectoryReader(const std::string& rFilePath);
+
+    /**
+     * @return the number of coordinates per node
+     */
+    unsigned GetSpaceDimension() const;
+
+    /**
+     * @return the quantum to which coordinates were rounded
+     */
+    double GetQuantum() const;
+
+    /**
+     * @return the number of samples in the file
+     */
+    unsigned GetNumSamples() const;
+
+    /**
+     * @return the number of keyframes in the file
+     */
+    unsigned GetNumKeyframes() const;
+
+    /**
+     * @param keyframe the index of a keyframe
+     * @return the sample number of that keyframe
+     */
+    unsigned GetKeyframeSample(unsigned keyframe) const;
+
+    /**
+     * @param keyframe the index of a keyframe
+     * @return the simulation time of that keyframe
+     */
+    double GetKeyframeTime(unsigned keyframe) const;
+
+    /**
+     * Reconstruct a sample.
+     *
+     * @param sample the sample number
+     * @param rCoordinates filled with the node coordinates, node by node
+     * @return the simulation time of the sample
+     */
+    double ReadSample(unsigned sample, std::vector<double>& rCoordinates);
+};
+
+#endif /*NODETRAJECTORYREADER_HPP_*/
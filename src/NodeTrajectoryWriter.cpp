@@ -0,0 +1,177 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "NodeTrajectoryWriter.hpp"
+
+#include <cmath>
+#include "Exception.hpp"
+
+const char NodeTrajectoryWriter::FILE_MAGIC[8] = {'C', 'H', 'T', 'R', 'J', '\0', '\0', '\1'};
+const char NodeTrajectoryWriter::INDEX_MAGIC[8] = {'C', 'H', 'T', 'R', 'J', 'I', 'D', 'X'};
+
+namespace
+{
+    /** Write a fixed-width value in native (little-endian on all supported platforms) byte order. */
+    template <typename T>
+    void WriteRaw(std::ofstream& rFile, const T& rValue)
+    {
+        rFile.write(reinterpret_cast<const char*>(&rValue), sizeof(T));
+    }
+}
+
+void NodeTrajectoryWriter::AppendVarint(uint64_t value, std::string& rBuffer)
+{
+    while (value >= 0x80u)
+    {
+        rBuffer.push_back(static_cast<char>((value & 0x7Fu) | 0x80u));
+        value >>= 7;
+    }
+    rBuffer.push_back(static_cast<char>(value));
+}
+
+void NodeTrajectoryWriter::AppendSignedVarint(int64_t value, std::string& rBuffer)
+{
+    AppendVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63), rBuffer);
+}
+
+NodeTrajectoryWriter::NodeTrajectoryWriter(const std::string& rFilePath,
+                                           unsigned spaceDimension,
+                                           unsigned keyframeInterval,
+                                           double quantum)
+    : mFile(rFilePath, std::ios::out | std::ios::binary | std::ios::trunc),
+      mSpaceDimension(spaceDimension),
+      mKeyframeInterval(keyframeInterval),
+      mQuantum(quantum)
+{
+    if (!mFile.is_open())
+    {
+        EXCEPTION("Could not open node trajectory file " + rFilePath);
+    }
+    if (keyframeInterval == 0 || quantum <= 0.0)
+    {
+        EXCEPTION("The keyframe interval and quantum of a node trajectory must be positive");
+    }
+
+    mFile.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+    WriteRaw(mFile, static_cast<uint32_t>(mSpaceDimension));
+    WriteRaw(mFile, static_cast<uint32_t>(mKeyframeInterval));
+    WriteRaw(mFile, mQuantum);
+}
+
+NodeTrajectoryWriter::~NodeTrajectoryWriter()
+{
+    Close();
+}
+
+void NodeTrajectoryWriter::WriteSample(double time, const std::vector<double>& rCoordinates)
+{
+    if (!mFile.is_open())
+    {
+        EXCEPTION("Cannot write to a node trajectory file that has been closed");
+    }
+    if (rCoordinates.size() % mSpaceDimension != 0)
+    {
+        EXCEPTION("The number of coordinates is not a multiple of the space dimension");
+    }
+
+    const bool is_keyframe = (mSamplesSinceKeyframe == 0) || (mSamplesSinceKeyframe >= mKeyframeInterval)
+                             || (rCoordinates.size() != mPreviousQuantised.size());
+
+    mPayload.clear();
+    mPreviousQuantised.resize(rCoordinates.size());
+    for (unsigned i = 0; i < rCoordinates.size(); ++i)
+    {
+        const int64_t quantised = std::llround(rCoordinates[i] / mQuantum);
+        AppendSignedVarint(is_keyframe ? quantised : quantised - mPreviousQuantised[i], mPayload);
+        mPreviousQuantised[i] = quantised;
+    }
+
+    if (is_keyframe)
+    {
+        mKeyframes.emplace_back(static_cast<uint64_t>(mFile.tellp()), mNumSamples, time);
+        mSamplesSinceKeyframe = 0;
+    }
+
+    std::string frame_header;
+    AppendVarint(rCoordinates.size() / mSpaceDimension, frame_header);
+    AppendVarint(mPayload.size(), frame_header);
+
+    WriteRaw(mFile, is_keyframe ? KEYFRAME : DELTA_FRAME);
+    WriteRaw(mFile, time);
+    mFile.write(frame_header.data(), frame_header.size());
+    mFile.write(mPayload.data(), mPayload.size());
+
+    ++mNumSamples;
+    ++mSamplesSinceKeyframe;
+}
+
+void NodeTrajectoryWriter::Close()
+{
+    if (!mFile.is_open())
+    {
+        return;
+    }
+
+    const uint64_t index_offset = mFile.tellp();
+
+    std::string index;
+    AppendVarint(mNumSamples, index);
+    AppendVarint(mKeyframes.size(), index);
+    mFile.write(index.data(), index.size());
+    for (const auto& r_keyframe : mKeyframes)
+    {
+        WriteRaw(mFile, std::get<0>(r_keyframe));
+
+        index.clear();
+        AppendVarint(std::get<1>(r_keyframe), index);
+        mFile.write(index.data(), index.size());
+
+        WriteRaw(mFile, std::get<2>(r_keyframe));
+    }
+
+    WriteRaw(mFile, index_offset);
+    mFile.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    mFile.close();
+}
+
+unsigned NodeTrajectoryWriter::GetNumSamples() const
+{
+    return mNumSamples;
+}
+
+uint64_t NodeTrajectoryWriter::GetNumBytesWritten()
+{
+    return mFile.is_open() ? static_cast<uint64_t>(mFile.tellp()) : 0u;
+}
@@ -0,0 +1,167 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef NODETRAJECTORYWRITER_HPP_
+#define NODETRAJECTORYWRITER_HPP_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/**
+ * Writes node trajectories to a compact binary file, read back by NodeTrajectoryReader.
+ *
+ * Each sample is a flat vector of node coordinates. The coordinates are quantised to integer multiples of a fixed
+ * quantum. Every mKeyframeInterval samples (and whenever the number of nodes changes) a keyframe holding the
+ * quantised coordinates is written; the samples in between hold only the difference from the previous sample. As
+ * most nodes move very little between samples these differences are small integers, which are stored as zigzag
+ * variable-length integers so that each typically takes one or two bytes rather than the eight of a double.
+ * Because the differences are between quantised values, reconstruction error never accumulates along a chain of
+ * deltas: every sample is recovered to within half a quantum.
+ *
+ * File layout (all fixed-width values little-endian):
+ *  - header: 8-byte magic, uint32 space dimension, uint32 keyframe interval, double quantum;
+ *  - frames: uint8 type (0 keyframe, 1 delta), double time, varint number of nodes, varint payload size, payload;
+ *  - index (written by Close()): varint number of samples, varint number of keyframes, then for each keyframe its
+ *    uint64 file offset, varint sample number and double time; followed by the uint64 offset of the index and an
+ *    8-byte magic.
+ * The index gives random access to any keyframe; a file without one (for example from a simulation that was
+ * killed) can still be read, as the reader then rebuilds the index by scanning the frames.
+ */
+class NodeTrajectoryWriter
+{
+public:
+
+    /** Magic number at the start of the file. */
+    static const char FILE_MAGIC[8];
+
+    /** Magic number at the end of the index. */
+    static const char INDEX_MAGIC[8];
+
+    /** Frame type of a keyframe. */
+    static constexpr uint8_t KEYFRAME = 0u;
+
+    /** Frame type of a delta frame. */
+    static constexpr uint8_t DELTA_FRAME = 1u;
+
+    /**
+     * Append an unsigned integer to a buffer as a little-endian base-128 variable-length integer.
+     *
+     * @param value the value
+     * @param rBuffer the buffer
+     */
+    static void AppendVarint(uint64_t value, std::string& rBuffer);
+
+    /**
+     * Append a signed integer to a buffer, zigzag encoded so that values of small magnitude take few bytes.
+     *
+     * @param value the value
+     * @param rBuffer the buffer
+     */
+    static void AppendSignedVarint(int64_t value, std::string& rBuffer);
+
+private:
+
+    /** The file being written. */
+    std::ofstream mFile;
+
+    /** The space dimension. */
+    unsigned mSpaceDimension;
+
+    /** The number of samples between keyframes. */
+    unsigned mKeyframeInterval;
+
+    /** The quantum to which coordinates are rounded. */
+    double mQuantum;
+
+    /** The number of samples written so far. */
+    unsigned mNumSamples = 0u;
+
+    /** The number of samples written since the last keyframe. */
+    unsigned mSamplesSinceKeyframe = 0u;
+
+    /** The quantised coordinates of the previous sample. */
+    std::vector<int64_t> mPreviousQuantised;
+
+    /** File offset, sample number and time of each keyframe. */
+    std::vector<std::tuple<uint64_t, unsigned, double> > mKeyframes;
+
+    /** Reused buffer for the payload of a frame. */
+    std::string mPayload;
+
+public:
+
+    /**
+     * Constructor. Creates the file and writes the header.
+     *
+     * @param rFilePath the full path of the file to create
+     * @param spaceDimension the number of coordinates per node
+     * @param keyframeInterval the number of samples between keyframes
+     * @param quantum the quantum to which coordinates are rounded
+     */
+    NodeTrajectoryWriter(const std::string& rFilePath, unsigned spaceDimension, unsigned keyframeInterval, double quantum);
+
+    /**
+     * Destructor. Closes the file if Close() has not been called.
+     */
+    ~NodeTrajectoryWriter();
+
+    /**
+     * Write a sample.
+     *
+     * @param time the simulation time of the sample
+     * @param rCoordinates the node coordinates, node by node
+     */
+    void WriteSample(double time, const std::vector<double>& rCoordinates);
+
+    /**
+     * Write the index and close the file. Further calls do nothing.
+     */
+    void Close();
+
+    /**
+     * @return the number of samples written so far
+     */
+    unsigned GetNumSamples() const;
+
+    /**
+     * @return the number of bytes written so far
+     */
+    uint64_t GetNumBytesWritten();
+};
+
+#endif /*NODETRAJECTORYWRITER_HPP_*/
@@ -0,0 +1,103 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "ParallelDivisionOffLatticeSimulation.hpp"
+
+#include "ParallelDivisionReadinessModifier.hpp"
+
+template<unsigned DIM>
+ParallelDivisionOffLatticeSimulation<DIM>::ParallelDivisionOffLatticeSimulation(AbstractCellPopulation<DIM>& rCellPopulation,
+                                                                                bool deleteCellPopulationInDestructor,
+                                                                                bool initialiseCells)
+    : OffLatticeSimulation<DIM>(rCellPopulation, deleteCellPopulationInDestructor, initialiseCells)
+{
+}
+
+template<unsigned DIM>
+unsigned ParallelDivisionOffLatticeSimulation<DIM>::DoCellBirth()
+{
+    if (this->mNoBirth)
+    {
+        return 0;
+    }
+
+    ParallelDivisionReadinessModifier<DIM>* p_readiness_modifier = nullptr;
+    for (auto& rp_modifier : this->mSimulationModifiers)
+    {
+        p_readiness_modifier = dynamic_cast<ParallelDivisionReadinessModifier<DIM>*>(rp_modifier.get());
+        if (p_readiness_modifier != nullptr)
+        {
+            break;
+        }
+    }
+    if (p_readiness_modifier == nullptr || !p_readiness_modifier->IsListComplete())
+    {
+        return OffLatticeSimulation<DIM>::DoCellBirth();
+    }
+    ++mNumListedBirthPhases;
+
+    // As in AbstractCellBasedSimulation::DoCellBirth(), skipping the cells that cell killers have since removed;
+    // Cell::ReadyToDivide() reads the cached outcome of the trial, and returns false for cells made apoptotic since
+    unsigned num_births_this_step = 0;
+    for (const CellPtr& rp_cell : p_readiness_modifier->rGetCellsReadyToDivide())
+    {
+        if (rp_cell->IsDead() || this->mrCellPopulation.IsCellAssociatedWithADeletedLocation(rp_cell))
+        {
+            continue;
+        }
+        if (rp_cell->ReadyToDivide() && this->mrCellPopulation.IsRoomToDivide(rp_cell))
+        {
+            CellPtr p_new_cell = rp_cell->Divide();
+            this->mrCellPopulation.AddCell(p_new_cell, rp_cell);
+            num_births_this_step++;
+        }
+    }
+    return num_births_this_step;
+}
+
+template<unsigned DIM>
+unsigned ParallelDivisionOffLatticeSimulation<DIM>::GetNumListedBirthPhases() const
+{
+    return mNumListedBirthPhases;
+}
+
+// Explicit instantiation
+template class ParallelDivisionOffLatticeSimulation<1>;
+template class ParallelDivisionOffLatticeSimulation<2>;
+template class ParallelDivisionOffLatticeSimulation<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(ParallelDivisionOffLatticeSimulation)
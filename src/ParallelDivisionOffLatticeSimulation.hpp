@@ -0,0 +1,147 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef PARALLELDIVISIONOFFLATTICESIMULATION_HPP_
+#define PARALLELDIVISIONOFFLATTICESIMULATION_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "OffLatticeSimulation.hpp"
+
+/**
+ * An OffLatticeSimulation whose cell birth phase divides only the cells listed by a
+ * ParallelDivisionReadinessModifier, whose trials were evaluated on worker threads at the end of the previous time
+ * step, instead of asking every cell in turn whether it is ready to divide.
+ *
+ * The listed cells are divided in the order in which they appear in the cell population, as the usual loop would
+ * divide them, so the results are the same. Where there is no such modifier, or its list does not cover every cell
+ * (see ParallelDivisionReadinessModifier::IsListComplete()), the usual loop over all cells is used.
+ */
+template<unsigned DIM>
+class ParallelDivisionOffLatticeSimulation : public OffLatticeSimulation<DIM>
+{
+private:
+
+    /** The number of cell birth phases in which only the listed cells were visited. */
+    unsigned mNumListedBirthPhases = 0u;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<OffLatticeSimulation<DIM> >(*this);
+    }
+
+protected:
+
+    /**
+     * Overridden DoCellBirth() method.
+     *
+     * Divides the cells listed by the ParallelDivisionReadinessModifier, or calls the method of the parent class
+     * if there is no complete list.
+     *
+     * @return the number of births that took place
+     */
+    virtual unsigned DoCellBirth();
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rCellPopulation Reference to a cell population object
+     * @param deleteCellPopulationInDestructor Whether to delete the cell population on destruction to
+     *     free up memory (defaults to false)
+     * @param initialiseCells Whether to initialise cells (defaults to true, set to false when loading
+     *     from an archive)
+     */
+    ParallelDivisionOffLatticeSimulation(AbstractCellPopulation<DIM>& rCellPopulation,
+                                         bool deleteCellPopulationInDestructor=false,
+                                         bool initialiseCells=true);
+
+    /**
+     * @return the number of cell birth phases, since construction, in which only the listed cells were visited
+     */
+    unsigned GetNumListedBirthPhases() const;
+};
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(ParallelDivisionOffLatticeSimulation)
+
+namespace boost
+{
+namespace serialization
+{
+/**
+ * Serialize information required to construct a ParallelDivisionOffLatticeSimulation.
+ */
+template<class Archive, unsigned DIM>
+inline void save_construct_data(
+    Archive & ar, const ParallelDivisionOffLatticeSimulation<DIM> * t, const unsigned int file_version)
+{
+    // Save data required to construct instance
+    const AbstractCellPopulation<DIM>* p_cell_population = &(t->rGetCellPopulation());
+    ar & p_cell_population;
+}
+
+/**
+ * De-serialize constructor parameters and initialise a ParallelDivisionOffLatticeSimulation.
+ */
+template<class Archive, unsigned DIM>
+inline void load_construct_data(
+    Archive & ar, ParallelDivisionOffLatticeSimulation<DIM> * t, const unsigned int file_version)
+{
+    // Retrieve data from archive required to construct new instance
+    AbstractCellPopulation<DIM>* p_cell_population;
+    ar >> p_cell_population;
+
+    // Invoke inplace constructor to initialise instance, last two variables set extra
+    // member variables to be deleted as they are loaded from archive and to not initialise sells.
+    ::new(t)ParallelDivisionOffLatticeSimulation<DIM>(*p_cell_population, true, false);
+}
+}
+} // namespace
+
+#endif /*PARALLELDIVISIONOFFLATTICESIMULATION_HPP_*/
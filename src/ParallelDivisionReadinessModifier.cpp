@@ -0,0 +1,147 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "ParallelDivisionReadinessModifier.hpp"
+
+#include "CounterBasedBernoulliTrialCellCycleModel.hpp"
+#include "CounterBasedRandomNumberGenerator.hpp"
+#include "NullSrnModel.hpp"
+#include "ThreadedLoop.hpp"
+
+template<unsigned DIM>
+ParallelDivisionReadinessModifier<DIM>::ParallelDivisionReadinessModifier()
+    : AbstractCellBasedSimulationModifier<DIM>()
+{
+}
+
+template<unsigned DIM>
+unsigned ParallelDivisionReadinessModifier<DIM>::GetMinCellsPerThread() const
+{
+    return mMinCellsPerThread;
+}
+
+template<unsigned DIM>
+void ParallelDivisionReadinessModifier<DIM>::SetMinCellsPerThread(unsigned minCellsPerThread)
+{
+    mMinCellsPerThread = minCellsPerThread;
+}
+
+template<unsigned DIM>
+void ParallelDivisionReadinessModifier<DIM>::EvaluateDivisionReadiness(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    const std::list<CellPtr>& r_cells = rCellPopulation.rGetCells();
+    const std::vector<CellPtr> cells(r_cells.begin(), r_cells.end());
+    std::vector<char> ready_to_divide(cells.size(), 0);
+    std::vector<char> not_evaluated(cells.size(), 0);
+
+    // The generator is created on first use, which is not thread-safe, so make sure it exists before the trials
+    CounterBasedRandomNumberGenerator::Instance();
+
+    // Each trial only reads shared state, and writes to the cell-cycle model of its own cell
+    ThreadedLoop::Run(cells.size(), [&](unsigned begin, unsigned end, unsigned thread)
+    {
+        for (unsigned i = begin; i < end; ++i)
+        {
+            const CellPtr& rp_cell = cells[i];
+            if (rp_cell->IsDead())
+            {
+                continue;
+            }
+
+            // Cell::ReadyToDivide() also runs the gene regulatory network, which is left to the simulation
+            auto p_model = dynamic_cast<CounterBasedBernoulliTrialCellCycleModel*>(rp_cell->GetCellCycleModel());
+            if (p_model == nullptr || dynamic_cast<NullSrnModel*>(rp_cell->GetSrnModel()) == nullptr)
+            {
+                not_evaluated[i] = 1;
+            }
+            else if (!rp_cell->HasApoptosisBegun() && rp_cell->GetAge() > 0.0)
+            {
+                ready_to_divide[i] = p_model->ReadyToDivide();
+            }
+        }
+    }, mMinCellsPerThread);
+
+    mCellsReadyToDivide.clear();
+    mNumCellsNotEvaluated = 0u;
+    for (unsigned i = 0; i < cells.size(); ++i)
+    {
+        if (ready_to_divide[i])
+        {
+            mCellsReadyToDivide.push_back(cells[i]);
+        }
+        mNumCellsNotEvaluated += not_evaluated[i];
+    }
+    mEvaluationTimeStep = SimulationTime::Instance()->GetTimeStepsElapsed();
+}
+
+template<unsigned DIM>
+const std::vector<CellPtr>& ParallelDivisionReadinessModifier<DIM>::rGetCellsReadyToDivide() const
+{
+    return mCellsReadyToDivide;
+}
+
+template<unsigned DIM>
+bool ParallelDivisionReadinessModifier<DIM>::IsListComplete() const
+{
+    return mEvaluationTimeStep == SimulationTime::Instance()->GetTimeStepsElapsed() && mNumCellsNotEvaluated == 0u;
+}
+
+template<unsigned DIM>
+void ParallelDivisionReadinessModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    EvaluateDivisionReadiness(rCellPopulation);
+}
+
+template<unsigned DIM>
+void ParallelDivisionReadinessModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    EvaluateDivisionReadiness(rCellPopulation);
+}
+
+template<unsigned DIM>
+void ParallelDivisionReadinessModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    // No parameters to output, so just call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class ParallelDivisionReadinessModifier<1>;
+template class ParallelDivisionReadinessModifier<2>;
+template class ParallelDivisionReadinessModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(ParallelDivisionReadinessModifier)
@@ -0,0 +1,165 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef PARALLELDIVISIONREADINESSMODIFIER_HPP_
+#define PARALLELDIVISIONREADINESSMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include <climits>
+#include <vector>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+
+/**
+ * A modifier that, at the end of each time step, evaluates the division trial of every cell that has a
+ * CounterBasedBernoulliTrialCellCycleModel on worker threads, and stores the list of cells that are ready to divide.
+ *
+ * The list is used by ParallelDivisionOffLatticeSimulation, whose cell birth phase, at the start of the next time
+ * step, divides only the listed cells instead of asking every cell whether it is ready, so that only the mesh edits of
+ * the divisions remain serial. If any cell has another cell-cycle model or a gene regulatory network, the list does not
+ * cover the whole population (see IsListComplete()) and the simulation falls back to the usual loop over all cells,
+ * in which the trials of the listed cells only read their cached outcome. With an OffLatticeSimulation the list is
+ * kept for inspection only (see rGetCellsReadyToDivide()).
+ */
+template<unsigned DIM>
+class ParallelDivisionReadinessModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+private:
+
+    /** The cells found to be ready to divide when the readiness was last evaluated. */
+    std::vector<CellPtr> mCellsReadyToDivide;
+
+    /** The time step at which the readiness was last evaluated, or UINT_MAX if it has not been. */
+    unsigned mEvaluationTimeStep = UINT_MAX;
+
+    /** The number of living cells whose readiness could not be evaluated when it was last evaluated. */
+    unsigned mNumCellsNotEvaluated = 0u;
+
+    /** The minimum number of cells given to each worker thread. Defaults to 256. */
+    unsigned mMinCellsPerThread = 256u;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+    }
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    ParallelDivisionReadinessModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~ParallelDivisionReadinessModifier() = default;
+
+    /**
+     * @return mMinCellsPerThread
+     */
+    unsigned GetMinCellsPerThread() const;
+
+    /**
+     * Set mMinCellsPerThread. This only affects performance, so is not archived.
+     *
+     * @param minCellsPerThread the new value of mMinCellsPerThread
+     */
+    void SetMinCellsPerThread(unsigned minCellsPerThread);
+
+    /**
+     * Evaluate the division trial of every cell with a CounterBasedBernoulliTrialCellCycleModel in parallel, and
+     * update the list of cells that are ready to divide.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void EvaluateDivisionReadiness(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * @return the cells found to be ready to divide by the last call to EvaluateDivisionReadiness(), in the order
+     * in which they appear in the cell population
+     */
+    const std::vector<CellPtr>& rGetCellsReadyToDivide() const;
+
+    /**
+     * @return whether the readiness was last evaluated at the current time step, for every living cell, so that
+     * rGetCellsReadyToDivide() lists all the cells that can divide now
+     */
+    bool IsListComplete() const;
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Evaluates the division readiness of all cells for the coming cell birth phase.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Evaluates the division readiness of all cells for the first cell birth phase.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(ParallelDivisionReadinessModifier)
+
+#endif /*PARALLELDIVISIONREADINESSMODIFIER_HPP_*/
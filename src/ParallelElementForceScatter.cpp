@@ -0,0 +1,115 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "ParallelElementForceScatter.hpp"
+
+template<unsigned DIM>
+bool ParallelElementForceScatter<DIM>::GetUseColouring() const
+{
+    return mUseColouring;
+}
+
+template<unsigned DIM>
+void ParallelElementForceScatter<DIM>::SetUseColouring(bool useColouring)
+{
+    mUseColouring = useColouring;
+}
+
+template<unsigned DIM>
+unsigned ParallelElementForceScatter<DIM>::GetMinElementsPerThread() const
+{
+    return mMinElementsPerThread;
+}
+
+template<unsigned DIM>
+void ParallelElementForceScatter<DIM>::SetMinElementsPerThread(unsigned minElementsPerThread)
+{
+    mMinElementsPerThread = minElementsPerThread;
+}
+
+template<unsigned DIM>
+const ElementColouring<DIM>& ParallelElementForceScatter<DIM>::rGetColouring() const
+{
+    return mColouring;
+}
+
+template<unsigned DIM>
+const std::vector<c_vector<double, DIM> >& ParallelElementForceScatter<DIM>::rGetNodeForces() const
+{
+    return mNodeForces;
+}
+
+template<unsigned DIM>
+void ParallelElementForceScatter<DIM>::ReduceThreadNodeForces()
+{
+    // Each thread sums a range of nodes over all the per-thread arrays, in thread order
+    ThreadedLoop::Run(mNodeForces.size(), [&](unsigned begin, unsigned end, unsigned thread)
+    {
+        for (unsigned node_index = begin; node_index < end; ++node_index)
+        {
+            c_vector<double, DIM> force = zero_vector<double>(DIM);
+            for (unsigned other_thread = 0; other_thread < mThreadNodeForces.size(); ++other_thread)
+            {
+                if (mThreadUsed[other_thread])
+                {
+                    force += mThreadNodeForces[other_thread][node_index];
+                }
+            }
+            mNodeForces[node_index] = force;
+        }
+    }, 1024u);
+}
+
+template<unsigned DIM>
+void ParallelElementForceScatter<DIM>::AddNodeForcesToMesh(MutableVertexMesh<DIM, DIM>& rMesh)
+{
+    // Each node is updated by one thread only
+    ThreadedLoop::Run(mNodeForces.size(), [&](unsigned begin, unsigned end, unsigned thread)
+    {
+        for (unsigned node_index = begin; node_index < end; ++node_index)
+        {
+            Node<DIM>* p_node = rMesh.GetNode(node_index);
+            if (!p_node->IsDeleted())
+            {
+                p_node->AddAppliedForceContribution(mNodeForces[node_index]);
+            }
+        }
+    }, 1024u);
+}
+
+// Explicit instantiation
+template class ParallelElementForceScatter<1>;
+template class ParallelElementForceScatter<2>;
+template class ParallelElementForceScatter<3>;
@@ -0,0 +1,194 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef PARALLELELEMENTFORCESCATTER_HPP_
+#define PARALLELELEMENTFORCESCATTER_HPP_
+
+#include <vector>
+
+#include "ElementColouring.hpp"
+#include "MutableVertexMesh.hpp"
+#include "ThreadedLoop.hpp"
+
+/**
+ * Runs a force loop over the elements of a vertex mesh on several threads, where each element adds contributions
+ * to the forces on its own nodes. Done naively, two threads would add to the force on a shared node at once.
+ *
+ * By default the elements are processed one colour of an ElementColouring at a time: the elements of one colour
+ * share no nodes, so they are split between threads and add straight into a single array of node forces. The
+ * result does not depend on the number of threads, as each node receives its contributions in the same order.
+ *
+ * Alternatively (SetUseColouring(false)), each thread adds the contributions of a contiguous range of elements
+ * into its own array of node forces, and the arrays are then summed node by node. This needs no colouring but more
+ * memory, and the rounding of the sums depends on the number of threads.
+ *
+ * The element loop is given as a function (a "kernel") called as
+ *
+ *     kernel(elemIndex, rNodeForces)
+ *
+ * which adds the contributions of element elemIndex to rNodeForces, indexed by global node index. The kernel is
+ * called concurrently, so it must only read shared data, and only write to the entries of rNodeForces of the
+ * element's own nodes.
+ */
+template<unsigned DIM>
+class ParallelElementForceScatter
+{
+private:
+
+    /** Whether to process elements by colour, rather than with per-thread force arrays. Defaults to true. */
+    bool mUseColouring = true;
+
+    /** Fewer threads are used if they would each get fewer elements than this. Defaults to 64. */
+    unsigned mMinElementsPerThread = 64u;
+
+    /** The colouring of the elements. */
+    ElementColouring<DIM> mColouring;
+
+    /** The force on each node, indexed by global node index. */
+    std::vector<c_vector<double, DIM> > mNodeForces;
+
+    /** The force on each node from the elements of each thread, when not using the colouring. */
+    std::vector<std::vector<c_vector<double, DIM> > > mThreadNodeForces;
+
+    /** Flags marking the threads that were used, when not using the colouring. */
+    std::vector<unsigned char> mThreadUsed;
+
+    /** Reused buffer of the indices of the elements, when not using the colouring. */
+    std::vector<unsigned> mElementIndices;
+
+    /**
+     * Sum the per-thread force arrays into mNodeForces.
+     */
+    void ReduceThreadNodeForces();
+
+public:
+
+    /**
+     * @return mUseColouring
+     */
+    bool GetUseColouring() const;
+
+    /**
+     * Set mUseColouring.
+     *
+     * @param useColouring the new value of mUseColouring
+     */
+    void SetUseColouring(bool useColouring);
+
+    /**
+     * @return mMinElementsPerThread
+     */
+    unsigned GetMinElementsPerThread() const;
+
+    /**
+     * Set mMinElementsPerThread.
+     *
+     * @param minElementsPerThread the new value of mMinElementsPerThread
+     */
+    void SetMinElementsPerThread(unsigned minElementsPerThread);
+
+    /**
+     * @return the colouring of the elements, as of the last call to Scatter() using it
+     */
+    const ElementColouring<DIM>& rGetColouring() const;
+
+    /**
+     * @return the force on each node from the last call to Scatter(), indexed by global node index
+     */
+    const std::vector<c_vector<double, DIM> >& rGetNodeForces() const;
+
+    /**
+     * Call the kernel for every element of the mesh, as described in the class documentation, with the node forces
+     * starting from zero.
+     *
+     * @param rMesh the mesh
+     * @param kernel the function adding the contributions of an element to the node forces
+     */
+    template<typename KERNEL>
+    void Scatter(MutableVertexMesh<DIM, DIM>& rMesh, KERNEL kernel)
+    {
+        const unsigned num_all_nodes = rMesh.GetNumAllNodes();
+
+        if (mUseColouring)
+        {
+            mColouring.Update(rMesh);
+            mNodeForces.assign(num_all_nodes, zero_vector<double>(DIM));
+            for (unsigned colour = 0; colour < mColouring.GetNumColours(); ++colour)
+            {
+                const std::vector<unsigned>& r_elements = mColouring.rGetElementsOfColour(colour);
+                ThreadedLoop::Run(r_elements.size(), [&](unsigned begin, unsigned end, unsigned thread)
+                {
+                    for (unsigned i = begin; i < end; ++i)
+                    {
+                        kernel(r_elements[i], mNodeForces);
+                    }
+                }, mMinElementsPerThread);
+            }
+        }
+        else
+        {
+            mElementIndices.clear();
+            for (auto elem_iter = rMesh.GetElementIteratorBegin(); elem_iter != rMesh.GetElementIteratorEnd(); ++elem_iter)
+            {
+                mElementIndices.push_back(elem_iter->GetIndex());
+            }
+
+            mThreadNodeForces.resize(ThreadedLoop::GetNumThreads());
+            mThreadUsed.assign(mThreadNodeForces.size(), 0u);
+            ThreadedLoop::Run(mElementIndices.size(), [&](unsigned begin, unsigned end, unsigned thread)
+            {
+                std::vector<c_vector<double, DIM> >& r_thread_forces = mThreadNodeForces[thread];
+                r_thread_forces.assign(num_all_nodes, zero_vector<double>(DIM));
+                mThreadUsed[thread] = 1u;
+                for (unsigned i = begin; i < end; ++i)
+                {
+                    kernel(mElementIndices[i], r_thread_forces);
+                }
+            }, mMinElementsPerThread);
+
+            mNodeForces.resize(num_all_nodes);
+            ReduceThreadNodeForces();
+        }
+    }
+
+    /**
+     * Add the node forces from the last call to Scatter() to the applied force of each node of the mesh.
+     *
+     * @param rMesh the mesh
+     */
+    void AddNodeForcesToMesh(MutableVertexMesh<DIM, DIM>& rMesh);
+};
+
+#endif /*PARALLELELEMENTFORCESCATTER_HPP_*/
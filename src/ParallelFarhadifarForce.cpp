@@ -0,0 +1,153 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "ParallelFarhadifarForce.hpp"
+
+template <unsigned DIM>
+ParallelFarhadifarForce<DIM>::ParallelFarhadifarForce()
+        : FarhadifarForce<DIM>()
+{
+}
+
+template <unsigned DIM>
+bool ParallelFarhadifarForce<DIM>::GetUseColouring() const
+{
+    return mScatter.GetUseColouring();
+}
+
+template <unsigned DIM>
+void ParallelFarhadifarForce<DIM>::SetUseColouring(bool useColouring)
+{
+    mScatter.SetUseColouring(useColouring);
+}
+
+template <unsigned DIM>
+ParallelElementForceScatter<DIM>& ParallelFarhadifarForce<DIM>::rGetScatter()
+{
+    return mScatter;
+}
+
+template <unsigned DIM>
+void ParallelFarhadifarForce<DIM>::AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation)
+{
+    // Throw an exception message if not using a VertexBasedCellPopulation
+    if (dynamic_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation) == nullptr)
+    {
+        EXCEPTION("ParallelFarhadifarForce is to be used with a VertexBasedCellPopulation only");
+    }
+
+    if constexpr (DIM != 2)
+    {
+        FarhadifarForce<DIM>::AddForceContribution(rCellPopulation);
+    }
+    else
+    {
+        auto p_cell_population = static_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation);
+        MutableVertexMesh<DIM, DIM>& r_mesh = p_cell_population->rGetMesh();
+
+        // Cell data are looked up on this thread only
+        mTargetAreas.resize(r_mesh.GetNumAllElements());
+        for (auto cell_iter = p_cell_population->Begin(); cell_iter != p_cell_population->End(); ++cell_iter)
+        {
+            const unsigned elem_index = p_cell_population->GetLocationIndexUsingCell(*cell_iter);
+            try
+            {
+                mTargetAreas[elem_index] = cell_iter->GetCellData()->GetItem("target area");
+            }
+            catch (Exception&)
+            {
+                EXCEPTION("You need to add an AbstractTargetAreaModifier to the simulation in order to use a ParallelFarhadifarForce");
+            }
+        }
+
+        const double area_elasticity_parameter = this->GetAreaElasticityParameter();
+        const double perimeter_contractility_parameter = this->GetPerimeterContractilityParameter();
+
+        /*
+         * The gradients of the area and perimeter of an element at a node each split into pieces from the node's two
+         * edges: the area gradient is half the rotated vector between the neighbouring nodes, which is the sum of
+         * half the rotated vectors along the two edges, and the perimeter and line tension gradients are unit vectors
+         * along each edge. So each edge of each element adds the same area term to both its end nodes, and equal
+         * and opposite tension terms along the edge.
+         */
+        mScatter.Scatter(r_mesh, [&](unsigned elemIndex, std::vector<c_vector<double, DIM> >& rNodeForces)
+        {
+            VertexElement<DIM, DIM>* p_element = r_mesh.GetElement(elemIndex);
+            const unsigned num_nodes_elem = p_element->GetNumNodes();
+
+            const double area_prefactor = -area_elasticity_parameter * (r_mesh.GetVolumeOfElement(elemIndex) - mTargetAreas[elemIndex]);
+            const double perimeter_tension = perimeter_contractility_parameter * r_mesh.GetSurfaceAreaOfElement(elemIndex);
+
+            for (unsigned local_index = 0; local_index < num_nodes_elem; local_index++)
+            {
+                Node<DIM>* p_node_a = p_element->GetNode(local_index);
+                Node<DIM>* p_node_b = p_element->GetNode((local_index + 1) % num_nodes_elem);
+
+                const c_vector<double, DIM> edge = r_mesh.GetVectorFromAtoB(p_node_a->rGetLocation(), p_node_b->rGetLocation());
+                const c_vector<double, DIM> unit_edge = edge / norm_2(edge);
+
+                c_vector<double, DIM> area_contribution;
+                area_contribution[0] = 0.5 * area_prefactor * edge[1];
+                area_contribution[1] = -0.5 * area_prefactor * edge[0];
+
+                // Half the line tension of an internal edge is counted from each of its two elements
+                const double tension = this->GetLineTensionParameter(p_node_a, p_node_b, *p_cell_population) + perimeter_tension;
+
+                rNodeForces[p_node_a->GetIndex()] += area_contribution + tension * unit_edge;
+                rNodeForces[p_node_b->GetIndex()] += area_contribution - tension * unit_edge;
+            }
+        });
+
+        mScatter.AddNodeForcesToMesh(r_mesh);
+    }
+}
+
+template <unsigned DIM>
+void ParallelFarhadifarForce<DIM>::OutputForceParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<UseColouring>" << mScatter.GetUseColouring() << "</UseColouring>\n";
+
+    // Call method on direct parent class
+    FarhadifarForce<DIM>::OutputForceParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class ParallelFarhadifarForce<1>;
+template class ParallelFarhadifarForce<2>;
+template class ParallelFarhadifarForce<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(ParallelFarhadifarForce)
@@ -0,0 +1,143 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef PARALLELFARHADIFARFORCE_HPP_
+#define PARALLELFARHADIFARFORCE_HPP_
+
+#include <boost/serialization/base_object.hpp>
+#include "ChasteSerialization.hpp"
+#include "Exception.hpp"
+
+#include "FarhadifarForce.hpp"
+#include "ParallelElementForceScatter.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+#include <iostream>
+#include <vector>
+
+/**
+ * A multithreaded version of FarhadifarForce, giving the same forces up to rounding.
+ *
+ * The parent class evaluates the force node by node, visiting every element containing each node. Here the force
+ * is assembled element by element instead: each edge of an element contributes a line tension and perimeter
+ * contractility term along the edge, and a share of the area elasticity term, to its two end nodes. The element
+ * loop is run on several threads with a ParallelElementForceScatter, which processes the elements one colour at a
+ * time so that no two threads ever add to the force on the same node (see ElementColouring).
+ *
+ * The parameters are set using the methods inherited from FarhadifarForce. A subclass may override
+ * GetLineTensionParameter(), but it is called from several threads at once, so must not modify any state.
+ */
+template <unsigned DIM>
+class ParallelFarhadifarForce : public FarhadifarForce<DIM>
+{
+private:
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template <class Archive>
+    void serialize(Archive& archive, const unsigned int version)
+    {
+        archive& boost::serialization::base_object<FarhadifarForce<DIM> >(*this);
+
+        // The scatter itself holds only working data, so just its setting is archived
+        bool use_colouring = mScatter.GetUseColouring();
+        archive& use_colouring;
+        mScatter.SetUseColouring(use_colouring);
+    }
+
+protected:
+    /** The parallel element loop, holding the colouring of the mesh between calls. */
+    ParallelElementForceScatter<DIM> mScatter;
+
+    /** Reused buffer of the target area of each element, indexed by element index. */
+    std::vector<double> mTargetAreas;
+
+public:
+
+    /**
+     * Constructor.
+     */
+    ParallelFarhadifarForce();
+
+    /**
+     * Destructor.
+     */
+    virtual ~ParallelFarhadifarForce() = default;
+
+    /**
+     * @return whether the element loop uses a colouring of the mesh, rather than per-thread force arrays (see
+     *     ParallelElementForceScatter)
+     */
+    bool GetUseColouring() const;
+
+    /**
+     * Set whether the element loop uses a colouring of the mesh. Defaults to true.
+     *
+     * @param useColouring whether to use a colouring
+     */
+    void SetUseColouring(bool useColouring);
+
+    /**
+     * @return the parallel element loop, for changing its settings or inspecting its colouring
+     */
+    ParallelElementForceScatter<DIM>& rGetScatter();
+
+    /**
+     * Overridden AddForceContribution() method.
+     *
+     * Calculates the force on each node in the vertex-based cell population, in 2D on several threads. In other
+     * dimensions the parent class method is used.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Overridden OutputForceParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputForceParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(ParallelFarhadifarForce)
+
+#endif /*PARALLELFARHADIFARFORCE_HPP_*/
@@ -0,0 +1,225 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "ParallelVtuOutputModifier.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "CellLabel.hpp"
+#include "HardwareCounterProfiler.hpp"
+#include "OutputFileHandler.hpp"
+#include "ThreadedLoop.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+template<unsigned DIM>
+ParallelVtuOutputModifier<DIM>::ParallelVtuOutputModifier()
+    : AbstractCellBasedSimulationModifier<DIM>()
+{
+}
+
+template<unsigned DIM>
+bool ParallelVtuOutputModifier<DIM>::GetCompress() const
+{
+    return mCompress;
+}
+
+template<unsigned DIM>
+void ParallelVtuOutputModifier<DIM>::SetCompress(bool compress)
+{
+    mCompress = compress;
+}
+
+template<unsigned DIM>
+unsigned ParallelVtuOutputModifier<DIM>::GetMinCellsPerThread() const
+{
+    return mMinCellsPerThread;
+}
+
+template<unsigned DIM>
+void ParallelVtuOutputModifier<DIM>::SetMinCellsPerThread(unsigned minCellsPerThread)
+{
+    mMinCellsPerThread = minCellsPerThread;
+}
+
+template<unsigned DIM>
+void ParallelVtuOutputModifier<DIM>::WriteVtuFile(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    HardwareCounterProfiler::ScopedPhase phase("ParallelVtuOutputModifier::WriteVtuFile");
+    auto& r_population = static_cast<VertexBasedCellPopulation<DIM>&>(rCellPopulation);
+    MutableVertexMesh<DIM,DIM>& r_mesh = r_population.rGetMesh();
+
+    // Number the nodes consecutively, skipping any that have been deleted but not yet removed
+    const unsigned num_all_nodes = r_mesh.GetNumAllNodes();
+    std::vector<int64_t> point_indices(num_all_nodes, -1);
+    std::vector<unsigned> node_indices;
+    node_indices.reserve(num_all_nodes);
+    for (unsigned node_index = 0; node_index < num_all_nodes; ++node_index)
+    {
+        if (!r_mesh.GetNode(node_index)->IsDeleted())
+        {
+            point_indices[node_index] = node_indices.size();
+            node_indices.push_back(node_index);
+        }
+    }
+
+    std::vector<double> coordinates(DIM * node_indices.size());
+    ThreadedLoop::Run(node_indices.size(), [&](unsigned begin, unsigned end, unsigned thread)
+    {
+        for (unsigned point = begin; point < end; ++point)
+        {
+            const c_vector<double, DIM>& r_location = r_mesh.GetNode(node_indices[point])->rGetLocation();
+            for (unsigned dim = 0; dim < DIM; ++dim)
+            {
+                coordinates[DIM * point + dim] = r_location[dim];
+            }
+        }
+    }, 4u * mMinCellsPerThread);
+
+    // The cell list and location map are not safe to share between threads, so are walked here
+    std::vector<CellPtr> cells;
+    std::vector<unsigned> element_indices;
+    std::vector<int64_t> offsets;
+    cells.reserve(r_population.GetNumRealCells());
+    element_indices.reserve(r_population.GetNumRealCells());
+    offsets.reserve(r_population.GetNumRealCells());
+    int64_t num_connections = 0;
+    for (auto cell_iter = r_population.Begin(); cell_iter != r_population.End(); ++cell_iter)
+    {
+        const unsigned element_index = r_population.GetLocationIndexUsingCell(*cell_iter);
+        cells.push_back(*cell_iter);
+        element_indices.push_back(element_index);
+        num_connections += r_mesh.GetElement(element_index)->GetNumNodes();
+        offsets.push_back(num_connections);
+    }
+
+    std::vector<int64_t> connectivity(num_connections);
+    std::vector<double> volumes(cells.size());
+    std::vector<int32_t> labels(cells.size());
+    std::vector<int32_t> types(cells.size());
+    ThreadedLoop::Run(cells.size(), [&](unsigned begin, unsigned end, unsigned thread)
+    {
+        for (unsigned i = begin; i < end; ++i)
+        {
+            VertexElement<DIM,DIM>* p_element = r_mesh.GetElement(element_indices[i]);
+            int64_t connection = (i == 0) ? 0 : offsets[i - 1];
+            for (unsigned local_index = 0; local_index < p_element->GetNumNodes(); ++local_index)
+            {
+                connectivity[connection++] = point_indices[p_element->GetNodeGlobalIndex(local_index)];
+            }
+
+            volumes[i] = r_mesh.GetVolumeOfElement(element_indices[i]);
+
+            labels[i] = 0;
+            if (cells[i]->template HasCellProperty<CellLabel>())
+            {
+                CellPropertyCollection collection = cells[i]->rGetCellPropertyCollection().template GetProperties<CellLabel>();
+                labels[i] = boost::static_pointer_cast<CellLabel>(collection.GetProperty())->GetColour();
+            }
+
+            types[i] = cells[i]->GetCellProliferativeType()->GetColour();
+        }
+    }, mMinCellsPerThread);
+
+    AppendedVtuWriter writer(mCompress);
+    writer.SetMinPointsPerThread(4u * mMinCellsPerThread);
+    writer.SetPoints(coordinates, DIM);
+    writer.SetPolygons(connectivity, offsets);
+    writer.AddCellData("Cell volumes", volumes);
+    writer.AddCellData("Cell labels", labels);
+    writer.AddCellData("Cell types", types);
+
+    const std::string file_name = "mesh_" + std::to_string(SimulationTime::Instance()->GetTimeStepsElapsed()) + ".vtu";
+    writer.Write(mOutputDirectoryFullPath + file_name);
+    mFilesWritten.emplace_back(SimulationTime::Instance()->GetTime(), file_name);
+
+    // Rewrite the PVD file every time, so it is complete even if the simulation is stopped early
+    std::ofstream pvd_file(mOutputDirectoryFullPath + "mesh.pvd");
+    pvd_file << "<?xml version=\"1.0\"?>\n";
+    pvd_file << "<VTKFile type=\"Collection\" version=\"1.0\" byte_order=\"LittleEndian\">\n";
+    pvd_file << "  <Collection>\n";
+    pvd_file << std::setprecision(12);
+    for (const auto& r_file : mFilesWritten)
+    {
+        pvd_file << "    <DataSet timestep=\"" << r_file.first << "\" group=\"\" part=\"0\" file=\"" << r_file.second << "\"/>\n";
+    }
+    pvd_file << "  </Collection>\n";
+    pvd_file << "</VTKFile>\n";
+}
+
+template<unsigned DIM>
+void ParallelVtuOutputModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+}
+
+template<unsigned DIM>
+void ParallelVtuOutputModifier<DIM>::UpdateAtEndOfOutputTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    WriteVtuFile(rCellPopulation);
+}
+
+template<unsigned DIM>
+void ParallelVtuOutputModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    if (DIM != 2 || dynamic_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation) == nullptr)
+    {
+        EXCEPTION("ParallelVtuOutputModifier is to be used with a 2D VertexBasedCellPopulation only");
+    }
+
+    OutputFileHandler output_file_handler(outputDirectory, false);
+    mOutputDirectoryFullPath = output_file_handler.GetOutputDirectoryFullPath();
+    mFilesWritten.clear();
+
+    WriteVtuFile(rCellPopulation);
+}
+
+template<unsigned DIM>
+void ParallelVtuOutputModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<Compress>" << mCompress << "</Compress>\n";
+
+    // Call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class ParallelVtuOutputModifier<1>;
+template class ParallelVtuOutputModifier<2>;
+template class ParallelVtuOutputModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(ParallelVtuOutputModifier)
@@ -0,0 +1,177 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef PARALLELVTUOUTPUTMODIFIER_HPP_
+#define PARALLELVTUOUTPUTMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "AppendedVtuWriter.hpp"
+
+/**
+ * A modifier that writes the mesh of a 2D vertex-based cell population at each output time step as an appended
+ * binary VTU file (see AppendedVtuWriter), together with a PVD file, mesh.pvd, listing every VTU file and its time,
+ * which can be opened directly in ParaView.
+ *
+ * Each polygon carries the cell data arrays "Cell volumes", "Cell labels" and "Cell types", with the same values as
+ * CellVolumesWriter, CellLabelWriter and CellProliferativeTypesWriter; these are evaluated, and the arrays encoded, on
+ * worker threads.
+ */
+template<unsigned DIM>
+class ParallelVtuOutputModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+private:
+
+    /** Whether to compress the VTU files, if Chaste was built with VTK. Defaults to true. */
+    bool mCompress = true;
+
+    /**
+     * The minimum number of cells given to each worker thread; loops over points, which do less work per item, use
+     * four times as many. Defaults to 1024, below which the cost of starting threads outweighs the gain.
+     */
+    unsigned mMinCellsPerThread = 1024u;
+
+    /** The full path of the output directory, once SetupSolve() has been called. */
+    std::string mOutputDirectoryFullPath;
+
+    /** The time and file name of each VTU file written, for the PVD file. */
+    std::vector<std::pair<double, std::string> > mFilesWritten;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & mCompress;
+    }
+
+    /**
+     * Write a VTU file of the current mesh, and rewrite the PVD file.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void WriteVtuFile(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    ParallelVtuOutputModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~ParallelVtuOutputModifier() = default;
+
+    /**
+     * @return mCompress
+     */
+    bool GetCompress() const;
+
+    /**
+     * Set mCompress.
+     *
+     * @param compress the new value of mCompress
+     */
+    void SetCompress(bool compress);
+
+    /**
+     * @return mMinCellsPerThread
+     */
+    unsigned GetMinCellsPerThread() const;
+
+    /**
+     * Set mMinCellsPerThread. This only affects performance, so is not archived.
+     *
+     * @param minCellsPerThread the new value of mMinCellsPerThread
+     */
+    void SetMinCellsPerThread(unsigned minCellsPerThread);
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Does nothing: files are written at output time steps only.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden UpdateAtEndOfOutputTimeStep() method.
+     *
+     * Writes a VTU file.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfOutputTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Checks the cell population is a 2D vertex-based one, and writes a VTU file of the initial mesh.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(ParallelVtuOutputModifier)
+
+#endif /*PARALLELVTUOUTPUTMODIFIER_HPP_*/
@@ -0,0 +1,97 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "ReproducibleVonMisesVertexBasedDivisionRule.hpp"
+#include "CounterBasedRandomNumberGenerator.hpp"
+#include "HardwareCounterProfiler.hpp"
+
+template <unsigned DIM>
+ReproducibleVonMisesVertexBasedDivisionRule<DIM>::ReproducibleVonMisesVertexBasedDivisionRule()
+        : AbstractVertexBasedDivisionRule<DIM>()
+{
+}
+
+template <unsigned DIM>
+double ReproducibleVonMisesVertexBasedDivisionRule<DIM>::GetMeanParameter()
+{
+    return mMeanParameter;
+}
+
+template <unsigned DIM>
+void ReproducibleVonMisesVertexBasedDivisionRule<DIM>::SetMeanParameter(double meanParameter)
+{
+    mMeanParameter = meanParameter;
+}
+
+template <unsigned DIM>
+double ReproducibleVonMisesVertexBasedDivisionRule<DIM>::GetConcentrationParameter()
+{
+    return mConcentrationParameter;
+}
+
+template <unsigned DIM>
+void ReproducibleVonMisesVertexBasedDivisionRule<DIM>::SetConcentrationParameter(double concentrationParameter)
+{
+    mConcentrationParameter = concentrationParameter;
+}
+
+template <unsigned SPACE_DIM>
+c_vector<double, SPACE_DIM> ReproducibleVonMisesVertexBasedDivisionRule<SPACE_DIM>::CalculateCellDivisionVector(
+    CellPtr pParentCell,
+    VertexBasedCellPopulation<SPACE_DIM>& rCellPopulation)
+{
+    HardwareCounterProfiler::ScopedPhase phase("ReproducibleVonMisesVertexBasedDivisionRule::CalculateCellDivisionVector");
+    CounterBasedRandomStream stream = CounterBasedRandomNumberGenerator::Instance()->GetStream(
+        pParentCell, CounterBasedRandomNumberGenerator::DIVISION_DIRECTION_STREAM);
+    const double theta = stream.VonMisesRandomDeviate(mMeanParameter, mConcentrationParameter);
+
+    c_vector<double, SPACE_DIM> vector = zero_vector<double>(SPACE_DIM);
+    vector(0) = std::cos(theta);
+    if constexpr (SPACE_DIM > 1)
+    {
+        vector(1) = std::sin(theta);
+    }
+
+    return vector;
+}
+
+// Explicit instantiation
+template class ReproducibleVonMisesVertexBasedDivisionRule<1>;
+template class ReproducibleVonMisesVertexBasedDivisionRule<2>;
+template class ReproducibleVonMisesVertexBasedDivisionRule<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(ReproducibleVonMisesVertexBasedDivisionRule)
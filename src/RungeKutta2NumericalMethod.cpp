@@ -0,0 +1,99 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "RungeKutta2NumericalMethod.hpp"
+#include "Exception.hpp"
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+RungeKutta2NumericalMethod<ELEMENT_DIM, SPACE_DIM>::RungeKutta2NumericalMethod()
+    : AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM>()
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void RungeKutta2NumericalMethod<ELEMENT_DIM, SPACE_DIM>::UpdateAllNodePositions(double dt)
+{
+    if (this->mUseUpdateNodeLocation)
+    {
+        EXCEPTION("RungeKutta2NumericalMethod cannot be used with a cell population that updates its own node locations");
+    }
+
+    AbstractMesh<ELEMENT_DIM, SPACE_DIM>& r_mesh = this->mpCellPopulation->rGetMesh();
+
+    std::vector<c_vector<double, SPACE_DIM> > initial_locations = this->SaveCurrentNodeLocations();
+    std::vector<c_vector<double, SPACE_DIM> > k1 = this->ComputeForcesIncludingDamping();
+
+    // Move each node to the forward Euler prediction...
+    unsigned index = 0;
+    for (auto node_iter = r_mesh.GetNodeIteratorBegin(); node_iter != r_mesh.GetNodeIteratorEnd(); ++node_iter, ++index)
+    {
+        c_vector<double, SPACE_DIM> predicted_location = initial_locations[index] + dt * k1[index];
+        this->SafeNodePositionUpdate(node_iter->GetIndex(), predicted_location);
+    }
+
+    // ...evaluate the forces there, and then take the step using the average of the two
+    std::vector<c_vector<double, SPACE_DIM> > k2 = this->ComputeForcesIncludingDamping();
+
+    index = 0;
+    for (auto node_iter = r_mesh.GetNodeIteratorBegin(); node_iter != r_mesh.GetNodeIteratorEnd(); ++node_iter, ++index)
+    {
+        c_vector<double, SPACE_DIM> displacement = 0.5 * dt * (k1[index] + k2[index]);
+
+        // In the vertex-based case, the displacement may be scaled if the cell rearrangement threshold is exceeded
+        this->DetectStepSizeExceptions(node_iter->GetIndex(), displacement, dt);
+
+        c_vector<double, SPACE_DIM> new_location = initial_locations[index] + displacement;
+        this->SafeNodePositionUpdate(node_iter->GetIndex(), new_location);
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void RungeKutta2NumericalMethod<ELEMENT_DIM, SPACE_DIM>::OutputNumericalMethodParameters(out_stream& rParamsFile)
+{
+    // No new parameters to output, so just call method on direct parent class
+    AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM>::OutputNumericalMethodParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class RungeKutta2NumericalMethod<1,1>;
+template class RungeKutta2NumericalMethod<1,2>;
+template class RungeKutta2NumericalMethod<2,2>;
+template class RungeKutta2NumericalMethod<1,3>;
+template class RungeKutta2NumericalMethod<2,3>;
+template class RungeKutta2NumericalMethod<3,3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(RungeKutta2NumericalMethod)
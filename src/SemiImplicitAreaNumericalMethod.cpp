@@ -0,0 +1,165 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "SemiImplicitAreaNumericalMethod.hpp"
+#include "Exception.hpp"
+#include "FarhadifarForce.hpp"
+#include "NagaiHondaForce.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+SemiImplicitAreaNumericalMethod<ELEMENT_DIM, SPACE_DIM>::SemiImplicitAreaNumericalMethod()
+    : AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM>()
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double SemiImplicitAreaNumericalMethod<ELEMENT_DIM, SPACE_DIM>::GetAreaStiffness()
+{
+    return mAreaStiffness;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void SemiImplicitAreaNumericalMethod<ELEMENT_DIM, SPACE_DIM>::SetAreaStiffness(double areaStiffness)
+{
+    mAreaStiffness = areaStiffness;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double SemiImplicitAreaNumericalMethod<ELEMENT_DIM, SPACE_DIM>::FindAreaStiffnessFromForces()
+{
+    double stiffness = 0.0;
+    for (auto& p_force : *(this->mpForceCollection))
+    {
+        // The Farhadifar area energy is K/2 (A - A0)^2, whereas the Nagai-Honda deformation energy is lambda (A - A0)^2
+        if (auto p_farhadifar = dynamic_cast<FarhadifarForce<2>*>(p_force.get()))
+        {
+            stiffness += p_farhadifar->GetAreaElasticityParameter();
+        }
+        else if (auto p_nagai_honda = dynamic_cast<NagaiHondaForce<2>*>(p_force.get()))
+        {
+            stiffness += 2.0 * p_nagai_honda->GetNagaiHondaDeformationEnergyParameter();
+        }
+    }
+    return stiffness;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void SemiImplicitAreaNumericalMethod<ELEMENT_DIM, SPACE_DIM>::UpdateAllNodePositions(double dt)
+{
+    if constexpr (ELEMENT_DIM != 2 || SPACE_DIM != 2)
+    {
+        EXCEPTION("SemiImplicitAreaNumericalMethod is only implemented in 2D");
+    }
+    else
+    {
+        auto p_population = dynamic_cast<VertexBasedCellPopulation<2>*>(this->mpCellPopulation);
+        if (p_population == nullptr || this->mUseUpdateNodeLocation)
+        {
+            EXCEPTION("SemiImplicitAreaNumericalMethod is to be used with a VertexBasedCellPopulation only");
+        }
+        MutableVertexMesh<2, 2>& r_mesh = p_population->rGetMesh();
+
+        const double stiffness = (mAreaStiffness >= 0.0) ? mAreaStiffness : FindAreaStiffnessFromForces();
+
+        std::vector<c_vector<double, 2> > forces = this->ComputeForcesIncludingDamping();
+
+        // Compute all displacements before moving any node, as the area gradients depend on the node locations
+        std::vector<c_vector<double, 2> > displacements(forces.size());
+
+        unsigned index = 0;
+        for (auto node_iter = r_mesh.GetNodeIteratorBegin(); node_iter != r_mesh.GetNodeIteratorEnd(); ++node_iter, ++index)
+        {
+            const unsigned node_index = node_iter->GetIndex();
+
+            // Assemble the Gauss-Newton approximation to the diagonal block of the area elasticity Jacobian
+            double j_xx = 0.0;
+            double j_xy = 0.0;
+            double j_yy = 0.0;
+            for (const unsigned elem_index : node_iter->rGetContainingElementIndices())
+            {
+                VertexElement<2, 2>* p_element = r_mesh.GetElement(elem_index);
+                const c_vector<double, 2> area_gradient =
+                    r_mesh.GetAreaGradientOfElementAtNode(p_element, p_element->GetNodeLocalIndex(node_index));
+
+                j_xx += area_gradient[0] * area_gradient[0];
+                j_xy += area_gradient[0] * area_gradient[1];
+                j_yy += area_gradient[1] * area_gradient[1];
+            }
+
+            // Solve (I + c J) dx = dt F / eta; the force has already been divided by the damping constant
+            const double c = dt * stiffness / p_population->GetDampingConstant(node_index);
+            const double a_xx = 1.0 + c * j_xx;
+            const double a_xy = c * j_xy;
+            const double a_yy = 1.0 + c * j_yy;
+            const double determinant = a_xx * a_yy - a_xy * a_xy;
+
+            const c_vector<double, 2> rhs = dt * forces[index];
+            displacements[index][0] = (a_yy * rhs[0] - a_xy * rhs[1]) / determinant;
+            displacements[index][1] = (a_xx * rhs[1] - a_xy * rhs[0]) / determinant;
+        }
+
+        index = 0;
+        for (auto node_iter = r_mesh.GetNodeIteratorBegin(); node_iter != r_mesh.GetNodeIteratorEnd(); ++node_iter, ++index)
+        {
+            // In the vertex-based case, the displacement may be scaled if the cell rearrangement threshold is exceeded
+            this->DetectStepSizeExceptions(node_iter->GetIndex(), displacements[index], dt);
+
+            c_vector<double, 2> new_location = node_iter->rGetLocation() + displacements[index];
+            this->SafeNodePositionUpdate(node_iter->GetIndex(), new_location);
+        }
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void SemiImplicitAreaNumericalMethod<ELEMENT_DIM, SPACE_DIM>::OutputNumericalMethodParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<AreaStiffness>" << mAreaStiffness << "</AreaStiffness>\n";
+
+    // Call method on direct parent class
+    AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM>::OutputNumericalMethodParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class SemiImplicitAreaNumericalMethod<1,1>;
+template class SemiImplicitAreaNumericalMethod<1,2>;
+template class SemiImplicitAreaNumericalMethod<2,2>;
+template class SemiImplicitAreaNumericalMethod<1,3>;
+template class SemiImplicitAreaNumericalMethod<2,3>;
+template class SemiImplicitAreaNumericalMethod<3,3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(SemiImplicitAreaNumericalMethod)
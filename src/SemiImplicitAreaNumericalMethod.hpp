@@ -0,0 +1,137 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef SEMIIMPLICITAREANUMERICALMETHOD_HPP_
+#define SEMIIMPLICITAREANUMERICALMETHOD_HPP_
+
+#include <boost/serialization/base_object.hpp>
+#include "ChasteSerialization.hpp"
+
+#include "AbstractNumericalMethod.hpp"
+
+/**
+ * A semi-implicit numerical method for 2D vertex-based simulations, in which the stiff area elasticity term of the
+ * energy is treated implicitly and all other forces explicitly.
+ *
+ * For an area energy of the form K/2 (A - A0)^2 per cell, the Jacobian of the force on node i with respect to its
+ * own position is, to leading order, -K sum_cells grad_i(A) grad_i(A)^T. Each step solves the 2x2 system
+ *
+ *     (I + dt/eta K sum_cells grad_i(A) grad_i(A)^T) dx_i = dt/eta F_i
+ *
+ * for the displacement of each node, where F_i is the total force and eta the damping constant. This is a linearly
+ * implicit Euler step in which the area term is implicit, and it stays stable for much larger area elasticity
+ * parameters or time steps than forward Euler, at the cost of one force evaluation per step.
+ *
+ * By default K is found from the FarhadifarForce and NagaiHondaForce objects (and subclasses) in the simulation;
+ * it may instead be set directly.
+ */
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM=ELEMENT_DIM>
+class SemiImplicitAreaNumericalMethod : public AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM>
+{
+private:
+
+    /**
+     * The area stiffness K used in the implicit part of the step. A negative value, the default, means that it is
+     * found from the forces each time step.
+     */
+    double mAreaStiffness = -1.0;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM> >(*this);
+        archive & mAreaStiffness;
+    }
+
+protected:
+
+    /**
+     * @return the sum of the area stiffnesses of the FarhadifarForce and NagaiHondaForce objects in the force
+     * collection
+     */
+    double FindAreaStiffnessFromForces();
+
+public:
+
+    /**
+     * Constructor.
+     */
+    SemiImplicitAreaNumericalMethod();
+
+    /**
+     * Destructor.
+     */
+    virtual ~SemiImplicitAreaNumericalMethod() = default;
+
+    /**
+     * @return mAreaStiffness
+     */
+    double GetAreaStiffness();
+
+    /**
+     * Set mAreaStiffness.
+     *
+     * @param areaStiffness the new value of mAreaStiffness; a negative value means it is found from the forces
+     */
+    void SetAreaStiffness(double areaStiffness);
+
+    /**
+     * Overridden UpdateAllNodePositions() method.
+     *
+     * @param dt Time step size
+     */
+    virtual void UpdateAllNodePositions(double dt);
+
+    /**
+     * Overridden OutputNumericalMethodParameters() method.
+     *
+     * @param rParamsFile Reference to the parameter output filestream
+     */
+    virtual void OutputNumericalMethodParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(SemiImplicitAreaNumericalMethod)
+
+#endif /*SEMIIMPLICITAREANUMERICALMETHOD_HPP_*/
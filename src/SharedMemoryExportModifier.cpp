@@ -0,0 +1,244 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "SharedMemoryExportModifier.hpp"
+
+#include <cmath>
+#include <unistd.h>
+
+#include "CellLabel.hpp"
+#include "HardwareCounterProfiler.hpp"
+#include "OutputFileHandler.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "Warnings.hpp"
+
+template<unsigned DIM>
+SharedMemoryExportModifier<DIM>::SharedMemoryExportModifier()
+    : AbstractCellBasedSimulationModifier<DIM>()
+{
+}
+
+template<unsigned DIM>
+const std::string& SharedMemoryExportModifier<DIM>::rGetSharedMemoryName() const
+{
+    return mSharedMemoryName;
+}
+
+template<unsigned DIM>
+void SharedMemoryExportModifier<DIM>::SetSharedMemoryName(const std::string& rSharedMemoryName)
+{
+    if (!rSharedMemoryName.empty() && (rSharedMemoryName[0] != '/' || rSharedMemoryName.find('/', 1) != std::string::npos))
+    {
+        EXCEPTION("A shared memory name must start with '/' and contain no other '/'");
+    }
+    mSharedMemoryName = rSharedMemoryName;
+}
+
+template<unsigned DIM>
+unsigned SharedMemoryExportModifier<DIM>::GetNumSlots() const
+{
+    return mNumSlots;
+}
+
+template<unsigned DIM>
+void SharedMemoryExportModifier<DIM>::SetNumSlots(unsigned numSlots)
+{
+    if (numSlots == 0)
+    {
+        EXCEPTION("SharedMemoryExportModifier needs at least one slot");
+    }
+    mNumSlots = numSlots;
+}
+
+template<unsigned DIM>
+double SharedMemoryExportModifier<DIM>::GetCapacityFactor() const
+{
+    return mCapacityFactor;
+}
+
+template<unsigned DIM>
+void SharedMemoryExportModifier<DIM>::SetCapacityFactor(double capacityFactor)
+{
+    if (capacityFactor < 1.0)
+    {
+        EXCEPTION("The capacity factor of SharedMemoryExportModifier must be at least 1");
+    }
+    mCapacityFactor = capacityFactor;
+}
+
+template<unsigned DIM>
+const std::string& SharedMemoryExportModifier<DIM>::rGetActiveSharedMemoryName() const
+{
+    return mActiveSharedMemoryName;
+}
+
+template<unsigned DIM>
+unsigned SharedMemoryExportModifier<DIM>::GetNumFramesPublished() const
+{
+    return mNumFramesPublished;
+}
+
+template<unsigned DIM>
+unsigned SharedMemoryExportModifier<DIM>::GetNumFramesSkipped() const
+{
+    return mNumFramesSkipped;
+}
+
+template<unsigned DIM>
+void SharedMemoryExportModifier<DIM>::PublishFrame(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    HardwareCounterProfiler::ScopedPhase phase("SharedMemoryExportModifier::PublishFrame");
+    auto& r_population = static_cast<VertexBasedCellPopulation<DIM>&>(rCellPopulation);
+    MutableVertexMesh<DIM, DIM>& r_mesh = r_population.rGetMesh();
+
+    const unsigned num_nodes = r_mesh.GetNumNodes();
+    const unsigned num_cells = r_population.GetNumRealCells();
+    unsigned num_element_nodes = 0;
+    for (auto cell_iter = r_population.Begin(); cell_iter != r_population.End(); ++cell_iter)
+    {
+        num_element_nodes += r_population.GetElementCorrespondingToCell(*cell_iter)->GetNumNodes();
+    }
+
+    SharedMemoryTissueWriter::FrameBuffers buffers;
+    if (!mpWriter->BeginFrame(SimulationTime::Instance()->GetTime(), num_nodes, num_cells, num_element_nodes, buffers))
+    {
+        WARN_ONCE_ONLY("The tissue has outgrown the shared memory segment of SharedMemoryExportModifier; frames are being skipped");
+        ++mNumFramesSkipped;
+        return;
+    }
+
+    // Write straight into the slot, with no intermediate copy
+    for (unsigned node_index = 0; node_index < num_nodes; ++node_index)
+    {
+        const c_vector<double, DIM>& r_location = r_mesh.GetNode(node_index)->rGetLocation();
+        for (unsigned dim = 0; dim < DIM; ++dim)
+        {
+            buffers.mpNodeLocations[DIM * node_index + dim] = r_location[dim];
+        }
+    }
+
+    unsigned cell = 0;
+    unsigned offset = 0;
+    for (auto cell_iter = r_population.Begin(); cell_iter != r_population.End(); ++cell_iter, ++cell)
+    {
+        VertexElement<DIM, DIM>* p_element = r_population.GetElementCorrespondingToCell(*cell_iter);
+        buffers.mpCellVolumes[cell] = r_mesh.GetVolumeOfElement(p_element->GetIndex());
+        buffers.mpCellLabels[cell] = cell_iter->template HasCellProperty<CellLabel>() ? 1u : 0u;
+        buffers.mpElementOffsets[cell] = offset;
+        for (unsigned local_index = 0; local_index < p_element->GetNumNodes(); ++local_index)
+        {
+            buffers.mpElementNodes[offset++] = p_element->GetNodeGlobalIndex(local_index);
+        }
+    }
+    buffers.mpElementOffsets[num_cells] = offset;
+
+    mpWriter->EndFrame();
+    ++mNumFramesPublished;
+}
+
+template<unsigned DIM>
+void SharedMemoryExportModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+}
+
+template<unsigned DIM>
+void SharedMemoryExportModifier<DIM>::UpdateAtEndOfOutputTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (mpWriter)
+    {
+        PublishFrame(rCellPopulation);
+    }
+}
+
+template<unsigned DIM>
+void SharedMemoryExportModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    auto p_population = dynamic_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation);
+    if (p_population == nullptr)
+    {
+        EXCEPTION("SharedMemoryExportModifier is to be used with a VertexBasedCellPopulation only");
+    }
+
+    mActiveSharedMemoryName = mSharedMemoryName.empty() ? "/chaste_tissue_" + std::to_string(getpid()) : mSharedMemoryName;
+    mNumFramesPublished = 0u;
+    mNumFramesSkipped = 0u;
+
+    unsigned num_element_nodes = 0;
+    for (auto cell_iter = p_population->Begin(); cell_iter != p_population->End(); ++cell_iter)
+    {
+        num_element_nodes += p_population->GetElementCorrespondingToCell(*cell_iter)->GetNumNodes();
+    }
+    mpWriter.reset(new SharedMemoryTissueWriter(mActiveSharedMemoryName, DIM, mNumSlots,
+                                                std::ceil(mCapacityFactor * p_population->rGetMesh().GetNumNodes()),
+                                                std::ceil(mCapacityFactor * p_population->GetNumRealCells()),
+                                                std::ceil(mCapacityFactor * num_element_nodes)));
+
+    OutputFileHandler output_file_handler(outputDirectory, false);
+    out_stream p_name_file = output_file_handler.OpenOutputFile("sharedmemory.txt");
+    *p_name_file << mActiveSharedMemoryName << "\n";
+    p_name_file->close();
+
+    PublishFrame(rCellPopulation);
+}
+
+template<unsigned DIM>
+void SharedMemoryExportModifier<DIM>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (mpWriter)
+    {
+        mpWriter->Close();
+        mpWriter.reset();
+    }
+}
+
+template<unsigned DIM>
+void SharedMemoryExportModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<SharedMemoryName>" << mSharedMemoryName << "</SharedMemoryName>\n";
+    *rParamsFile << "\t\t\t<NumSlots>" << mNumSlots << "</NumSlots>\n";
+    *rParamsFile << "\t\t\t<CapacityFactor>" << mCapacityFactor << "</CapacityFactor>\n";
+
+    // Call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class SharedMemoryExportModifier<1>;
+template class SharedMemoryExportModifier<2>;
+template class SharedMemoryExportModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(SharedMemoryExportModifier)
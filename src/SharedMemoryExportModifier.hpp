@@ -0,0 +1,225 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef SHAREDMEMORYEXPORTMODIFIER_HPP_
+#define SHAREDMEMORYEXPORTMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "SharedMemoryTissueWriter.hpp"
+
+/**
+ * A modifier that publishes the state of a vertex tissue into a POSIX shared memory segment at the start of the
+ * simulation and at each output time step, so that other processes on the same machine can follow the simulation
+ * live, without any files being written or read. See SharedMemoryTissueWriter for the layout of the segment, and
+ * SharedMemoryTissueReader and apps/src/SharedMemoryTissueViewerApp.cpp for how it is read.
+ *
+ * Each frame holds the location of every node, the nodes of every element (as node indices, anticlockwise), and the
+ * volume and label of every cell, in cell iterator order. The capacity of each slot is fixed when the segment is
+ * created, as a multiple of the size of the initial tissue; frames that would not fit are skipped, with a warning.
+ *
+ * The name of the segment is written to the file sharedmemory.txt in the output directory. The segment is removed
+ * at the end of the simulation.
+ */
+template<unsigned DIM>
+class SharedMemoryExportModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+private:
+
+    /**
+     * The name of the segment, starting with '/'. If empty (the default), the name /chaste_tissue_<pid> is used,
+     * where <pid> is the process ID.
+     */
+    std::string mSharedMemoryName;
+
+    /** The number of slots in the ring of frames. Defaults to 4. */
+    unsigned mNumSlots = 4u;
+
+    /** The capacity of each slot, as a multiple of the size of the initial tissue. Defaults to 4. */
+    double mCapacityFactor = 4.0;
+
+    /** The writer, while a simulation is running. */
+    boost::shared_ptr<SharedMemoryTissueWriter> mpWriter;
+
+    /** The name of the segment being written, while a simulation is running. */
+    std::string mActiveSharedMemoryName;
+
+    /** The number of frames published in the current or last simulation. */
+    unsigned mNumFramesPublished = 0u;
+
+    /** The number of frames skipped because they did not fit in a slot. */
+    unsigned mNumFramesSkipped = 0u;
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & mSharedMemoryName;
+        archive & mNumSlots;
+        archive & mCapacityFactor;
+    }
+
+    /**
+     * Publish the current state of the tissue as a frame.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void PublishFrame(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    SharedMemoryExportModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~SharedMemoryExportModifier() = default;
+
+    /**
+     * @return mSharedMemoryName
+     */
+    const std::string& rGetSharedMemoryName() const;
+
+    /**
+     * Set mSharedMemoryName.
+     *
+     * @param rSharedMemoryName the new value of mSharedMemoryName
+     */
+    void SetSharedMemoryName(const std::string& rSharedMemoryName);
+
+    /**
+     * @return mNumSlots
+     */
+    unsigned GetNumSlots() const;
+
+    /**
+     * Set mNumSlots.
+     *
+     * @param numSlots the new value of mNumSlots
+     */
+    void SetNumSlots(unsigned numSlots);
+
+    /**
+     * @return mCapacityFactor
+     */
+    double GetCapacityFactor() const;
+
+    /**
+     * Set mCapacityFactor.
+     *
+     * @param capacityFactor the new value of mCapacityFactor
+     */
+    void SetCapacityFactor(double capacityFactor);
+
+    /**
+     * @return the name of the segment of the current or last simulation
+     */
+    const std::string& rGetActiveSharedMemoryName() const;
+
+    /**
+     * @return the number of frames published in the current or last simulation
+     */
+    unsigned GetNumFramesPublished() const;
+
+    /**
+     * @return the number of frames skipped in the current or last simulation because they did not fit in a slot
+     */
+    unsigned GetNumFramesSkipped() const;
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Does nothing: frames are published at output time steps only.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden UpdateAtEndOfOutputTimeStep() method.
+     *
+     * Publishes a frame.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfOutputTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Creates the segment, records its name in the output directory and publishes the initial state.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden UpdateAtEndOfSolve() method.
+     *
+     * Marks the segment as finished and removes it.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(SharedMemoryExportModifier)
+
+#endif /*SHAREDMEMORYEXPORTMODIFIER_HPP_*/
@@ -0,0 +1,185 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "SharedMemoryTissueReader.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Exception.hpp"
+
+SharedMemoryTissueReader::SharedMemoryTissueReader(const std::string& rName)
+    : mName(rName)
+{
+    const int file_descriptor = shm_open(mName.c_str(), O_RDONLY, 0);
+    if (file_descriptor < 0)
+    {
+        EXCEPTION("Could not open shared memory segment " + mName + ": " + strerror(errno));
+    }
+
+    struct stat status;
+    if (fstat(file_descriptor, &status) != 0
+        || static_cast<uint64_t>(status.st_size) < SharedMemoryTissueWriter::GetSegmentHeaderSize())
+    {
+        close(file_descriptor);
+        EXCEPTION(mName + " is not a shared memory tissue segment");
+    }
+    mSegmentSize = status.st_size;
+
+    // The mapping stays valid once the descriptor is closed, and after the writer removes the name
+    void* p_segment = mmap(nullptr, mSegmentSize, PROT_READ, MAP_SHARED, file_descriptor, 0);
+    close(file_descriptor);
+    if (p_segment == MAP_FAILED)
+    {
+        EXCEPTION("Could not map shared memory segment " + mName + ": " + strerror(errno));
+    }
+    mpSegment = static_cast<const char*>(p_segment);
+
+    const SharedMemoryTissueWriter::SegmentHeader* p_header = GetSegmentHeader();
+    const uint32_t version = p_header->mVersion.load(std::memory_order_acquire);
+    if (memcmp(p_header->mMagic, SharedMemoryTissueWriter::SEGMENT_MAGIC, sizeof(p_header->mMagic)) != 0
+        || version != SharedMemoryTissueWriter::FORMAT_VERSION)
+    {
+        munmap(const_cast<char*>(mpSegment), mSegmentSize);
+        mpSegment = nullptr;
+        EXCEPTION(mName + " is not a shared memory tissue segment, or is still being created");
+    }
+
+    mSlotLayout = SharedMemoryTissueWriter::CalculateSlotLayout(p_header->mSpaceDimension,
+                                                                p_header->mMaxNumNodes,
+                                                                p_header->mMaxNumElements,
+                                                                p_header->mMaxNumElementNodes);
+    if (mSlotLayout.mSize != p_header->mSlotSize
+        || SharedMemoryTissueWriter::GetSegmentHeaderSize() + p_header->mNumSlots * mSlotLayout.mSize > mSegmentSize)
+    {
+        munmap(const_cast<char*>(mpSegment), mSegmentSize);
+        mpSegment = nullptr;
+        EXCEPTION("Shared memory segment " + mName + " has an inconsistent layout");
+    }
+}
+
+SharedMemoryTissueReader::~SharedMemoryTissueReader()
+{
+    if (mpSegment != nullptr)
+    {
+        munmap(const_cast<char*>(mpSegment), mSegmentSize);
+    }
+}
+
+const SharedMemoryTissueWriter::SegmentHeader* SharedMemoryTissueReader::GetSegmentHeader() const
+{
+    return reinterpret_cast<const SharedMemoryTissueWriter::SegmentHeader*>(mpSegment);
+}
+
+unsigned SharedMemoryTissueReader::GetSpaceDimension() const
+{
+    return GetSegmentHeader()->mSpaceDimension;
+}
+
+unsigned SharedMemoryTissueReader::GetNumSlots() const
+{
+    return GetSegmentHeader()->mNumSlots;
+}
+
+uint64_t SharedMemoryTissueReader::GetNumFramesPublished() const
+{
+    return GetSegmentHeader()->mNumFramesPublished.load(std::memory_order_acquire);
+}
+
+bool SharedMemoryTissueReader::IsFinished() const
+{
+    return GetSegmentHeader()->mFinished.load(std::memory_order_acquire) != 0u;
+}
+
+bool SharedMemoryTissueReader::ReadFrame(uint64_t frameIndex, Frame& rFrame) const
+{
+    const SharedMemoryTissueWriter::SegmentHeader* p_header = GetSegmentHeader();
+    const char* p_slot = mpSegment + SharedMemoryTissueWriter::GetSegmentHeaderSize()
+                         + (frameIndex % p_header->mNumSlots) * mSlotLayout.mSize;
+    const auto* p_frame = reinterpret_cast<const SharedMemoryTissueWriter::FrameHeader*>(p_slot);
+
+    const uint64_t expected_sequence = 2u * frameIndex + 2u;
+    if (p_frame->mSequence.load(std::memory_order_acquire) != expected_sequence)
+    {
+        return false;
+    }
+
+    // Anything read from here on may be torn, so the counts are checked before they are used to copy
+    const unsigned num_nodes = p_frame->mNumNodes;
+    const unsigned num_elements = p_frame->mNumElements;
+    const unsigned num_element_nodes = p_frame->mNumElementNodes;
+    if (num_nodes > p_header->mMaxNumNodes || num_elements > p_header->mMaxNumElements
+        || num_element_nodes > p_header->mMaxNumElementNodes)
+    {
+        return false;
+    }
+
+    rFrame.mFrameIndex = frameIndex;
+    rFrame.mTime = p_frame->mTime;
+    rFrame.mNodeLocations.resize(num_nodes * p_header->mSpaceDimension);
+    rFrame.mCellVolumes.resize(num_elements);
+    rFrame.mElementOffsets.resize(num_elements + 1u);
+    rFrame.mElementNodes.resize(num_element_nodes);
+    rFrame.mCellLabels.resize(num_elements);
+
+    memcpy(rFrame.mNodeLocations.data(), p_slot + mSlotLayout.mNodeLocations, rFrame.mNodeLocations.size() * sizeof(double));
+    memcpy(rFrame.mCellVolumes.data(), p_slot + mSlotLayout.mCellVolumes, num_elements * sizeof(double));
+    memcpy(rFrame.mElementOffsets.data(), p_slot + mSlotLayout.mElementOffsets, (num_elements + 1u) * sizeof(uint32_t));
+    memcpy(rFrame.mElementNodes.data(), p_slot + mSlotLayout.mElementNodes, num_element_nodes * sizeof(uint32_t));
+    memcpy(rFrame.mCellLabels.data(), p_slot + mSlotLayout.mCellLabels, num_elements);
+
+    // The copy is only valid if the writer did not start on the slot while it was being made
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return p_frame->mSequence.load(std::memory_order_relaxed) == expected_sequence;
+}
+
+bool SharedMemoryTissueReader::ReadLatestFrame(Frame& rFrame) const
+{
+    for (;;)
+    {
+        const uint64_t num_frames = GetNumFramesPublished();
+        if (num_frames == 0u)
+        {
+            return false;
+        }
+        if (ReadFrame(num_frames - 1u, rFrame))
+        {
+            return true;
+        }
+    }
+}
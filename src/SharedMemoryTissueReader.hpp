@@ -0,0 +1,159 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef SHAREDMEMORYTISSUEREADER_HPP_
+#define SHAREDMEMORYTISSUEREADER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SharedMemoryTissueWriter.hpp"
+
+/**
+ * Reads frames from a shared memory segment published by SharedMemoryTissueWriter, typically from another process.
+ * The segment is mapped read-only. Each frame is copied out of its slot and then checked against the slot's sequence
+ * number, so a frame that the writer overwrote during the copy is reported as unavailable rather than returned torn.
+ */
+class SharedMemoryTissueReader
+{
+public:
+
+    /** A copy of one frame. */
+    struct Frame
+    {
+        /** The frame number, counting from 0. */
+        uint64_t mFrameIndex = 0u;
+
+        /** The simulation time. */
+        double mTime = 0.0;
+
+        /** Node locations, GetSpaceDimension() coordinates per node. */
+        std::vector<double> mNodeLocations;
+
+        /** The volume of each cell. */
+        std::vector<double> mCellVolumes;
+
+        /** The nodes of element e are mElementNodes[mElementOffsets[e]] to mElementNodes[mElementOffsets[e+1]-1]. */
+        std::vector<uint32_t> mElementOffsets;
+
+        /** Node indices of the elements. */
+        std::vector<uint32_t> mElementNodes;
+
+        /** 1 for each cell with a CellLabel, 0 otherwise. */
+        std::vector<uint8_t> mCellLabels;
+
+        /**
+         * @return the number of elements (cells) in the frame
+         */
+        unsigned GetNumElements() const
+        {
+            return mCellVolumes.size();
+        }
+    };
+
+private:
+
+    /** The name of the segment. */
+    std::string mName;
+
+    /** The start of the mapped segment. */
+    const char* mpSegment = nullptr;
+
+    /** The size of the mapped segment in bytes. */
+    uint64_t mSegmentSize = 0u;
+
+    /** The layout of each slot. */
+    SharedMemoryTissueWriter::SlotLayout mSlotLayout;
+
+    /**
+     * @return the segment header
+     */
+    const SharedMemoryTissueWriter::SegmentHeader* GetSegmentHeader() const;
+
+public:
+
+    /**
+     * Constructor. Maps the segment read-only and checks its header.
+     *
+     * @param rName the name of the segment, as given to SharedMemoryTissueWriter
+     */
+    SharedMemoryTissueReader(const std::string& rName);
+
+    /**
+     * Destructor. Unmaps the segment.
+     */
+    ~SharedMemoryTissueReader();
+
+    /**
+     * @return the number of coordinates per node
+     */
+    unsigned GetSpaceDimension() const;
+
+    /**
+     * @return the number of slots in the ring, which is how many of the latest frames can be read
+     */
+    unsigned GetNumSlots() const;
+
+    /**
+     * @return the number of frames published so far
+     */
+    uint64_t GetNumFramesPublished() const;
+
+    /**
+     * @return whether the writer has finished, so no more frames will be published
+     */
+    bool IsFinished() const;
+
+    /**
+     * Copy a frame.
+     *
+     * @param frameIndex the frame number
+     * @param rFrame filled with the frame
+     * @return whether the frame could be read; false if it has not been published yet, or its slot has been (or is
+     *     being) reused for a later frame
+     */
+    bool ReadFrame(uint64_t frameIndex, Frame& rFrame) const;
+
+    /**
+     * Copy the most recently published frame, retrying if the writer overwrites it during the copy.
+     *
+     * @param rFrame filled with the frame
+     * @return whether a frame could be read; false if none has been published yet
+     */
+    bool ReadLatestFrame(Frame& rFrame) const;
+};
+
+#endif /*SHAREDMEMORYTISSUEREADER_HPP_*/
@@ -0,0 +1,218 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "SharedMemoryTissueWriter.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "Exception.hpp"
+
+const char SharedMemoryTissueWriter::SEGMENT_MAGIC[8] = {'C', 'H', 'T', 'I', 'S', 'S', 'H', 'M'};
+
+namespace
+{
+    /** @return the given size rounded up to a whole number of cache lines */
+    uint64_t RoundUpToCacheLine(uint64_t size)
+    {
+        return (size + 63u) & ~uint64_t(63u);
+    }
+}
+
+SharedMemoryTissueWriter::SlotLayout SharedMemoryTissueWriter::CalculateSlotLayout(unsigned spaceDimension,
+                                                                                   unsigned maxNumNodes,
+                                                                                   unsigned maxNumElements,
+                                                                                   unsigned maxNumElementNodes)
+{
+    // Each array starts on a cache line, and the eight-byte arrays come first
+    SlotLayout layout;
+    layout.mNodeLocations = RoundUpToCacheLine(sizeof(FrameHeader));
+    layout.mCellVolumes = layout.mNodeLocations + RoundUpToCacheLine(uint64_t(maxNumNodes) * spaceDimension * sizeof(double));
+    layout.mElementOffsets = layout.mCellVolumes + RoundUpToCacheLine(uint64_t(maxNumElements) * sizeof(double));
+    layout.mElementNodes = layout.mElementOffsets + RoundUpToCacheLine((uint64_t(maxNumElements) + 1u) * sizeof(uint32_t));
+    layout.mCellLabels = layout.mElementNodes + RoundUpToCacheLine(uint64_t(maxNumElementNodes) * sizeof(uint32_t));
+    layout.mSize = layout.mCellLabels + RoundUpToCacheLine(maxNumElements);
+    return layout;
+}
+
+uint64_t SharedMemoryTissueWriter::GetSegmentHeaderSize()
+{
+    return RoundUpToCacheLine(sizeof(SegmentHeader));
+}
+
+SharedMemoryTissueWriter::SharedMemoryTissueWriter(const std::string& rName,
+                                                   unsigned spaceDimension,
+                                                   unsigned numSlots,
+                                                   unsigned maxNumNodes,
+                                                   unsigned maxNumElements,
+                                                   unsigned maxNumElementNodes)
+    : mName(rName),
+      mSlotLayout(CalculateSlotLayout(spaceDimension, maxNumNodes, maxNumElements, maxNumElementNodes))
+{
+    if (numSlots == 0)
+    {
+        EXCEPTION("A shared memory tissue segment needs at least one slot");
+    }
+
+    // A segment left behind by a run that was killed is replaced, rather than reused with a stale layout
+    shm_unlink(mName.c_str());
+    mFileDescriptor = shm_open(mName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (mFileDescriptor < 0)
+    {
+        EXCEPTION("Could not create shared memory segment " + mName + ": " + strerror(errno));
+    }
+
+    mSegmentSize = GetSegmentHeaderSize() + numSlots * mSlotLayout.mSize;
+    if (ftruncate(mFileDescriptor, mSegmentSize) != 0)
+    {
+        const std::string error = strerror(errno);
+        Close();
+        EXCEPTION("Could not size shared memory segment " + mName + ": " + error);
+    }
+
+    void* p_segment = mmap(nullptr, mSegmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, mFileDescriptor, 0);
+    if (p_segment == MAP_FAILED)
+    {
+        const std::string error = strerror(errno);
+        Close();
+        EXCEPTION("Could not map shared memory segment " + mName + ": " + error);
+    }
+    mpSegment = static_cast<char*>(p_segment);
+
+    // The new segment is zero-filled, so every slot starts with sequence number 0: nothing published
+    SegmentHeader* p_header = new (mpSegment) SegmentHeader;
+    memcpy(p_header->mMagic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+    p_header->mSpaceDimension = spaceDimension;
+    p_header->mNumSlots = numSlots;
+    p_header->mMaxNumNodes = maxNumNodes;
+    p_header->mMaxNumElements = maxNumElements;
+    p_header->mMaxNumElementNodes = maxNumElementNodes;
+    p_header->mSlotSize = mSlotLayout.mSize;
+    p_header->mNumFramesPublished.store(0u, std::memory_order_relaxed);
+    p_header->mFinished.store(0u, std::memory_order_relaxed);
+    for (unsigned slot = 0; slot < numSlots; ++slot)
+    {
+        new (mpSegment + GetSegmentHeaderSize() + slot * mSlotLayout.mSize) FrameHeader;
+    }
+    p_header->mVersion.store(FORMAT_VERSION, std::memory_order_release);
+}
+
+SharedMemoryTissueWriter::~SharedMemoryTissueWriter()
+{
+    Close();
+}
+
+SharedMemoryTissueWriter::SegmentHeader* SharedMemoryTissueWriter::GetSegmentHeader()
+{
+    return reinterpret_cast<SegmentHeader*>(mpSegment);
+}
+
+bool SharedMemoryTissueWriter::BeginFrame(double time,
+                                          unsigned numNodes,
+                                          unsigned numElements,
+                                          unsigned numElementNodes,
+                                          FrameBuffers& rBuffers)
+{
+    if (mpSegment == nullptr)
+    {
+        EXCEPTION("Cannot write to a shared memory tissue segment that has been closed");
+    }
+
+    SegmentHeader* p_header = GetSegmentHeader();
+    if (numNodes > p_header->mMaxNumNodes || numElements > p_header->mMaxNumElements
+        || numElementNodes > p_header->mMaxNumElementNodes)
+    {
+        return false;
+    }
+
+    const uint64_t frame = p_header->mNumFramesPublished.load(std::memory_order_relaxed);
+    char* p_slot = mpSegment + GetSegmentHeaderSize() + (frame % p_header->mNumSlots) * mSlotLayout.mSize;
+    mpCurrentFrame = reinterpret_cast<FrameHeader*>(p_slot);
+
+    // Mark the slot as being written before touching its contents
+    mpCurrentFrame->mSequence.store(2u * frame + 1u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    mpCurrentFrame->mTime = time;
+    mpCurrentFrame->mNumNodes = numNodes;
+    mpCurrentFrame->mNumElements = numElements;
+    mpCurrentFrame->mNumElementNodes = numElementNodes;
+
+    rBuffers.mpNodeLocations = reinterpret_cast<double*>(p_slot + mSlotLayout.mNodeLocations);
+    rBuffers.mpCellVolumes = reinterpret_cast<double*>(p_slot + mSlotLayout.mCellVolumes);
+    rBuffers.mpElementOffsets = reinterpret_cast<uint32_t*>(p_slot + mSlotLayout.mElementOffsets);
+    rBuffers.mpElementNodes = reinterpret_cast<uint32_t*>(p_slot + mSlotLayout.mElementNodes);
+    rBuffers.mpCellLabels = reinterpret_cast<uint8_t*>(p_slot + mSlotLayout.mCellLabels);
+    return true;
+}
+
+void SharedMemoryTissueWriter::EndFrame()
+{
+    if (mpCurrentFrame == nullptr)
+    {
+        EXCEPTION("EndFrame() called without a matching call to BeginFrame()");
+    }
+
+    SegmentHeader* p_header = GetSegmentHeader();
+    const uint64_t frame = p_header->mNumFramesPublished.load(std::memory_order_relaxed);
+    mpCurrentFrame->mSequence.store(2u * frame + 2u, std::memory_order_release);
+    p_header->mNumFramesPublished.store(frame + 1u, std::memory_order_release);
+    mpCurrentFrame = nullptr;
+}
+
+void SharedMemoryTissueWriter::Close()
+{
+    if (mpSegment != nullptr)
+    {
+        GetSegmentHeader()->mFinished.store(1u, std::memory_order_release);
+        munmap(mpSegment, mSegmentSize);
+        mpSegment = nullptr;
+        mpCurrentFrame = nullptr;
+    }
+    if (mFileDescriptor >= 0)
+    {
+        close(mFileDescriptor);
+        shm_unlink(mName.c_str());
+        mFileDescriptor = -1;
+    }
+}
+
+uint64_t SharedMemoryTissueWriter::GetNumFramesPublished()
+{
+    return (mpSegment != nullptr) ? GetSegmentHeader()->mNumFramesPublished.load(std::memory_order_relaxed) : 0u;
+}
@@ -0,0 +1,254 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef SHAREDMEMORYTISSUEWRITER_HPP_
+#define SHAREDMEMORYTISSUEWRITER_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * Publishes snapshots of a vertex tissue (node locations, element connectivity, and the volume and label of each
+ * cell) in a POSIX shared memory segment, so that local analysis or visualisation processes can follow a running
+ * simulation without any files being written. The segment is read with SharedMemoryTissueReader.
+ *
+ * The segment holds a SegmentHeader followed by a ring of mNumSlots slots of fixed capacity; frame f is written to
+ * slot f % mNumSlots. Each slot starts with a FrameHeader whose sequence number acts as a seqlock: it is odd while
+ * the slot is being written, and equal to 2(f + 1) once frame f is complete. A reader copies a slot and checks the
+ * sequence number is unchanged, so the writer never waits for readers, and readers only need read access.
+ *
+ * Frames are written in place: BeginFrame() returns pointers into the slot, which the caller fills before calling
+ * EndFrame(). The segment is removed by the destructor; processes that have already mapped it can still read it.
+ */
+class SharedMemoryTissueWriter
+{
+public:
+
+    /** The start of a segment, identifying it as a tissue segment. */
+    static const char SEGMENT_MAGIC[8];
+
+    /** The version of the segment layout. */
+    static const uint32_t FORMAT_VERSION = 1u;
+
+    /** The header at the start of the segment. */
+    struct SegmentHeader
+    {
+        /** SEGMENT_MAGIC. */
+        char mMagic[8];
+
+        /** FORMAT_VERSION, set last when the segment is created, so a reader never sees a partial header. */
+        std::atomic<uint32_t> mVersion;
+
+        /** The number of coordinates per node. */
+        uint32_t mSpaceDimension;
+
+        /** The number of slots in the ring. */
+        uint32_t mNumSlots;
+
+        /** The greatest number of nodes a frame can hold. */
+        uint32_t mMaxNumNodes;
+
+        /** The greatest number of elements a frame can hold. */
+        uint32_t mMaxNumElements;
+
+        /** The greatest total number of nodes over all elements a frame can hold. */
+        uint32_t mMaxNumElementNodes;
+
+        /** The size of each slot in bytes. */
+        uint64_t mSlotSize;
+
+        /** The number of frames published so far. */
+        std::atomic<uint64_t> mNumFramesPublished;
+
+        /** Nonzero once the simulation has finished and no more frames will be published. */
+        std::atomic<uint32_t> mFinished;
+    };
+
+    /** The header at the start of each slot. */
+    struct FrameHeader
+    {
+        /** Odd while the slot is being written; 2(f + 1) once frame f is complete. */
+        std::atomic<uint64_t> mSequence;
+
+        /** The simulation time of the frame. */
+        double mTime;
+
+        /** The number of nodes. */
+        uint32_t mNumNodes;
+
+        /** The number of elements (cells). */
+        uint32_t mNumElements;
+
+        /** The total number of nodes over all elements. */
+        uint32_t mNumElementNodes;
+    };
+
+    /** The offsets in bytes of the arrays within a slot, from the start of the slot. */
+    struct SlotLayout
+    {
+        /** Node locations, mSpaceDimension doubles per node. */
+        uint64_t mNodeLocations;
+
+        /** Cell volumes, one double per element. */
+        uint64_t mCellVolumes;
+
+        /** Offsets into the element node array, one uint32_t per element plus one. */
+        uint64_t mElementOffsets;
+
+        /** Node indices of the elements, one uint32_t per node of each element, anticlockwise. */
+        uint64_t mElementNodes;
+
+        /** Cell labels, one byte per element: 1 if the cell has a CellLabel, 0 otherwise. */
+        uint64_t mCellLabels;
+
+        /** The size of the slot. */
+        uint64_t mSize;
+    };
+
+    /** Pointers to the arrays of the frame being written. */
+    struct FrameBuffers
+    {
+        /** Node locations, to be filled with mSpaceDimension doubles per node. */
+        double* mpNodeLocations;
+
+        /** Cell volumes, to be filled with one double per element. */
+        double* mpCellVolumes;
+
+        /** Offsets, to be filled with the offset of the first node of each element, then the total. */
+        uint32_t* mpElementOffsets;
+
+        /** Node indices of the elements. */
+        uint32_t* mpElementNodes;
+
+        /** Cell labels, one byte per element. */
+        uint8_t* mpCellLabels;
+    };
+
+    /**
+     * @param spaceDimension the number of coordinates per node
+     * @param maxNumNodes the greatest number of nodes a frame can hold
+     * @param maxNumElements the greatest number of elements a frame can hold
+     * @param maxNumElementNodes the greatest total number of nodes over all elements a frame can hold
+     * @return the layout of a slot with these capacities
+     */
+    static SlotLayout CalculateSlotLayout(unsigned spaceDimension,
+                                          unsigned maxNumNodes,
+                                          unsigned maxNumElements,
+                                          unsigned maxNumElementNodes);
+
+    /**
+     * @return the size in bytes of the segment header, including padding
+     */
+    static uint64_t GetSegmentHeaderSize();
+
+private:
+
+    /** The name of the segment. */
+    std::string mName;
+
+    /** File descriptor of the segment, or -1 once closed. */
+    int mFileDescriptor = -1;
+
+    /** The start of the mapped segment. */
+    char* mpSegment = nullptr;
+
+    /** The size of the mapped segment in bytes. */
+    uint64_t mSegmentSize = 0u;
+
+    /** The layout of each slot. */
+    SlotLayout mSlotLayout;
+
+    /** The header of the slot being written, or nullptr if no frame is being written. */
+    FrameHeader* mpCurrentFrame = nullptr;
+
+    /**
+     * @return the segment header
+     */
+    SegmentHeader* GetSegmentHeader();
+
+public:
+
+    /**
+     * Constructor. Creates and maps the segment, replacing any existing segment with the same name.
+     *
+     * @param rName the name of the segment, starting with '/', as for shm_open()
+     * @param spaceDimension the number of coordinates per node
+     * @param numSlots the number of slots in the ring
+     * @param maxNumNodes the greatest number of nodes a frame can hold
+     * @param maxNumElements the greatest number of elements a frame can hold
+     * @param maxNumElementNodes the greatest total number of nodes over all elements a frame can hold
+     */
+    SharedMemoryTissueWriter(const std::string& rName,
+                             unsigned spaceDimension,
+                             unsigned numSlots,
+                             unsigned maxNumNodes,
+                             unsigned maxNumElements,
+                             unsigned maxNumElementNodes);
+
+    /**
+     * Destructor. Calls Close().
+     */
+    ~SharedMemoryTissueWriter();
+
+    /**
+     * Start writing a frame into the next slot.
+     *
+     * @param time the simulation time
+     * @param numNodes the number of nodes
+     * @param numElements the number of elements
+     * @param numElementNodes the total number of nodes over all elements
+     * @param rBuffers filled with pointers to the arrays to be written
+     * @return whether the frame fits; if not, nothing is written and EndFrame() must not be called
+     */
+    bool BeginFrame(double time, unsigned numNodes, unsigned numElements, unsigned numElementNodes, FrameBuffers& rBuffers);
+
+    /**
+     * Publish the frame started by BeginFrame().
+     */
+    void EndFrame();
+
+    /**
+     * Mark the segment as finished, unmap it and remove its name. Does nothing if already closed.
+     */
+    void Close();
+
+    /**
+     * @return the number of frames published
+     */
+    uint64_t GetNumFramesPublished();
+};
+
+#endif /*SHAREDMEMORYTISSUEWRITER_HPP_*/
@@ -34,6 +34,9 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "SillyForce.hpp"
+#include "Cylindrical2dVertexMesh.hpp"
+#include "HardwareCounterProfiler.hpp"
+#include "Toroidal2dVertexMesh.hpp"
 
 template <unsigned DIM>
 SillyForce<DIM>::SillyForce()
@@ -41,6 +44,111 @@ SillyForce<DIM>::SillyForce()
 {
 }
 
+template <unsigned DIM>
+void SillyForce<DIM>::AddForceContributionToNode(AbstractCellPopulation<DIM>& rCellPopulation,
+                                                 const c_vector<double, DIM>& rCentroid,
+                                                 Node<DIM>* pNode)
+{
+    c_vector<double, DIM> vec_from_centroid = rCellPopulation.rGetMesh().GetVectorFromAtoB(rCentroid, pNode->rGetLocation());
+
+    c_vector<double, DIM> force_on_node = zero_vector<double>(DIM);
+    if constexpr (DIM == 2)
+    {
+        force_on_node[0] = -vec_from_centroid[1];
+        force_on_node[1] = vec_from_centroid[0];
+    }
+
+    pNode->AddAppliedForceContribution(force_on_node * mStrengthMultiplier);
+}
+
+template <unsigned DIM>
+void SillyForce<DIM>::GatherSingleLocations(AbstractCellPopulation<DIM>& rCellPopulation)
+{
+    const unsigned num_nodes = rCellPopulation.GetNumNodes();
+    for (unsigned d = 0; d < DIM; ++d)
+    {
+        mSingleLocations[d].resize(num_nodes);
+    }
+
+    for (unsigned node_index = 0; node_index < num_nodes; node_index++)
+    {
+        const c_vector<double, DIM>& r_location = rCellPopulation.GetNode(node_index)->rGetLocation();
+        for (unsigned d = 0; d < DIM; ++d)
+        {
+            mSingleLocations[d][node_index] = static_cast<float>(r_location[d]);
+        }
+    }
+}
+
+template <unsigned DIM>
+c_vector<double, DIM> SillyForce<DIM>::CalculateSingleCentroid(VertexBasedCellPopulation<DIM>& rCellPopulation)
+{
+    c_vector<double, DIM> centroid = zero_vector<double>(DIM);
+    if constexpr (DIM == 2)
+    {
+        MutableVertexMesh<DIM, DIM>& r_mesh = rCellPopulation.rGetMesh();
+        if (dynamic_cast<Cylindrical2dVertexMesh*>(&r_mesh) != nullptr || dynamic_cast<Toroidal2dVertexMesh*>(&r_mesh) != nullptr)
+        {
+            EXCEPTION("The single precision mode of SillyForce does not support periodic meshes");
+        }
+
+        const float* p_x = mSingleLocations[0].data();
+        const float* p_y = mSingleLocations[1].data();
+
+        // As VertexMesh::GetCentroidOfElement(), relative to the first node of each element
+        double sum_x = 0.0;
+        double sum_y = 0.0;
+        unsigned num_elements = 0;
+        for (auto cell_iter = rCellPopulation.Begin(); cell_iter != rCellPopulation.End(); ++cell_iter)
+        {
+            VertexElement<DIM, DIM>* p_element = r_mesh.GetElement(rCellPopulation.GetLocationIndexUsingCell(*cell_iter));
+            const unsigned num_nodes = p_element->GetNumNodes();
+            const unsigned first_index = p_element->GetNodeGlobalIndex(0);
+            const double first_x = p_x[first_index];
+            const double first_y = p_y[first_index];
+
+            double this_x = 0.0;
+            double this_y = 0.0;
+            double moment_x = 0.0;
+            double moment_y = 0.0;
+            double twice_area = 0.0;
+            for (unsigned local_index = 0; local_index < num_nodes; ++local_index)
+            {
+                const unsigned next_index = p_element->GetNodeGlobalIndex((local_index + 1) % num_nodes);
+                const double next_x = p_x[next_index] - first_x;
+                const double next_y = p_y[next_index] - first_y;
+
+                const double signed_area_term = this_x * next_y - this_y * next_x;
+                moment_x += (this_x + next_x) * signed_area_term;
+                moment_y += (this_y + next_y) * signed_area_term;
+                twice_area += signed_area_term;
+
+                this_x = next_x;
+                this_y = next_y;
+            }
+
+            sum_x += first_x + moment_x / (3.0 * twice_area);
+            sum_y += first_y + moment_y / (3.0 * twice_area);
+            ++num_elements;
+        }
+
+        centroid[0] = sum_x / num_elements;
+        centroid[1] = sum_y / num_elements;
+    }
+    return centroid;
+}
+
+template <unsigned DIM>
+c_vector<double, DIM> SillyForce<DIM>::CalculateCentroid(AbstractCellPopulation<DIM>& rCellPopulation)
+{
+    if (DIM == 2 && mUseSinglePrecision)
+    {
+        GatherSingleLocations(rCellPopulation);
+        return CalculateSingleCentroid(static_cast<VertexBasedCellPopulation<DIM>&>(rCellPopulation));
+    }
+    return rCellPopulation.GetCentroidOfCellPopulation();
+}
+
 template <unsigned DIM>
 void SillyForce<DIM>::AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation)
 {
@@ -50,23 +158,57 @@ void SillyForce<DIM>::AddForceContribution(AbstractCellPopulation<DIM>& rCellPop
         EXCEPTION("SillyForce is to be used with a VertexBasedCellPopulation only");
     }
 
-    const c_vector<double, DIM> centroid = rCellPopulation.GetCentroidOfCellPopulation();
+    HardwareCounterProfiler::ScopedPhase phase("SillyForce::AddForceContribution");
+    const c_vector<double, DIM> centroid = CalculateCentroid(rCellPopulation);
+    mLastCentroid = centroid;
+    mHasLastCentroid = true;
+
+    if (DIM == 2 && mUseSinglePrecision)
+    {
+        // One pass over the single precision locations filled by CalculateCentroid(), adding each force as it is found
+        const float centroid_x = static_cast<float>(centroid[0]);
+        const float centroid_y = static_cast<float>(centroid[DIM - 1]);
+        const float strength = static_cast<float>(mStrengthMultiplier);
+        const float* p_x = mSingleLocations[0].data();
+        const float* p_y = mSingleLocations[DIM - 1].data();
+        c_vector<double, DIM> force_on_node;
+        for (unsigned node_index = 0; node_index < rCellPopulation.GetNumNodes(); node_index++)
+        {
+            force_on_node[0] = -(p_y[node_index] - centroid_y) * strength;
+            force_on_node[DIM - 1] = (p_x[node_index] - centroid_x) * strength;
+            rCellPopulation.GetNode(node_index)->AddAppliedForceContribution(force_on_node);
+        }
+        return;
+    }
 
     // Iterate over vertices in the cell population
     for (unsigned node_index = 0; node_index < rCellPopulation.GetNumNodes(); node_index++)
     {
-        Node<DIM>* p_this_node = rCellPopulation.GetNode(node_index);
+        AddForceContributionToNode(rCellPopulation, centroid, rCellPopulation.GetNode(node_index));
+    }
+}
 
-        c_vector<double, DIM> vec_from_centroid = rCellPopulation.rGetMesh().GetVectorFromAtoB(centroid, p_this_node->rGetLocation());
+template <unsigned DIM>
+void SillyForce<DIM>::AddForceContributionToNodes(AbstractCellPopulation<DIM>& rCellPopulation,
+                                                  const std::vector<unsigned>& rNodeIndices,
+                                                  const std::vector<unsigned char>& rNodeMask)
+{
+    // Throw an exception message if not using a VertexBasedCellPopulation
+    if (dynamic_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation) == nullptr)
+    {
+        EXCEPTION("SillyForce is to be used with a VertexBasedCellPopulation only");
+    }
 
-        c_vector<double, DIM> force_on_node = zero_vector<double>(DIM);
-        if constexpr (DIM == 2)
-        {
-            force_on_node[0] = -vec_from_centroid[1];
-            force_on_node[1] = vec_from_centroid[0];
-        }
+    // The centroid depends on every cell, so the one found by the last full evaluation is reused
+    if (!mHasLastCentroid)
+    {
+        mLastCentroid = CalculateCentroid(rCellPopulation);
+        mHasLastCentroid = true;
+    }
 
-        p_this_node->AddAppliedForceContribution(force_on_node * mStrengthMultiplier);
+    for (const unsigned node_index : rNodeIndices)
+    {
+        AddForceContributionToNode(rCellPopulation, mLastCentroid, rCellPopulation.GetNode(node_index));
     }
 }
 
@@ -82,10 +224,23 @@ void SillyForce<DIM>::SetStrengthMultiplier(double strengthMultiplier)
     mStrengthMultiplier = strengthMultiplier;
 }
 
+template <unsigned DIM>
+bool SillyForce<DIM>::GetUseSinglePrecision() const
+{
+    return mUseSinglePrecision;
+}
+
+template <unsigned DIM>
+void SillyForce<DIM>::SetUseSinglePrecision(bool useSinglePrecision)
+{
+    mUseSinglePrecision = useSinglePrecision;
+}
+
 template <unsigned DIM>
 void SillyForce<DIM>::OutputForceParameters(out_stream& rParamsFile)
 {
     *rParamsFile << "\t\t\t<StrengthMultiplier>" << mStrengthMultiplier << "</StrengthMultiplier>\n";
+    *rParamsFile << "\t\t\t<UseSinglePrecision>" << mUseSinglePrecision << "</UseSinglePrecision>\n";
 
     // Call method on direct parent class
     AbstractForce<DIM>::OutputForceParameters(rParamsFile);
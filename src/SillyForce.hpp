@@ -36,22 +36,32 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef SILLYFORCE_HPP_
 #define SILLYFORCE_HPP_
 
+#include <boost/align/aligned_allocator.hpp>
 #include <boost/serialization/base_object.hpp>
 #include "ChasteSerialization.hpp"
+#include "ChasteSerializationVersion.hpp"
 #include "Exception.hpp"
 
 #include "AbstractForce.hpp"
+#include "AbstractNodeSubsetForce.hpp"
 #include "VertexBasedCellPopulation.hpp"
 
 #include <iostream>
+#include <vector>
 
 /**
  * A silly force class for use in Vertex-based simulations. This force causes a spiral around the centroid
  * of the cell population.
+ *
+ * In 2D the force can optionally be computed in mixed precision: the node locations are gathered into single
+ * precision structure-of-arrays buffers, from which the centroid is found with double precision accumulation and
+ * the force on each node is computed in single precision. This mode is a tool for studying whether single precision
+ * is accurate enough, not an optimisation: the locations are copied from the Node objects on every call, which adds
+ * to the memory traffic of the double precision force. Periodic meshes are not supported in this mode.
  */
 
 template <unsigned DIM>
-class SillyForce : public AbstractForce<DIM>
+class SillyForce : public AbstractForce<DIM>, public AbstractNodeSubsetForce<DIM>
 {
     friend class TestForces;
 
@@ -69,6 +79,12 @@ private:
     {
         archive& boost::serialization::base_object<AbstractForce<DIM> >(*this);
         archive & mStrengthMultiplier;
+
+        // Archives written before the mixed precision mode was added do not include it
+        if (version > 0)
+        {
+            archive & mUseSinglePrecision;
+        }
     }
 
 protected:
@@ -77,6 +93,54 @@ protected:
      */
     double mStrengthMultiplier = 1.0;
 
+    /** Whether to compute the force in mixed precision. Defaults to false. */
+    bool mUseSinglePrecision = false;
+
+    /** A contiguous buffer of floats aligned for vector loads and stores. */
+    typedef std::vector<float, boost::alignment::aligned_allocator<float, 64> > AlignedBuffer;
+
+    /** Node locations in single precision, indexed by node index, one buffer per coordinate. */
+    AlignedBuffer mSingleLocations[DIM];
+
+    /** The centroid found by the last call to AddForceContribution(), reused by AddForceContributionToNodes(). */
+    c_vector<double, DIM> mLastCentroid;
+
+    /** Whether mLastCentroid has been set. */
+    bool mHasLastCentroid = false;
+
+    /**
+     * Gather the node locations into mSingleLocations.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void GatherSingleLocations(AbstractCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Compute the centroid of the cell population, the mean of the centroids of its elements, from
+     * mSingleLocations, accumulating in double precision. Only implemented in 2D.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @return the centroid
+     */
+    c_vector<double, DIM> CalculateSingleCentroid(VertexBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * @param rCellPopulation reference to the cell population
+     * @return the centroid of the cell population, computed in mixed precision if mUseSinglePrecision is set
+     */
+    c_vector<double, DIM> CalculateCentroid(AbstractCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Apply the force to a single node.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param rCentroid the centroid of the cell population
+     * @param pNode the node
+     */
+    void AddForceContributionToNode(AbstractCellPopulation<DIM>& rCellPopulation,
+                                    const c_vector<double, DIM>& rCentroid,
+                                    Node<DIM>* pNode);
+
 public:
     /**
      * Constructor.
@@ -98,6 +162,20 @@ public:
      */
     virtual void AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation);
 
+    /**
+     * Overridden AddForceContributionToNodes() method.
+     *
+     * As AddForceContribution(), but for the given nodes only. The centroid of the cell population is the one
+     * found by the last call to AddForceContribution(), so the cost scales with the number of nodes given.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param rNodeIndices the global indices of the nodes to update
+     * @param rNodeMask indexed by global node index: nonzero for the nodes in rNodeIndices
+     */
+    virtual void AddForceContributionToNodes(AbstractCellPopulation<DIM>& rCellPopulation,
+                                             const std::vector<unsigned>& rNodeIndices,
+                                             const std::vector<unsigned char>& rNodeMask);
+
     /**
      * @return mStrengthMultiplier
      */
@@ -110,6 +188,18 @@ public:
      */
     void SetStrengthMultiplier(double strengthMultiplier);
 
+    /**
+     * @return mUseSinglePrecision
+     */
+    bool GetUseSinglePrecision() const;
+
+    /**
+     * Set mUseSinglePrecision. This only has an effect in 2D.
+     *
+     * @param useSinglePrecision whether to compute the force in mixed precision
+     */
+    void SetUseSinglePrecision(bool useSinglePrecision);
+
     /**
      * Overridden OutputForceParameters() method.
      *
@@ -118,6 +208,23 @@ public:
     void OutputForceParameters(out_stream& rParamsFile);
 };
 
+namespace boost
+{
+namespace serialization
+{
+/**
+ * Specify a version number for archives of SillyForce: version 1 added mUseSinglePrecision.
+ */
+template<unsigned DIM>
+struct version<SillyForce<DIM> >
+{
+    ///\cond
+    CHASTE_VERSION_CONTENT(1);
+    ///\endcond
+};
+} // namespace serialization
+} // namespace boost
+
 #include "SerializationExportWrapper.hpp"
 EXPORT_TEMPLATE_CLASS_SAME_DIMS(SillyForce)
 
@@ -34,6 +34,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "SillySimulationModifier.hpp"
+#include "HardwareCounterProfiler.hpp"
 
 template<unsigned DIM>
 SillySimulationModifier<DIM>::SillySimulationModifier()
@@ -46,6 +47,7 @@ void SillySimulationModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<
 {
     if (const double time_now = SimulationTime::Instance()->GetTime(); time_now - mTimeLastSquashed >= 10.0)
     {
+        HardwareCounterProfiler::ScopedPhase phase("SillySimulationModifier::Squash");
         mTimeLastSquashed = time_now;
 
         c_vector<double, DIM> centroid = rCellPopulation.GetCentroidOfCellPopulation();
@@ -34,6 +34,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "SillyVertexBasedDivisionRule.hpp"
+#include "HardwareCounterProfiler.hpp"
 #include "MathsCustomFunctions.hpp"
 
 template <unsigned DIM>
@@ -59,6 +60,7 @@ c_vector<double, SPACE_DIM> SillyVertexBasedDivisionRule<SPACE_DIM>::CalculateCe
     CellPtr pParentCell,
     VertexBasedCellPopulation<SPACE_DIM>& rCellPopulation)
 {
+    HardwareCounterProfiler::ScopedPhase phase("SillyVertexBasedDivisionRule::CalculateCellDivisionVector");
     const double theta = 2.0 * M_PI * SimulationTime::Instance()->GetTime() / mPeriod;
 
     c_vector<double, SPACE_DIM> vector;
@@ -0,0 +1,207 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "ThreadedLoop.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+
+#include "HardwareCounterProfiler.hpp"
+
+namespace
+{
+
+/**
+ * Worker threads that wait between calls to ThreadedLoop::Run(). Worker w runs chunk w + 1 of each call that has
+ * more than w + 1 chunks, and sleeps through the others.
+ */
+class WorkerPool
+{
+private:
+
+    /** Guards the members below. */
+    std::mutex mMutex;
+
+    /** Notified when a call is posted. */
+    std::condition_variable mCallPosted;
+
+    /** Notified when the last worker taking part in a call has finished its chunk. */
+    std::condition_variable mCallFinished;
+
+    /** The worker threads, which run until the process exits. */
+    std::vector<std::thread> mWorkers;
+
+    /** The function to call for each chunk of the current call. */
+    const std::function<void(unsigned)>* mpChunk = nullptr;
+
+    /** The number of chunks in the current call. */
+    unsigned mNumChunks = 0u;
+
+    /** The number of workers yet to finish their chunk of the current call. */
+    unsigned mNumWorkersRunning = 0u;
+
+    /** Incremented by each call, so that the workers can tell a new call from a spurious wake up. */
+    unsigned long mCallIndex = 0u;
+
+    /**
+     * The loop run by each worker thread.
+     *
+     * @param worker the index of the worker
+     */
+    void Work(unsigned worker)
+    {
+        unsigned long last_call_index = 0u;
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (true)
+        {
+            mCallPosted.wait(lock, [&]() { return mCallIndex != last_call_index; });
+            last_call_index = mCallIndex;
+            if (worker + 1u < mNumChunks)
+            {
+                const std::function<void(unsigned)>* p_chunk = mpChunk;
+                lock.unlock();
+                (*p_chunk)(worker + 1u);
+                lock.lock();
+                if (--mNumWorkersRunning == 0u)
+                {
+                    mCallFinished.notify_one();
+                }
+            }
+        }
+    }
+
+public:
+
+    /** The process that started the worker threads; a process forked from it has none of them. */
+    const pid_t mProcessId = getpid();
+
+    /**
+     * Call rChunk for each chunk, as ThreadedLoop::RunChunks() does, starting more workers if needed.
+     *
+     * @param numChunks the number of chunks
+     * @param rChunk the function to call for each chunk
+     */
+    void Run(unsigned numChunks, const std::function<void(unsigned)>& rChunk)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            while (mWorkers.size() + 1u < numChunks)
+            {
+                // A new worker first takes the lock after the call below is posted, so takes part in it
+                mWorkers.emplace_back(&WorkerPool::Work, this, static_cast<unsigned>(mWorkers.size()));
+            }
+            mpChunk = &rChunk;
+            mNumChunks = numChunks;
+            mNumWorkersRunning = numChunks - 1u;
+            ++mCallIndex;
+        }
+        mCallPosted.notify_all();
+
+        rChunk(0u);
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCallFinished.wait(lock, [&]() { return mNumWorkersRunning == 0u; });
+    }
+};
+
+/**
+ * The pool, which is never destroyed, as its workers never exit. It is replaced, not destroyed, in a forked process,
+ * where its threads do not exist.
+ */
+WorkerPool* gpWorkerPool = nullptr;
+
+/** Whether a call is using the pool. */
+std::atomic<bool> gWorkerPoolBusy(false);
+
+} // namespace
+
+unsigned ThreadedLoop::msNumThreads = 0u;
+
+unsigned ThreadedLoop::GetNumThreads()
+{
+    if (msNumThreads > 0u)
+    {
+        return msNumThreads;
+    }
+
+    if (const char* p_value = std::getenv("CHASTE_NUM_THREADS"))
+    {
+        const int num_threads = std::atoi(p_value);
+        if (num_threads > 0)
+        {
+            return num_threads;
+        }
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void ThreadedLoop::SetNumThreads(unsigned numThreads)
+{
+    msNumThreads = numThreads;
+}
+
+void ThreadedLoop::RunChunks(unsigned numChunks, const std::function<void(unsigned)>& rChunk)
+{
+    // The hardware counters of the profiled phases will miss the work of the other threads
+    HardwareCounterProfiler::NoteWorkerThreads();
+
+    if (!gWorkerPoolBusy.exchange(true))
+    {
+        if (gpWorkerPool == nullptr || gpWorkerPool->mProcessId != getpid())
+        {
+            gpWorkerPool = new WorkerPool;
+        }
+        gpWorkerPool->Run(numChunks, rChunk);
+        gWorkerPoolBusy = false;
+        return;
+    }
+
+    // The pool is busy with the call this one is nested in, or with a call from another thread
+    std::vector<std::thread> workers;
+    workers.reserve(numChunks - 1u);
+    for (unsigned chunk = 1u; chunk < numChunks; ++chunk)
+    {
+        workers.emplace_back(rChunk, chunk);
+    }
+    rChunk(0u);
+    for (auto& r_worker : workers)
+    {
+        r_worker.join();
+    }
+}
@@ -0,0 +1,138 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef THREADEDLOOP_HPP_
+#define THREADEDLOOP_HPP_
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <vector>
+
+/**
+ * A minimal parallel-for, used by the project classes that do embarrassingly parallel work (encoding output, updating
+ * independent per-cell quantities) on worker threads alongside the serial simulation loop.
+ *
+ * The number of threads defaults to std::thread::hardware_concurrency(), and can be overridden either with
+ * SetNumThreads() or with the environment variable CHASTE_NUM_THREADS.
+ *
+ * Run() is called many times per time step (once per colour by ParallelElementForceScatter), so the worker threads
+ * are kept waiting in a pool between calls rather than created and joined each time. A call made while the pool is
+ * busy, from inside another call or from another thread, starts its own threads instead. A process forked from one
+ * that has a pool, as by WarmStartForker, starts a new pool of its own.
+ */
+class ThreadedLoop
+{
+private:
+
+    /** The number of threads set by SetNumThreads(), or 0 if unset. */
+    static unsigned msNumThreads;
+
+    /**
+     * Call rChunk(chunk) for each chunk in [0, numChunks), on the calling thread for chunk 0 and on the pool of
+     * worker threads for the others, and return once all the calls have returned.
+     *
+     * @param numChunks the number of chunks
+     * @param rChunk the function to call for each chunk, which must not throw
+     */
+    static void RunChunks(unsigned numChunks, const std::function<void(unsigned)>& rChunk);
+
+public:
+
+    /**
+     * @return the number of threads used by Run()
+     */
+    static unsigned GetNumThreads();
+
+    /**
+     * Set the number of threads used by Run().
+     *
+     * @param numThreads the number of threads, or 0 to restore the default
+     */
+    static void SetNumThreads(unsigned numThreads);
+
+    /**
+     * Split the range [0, numItems) into one contiguous chunk per thread, and call
+     *
+     *     function(begin, end, threadIndex)
+     *
+     * for each chunk. The calling thread processes the first chunk. If any call throws, the first exception is
+     * rethrown once all threads have finished.
+     *
+     * @param numItems the number of items
+     * @param function the function to call for each chunk
+     * @param minItemsPerThread fewer threads are used if they would each get fewer items than this
+     */
+    template<typename FUNCTION>
+    static void Run(unsigned numItems, FUNCTION function, unsigned minItemsPerThread = 1u)
+    {
+        const unsigned num_threads = std::max(1u, std::min(GetNumThreads(), numItems / std::max(1u, minItemsPerThread)));
+        if (num_threads == 1u)
+        {
+            if (numItems > 0u)
+            {
+                function(0u, numItems, 0u);
+            }
+            return;
+        }
+
+        std::vector<std::exception_ptr> exceptions(num_threads);
+        auto run_chunk = [&](unsigned thread)
+        {
+            try
+            {
+                function((numItems * static_cast<unsigned long>(thread)) / num_threads,
+                         (numItems * static_cast<unsigned long>(thread + 1)) / num_threads,
+                         thread);
+            }
+            catch (...)
+            {
+                exceptions[thread] = std::current_exception();
+            }
+        };
+
+        RunChunks(num_threads, run_chunk);
+
+        for (const auto& r_exception : exceptions)
+        {
+            if (r_exception)
+            {
+                std::rethrow_exception(r_exception);
+            }
+        }
+    }
+};
+
+#endif /*THREADEDLOOP_HPP_*/
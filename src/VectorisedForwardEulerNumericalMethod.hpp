@@ -0,0 +1,221 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef VECTORISEDFORWARDEULERNUMERICALMETHOD_HPP_
+#define VECTORISEDFORWARDEULERNUMERICALMETHOD_HPP_
+
+#include <boost/align/aligned_allocator.hpp>
+#include <boost/serialization/base_object.hpp>
+#include "ChasteSerialization.hpp"
+#include "ChasteSerializationVersion.hpp"
+
+#include "AbstractNumericalMethod.hpp"
+
+#include <vector>
+
+/**
+ * A forward Euler numerical method that keeps node positions and applied forces in structure-of-arrays buffers.
+ *
+ * After the forces have been summed, the positions and (damped) forces are gathered into one contiguous, 64-byte
+ * aligned array per coordinate, and the position update is performed as a single sweep over those arrays that the
+ * compiler can vectorise. The new positions are then written back to the Node objects, which all Chaste forces and
+ * topology operations read from. The buffers are kept between time steps, so no memory is allocated once the number
+ * of nodes has settled.
+ *
+ * The result is identical, bit for bit, to that of ForwardEulerNumericalMethod.
+ *
+ * Optionally, the buffers can be kept in single precision. The forces are still computed, and the node locations
+ * still stored, in double precision, but each new location is rounded to single precision. This mode is a tool for
+ * studying accuracy, not an optimisation: as Chaste forces read the locations from the Node objects, the buffers
+ * are still gathered from and scattered back to them on every step, so the smaller buffers do not reduce the memory
+ * traffic of a step. It shows whether positions accurate to about one part in 10^7 are sufficient for a run;
+ * TestMixedPrecisionAccuracyReport in TestProjectBenchmarks compares the end states of the two modes.
+ */
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM=ELEMENT_DIM>
+class VectorisedForwardEulerNumericalMethod : public AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM>
+{
+protected:
+
+    /**
+     * Structure-of-arrays buffers, each contiguous and aligned for vector loads and stores.
+     */
+    template<typename REAL>
+    struct NodeBuffers
+    {
+        /** A contiguous buffer aligned for vector loads and stores. */
+        typedef std::vector<REAL, boost::alignment::aligned_allocator<REAL, 64> > AlignedBuffer;
+
+        /** Node positions, one buffer per coordinate. */
+        AlignedBuffer mPositions[SPACE_DIM];
+
+        /** Applied forces divided by the damping constant, one buffer per coordinate. */
+        AlignedBuffer mForces[SPACE_DIM];
+
+        /** Displacements over the current time step, one buffer per coordinate. */
+        AlignedBuffer mDisplacements[SPACE_DIM];
+    };
+
+    /** Whether to use mSingleBuffers rather than mDoubleBuffers. */
+    bool mUseSinglePrecision = false;
+
+    /** Global indices of the nodes, in the order in which they are stored in the buffers. */
+    std::vector<unsigned> mNodeIndices;
+
+    /** Double precision buffers, used by default. */
+    NodeBuffers<double> mDoubleBuffers;
+
+    /** Single precision buffers, used if mUseSinglePrecision is set. */
+    NodeBuffers<float> mSingleBuffers;
+
+    /**
+     * Gather the current node locations and the given damped forces into the buffers.
+     *
+     * @param rForces the damped forces, in node iterator order, as returned by ComputeForcesIncludingDamping()
+     * @param rBuffers the buffers to fill
+     */
+    template<typename REAL>
+    void GatherNodeData(const std::vector<c_vector<double, SPACE_DIM> >& rForces, NodeBuffers<REAL>& rBuffers);
+
+    /**
+     * Pass every node whose displacement may be too large to DetectStepSizeExceptions(), which may scale the
+     * displacement down or throw a StepSizeException.
+     *
+     * @param dt the time step
+     * @param rBuffers the buffers holding the displacements
+     */
+    template<typename REAL>
+    void CheckDisplacements(double dt, NodeBuffers<REAL>& rBuffers);
+
+    /**
+     * Write the positions held in the buffers back to the nodes.
+     *
+     * @param rBuffers the buffers holding the new positions
+     */
+    template<typename REAL>
+    void ScatterNodeLocations(const NodeBuffers<REAL>& rBuffers);
+
+    /**
+     * Gather, update and scatter the node positions using the given buffers.
+     *
+     * @param dt the time step
+     * @param rBuffers the buffers to use
+     */
+    template<typename REAL>
+    void UpdateNodePositionsInBuffers(double dt, NodeBuffers<REAL>& rBuffers);
+
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM> >(*this);
+
+        // Archives written before the single precision mode was added do not include it
+        if (version > 0)
+        {
+            archive & mUseSinglePrecision;
+        }
+    }
+
+public:
+
+    /**
+     * Constructor.
+     */
+    VectorisedForwardEulerNumericalMethod();
+
+    /**
+     * Destructor.
+     */
+    virtual ~VectorisedForwardEulerNumericalMethod() = default;
+
+    /**
+     * @return mUseSinglePrecision
+     */
+    bool GetUseSinglePrecision() const;
+
+    /**
+     * Set mUseSinglePrecision.
+     *
+     * @param useSinglePrecision whether to keep the position and force buffers in single precision
+     */
+    void SetUseSinglePrecision(bool useSinglePrecision);
+
+    /**
+     * Overridden UpdateAllNodePositions() method.
+     *
+     * @param dt Time step size
+     */
+    virtual void UpdateAllNodePositions(double dt);
+
+    /**
+     * Overridden OutputNumericalMethodParameters() method.
+     *
+     * @param rParamsFile Reference to the parameter output filestream
+     */
+    virtual void OutputNumericalMethodParameters(out_stream& rParamsFile);
+};
+
+namespace boost
+{
+namespace serialization
+{
+/**
+ * Specify a version number for archives of VectorisedForwardEulerNumericalMethod: version 1 added
+ * mUseSinglePrecision.
+ */
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+struct version<VectorisedForwardEulerNumericalMethod<ELEMENT_DIM, SPACE_DIM> >
+{
+    ///\cond
+    CHASTE_VERSION_CONTENT(1);
+    ///\endcond
+};
+} // namespace serialization
+} // namespace boost
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(VectorisedForwardEulerNumericalMethod)
+
+#endif /*VECTORISEDFORWARDEULERNUMERICALMETHOD_HPP_*/
@@ -0,0 +1,202 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "WarmStartForker.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+#include "CounterBasedRandomNumberGenerator.hpp"
+#include "Exception.hpp"
+#include "PetscTools.hpp"
+#include "RandomNumberGenerator.hpp"
+
+namespace
+{
+    /**
+     * Wait until at least one of the given child processes has finished, then record the exit status of each that
+     * has, and stop tracking it. Only these processes are waited for, so any other children of this process are left
+     * alone.
+     *
+     * @param rRunningVariants the process ID of each running variant, mapped to the index of the variant
+     * @param rExitStatuses the exit status of each variant, to be filled in
+     */
+    void ReapVariants(std::map<pid_t, unsigned>& rRunningVariants, std::vector<int>& rExitStatuses)
+    {
+        while (!rRunningVariants.empty())
+        {
+            bool any_finished = false;
+            for (auto iter = rRunningVariants.begin(); iter != rRunningVariants.end();)
+            {
+                int status;
+                const pid_t pid = waitpid(iter->first, &status, WNOHANG);
+                if (pid == 0 || (pid < 0 && errno == EINTR))
+                {
+                    ++iter;
+                    continue;
+                }
+
+                // If the process cannot be waited for, its status has been collected elsewhere and is left at -1
+                if (pid > 0)
+                {
+                    rExitStatuses[iter->second] = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+                }
+                iter = rRunningVariants.erase(iter);
+                any_finished = true;
+            }
+
+            if (any_finished)
+            {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+}
+
+WarmStartForker::WarmStartForker(unsigned maxConcurrentVariants)
+    : mMaxConcurrentVariants(maxConcurrentVariants)
+{
+}
+
+void WarmStartForker::AddVariant(const std::string& rName, unsigned seed, std::function<void()> continuation)
+{
+    mVariants.push_back({rName, seed, continuation});
+}
+
+unsigned WarmStartForker::GetNumVariants() const
+{
+    return mVariants.size();
+}
+
+const std::string& WarmStartForker::rGetVariantName(unsigned variantIndex) const
+{
+    return mVariants.at(variantIndex).mName;
+}
+
+unsigned WarmStartForker::GetMaxConcurrentVariants() const
+{
+    return mMaxConcurrentVariants;
+}
+
+void WarmStartForker::SetMaxConcurrentVariants(unsigned maxConcurrentVariants)
+{
+    mMaxConcurrentVariants = maxConcurrentVariants;
+}
+
+void WarmStartForker::RunVariantInChild(unsigned variantIndex)
+{
+    const Variant& r_variant = mVariants[variantIndex];
+    int exit_status = 0;
+    try
+    {
+        RandomNumberGenerator::Instance()->Reseed(r_variant.mSeed);
+        CounterBasedRandomNumberGenerator::Instance()->Reseed(r_variant.mSeed);
+        r_variant.mContinuation();
+    }
+    catch (const Exception& e)
+    {
+        std::cerr << "Variant " << r_variant.mName << " failed: " << e.GetMessage() << std::endl;
+        exit_status = 1;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Variant " << r_variant.mName << " failed: " << e.what() << std::endl;
+        exit_status = 1;
+    }
+    catch (...)
+    {
+        // Nothing may unwind out of the child, or it would go on to run the parent's loop over the variants
+        std::cerr << "Variant " << r_variant.mName << " failed with an unknown exception" << std::endl;
+        exit_status = 1;
+    }
+
+    // Skip the exit handlers and destructors, which belong to the parent
+    std::cout.flush();
+    std::cerr.flush();
+    fflush(nullptr);
+    _exit(exit_status);
+}
+
+std::vector<int> WarmStartForker::RunVariants()
+{
+    if (!PetscTools::IsSequential())
+    {
+        EXCEPTION("WarmStartForker can only be used when running on one process");
+    }
+    if (mMaxConcurrentVariants == 0u)
+    {
+        EXCEPTION("The maximum number of concurrent variants must be positive");
+    }
+
+    std::vector<int> exit_statuses(mVariants.size(), -1);
+    std::map<pid_t, unsigned> running_variants;
+    unsigned next_variant = 0;
+    while (next_variant < mVariants.size() || !running_variants.empty())
+    {
+        while (next_variant < mVariants.size() && running_variants.size() < mMaxConcurrentVariants)
+        {
+            // Otherwise anything still buffered would be written by the child as well
+            std::cout.flush();
+            std::cerr.flush();
+            fflush(nullptr);
+
+            const pid_t pid = fork();
+            if (pid < 0)
+            {
+                // Wait for the variants already started, so that none is left running unwatched
+                while (!running_variants.empty())
+                {
+                    ReapVariants(running_variants, exit_statuses);
+                }
+                EXCEPTION("Could not create a process for variant " << mVariants[next_variant].mName);
+            }
+            if (pid == 0)
+            {
+                RunVariantInChild(next_variant);
+            }
+            running_variants[pid] = next_variant++;
+        }
+
+        ReapVariants(running_variants, exit_statuses);
+    }
+    return exit_statuses;
+}
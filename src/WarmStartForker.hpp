@@ -0,0 +1,144 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef WARMSTARTFORKER_HPP_
+#define WARMSTARTFORKER_HPP_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Runs several variants of an experiment from one shared, expensively prepared state, such as a tissue that has
+ * been relaxed to equilibrium, without repeating the preparation for each variant.
+ *
+ * Each variant is a function, typically capturing the simulation by reference, that applies the variant's
+ * modifications (adding forces or modifiers, changing parameters, setting a new output directory) and continues the
+ * simulation with a later end time. RunVariants() runs each one in a child process created with fork(), which starts
+ * with a copy-on-write copy of the memory of the parent, so the shared state is not copied until a variant changes
+ * it, and no variant sees the changes made by another. Before running its function, each child reseeds
+ * RandomNumberGenerator and CounterBasedRandomNumberGenerator with the variant's seed.
+ *
+ * This is only supported when running on one process. A child process has only the thread that called
+ * RunVariants(), so no other thread should be doing work or holding a lock when it is called. The idle worker threads
+ * that ThreadedLoop keeps between calls are safe: a child starts a pool of its own on its first parallel loop. So
+ * RunVariants() may be called after parallel work such as FastVoronoiVertexMeshGenerator, but not from inside
+ * ThreadedLoop::Run(), nor while a thread such as the server of a LiveMetricsModifier is running, since that
+ * thread would be missing in the variants.
+ */
+class WarmStartForker
+{
+private:
+
+    /** A variant of the experiment. */
+    struct Variant
+    {
+        /** The name of the variant, used in messages. */
+        std::string mName;
+
+        /** The random seed of the variant. */
+        unsigned mSeed;
+
+        /** The function that runs the variant. */
+        std::function<void()> mContinuation;
+    };
+
+    /** The variants, in the order they were added. */
+    std::vector<Variant> mVariants;
+
+    /** The greatest number of variants to run at once. */
+    unsigned mMaxConcurrentVariants;
+
+    /**
+     * Run a variant in a child process, and end the process.
+     *
+     * @param variantIndex the index of the variant
+     */
+    [[noreturn]] void RunVariantInChild(unsigned variantIndex);
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param maxConcurrentVariants the greatest number of variants to run at once (defaults to 1)
+     */
+    WarmStartForker(unsigned maxConcurrentVariants = 1u);
+
+    /**
+     * Add a variant.
+     *
+     * @param rName the name of the variant
+     * @param seed the random seed of the variant
+     * @param continuation the function that runs the variant in the child process
+     */
+    void AddVariant(const std::string& rName, unsigned seed, std::function<void()> continuation);
+
+    /**
+     * @return the number of variants
+     */
+    unsigned GetNumVariants() const;
+
+    /**
+     * @param variantIndex the index of a variant
+     * @return the name of the variant
+     */
+    const std::string& rGetVariantName(unsigned variantIndex) const;
+
+    /**
+     * @return mMaxConcurrentVariants
+     */
+    unsigned GetMaxConcurrentVariants() const;
+
+    /**
+     * Set mMaxConcurrentVariants.
+     *
+     * @param maxConcurrentVariants the new value of mMaxConcurrentVariants
+     */
+    void SetMaxConcurrentVariants(unsigned maxConcurrentVariants);
+
+    /**
+     * Run every variant in its own child process, and wait for them all to finish. The state of this process is not
+     * changed. Only the processes started here are waited for, and if a process cannot be started, those already
+     * running are waited for before an exception is thrown.
+     *
+     * @return the exit status of each variant: 0 if it succeeded, 1 if it threw an exception, 128 plus the signal
+     *     number if it was killed by a signal, or -1 if its status was collected by something else (for example
+     *     because SIGCHLD is ignored)
+     */
+    std::vector<int> RunVariants();
+};
+
+#endif /*WARMSTARTFORKER_HPP_*/
@@ -0,0 +1,267 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef CUSTOMVERTEXSCENARIO_HPP_
+#define CUSTOMVERTEXSCENARIO_HPP_
+
+#include <string>
+
+#include "Exception.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "SmartPointers.hpp"
+#include "VoronoiVertexMeshGenerator.hpp"
+
+#include "CellLabel.hpp"
+#include "CellLabelWriter.hpp"
+#include "CellVolumesWriter.hpp"
+#include "CellsGenerator.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "HeterotypicBoundaryLengthWriter.hpp"
+#include "LabelDependentBernoulliTrialCellCycleModel.hpp"
+#include "NoCellCycleModel.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "VonMisesVertexBasedDivisionRule.hpp"
+
+#include "FarhadifarForce.hpp"
+#include "NagaiHondaDifferentialAdhesionForce.hpp"
+#include "OffLatticeSimulation.hpp"
+
+#include "SillyForce.hpp"
+#include "SillySimulationModifier.hpp"
+#include "SillyVertexBasedDivisionRule.hpp"
+
+/**
+ * Sets up one of the six scenarios of TestCustomVertexSimulations (Test01Relaxation to
+ * Test06CustomSimulationModifier), with the same mesh, cells, writers, forces, division rules, modifiers, time step,
+ * sampling timestep multiple and end time, so that benchmarks can run them with other numerical methods or options.
+ * It lives next to the tutorial, which keeps its step-by-step set-ups, and must be changed with it.
+ *
+ * The random number generator is reseeded as in the test, but SimulationTime must already have been set up, as
+ * AbstractCellBasedTestSuite does.
+ */
+class CustomVertexScenario
+{
+private:
+
+    /** The end time of the simulation. */
+    double mEndTime;
+
+    /** The mesh. */
+    boost::shared_ptr<MutableVertexMesh<2, 2> > mpMesh;
+
+    /** The cell population. */
+    boost::shared_ptr<VertexBasedCellPopulation<2> > mpCellPopulation;
+
+    /** The simulation, which refers to the cell population so is destroyed first. */
+    boost::shared_ptr<OffLatticeSimulation<2> > mpSimulation;
+
+    /** The SillyForce of scenario 5, or an empty pointer in the other scenarios. */
+    boost::shared_ptr<SillyForce<2> > mpSillyForce;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param scenario the number of the scenario, from 1 to 6
+     * @param rOutputDirectory the output directory of the simulation
+     */
+    CustomVertexScenario(unsigned scenario, const std::string& rOutputDirectory)
+    {
+        if (scenario < 1 || scenario > 6)
+        {
+            EXCEPTION("The scenario must be between 1 and 6");
+        }
+
+        const bool is_large = (scenario == 3 || scenario == 5 || scenario == 6);
+        const bool is_proliferative = (scenario == 2 || scenario == 4);
+        const bool is_labelled = (scenario == 3 || scenario == 6);
+
+        RandomNumberGenerator::Instance()->Reseed(scenario == 6 ? 2 : 1);
+        VoronoiVertexMeshGenerator generator(is_large ? 9 : 6, is_large ? 9 : 6, scenario == 5 ? 2 : 1);
+        mpMesh = generator.GetMesh();
+        if (scenario != 2)
+        {
+            mpMesh->SetDistanceForT3SwapChecking(1.0);
+        }
+
+        std::vector<CellPtr> cells;
+        if (is_proliferative)
+        {
+            MAKE_PTR(TransitCellProliferativeType, p_cell_type);
+            CellsGenerator<LabelDependentBernoulliTrialCellCycleModel, 2> cells_generator;
+            cells_generator.GenerateBasicRandom(cells, mpMesh->GetNumElements(), p_cell_type);
+            if (scenario == 4)
+            {
+                for (auto& p_cell : cells)
+                {
+                    dynamic_cast<LabelDependentBernoulliTrialCellCycleModel*>(p_cell->GetCellCycleModel())->SetDivisionProbability(0.05);
+                }
+            }
+        }
+        else
+        {
+            MAKE_PTR(DifferentiatedCellProliferativeType, p_cell_type);
+            CellsGenerator<NoCellCycleModel, 2> cells_generator;
+            cells_generator.GenerateBasicRandom(cells, mpMesh->GetNumElements(), p_cell_type);
+        }
+
+        // The labels are drawn from the global generator, in the same order as in TestCustomVertexSimulations
+        if (is_labelled)
+        {
+            MAKE_PTR(CellLabel, p_cell_label);
+            for (auto& p_cell : cells)
+            {
+                if (RandomNumberGenerator::Instance()->ranf() < 0.5)
+                {
+                    p_cell->AddCellProperty(p_cell_label);
+                }
+            }
+        }
+
+        mpCellPopulation.reset(new VertexBasedCellPopulation<2>(*mpMesh, cells));
+        mpCellPopulation->AddCellWriter<CellVolumesWriter>();
+        if (is_labelled)
+        {
+            mpCellPopulation->AddCellWriter<CellLabelWriter>();
+            mpCellPopulation->AddPopulationWriter<HeterotypicBoundaryLengthWriter>();
+        }
+
+        if (scenario == 2)
+        {
+            MAKE_PTR(VonMisesVertexBasedDivisionRule<2>, p_division_rule);
+            p_division_rule->SetMeanParameter(1.57);
+            p_division_rule->SetConcentrationParameter(1.0);
+            mpCellPopulation->SetVertexBasedDivisionRule(p_division_rule);
+        }
+        else if (scenario == 4)
+        {
+            MAKE_PTR(SillyVertexBasedDivisionRule<2>, p_division_rule);
+            p_division_rule->SetPeriod(100.0);
+            mpCellPopulation->SetVertexBasedDivisionRule(p_division_rule);
+        }
+
+        const double end_times[6] = {100.0, 50.0, 20.0, 50.0, 100.0, 49.9};
+        const unsigned sampling_timestep_multiples[6] = {10u, 25u, 10u, 25u, 50u, 50u};
+        mEndTime = end_times[scenario - 1];
+
+        mpSimulation.reset(new OffLatticeSimulation<2>(*mpCellPopulation));
+        mpSimulation->SetOutputDirectory(rOutputDirectory);
+        mpSimulation->SetEndTime(mEndTime);
+        mpSimulation->SetDt(0.01);
+        mpSimulation->SetSamplingTimestepMultiple(sampling_timestep_multiples[scenario - 1]);
+
+        if (is_labelled)
+        {
+            MAKE_PTR(NagaiHondaDifferentialAdhesionForce<2>, p_force);
+            p_force->SetNagaiHondaDeformationEnergyParameter(55.0);
+            p_force->SetNagaiHondaMembraneSurfaceEnergyParameter(0.0);
+            p_force->SetNagaiHondaCellCellAdhesionEnergyParameter(1.0);
+            p_force->SetNagaiHondaLabelledCellCellAdhesionEnergyParameter(6.0);
+            p_force->SetNagaiHondaLabelledCellLabelledCellAdhesionEnergyParameter(3.0);
+            p_force->SetNagaiHondaCellBoundaryAdhesionEnergyParameter(12.0);
+            p_force->SetNagaiHondaLabelledCellBoundaryAdhesionEnergyParameter(40.0);
+            mpSimulation->AddForce(p_force);
+        }
+        else
+        {
+            MAKE_PTR(FarhadifarForce<2>, p_force);
+            if (scenario == 1)
+            {
+                p_force->SetAreaElasticityParameter(1.0);
+                p_force->SetPerimeterContractilityParameter(0.04);
+                p_force->SetLineTensionParameter(0.12);
+                p_force->SetBoundaryLineTensionParameter(0.12);
+            }
+            mpSimulation->AddForce(p_force);
+        }
+
+        if (scenario == 5)
+        {
+            mpSillyForce.reset(new SillyForce<2>());
+            mpSillyForce->SetStrengthMultiplier(0.15);
+            mpSimulation->AddForce(mpSillyForce);
+        }
+
+        if (scenario == 6)
+        {
+            MAKE_PTR(SillySimulationModifier<2>, p_sim_modifier);
+            mpSimulation->AddSimulationModifier(p_sim_modifier);
+        }
+    }
+
+    /**
+     * @return the end time of the simulation
+     */
+    double GetEndTime() const
+    {
+        return mEndTime;
+    }
+
+    /**
+     * @return the mesh
+     */
+    MutableVertexMesh<2, 2>& rGetMesh()
+    {
+        return *mpMesh;
+    }
+
+    /**
+     * @return the cell population
+     */
+    VertexBasedCellPopulation<2>& rGetCellPopulation()
+    {
+        return *mpCellPopulation;
+    }
+
+    /**
+     * @return the simulation, ready to be solved
+     */
+    OffLatticeSimulation<2>& rGetSimulation()
+    {
+        return *mpSimulation;
+    }
+
+    /**
+     * @return the SillyForce of scenario 5, or an empty pointer in the other scenarios
+     */
+    boost::shared_ptr<SillyForce<2> > GetSillyForce()
+    {
+        return mpSillyForce;
+    }
+};
+
+#endif /*CUSTOMVERTEXSCENARIO_HPP_*/
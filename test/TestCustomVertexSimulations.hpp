@@ -77,6 +77,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // Finally, we include a header that enforces running this test only on one process
 #include "FakePetscSetup.hpp"
 
+// The benchmarks repeat these six set-ups in CustomVertexScenario.hpp, which must be changed along with them
 class TestCustomVertexSimulations : public AbstractCellBasedTestSuite
 {
 public:
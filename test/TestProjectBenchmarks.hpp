@@ -0,0 +1,568 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTPROJECTBENCHMARKS_HPP_
+#define TESTPROJECTBENCHMARKS_HPP_
+
+// These first headers relate to the Chaste infrastructure and can be found at the top of every test suite
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "CheckpointArchiveTypes.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "RandomNumberGenerator.hpp"
+#include "SmartPointers.hpp"
+
+#include "VoronoiVertexMeshGenerator.hpp"
+
+#include "CellId.hpp"
+#include "CellLabel.hpp"
+#include "CellsGenerator.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "NoCellCycleModel.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+#include "FarhadifarForce.hpp"
+#include "ForwardEulerNumericalMethod.hpp"
+#include "OffLatticeSimulation.hpp"
+
+// Custom headers from this user project
+#include "CounterBasedBernoulliTrialCellCycleModel.hpp"
+#include "CounterBasedRandomNumberGenerator.hpp"
+#include "CustomVertexScenario.hpp"
+#include "FastVoronoiVertexMeshGenerator.hpp"
+#include "HardwareCounterProfiler.hpp"
+#include "HilbertRenumberingModifier.hpp"
+#include "LabelPairDifferentialAdhesionForce.hpp"
+#include "MultiRateNumericalMethod.hpp"
+#include "ParallelFarhadifarForce.hpp"
+#include "ReproducibleVonMisesVertexBasedDivisionRule.hpp"
+#include "SillyForce.hpp"
+#include "ThreadedLoop.hpp"
+#include "VectorisedForwardEulerNumericalMethod.hpp"
+
+// Finally, we include a header that enforces running this test only on one process
+#include "FakePetscSetup.hpp"
+
+/**
+ * A numerical method that runs another one and records the wall time spent updating the node positions, which
+ * includes evaluating the forces.
+ */
+class TimedNumericalMethod : public AbstractNumericalMethod<2, 2>
+{
+private:
+
+    /** The numerical method that is timed. */
+    boost::shared_ptr<AbstractNumericalMethod<2, 2> > mpMethod;
+
+    /** The total wall time spent in UpdateAllNodePositions(), in seconds. */
+    double mUpdateTime = 0.0;
+
+    friend class boost::serialization::access;
+    template <class Archive>
+    void serialize(Archive& archive, const unsigned int version)
+    {
+        archive& boost::serialization::base_object<AbstractNumericalMethod<2, 2> >(*this);
+    }
+
+public:
+
+    TimedNumericalMethod(boost::shared_ptr<AbstractNumericalMethod<2, 2> > pMethod
+                         = boost::shared_ptr<AbstractNumericalMethod<2, 2> >(new ForwardEulerNumericalMethod<2, 2>()))
+        : mpMethod(pMethod)
+    {
+    }
+
+    void UpdateAllNodePositions(double dt)
+    {
+        mpMethod->SetCellPopulation(this->mpCellPopulation);
+        mpMethod->SetForceCollection(this->mpForceCollection);
+        mpMethod->SetBoundaryConditions(this->mpBoundaryConditions);
+
+        const auto start = std::chrono::steady_clock::now();
+        mpMethod->UpdateAllNodePositions(dt);
+        const std::chrono::duration<double> update_time = std::chrono::steady_clock::now() - start;
+        mUpdateTime += update_time.count();
+    }
+
+    double GetUpdateTime() const
+    {
+        return mUpdateTime;
+    }
+};
+
+#include "SerializationExportWrapper.hpp"
+CHASTE_CLASS_EXPORT(TimedNumericalMethod)
+#include "SerializationExportWrapperForCpp.hpp"
+CHASTE_CLASS_EXPORT(TimedNumericalMethod)
+
+/**
+ * Longer-running benchmarks of the project classes, which report timings rather than check results. These are in the
+ * nightly test pack.
+ */
+class TestProjectBenchmarks : public AbstractCellBasedTestSuite
+{
+private:
+
+    /** The results of a benchmark run. */
+    struct BenchmarkResult
+    {
+        /** The wall time taken by Solve(), in seconds. */
+        double mSolveTime;
+
+        /** The final number of cells. */
+        unsigned mNumCells;
+
+        /** The final value of HilbertRenumberingModifier::CalculateLocalityMetric(). */
+        double mLocalityMetric;
+
+        /** The hardware counter totals of Solve(), on the calling thread. */
+        HardwareCounterProfiler::PhaseData mSolveCounts;
+    };
+
+    /**
+     * @param rCounts the hardware counter totals of a phase
+     * @param counter a counter
+     * @return the count per thousand instructions, as text, or "n/a" if the counters could not be opened
+     */
+    std::string GetCountPerKiloInstruction(const HardwareCounterProfiler::PhaseData& rCounts, unsigned counter)
+    {
+        HardwareCounterProfiler* p_profiler = HardwareCounterProfiler::Instance();
+        if (!p_profiler->WasCounterOpened(counter) || !p_profiler->WasCounterOpened(HardwareCounterProfiler::INSTRUCTIONS)
+            || rCounts.mCounts[HardwareCounterProfiler::INSTRUCTIONS] <= 0.0)
+        {
+            return "n/a";
+        }
+        return std::to_string(1000.0 * rCounts.mCounts[counter] / rCounts.mCounts[HardwareCounterProfiler::INSTRUCTIONS]);
+    }
+
+    /**
+     * Run a long proliferative simulation, like Test02OrientedCellDivision in TestCustomVertexSimulations, from a
+     * larger initial tissue.
+     *
+     * Solve() is measured with the HardwareCounterProfiler, whose counters are left to be checked with
+     * HardwareCounterProfiler::WasCounterOpened().
+     *
+     * @param pModifier a modifier to add to the simulation, or an empty pointer for none
+     * @param outputDirectory the output directory
+     * @return the results
+     */
+    BenchmarkResult RunProliferationBenchmark(boost::shared_ptr<AbstractCellBasedSimulationModifier<2, 2> > pModifier,
+                                              const std::string& outputDirectory)
+    {
+        SimulationTime::Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+        RandomNumberGenerator::Instance()->Reseed(1);
+        CounterBasedRandomNumberGenerator::Instance()->Reseed(1);
+        CellId::ResetMaxCellId();
+
+        VoronoiVertexMeshGenerator generator(10, 10, 1);
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_cell_type);
+        CellsGenerator<CounterBasedBernoulliTrialCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumElements(), p_cell_type);
+
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        MAKE_PTR(ReproducibleVonMisesVertexBasedDivisionRule<2>, p_division_rule);
+        p_division_rule->SetMeanParameter(1.57);
+        p_division_rule->SetConcentrationParameter(1.0);
+        cell_population.SetVertexBasedDivisionRule(p_division_rule);
+
+        OffLatticeSimulation<2> simulation(cell_population);
+        simulation.SetOutputDirectory(outputDirectory);
+        simulation.SetEndTime(40.0);
+        simulation.SetDt(0.01);
+        simulation.SetSamplingTimestepMultiple(1000);
+
+        MAKE_PTR(FarhadifarForce<2>, p_force);
+        simulation.AddForce(p_force);
+
+        if (pModifier)
+        {
+            simulation.AddSimulationModifier(pModifier);
+        }
+
+        HardwareCounterProfiler* p_profiler = HardwareCounterProfiler::Instance();
+        p_profiler->Enable();
+        p_profiler->Reset();
+        const auto start = std::chrono::steady_clock::now();
+        {
+            HardwareCounterProfiler::ScopedPhase phase("Solve");
+            simulation.Solve();
+        }
+        const std::chrono::duration<double> solve_time = std::chrono::steady_clock::now() - start;
+        p_profiler->Disable();
+
+        BenchmarkResult result;
+        result.mSolveTime = solve_time.count();
+        result.mNumCells = cell_population.GetNumRealCells();
+        result.mLocalityMetric = HilbertRenumberingModifier<2>::CalculateLocalityMetric(*p_mesh);
+        result.mSolveCounts = p_profiler->rGetPhase("Solve");
+        return result;
+    }
+
+    /**
+     * Relax a tissue in which only a small central patch of cells is labelled, so that once relaxed only the
+     * boundary of the patch keeps moving, and then time the rest of the simulation.
+     *
+     * @param pMethod the timed numerical method to switch to after relaxation
+     * @param outputDirectory the output directory
+     * @return the wall time taken by the simulation after relaxation, in seconds
+     */
+    double RunQuiescentTissueBenchmark(boost::shared_ptr<TimedNumericalMethod> pMethod,
+                                       const std::string& outputDirectory)
+    {
+        SimulationTime::Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+        RandomNumberGenerator::Instance()->Reseed(1);
+        CellId::ResetMaxCellId();
+
+        VoronoiVertexMeshGenerator generator(20, 20, 1);
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+        p_mesh->SetDistanceForT3SwapChecking(1.0);
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(DifferentiatedCellProliferativeType, p_cell_type);
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumElements(), p_cell_type);
+
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        MAKE_PTR(CellLabel, p_cell_label);
+        const c_vector<double, 2> centre = cell_population.GetCentroidOfCellPopulation();
+        for (auto cell_iter = cell_population.Begin(); cell_iter != cell_population.End(); ++cell_iter)
+        {
+            if (norm_2(cell_population.GetLocationOfCellCentre(*cell_iter) - centre) < 3.0)
+            {
+                cell_iter->AddCellProperty(p_cell_label);
+            }
+        }
+
+        OffLatticeSimulation<2> simulation(cell_population);
+        simulation.SetOutputDirectory(outputDirectory);
+        simulation.SetEndTime(5.0);
+        simulation.SetDt(0.01);
+        simulation.SetSamplingTimestepMultiple(100);
+
+        MAKE_PTR(LabelPairDifferentialAdhesionForce<2>, p_force);
+        p_force->SetNagaiHondaDeformationEnergyParameter(55.0);
+        p_force->SetNagaiHondaMembraneSurfaceEnergyParameter(0.0);
+        p_force->SetNagaiHondaCellCellAdhesionEnergyParameter(1.0);
+        p_force->SetNagaiHondaLabelledCellCellAdhesionEnergyParameter(6.0);
+        p_force->SetNagaiHondaLabelledCellLabelledCellAdhesionEnergyParameter(3.0);
+        p_force->SetNagaiHondaCellBoundaryAdhesionEnergyParameter(12.0);
+        p_force->SetNagaiHondaLabelledCellBoundaryAdhesionEnergyParameter(40.0);
+        simulation.AddForce(p_force);
+
+        simulation.Solve();
+
+        simulation.SetNumericalMethod(pMethod);
+        simulation.SetEndTime(25.0);
+
+        const auto start = std::chrono::steady_clock::now();
+        simulation.Solve();
+        const std::chrono::duration<double> solve_time = std::chrono::steady_clock::now() - start;
+        return solve_time.count();
+    }
+
+    /** Summary of the end state of one of the scenarios of TestCustomVertexSimulations. */
+    struct ScenarioSummary
+    {
+        /** The final number of cells. */
+        unsigned mNumCells;
+
+        /** The mean area of the cells. */
+        double mMeanArea;
+
+        /** The root mean square distance of the nodes from their centroid. */
+        double mRadiusOfGyration;
+
+        /** The node locations. */
+        std::vector<c_vector<double, 2> > mLocations;
+    };
+
+    /**
+     * Run one of the six scenarios of TestCustomVertexSimulations to its end time, integrated with
+     * VectorisedForwardEulerNumericalMethod.
+     *
+     * @param scenario the number of the scenario, from 1 to 6
+     * @param useSinglePrecision whether to use the mixed precision modes of the numerical method and SillyForce
+     * @param outputDirectory the output directory
+     * @return a summary of the end state
+     */
+    ScenarioSummary RunCustomVertexScenario(unsigned scenario,
+                                            bool useSinglePrecision,
+                                            const std::string& outputDirectory)
+    {
+        SimulationTime::Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+        CellId::ResetMaxCellId();
+
+        CustomVertexScenario custom_scenario(scenario, outputDirectory);
+        if (custom_scenario.GetSillyForce())
+        {
+            custom_scenario.GetSillyForce()->SetUseSinglePrecision(useSinglePrecision);
+        }
+
+        MAKE_PTR(VectorisedForwardEulerNumericalMethod<2>, p_method);
+        p_method->SetUseSinglePrecision(useSinglePrecision);
+        custom_scenario.rGetSimulation().SetNumericalMethod(p_method);
+
+        custom_scenario.rGetSimulation().Solve();
+
+        VertexBasedCellPopulation<2>& cell_population = custom_scenario.rGetCellPopulation();
+        MutableVertexMesh<2, 2>& r_mesh = custom_scenario.rGetMesh();
+
+        ScenarioSummary summary;
+        summary.mNumCells = cell_population.GetNumRealCells();
+
+        c_vector<double, 2> centroid = zero_vector<double>(2);
+        for (unsigned i = 0; i < cell_population.GetNumNodes(); ++i)
+        {
+            summary.mLocations.push_back(cell_population.GetNode(i)->rGetLocation());
+            centroid += summary.mLocations.back();
+        }
+        centroid /= summary.mLocations.size();
+
+        summary.mRadiusOfGyration = 0.0;
+        for (const auto& r_location : summary.mLocations)
+        {
+            summary.mRadiusOfGyration += inner_prod(r_location - centroid, r_location - centroid);
+        }
+        summary.mRadiusOfGyration = sqrt(summary.mRadiusOfGyration / summary.mLocations.size());
+
+        summary.mMeanArea = 0.0;
+        for (auto elem_iter = r_mesh.GetElementIteratorBegin(); elem_iter != r_mesh.GetElementIteratorEnd(); ++elem_iter)
+        {
+            summary.mMeanArea += r_mesh.GetVolumeOfElement(elem_iter->GetIndex());
+        }
+        summary.mMeanArea /= r_mesh.GetNumElements();
+
+        return summary;
+    }
+
+public:
+
+    void TestHilbertRenumberingBenchmark()
+    {
+        const BenchmarkResult reference = RunProliferationBenchmark(boost::shared_ptr<AbstractCellBasedSimulationModifier<2, 2> >(),
+                                                                    "TestHilbertRenumberingBenchmarkReference");
+
+        // Renumber only when the locality metric degrades
+        MAKE_PTR(HilbertRenumberingModifier<2>, p_modifier);
+        p_modifier->SetLocalityCheckInterval(100);
+        const BenchmarkResult renumbered = RunProliferationBenchmark(p_modifier, "TestHilbertRenumberingBenchmark");
+
+        const unsigned num_steps = SimulationTime::Instance()->GetTimeStepsElapsed();
+        std::cout << "\nProliferation benchmark, " << num_steps << " time steps:\n";
+        for (const auto& r_run : {std::make_pair("without renumbering", reference), std::make_pair("with renumbering", renumbered)})
+        {
+            std::cout << "  " << r_run.first << ": " << r_run.second.mNumCells << " cells, "
+                      << r_run.second.mSolveTime << " s, " << num_steps / r_run.second.mSolveTime << " steps/s, "
+                      << "locality metric " << r_run.second.mLocalityMetric << ", misses per thousand instructions: "
+                      << "L1 data " << GetCountPerKiloInstruction(r_run.second.mSolveCounts, HardwareCounterProfiler::L1D_READ_MISSES)
+                      << ", last level " << GetCountPerKiloInstruction(r_run.second.mSolveCounts, HardwareCounterProfiler::LLC_MISSES) << "\n";
+        }
+        std::cout << "  " << p_modifier->GetNumRenumberings() << " renumberings\n";
+        if (!HardwareCounterProfiler::Instance()->WasCounterOpened(HardwareCounterProfiler::INSTRUCTIONS))
+        {
+            std::cout << "  Hardware counters are not available here (see /proc/sys/kernel/perf_event_paranoid)\n";
+        }
+
+        // Timings and cache misses depend on the machine, so only the effect on memory locality is checked
+        TS_ASSERT_LESS_THAN(1u, p_modifier->GetNumRenumberings());
+        TS_ASSERT_LESS_THAN(renumbered.mLocalityMetric, reference.mLocalityMetric);
+        if (HardwareCounterProfiler::Instance()->WasCounterOpened(HardwareCounterProfiler::INSTRUCTIONS))
+        {
+            TS_ASSERT_LESS_THAN(0.0, reference.mSolveCounts.mCounts[HardwareCounterProfiler::INSTRUCTIONS]);
+            TS_ASSERT_LESS_THAN(0.0, renumbered.mSolveCounts.mCounts[HardwareCounterProfiler::INSTRUCTIONS]);
+        }
+        HardwareCounterProfiler::Destroy();
+    }
+
+    void TestFastVoronoiVertexMeshGeneratorBenchmark()
+    {
+        std::cout << "\nMesh generation, with one Lloyd relaxation step:\n";
+
+        RandomNumberGenerator::Instance()->Reseed(1);
+        auto start = std::chrono::steady_clock::now();
+        VoronoiVertexMeshGenerator reference_generator(100, 100, 1);
+        std::chrono::duration<double> generation_time = std::chrono::steady_clock::now() - start;
+        std::cout << "  VoronoiVertexMeshGenerator, 100 x 100: " << generation_time.count() << " s\n";
+        TS_ASSERT_EQUALS(reference_generator.GetMesh()->GetNumElements(), 10000u);
+
+        for (unsigned num_elements_across : {100u, 1000u})
+        {
+            start = std::chrono::steady_clock::now();
+            FastVoronoiVertexMeshGenerator generator(num_elements_across, num_elements_across, 1);
+            generation_time = std::chrono::steady_clock::now() - start;
+            std::cout << "  FastVoronoiVertexMeshGenerator, " << num_elements_across << " x " << num_elements_across
+                      << ": " << generation_time.count() << " s on " << ThreadedLoop::GetNumThreads() << " threads\n";
+            TS_ASSERT_EQUALS(generator.GetMesh()->GetNumElements(), num_elements_across * num_elements_across);
+        }
+    }
+
+    void TestMultiRateNumericalMethodBenchmark()
+    {
+        MAKE_PTR(TimedNumericalMethod, p_reference_method);
+        const double reference_time = RunQuiescentTissueBenchmark(p_reference_method, "TestMultiRateNumericalMethodBenchmarkReference");
+
+        // Every output of the benchmark follows a full evaluation
+        MAKE_PTR(MultiRateNumericalMethod<2>, p_method);
+        p_method->SetSyncInterval(100);
+        MAKE_PTR_ARGS(TimedNumericalMethod, p_timed_method, (p_method));
+        const double multi_rate_time = RunQuiescentTissueBenchmark(p_timed_method, "TestMultiRateNumericalMethodBenchmark");
+
+        const double update_speedup = p_reference_method->GetUpdateTime() / p_timed_method->GetUpdateTime();
+        const double evaluation_ratio = double(p_method->GetNumNodeForceEvaluations()) / p_method->GetNumNodeUpdates();
+        std::cout << "\nMostly quiescent tissue, 20 x 20 cells, after relaxation:\n"
+                  << "  forward Euler: " << reference_time << " s, of which " << p_reference_method->GetUpdateTime()
+                  << " s updating node positions\n"
+                  << "  multi-rate:    " << multi_rate_time << " s, of which " << p_timed_method->GetUpdateTime()
+                  << " s updating node positions\n"
+                  << "  speedup " << reference_time / multi_rate_time << " overall, " << update_speedup
+                  << " in updating node positions, " << evaluation_ratio << " node force evaluations per node update, "
+                  << p_method->GetNumFullEvaluations() << " full evaluations\n";
+
+        // The rest of each step (remeshing, output) is unchanged by the numerical method, so the speedup is checked
+        // on the node position updates, including the force evaluations
+        TS_ASSERT_LESS_THAN(evaluation_ratio, 0.5);
+        TS_ASSERT_LESS_THAN(2.0, update_speedup);
+    }
+
+    void TestParallelFarhadifarForceBenchmark()
+    {
+        RandomNumberGenerator::Instance()->Reseed(1);
+        FastVoronoiVertexMeshGenerator generator(100, 100, 1);
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(DifferentiatedCellProliferativeType, p_cell_type);
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumElements(), p_cell_type);
+        for (auto& p_cell : cells)
+        {
+            p_cell->GetCellData()->SetItem("target area", 1.0);
+        }
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        // The mean time per evaluation, after one untimed evaluation in which the colouring is built
+        auto time_force = [&](AbstractForce<2>& rForce)
+        {
+            const unsigned num_evaluations = 20;
+            rForce.AddForceContribution(cell_population);
+            const auto start = std::chrono::steady_clock::now();
+            for (unsigned evaluation = 0; evaluation < num_evaluations; ++evaluation)
+            {
+                rForce.AddForceContribution(cell_population);
+            }
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            for (unsigned i = 0; i < cell_population.GetNumNodes(); ++i)
+            {
+                cell_population.GetNode(i)->ClearAppliedForce();
+            }
+            return elapsed.count() / num_evaluations;
+        };
+
+        FarhadifarForce<2> reference_force;
+        const double reference_time = time_force(reference_force);
+
+        ParallelFarhadifarForce<2> coloured_force;
+        const double coloured_time = time_force(coloured_force);
+
+        ParallelFarhadifarForce<2> thread_local_force;
+        thread_local_force.SetUseColouring(false);
+        const double thread_local_time = time_force(thread_local_force);
+
+        const unsigned num_colours = coloured_force.rGetScatter().rGetColouring().GetNumColours();
+        std::cout << "\nFarhadifar force, 100 x 100 cells, " << ThreadedLoop::GetNumThreads() << " threads:\n"
+                  << "  FarhadifarForce:                         " << reference_time << " s\n"
+                  << "  ParallelFarhadifarForce, " << num_colours << " colours:      " << coloured_time
+                  << " s, speedup " << reference_time / coloured_time << "\n"
+                  << "  ParallelFarhadifarForce, thread-local:   " << thread_local_time
+                  << " s, speedup " << reference_time / thread_local_time << "\n";
+
+        // The number of colours limits the parallelism; with enough threads, running one colour after another must
+        // still beat the serial force, so the cost of starting each colour on the worker pool is small
+        TS_ASSERT_LESS_THAN(num_colours, 10u);
+        if (ThreadedLoop::GetNumThreads() >= 4u)
+        {
+            TS_ASSERT_LESS_THAN(coloured_time, reference_time);
+        }
+    }
+
+    void TestMixedPrecisionAccuracyReport()
+    {
+        std::cout << "\nMixed precision against double precision, scenarios of TestCustomVertexSimulations to their end times:\n";
+        for (unsigned scenario = 1; scenario <= 6; ++scenario)
+        {
+            const std::string directory = "TestMixedPrecisionAccuracyReport/Scenario" + std::to_string(scenario);
+            const ScenarioSummary reference = RunCustomVertexScenario(scenario, false, directory + "/Double");
+            const ScenarioSummary mixed = RunCustomVertexScenario(scenario, true, directory + "/Mixed");
+
+            const double area_error = fabs(mixed.mMeanArea - reference.mMeanArea) / reference.mMeanArea;
+            const double radius_error = fabs(mixed.mRadiusOfGyration - reference.mRadiusOfGyration) / reference.mRadiusOfGyration;
+
+            std::cout << "  scenario " << scenario << ", t = " << SimulationTime::Instance()->GetTime() << ": "
+                      << reference.mNumCells << " / " << mixed.mNumCells << " cells, "
+                      << "relative error in mean area " << area_error << ", in radius of gyration " << radius_error;
+
+            // Node locations can only be compared while the two runs have the same topology
+            if (mixed.mLocations.size() == reference.mLocations.size())
+            {
+                double max_distance = 0.0;
+                for (unsigned i = 0; i < reference.mLocations.size(); ++i)
+                {
+                    max_distance = std::max(max_distance, norm_2(mixed.mLocations[i] - reference.mLocations[i]));
+                }
+                std::cout << ", largest node distance " << max_distance;
+            }
+            std::cout << "\n";
+
+            TS_ASSERT_LESS_THAN(area_error, 1e-2);
+            TS_ASSERT_LESS_THAN(radius_error, 1e-2);
+        }
+    }
+};
+
+#endif /* TESTPROJECTBENCHMARKS_HPP_ */
@@ -0,0 +1,288 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTPROJECTCELLCYCLEMODELS_HPP_
+#define TESTPROJECTCELLCYCLEMODELS_HPP_
+
+// These first headers relate to the Chaste infrastructure and can be found at the top of every test suite
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "CheckpointArchiveTypes.hpp"
+
+#include <memory>
+
+#include "RandomNumberGenerator.hpp"
+#include "SmartPointers.hpp"
+
+#include "VoronoiVertexMeshGenerator.hpp"
+
+#include "Cell.hpp"
+#include "CellId.hpp"
+#include "CellLabel.hpp"
+#include "CellsGenerator.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "NoCellCycleModel.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "WildTypeCellMutationState.hpp"
+
+#include "FarhadifarForce.hpp"
+#include "OffLatticeSimulation.hpp"
+
+// Custom headers from this user project
+#include "CounterBasedBernoulliTrialCellCycleModel.hpp"
+#include "CounterBasedRandomNumberGenerator.hpp"
+#include "ParallelDivisionOffLatticeSimulation.hpp"
+#include "ParallelDivisionReadinessModifier.hpp"
+#include "ReproducibleVonMisesVertexBasedDivisionRule.hpp"
+#include "ThreadedLoop.hpp"
+
+// Finally, we include a header that enforces running this test only on one process
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests of the project cell-cycle models, and the parallel evaluation of division readiness.
+ */
+class TestProjectCellCycleModels : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Run a simulation like Test02OrientedCellDivision in TestCustomVertexSimulations, in which all randomness after
+     * the mesh is generated comes from CounterBasedRandomNumberGenerator.
+     *
+     * @param numThreads the number of threads with which to evaluate division readiness
+     * @param outputDirectory the output directory
+     * @param rLocations filled with the final node locations
+     * @param divideListedCells whether to use a ParallelDivisionOffLatticeSimulation, which divides the cells
+     *     listed by the modifier, rather than an OffLatticeSimulation (defaults to false)
+     * @param differentiateSomeCells whether to give every sixth cell a NoCellCycleModel (defaults to false)
+     * @return the final number of cells
+     */
+    unsigned RunDivisionScenario(unsigned numThreads, const std::string& outputDirectory,
+                                 std::vector<c_vector<double, 2> >& rLocations,
+                                 bool divideListedCells=false, bool differentiateSomeCells=false)
+    {
+        SimulationTime::Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+        RandomNumberGenerator::Instance()->Reseed(1);
+        CounterBasedRandomNumberGenerator::Instance()->Reseed(1);
+        CellId::ResetMaxCellId();
+
+        VoronoiVertexMeshGenerator generator(6, 6, 1);
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_cell_type);
+        CellsGenerator<CounterBasedBernoulliTrialCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumElements(), p_cell_type);
+        if (differentiateSomeCells)
+        {
+            MAKE_PTR(DifferentiatedCellProliferativeType, p_diff_type);
+            for (unsigned i = 0; i < cells.size(); i += 6)
+            {
+                CellPtr p_cell(new Cell(cells[i]->GetMutationState(), new NoCellCycleModel()));
+                p_cell->SetCellProliferativeType(p_diff_type);
+                p_cell->SetBirthTime(cells[i]->GetBirthTime());
+                cells[i] = p_cell;
+            }
+        }
+
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        MAKE_PTR(ReproducibleVonMisesVertexBasedDivisionRule<2>, p_division_rule);
+        p_division_rule->SetMeanParameter(1.57);
+        p_division_rule->SetConcentrationParameter(1.0);
+        cell_population.SetVertexBasedDivisionRule(p_division_rule);
+
+        std::unique_ptr<OffLatticeSimulation<2> > p_simulation(divideListedCells
+            ? new ParallelDivisionOffLatticeSimulation<2>(cell_population)
+            : new OffLatticeSimulation<2>(cell_population));
+        OffLatticeSimulation<2>& simulation = *p_simulation;
+        simulation.SetOutputDirectory(outputDirectory);
+        simulation.SetEndTime(10.0);
+        simulation.SetDt(0.01);
+        simulation.SetSamplingTimestepMultiple(100);
+
+        MAKE_PTR(FarhadifarForce<2>, p_force);
+        simulation.AddForce(p_force);
+
+        // The population is far smaller than the default minimum number of cells per thread
+        MAKE_PTR(ParallelDivisionReadinessModifier<2>, p_modifier);
+        p_modifier->SetMinCellsPerThread(1);
+        TS_ASSERT_EQUALS(p_modifier->GetMinCellsPerThread(), 1u);
+        simulation.AddSimulationModifier(p_modifier);
+
+        ThreadedLoop::SetNumThreads(numThreads);
+        simulation.Solve();
+        ThreadedLoop::SetNumThreads(0);
+
+        // The listed cells are divided at every time step, unless some cells have other cell-cycle models
+        if (divideListedCells)
+        {
+            const unsigned num_listed_birth_phases = static_cast<ParallelDivisionOffLatticeSimulation<2>&>(simulation).GetNumListedBirthPhases();
+            TS_ASSERT_EQUALS(num_listed_birth_phases, differentiateSomeCells ? 0u : 1000u);
+        }
+
+        // Every cell in the final division list is still waiting to divide
+        for (const CellPtr& rp_cell : p_modifier->rGetCellsReadyToDivide())
+        {
+            TS_ASSERT(rp_cell->GetCellCycleModel()->ReadyToDivide());
+        }
+
+        rLocations.clear();
+        for (auto node_iter = p_mesh->GetNodeIteratorBegin(); node_iter != p_mesh->GetNodeIteratorEnd(); ++node_iter)
+        {
+            rLocations.push_back(node_iter->rGetLocation());
+        }
+        return cell_population.GetNumRealCells();
+    }
+
+public:
+
+    void TestCounterBasedBernoulliTrialCellCycleModel()
+    {
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(100.0, 10000);
+
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        MAKE_PTR(DifferentiatedCellProliferativeType, p_diff_type);
+        MAKE_PTR(CellLabel, p_label);
+
+        // Half the cells are labelled, and divide twice as often; one cell is differentiated
+        std::vector<CellPtr> cells;
+        for (unsigned i = 0; i < 1001; ++i)
+        {
+            auto p_model = new CounterBasedBernoulliTrialCellCycleModel();
+            p_model->SetDivisionProbability(0.5);
+            p_model->SetLabelledDivisionProbability(1.0);
+            p_model->SetMinimumDivisionAge(1.0);
+
+            CellPtr p_cell(new Cell(p_state, p_model));
+            p_cell->SetCellProliferativeType(i < 1000 ? p_transit_type : p_diff_type);
+            if (i % 2 == 1)
+            {
+                p_cell->AddCellProperty(p_label);
+            }
+            p_cell->InitialiseCellCycleModel();
+            cells.push_back(p_cell);
+        }
+
+        auto p_model = static_cast<CounterBasedBernoulliTrialCellCycleModel*>(cells[0]->GetCellCycleModel());
+        TS_ASSERT_DELTA(p_model->GetDivisionProbability(), 0.5, 1e-12);
+        TS_ASSERT_DELTA(p_model->GetLabelledDivisionProbability(), 1.0, 1e-12);
+        TS_ASSERT_DELTA(p_model->GetMinimumDivisionAge(), 1.0, 1e-12);
+        TS_ASSERT_DELTA(p_model->GetAverageTransitCellCycleTime(), 3.0, 1e-12);
+
+        // Record the time at which each cell first becomes ready to divide
+        std::vector<double> division_times(cells.size(), -1.0);
+        unsigned num_ready = 0;
+        while (num_ready < 1000 && !SimulationTime::Instance()->IsFinished())
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            for (unsigned i = 0; i < cells.size(); ++i)
+            {
+                const bool ready = cells[i]->GetCellCycleModel()->ReadyToDivide();
+
+                // Asking again in the same time step gives the same answer
+                TS_ASSERT_EQUALS(cells[i]->GetCellCycleModel()->ReadyToDivide(), ready);
+
+                if (ready && division_times[i] < 0.0)
+                {
+                    division_times[i] = SimulationTime::Instance()->GetTime();
+                    ++num_ready;
+                }
+            }
+        }
+        TS_ASSERT_EQUALS(num_ready, 1000u);
+        TS_ASSERT_LESS_THAN(division_times[1000], 0.0);
+
+        double mean_unlabelled_time = 0.0;
+        double mean_labelled_time = 0.0;
+        for (unsigned i = 0; i < 1000; ++i)
+        {
+            TS_ASSERT_LESS_THAN(1.0, division_times[i]);
+            (i % 2 == 1 ? mean_labelled_time : mean_unlabelled_time) += division_times[i] / 500.0;
+        }
+        TS_ASSERT_DELTA(mean_unlabelled_time, 3.0, 0.3);
+        TS_ASSERT_DELTA(mean_labelled_time, 2.0, 0.15);
+    }
+
+    void TestParallelDivisionReadinessIsIndependentOfThreadCount()
+    {
+        std::vector<c_vector<double, 2> > serial_locations;
+        const unsigned num_serial_cells = RunDivisionScenario(1, "TestParallelDivisionReadiness/Serial", serial_locations);
+
+        std::vector<c_vector<double, 2> > parallel_locations;
+        const unsigned num_parallel_cells = RunDivisionScenario(4, "TestParallelDivisionReadiness/Parallel", parallel_locations);
+
+        TS_ASSERT_LESS_THAN(36u, num_serial_cells);
+        TS_ASSERT_EQUALS(num_parallel_cells, num_serial_cells);
+        TS_ASSERT_EQUALS(parallel_locations.size(), serial_locations.size());
+        for (unsigned i = 0; i < std::min(parallel_locations.size(), serial_locations.size()); ++i)
+        {
+            TS_ASSERT_EQUALS(parallel_locations[i][0], serial_locations[i][0]);
+            TS_ASSERT_EQUALS(parallel_locations[i][1], serial_locations[i][1]);
+        }
+    }
+
+    void TestDividingListedCellsMatchesUsualCellBirth()
+    {
+        // Dividing only the listed cells gives the same divisions as asking every cell
+        for (bool differentiate_some_cells : {false, true})
+        {
+            const std::string directory = std::string("TestDividingListedCells/") + (differentiate_some_cells ? "Mixed" : "Uniform");
+
+            std::vector<c_vector<double, 2> > usual_locations;
+            const unsigned num_usual_cells = RunDivisionScenario(4, directory + "/Usual", usual_locations,
+                                                                 false, differentiate_some_cells);
+
+            std::vector<c_vector<double, 2> > listed_locations;
+            const unsigned num_listed_cells = RunDivisionScenario(4, directory + "/Listed", listed_locations,
+                                                                  true, differentiate_some_cells);
+
+            TS_ASSERT_LESS_THAN(36u, num_usual_cells);
+            TS_ASSERT_EQUALS(num_listed_cells, num_usual_cells);
+            TS_ASSERT_EQUALS(listed_locations.size(), usual_locations.size());
+            for (unsigned i = 0; i < std::min(listed_locations.size(), usual_locations.size()); ++i)
+            {
+                TS_ASSERT_EQUALS(listed_locations[i][0], usual_locations[i][0]);
+                TS_ASSERT_EQUALS(listed_locations[i][1], usual_locations[i][1]);
+            }
+        }
+    }
+};
+
+#endif /* TESTPROJECTCELLCYCLEMODELS_HPP_ */
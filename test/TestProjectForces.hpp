@@ -0,0 +1,403 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTPROJECTFORCES_HPP_
+#define TESTPROJECTFORCES_HPP_
+
+// These first headers relate to the Chaste infrastructure and can be found at the top of every test suite
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "CheckpointArchiveTypes.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+#include "RandomNumberGenerator.hpp"
+#include "SmartPointers.hpp"
+
+#include "VoronoiVertexMeshGenerator.hpp"
+
+#include "Cell.hpp"
+#include "CellLabel.hpp"
+#include "CellsGenerator.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "NoCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+#include "FarhadifarForce.hpp"
+#include "NagaiHondaDifferentialAdhesionForce.hpp"
+
+// Custom headers from this user project
+#include "ElementColouring.hpp"
+#include "LabelPairDifferentialAdhesionForce.hpp"
+#include "ParallelFarhadifarForce.hpp"
+#include "SillyForce.hpp"
+#include "ThreadedLoop.hpp"
+
+// Finally, we include a header that enforces running this test only on one process
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests that the project forces reproduce the forces of the Chaste classes they are designed to replace.
+ */
+class TestProjectForces : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Set up a labelled population like that of Test03CellSorting, with target areas set directly so that no
+     * simulation (and hence no target area modifier) is required.
+     */
+    void SetUpLabelledPopulation(boost::shared_ptr<MutableVertexMesh<2, 2> >& rpMesh, std::vector<CellPtr>& rCells)
+    {
+        RandomNumberGenerator::Instance()->Reseed(1);
+        VoronoiVertexMeshGenerator generator(9, 9, 1);
+        rpMesh = generator.GetMesh();
+
+        MAKE_PTR(DifferentiatedCellProliferativeType, p_cell_type);
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasicRandom(rCells, rpMesh->GetNumElements(), p_cell_type);
+
+        MAKE_PTR(CellLabel, p_cell_label);
+        for (auto& p_cell : rCells)
+        {
+            p_cell->GetCellData()->SetItem("target area", 0.8 + 0.4 * RandomNumberGenerator::Instance()->ranf());
+            if (RandomNumberGenerator::Instance()->ranf() < 0.5)
+            {
+                p_cell->AddCellProperty(p_cell_label);
+            }
+        }
+    }
+
+    /**
+     * Set the same parameters as Test03CellSorting, plus a non-zero membrane surface energy so that every term is
+     * exercised.
+     */
+    void SetCellSortingParameters(NagaiHondaDifferentialAdhesionForce<2>& rForce)
+    {
+        rForce.SetNagaiHondaDeformationEnergyParameter(55.0);
+        rForce.SetNagaiHondaMembraneSurfaceEnergyParameter(0.7);
+        rForce.SetNagaiHondaCellCellAdhesionEnergyParameter(1.0);
+        rForce.SetNagaiHondaLabelledCellCellAdhesionEnergyParameter(6.0);
+        rForce.SetNagaiHondaLabelledCellLabelledCellAdhesionEnergyParameter(3.0);
+        rForce.SetNagaiHondaCellBoundaryAdhesionEnergyParameter(12.0);
+        rForce.SetNagaiHondaLabelledCellBoundaryAdhesionEnergyParameter(40.0);
+    }
+
+public:
+
+    void TestLabelPairDifferentialAdhesionForceMatchesNagaiHonda()
+    {
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh;
+        std::vector<CellPtr> cells;
+        SetUpLabelledPopulation(p_mesh, cells);
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        NagaiHondaDifferentialAdhesionForce<2> reference_force;
+        SetCellSortingParameters(reference_force);
+        reference_force.AddForceContribution(cell_population);
+
+        std::vector<c_vector<double, 2> > reference_forces;
+        for (unsigned i = 0; i < cell_population.GetNumNodes(); ++i)
+        {
+            reference_forces.push_back(cell_population.GetNode(i)->rGetAppliedForce());
+            cell_population.GetNode(i)->ClearAppliedForce();
+        }
+
+        LabelPairDifferentialAdhesionForce<2> force;
+        SetCellSortingParameters(force);
+        force.AddForceContribution(cell_population);
+
+        for (unsigned i = 0; i < cell_population.GetNumNodes(); ++i)
+        {
+            const c_vector<double, 2>& r_force = cell_population.GetNode(i)->rGetAppliedForce();
+            TS_ASSERT_DELTA(r_force[0], reference_forces[i][0], 1e-10);
+            TS_ASSERT_DELTA(r_force[1], reference_forces[i][1], 1e-10);
+        }
+
+        // The matrix must pick up parameter changes made after construction
+        TS_ASSERT_DELTA(force.mAdhesionMatrix[1][LabelPairDifferentialAdhesionForce<2>::BOUNDARY_INDEX], 40.0, 1e-12);
+        TS_ASSERT_DELTA(force.mAdhesionMatrix[0][1], 6.0, 1e-12);
+    }
+
+    void TestNodeSubsetForcesMatchFullEvaluation()
+    {
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh;
+        std::vector<CellPtr> cells;
+        SetUpLabelledPopulation(p_mesh, cells);
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        LabelPairDifferentialAdhesionForce<2> label_pair_force;
+        SetCellSortingParameters(label_pair_force);
+        SillyForce<2> silly_force;
+        silly_force.SetStrengthMultiplier(0.15);
+
+        // Update every third node, which leaves some elements with no node updated
+        std::vector<unsigned> node_indices;
+        std::vector<unsigned char> node_mask(cell_population.GetNumNodes(), 0u);
+        for (unsigned i = 0; i < cell_population.GetNumNodes(); i += 3)
+        {
+            node_indices.push_back(i);
+            node_mask[i] = 1u;
+        }
+
+        for (AbstractNodeSubsetForce<2>* p_subset_force : std::vector<AbstractNodeSubsetForce<2>*>{&label_pair_force, &silly_force})
+        {
+            AbstractForce<2>* p_force = dynamic_cast<AbstractForce<2>*>(p_subset_force);
+            p_force->AddForceContribution(cell_population);
+
+            std::vector<c_vector<double, 2> > full_forces;
+            c_vector<double, 2> untouched_force;
+            untouched_force[0] = 7.0;
+            untouched_force[1] = -7.0;
+            for (unsigned i = 0; i < cell_population.GetNumNodes(); ++i)
+            {
+                full_forces.push_back(cell_population.GetNode(i)->rGetAppliedForce());
+                cell_population.GetNode(i)->ClearAppliedForce();
+                cell_population.GetNode(i)->AddAppliedForceContribution(untouched_force);
+            }
+
+            for (unsigned i : node_indices)
+            {
+                cell_population.GetNode(i)->ClearAppliedForce();
+            }
+            p_subset_force->AddForceContributionToNodes(cell_population, node_indices, node_mask);
+
+            // The contributions are summed in the same order, so the updated forces are identical
+            for (unsigned i = 0; i < cell_population.GetNumNodes(); ++i)
+            {
+                const c_vector<double, 2>& r_force = cell_population.GetNode(i)->rGetAppliedForce();
+                const c_vector<double, 2>& r_expected = node_mask[i] ? full_forces[i] : untouched_force;
+                TS_ASSERT_EQUALS(r_force[0], r_expected[0]);
+                TS_ASSERT_EQUALS(r_force[1], r_expected[1]);
+                cell_population.GetNode(i)->ClearAppliedForce();
+            }
+        }
+    }
+
+    void TestSillyForceSinglePrecision()
+    {
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh;
+        std::vector<CellPtr> cells;
+        SetUpLabelledPopulation(p_mesh, cells);
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        SillyForce<2> force;
+        force.SetStrengthMultiplier(0.15);
+        TS_ASSERT_EQUALS(force.GetUseSinglePrecision(), false);
+        force.AddForceContribution(cell_population);
+
+        std::vector<c_vector<double, 2> > double_forces;
+        for (unsigned i = 0; i < cell_population.GetNumNodes(); ++i)
+        {
+            double_forces.push_back(cell_population.GetNode(i)->rGetAppliedForce());
+            cell_population.GetNode(i)->ClearAppliedForce();
+        }
+
+        // The centroid is accumulated in double precision, so only the rounding of each node location remains
+        force.SetUseSinglePrecision(true);
+        force.AddForceContribution(cell_population);
+        for (unsigned i = 0; i < cell_population.GetNumNodes(); ++i)
+        {
+            const c_vector<double, 2>& r_force = cell_population.GetNode(i)->rGetAppliedForce();
+            TS_ASSERT_DELTA(r_force[0], double_forces[i][0], 1e-5);
+            TS_ASSERT_DELTA(r_force[1], double_forces[i][1], 1e-5);
+            cell_population.GetNode(i)->ClearAppliedForce();
+        }
+    }
+
+    void TestElementColouring()
+    {
+        RandomNumberGenerator::Instance()->Reseed(1);
+        VoronoiVertexMeshGenerator generator(9, 9, 1);
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+
+        // The first update colours every element, and a second one has nothing to do
+        ElementColouring<2> colouring;
+        TS_ASSERT_EQUALS(colouring.Update(*p_mesh), 81u);
+        TS_ASSERT(colouring.IsValid(*p_mesh));
+        TS_ASSERT_LESS_THAN(2u, colouring.GetNumColours());
+        TS_ASSERT_LESS_THAN(colouring.GetNumColours(), 10u);
+        TS_ASSERT_EQUALS(colouring.Update(*p_mesh), 0u);
+        TS_ASSERT_EQUALS(colouring.GetNumRecolouredElements(), 0u);
+
+        unsigned num_coloured = 0;
+        for (unsigned colour = 0; colour < colouring.GetNumColours(); ++colour)
+        {
+            for (unsigned elem_index : colouring.rGetElementsOfColour(colour))
+            {
+                TS_ASSERT_EQUALS(colouring.GetColour(elem_index), colour);
+                ++num_coloured;
+            }
+        }
+        TS_ASSERT_EQUALS(num_coloured, 81u);
+
+        // A division only changes the divided element, its new sibling and the neighbours that gain a node
+        const unsigned new_elem_index = p_mesh->DivideElementAlongShortAxis(p_mesh->GetElement(40));
+        TS_ASSERT_EQUALS(colouring.GetColour(new_elem_index), ElementColouring<2>::UNCOLOURED);
+        TS_ASSERT(!colouring.IsValid(*p_mesh));
+        const unsigned num_recoloured = colouring.Update(*p_mesh);
+        TS_ASSERT_LESS_THAN(1u, num_recoloured);
+        TS_ASSERT_LESS_THAN(num_recoloured, 6u);
+        TS_ASSERT(colouring.IsValid(*p_mesh));
+
+        // Removing an element renumbers those after it, which are then recoloured
+        p_mesh->DeleteElementPriorToReMesh(0);
+        p_mesh->ReMesh();
+        TS_ASSERT_EQUALS(p_mesh->GetNumAllElements(), 81u);
+        TS_ASSERT_LESS_THAN(0u, colouring.Update(*p_mesh));
+        TS_ASSERT(colouring.IsValid(*p_mesh));
+
+        colouring.Clear();
+        TS_ASSERT_EQUALS(colouring.GetNumColours(), 0u);
+        TS_ASSERT_EQUALS(colouring.Update(*p_mesh), 81u);
+        TS_ASSERT(colouring.IsValid(*p_mesh));
+    }
+
+    void TestThreadedLoop()
+    {
+        // Many calls in a row, as from one colour to the next, on a pool that grows and shrinks with the thread count
+        std::vector<unsigned> counts(1000, 0u);
+        for (unsigned call = 0; call < 200; ++call)
+        {
+            ThreadedLoop::SetNumThreads(1u + call % 5u);
+            ThreadedLoop::Run(counts.size(), [&](unsigned begin, unsigned end, unsigned thread)
+            {
+                for (unsigned i = begin; i < end; ++i)
+                {
+                    ++counts[i];
+                }
+            });
+        }
+        TS_ASSERT_EQUALS(std::count(counts.begin(), counts.end(), 200u), 1000);
+
+        // A call made from inside another does not wait for the busy pool
+        ThreadedLoop::SetNumThreads(3);
+        std::atomic<unsigned> num_items(0u);
+        ThreadedLoop::Run(30, [&](unsigned begin, unsigned end, unsigned thread)
+        {
+            ThreadedLoop::Run(10, [&](unsigned innerBegin, unsigned innerEnd, unsigned innerThread)
+            {
+                num_items += innerEnd - innerBegin;
+            });
+        });
+        TS_ASSERT_EQUALS(num_items, 30u);
+
+        // An exception thrown on a worker is rethrown on the calling thread, and the pool is still usable
+        TS_ASSERT_THROWS_THIS(ThreadedLoop::Run(30, [&](unsigned begin, unsigned end, unsigned thread)
+        {
+            if (thread == 2u)
+            {
+                EXCEPTION("Thrown on a worker");
+            }
+        }), "Thrown on a worker");
+        num_items = 0u;
+        ThreadedLoop::Run(30, [&](unsigned begin, unsigned end, unsigned thread)
+        {
+            num_items += end - begin;
+        });
+        TS_ASSERT_EQUALS(num_items, 30u);
+        ThreadedLoop::SetNumThreads(0);
+    }
+
+    void TestParallelFarhadifarForceMatchesFarhadifar()
+    {
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh;
+        std::vector<CellPtr> cells;
+        SetUpLabelledPopulation(p_mesh, cells);
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        FarhadifarForce<2> reference_force;
+        reference_force.SetAreaElasticityParameter(1.5);
+        reference_force.SetPerimeterContractilityParameter(0.3);
+        reference_force.SetLineTensionParameter(0.2);
+        reference_force.SetBoundaryLineTensionParameter(0.5);
+        reference_force.AddForceContribution(cell_population);
+
+        std::vector<c_vector<double, 2> > reference_forces;
+        for (unsigned i = 0; i < cell_population.GetNumNodes(); ++i)
+        {
+            reference_forces.push_back(cell_population.GetNode(i)->rGetAppliedForce());
+            cell_population.GetNode(i)->ClearAppliedForce();
+        }
+
+        // Each combination of scatter method and number of threads, with few elements per thread so all are used
+        std::vector<c_vector<double, 2> > coloured_forces;
+        for (bool use_colouring : {true, false})
+        {
+            for (unsigned num_threads : {1u, 4u})
+            {
+                ParallelFarhadifarForce<2> force;
+                force.SetAreaElasticityParameter(1.5);
+                force.SetPerimeterContractilityParameter(0.3);
+                force.SetLineTensionParameter(0.2);
+                force.SetBoundaryLineTensionParameter(0.5);
+                force.SetUseColouring(use_colouring);
+                TS_ASSERT_EQUALS(force.GetUseColouring(), use_colouring);
+                force.rGetScatter().SetMinElementsPerThread(4);
+
+                ThreadedLoop::SetNumThreads(num_threads);
+                force.AddForceContribution(cell_population);
+                ThreadedLoop::SetNumThreads(0);
+
+                if (use_colouring)
+                {
+                    TS_ASSERT(force.rGetScatter().rGetColouring().IsValid(*p_mesh));
+                }
+
+                for (unsigned i = 0; i < cell_population.GetNumNodes(); ++i)
+                {
+                    const c_vector<double, 2>& r_force = cell_population.GetNode(i)->rGetAppliedForce();
+                    TS_ASSERT_DELTA(r_force[0], reference_forces[i][0], 1e-10);
+                    TS_ASSERT_DELTA(r_force[1], reference_forces[i][1], 1e-10);
+
+                    // With the colouring, each node sums its contributions in the same order on any number of threads
+                    if (use_colouring && num_threads == 1u)
+                    {
+                        coloured_forces.push_back(r_force);
+                    }
+                    else if (use_colouring)
+                    {
+                        TS_ASSERT_EQUALS(r_force[0], coloured_forces[i][0]);
+                        TS_ASSERT_EQUALS(r_force[1], coloured_forces[i][1]);
+                    }
+                    cell_population.GetNode(i)->ClearAppliedForce();
+                }
+            }
+        }
+    }
+};
+
+#endif /* TESTPROJECTFORCES_HPP_ */
@@ -0,0 +1,196 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTPROJECTMESHGENERATORS_HPP_
+#define TESTPROJECTMESHGENERATORS_HPP_
+
+// These first headers relate to the Chaste infrastructure and can be found at the top of every test suite
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "CheckpointArchiveTypes.hpp"
+
+#include <cmath>
+
+#include "SmartPointers.hpp"
+
+#include "CellsGenerator.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "NoCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+#include "FarhadifarForce.hpp"
+#include "OffLatticeSimulation.hpp"
+
+// Custom headers from this user project
+#include "FastVoronoiVertexMeshGenerator.hpp"
+#include "ThreadedLoop.hpp"
+
+// Finally, we include a header that enforces running this test only on one process
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests of the project mesh generators.
+ */
+class TestProjectMeshGenerators : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * @param rMesh a mesh
+     * @return the locations of the nodes of the mesh
+     */
+    std::vector<c_vector<double, 2> > GetNodeLocations(MutableVertexMesh<2, 2>& rMesh)
+    {
+        std::vector<c_vector<double, 2> > locations;
+        for (unsigned node_index = 0; node_index < rMesh.GetNumNodes(); ++node_index)
+        {
+            locations.push_back(rMesh.GetNode(node_index)->rGetLocation());
+        }
+        return locations;
+    }
+
+    /**
+     * @param rMesh a mesh
+     * @return the standard deviation of the areas of the elements of the mesh
+     */
+    double GetAreaStandardDeviation(MutableVertexMesh<2, 2>& rMesh)
+    {
+        double sum = 0.0;
+        double sum_of_squares = 0.0;
+        for (unsigned elem_index = 0; elem_index < rMesh.GetNumElements(); ++elem_index)
+        {
+            const double area = rMesh.GetVolumeOfElement(elem_index);
+            sum += area;
+            sum_of_squares += area * area;
+        }
+        const double mean = sum / rMesh.GetNumElements();
+        return std::sqrt(sum_of_squares / rMesh.GetNumElements() - mean * mean);
+    }
+
+public:
+
+    void TestFastVoronoiVertexMeshGenerator()
+    {
+        FastVoronoiVertexMeshGenerator generator(9, 10, 3, 2.0);
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+
+        // The elements tile the periodic box, so their total area is exact
+        TS_ASSERT_EQUALS(p_mesh->GetNumElements(), 90u);
+        TS_ASSERT_DELTA(generator.GetWidth() * generator.GetHeight(), 180.0, 1e-9);
+        double total_area = 0.0;
+        for (unsigned elem_index = 0; elem_index < p_mesh->GetNumElements(); ++elem_index)
+        {
+            TS_ASSERT_LESS_THAN(0.0, p_mesh->GetVolumeOfElement(elem_index));
+            TS_ASSERT_LESS_THAN_EQUALS(3u, p_mesh->GetElement(elem_index)->GetNumNodes());
+            total_area += p_mesh->GetVolumeOfElement(elem_index);
+        }
+        TS_ASSERT_DELTA(total_area, 180.0, 1e-9);
+
+        // Nodes inside the tissue are shared by three elements, and those on the boundary by fewer
+        unsigned num_boundary_nodes = 0;
+        for (unsigned node_index = 0; node_index < p_mesh->GetNumNodes(); ++node_index)
+        {
+            Node<2>* p_node = p_mesh->GetNode(node_index);
+            const unsigned num_containing_elements = p_node->rGetContainingElementIndices().size();
+            TS_ASSERT_LESS_THAN_EQUALS(num_containing_elements, 3u);
+            TS_ASSERT_EQUALS(p_node->IsBoundaryNode(), num_containing_elements < 3);
+            num_boundary_nodes += p_node->IsBoundaryNode();
+        }
+        TS_ASSERT_LESS_THAN(0u, num_boundary_nodes);
+
+        // The mesh depends only on the arguments, not on the number of threads
+        ThreadedLoop::SetNumThreads(4);
+        FastVoronoiVertexMeshGenerator threaded_generator(9, 10, 3, 2.0);
+        ThreadedLoop::SetNumThreads(0);
+        std::vector<c_vector<double, 2> > locations = GetNodeLocations(*p_mesh);
+        std::vector<c_vector<double, 2> > threaded_locations = GetNodeLocations(*(threaded_generator.GetMesh()));
+        TS_ASSERT_EQUALS(threaded_locations.size(), locations.size());
+        for (unsigned node_index = 0; node_index < std::min(locations.size(), threaded_locations.size()); ++node_index)
+        {
+            TS_ASSERT_EQUALS(threaded_locations[node_index][0], locations[node_index][0]);
+            TS_ASSERT_EQUALS(threaded_locations[node_index][1], locations[node_index][1]);
+        }
+
+        FastVoronoiVertexMeshGenerator reseeded_generator(9, 10, 3, 2.0, FastVoronoiVertexMeshGenerator::JITTERED_HONEYCOMB, 0.3, 1u);
+        TS_ASSERT_DIFFERS(reseeded_generator.rGetSeeds()[0][0], generator.rGetSeeds()[0][0]);
+
+        // Without jitter or relaxation, the elements are regular hexagons
+        FastVoronoiVertexMeshGenerator honeycomb_generator(4, 4, 0, 1.0, FastVoronoiVertexMeshGenerator::JITTERED_HONEYCOMB, 0.0);
+        for (unsigned elem_index = 0; elem_index < 16; ++elem_index)
+        {
+            TS_ASSERT_EQUALS(honeycomb_generator.GetMesh()->GetElement(elem_index)->GetNumNodes(), 6u);
+            TS_ASSERT_DELTA(honeycomb_generator.GetMesh()->GetVolumeOfElement(elem_index), 1.0, 1e-9);
+        }
+
+        // Lloyd relaxation evens out the areas of random Voronoi cells
+        FastVoronoiVertexMeshGenerator random_generator(20, 20, 0, 1.0, FastVoronoiVertexMeshGenerator::UNIFORM_RANDOM);
+        FastVoronoiVertexMeshGenerator relaxed_generator(20, 20, 5, 1.0, FastVoronoiVertexMeshGenerator::UNIFORM_RANDOM);
+        TS_ASSERT_LESS_THAN(GetAreaStandardDeviation(*(relaxed_generator.GetMesh())),
+                            0.5 * GetAreaStandardDeviation(*(random_generator.GetMesh())));
+
+        TS_ASSERT_THROWS_THIS(FastVoronoiVertexMeshGenerator(1, 5, 0), "Need at least 2 by 2 cells");
+        TS_ASSERT_THROWS_THIS(FastVoronoiVertexMeshGenerator(5, 5, 0, -1.0), "Specified target area must be strictly positive");
+        TS_ASSERT_THROWS_THIS(FastVoronoiVertexMeshGenerator(5, 5, 0, 1.0, FastVoronoiVertexMeshGenerator::JITTERED_HONEYCOMB, -0.1),
+                              "The jitter of the seeds must be non-negative");
+    }
+
+    void TestSimulationWithFastVoronoiVertexMesh()
+    {
+        // As in Test01VertexSimulation in TestCustomVertexSimulations, but with a generated mesh
+        FastVoronoiVertexMeshGenerator generator(6, 6, 1);
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(DifferentiatedCellProliferativeType, p_cell_type);
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumElements(), p_cell_type);
+
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        OffLatticeSimulation<2> simulation(cell_population);
+        simulation.SetOutputDirectory("TestSimulationWithFastVoronoiVertexMesh");
+        simulation.SetEndTime(1.0);
+        simulation.SetDt(0.01);
+        simulation.SetSamplingTimestepMultiple(100);
+
+        MAKE_PTR(FarhadifarForce<2>, p_force);
+        simulation.AddForce(p_force);
+
+        TS_ASSERT_THROWS_NOTHING(simulation.Solve());
+        TS_ASSERT_EQUALS(cell_population.GetNumRealCells(), 36u);
+    }
+};
+
+#endif /* TESTPROJECTMESHGENERATORS_HPP_ */
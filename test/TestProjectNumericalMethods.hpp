@@ -0,0 +1,427 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTPROJECTNUMERICALMETHODS_HPP_
+#define TESTPROJECTNUMERICALMETHODS_HPP_
+
+// These first headers relate to the Chaste infrastructure and can be found at the top of every test suite
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "CheckpointArchiveTypes.hpp"
+
+#include <algorithm>
+
+#include "RandomNumberGenerator.hpp"
+#include "SmartPointers.hpp"
+
+#include "VoronoiVertexMeshGenerator.hpp"
+
+#include "Cell.hpp"
+#include "CellLabel.hpp"
+#include "CellsGenerator.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "NoCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+#include "FarhadifarForce.hpp"
+#include "OffLatticeSimulation.hpp"
+#include "RK4NumericalMethod.hpp"
+
+// Custom headers from this user project
+#include "CounterBasedRandomNumberGenerator.hpp"
+#include "LabelPairDifferentialAdhesionForce.hpp"
+#include "MultiRateNumericalMethod.hpp"
+#include "RungeKutta2NumericalMethod.hpp"
+#include "SemiImplicitAreaNumericalMethod.hpp"
+#include "SillyForce.hpp"
+#include "VectorisedForwardEulerNumericalMethod.hpp"
+
+// Finally, we include a header that enforces running this test only on one process
+#include "FakePetscSetup.hpp"
+
+/**
+ * A force that applies nothing, but counts how many times the forces have been evaluated.
+ */
+class ForceEvaluationCounter : public AbstractForce<2>
+{
+private:
+
+    /** The number of calls to AddForceContribution(). */
+    unsigned mNumEvaluations = 0;
+
+    friend class boost::serialization::access;
+    template <class Archive>
+    void serialize(Archive& archive, const unsigned int version)
+    {
+        archive& boost::serialization::base_object<AbstractForce<2> >(*this);
+    }
+
+public:
+
+    void AddForceContribution(AbstractCellPopulation<2>& rCellPopulation)
+    {
+        ++mNumEvaluations;
+    }
+
+    unsigned GetNumEvaluations()
+    {
+        return mNumEvaluations;
+    }
+
+    void OutputForceParameters(out_stream& rParamsFile)
+    {
+        AbstractForce<2>::OutputForceParameters(rParamsFile);
+    }
+};
+
+#include "SerializationExportWrapper.hpp"
+CHASTE_CLASS_EXPORT(ForceEvaluationCounter)
+#include "SerializationExportWrapperForCpp.hpp"
+CHASTE_CLASS_EXPORT(ForceEvaluationCounter)
+
+/**
+ * Tests of the project numerical methods, run on the scenarios from TestCustomVertexSimulations.
+ */
+class TestProjectNumericalMethods : public AbstractCellBasedTestSuite
+{
+private:
+
+    /** Summary of the end state of a scenario. */
+    struct ScenarioResult
+    {
+        /** The node locations. */
+        std::vector<c_vector<double, 2> > locations;
+
+        /** The mean area of the cells. */
+        double meanArea = 0.0;
+
+        /** The root mean square distance of the nodes from their centroid, which is unaffected by rotation. */
+        double radiusOfGyration = 0.0;
+
+        /** The number of times the forces were evaluated. */
+        unsigned numForceEvaluations = 0;
+    };
+
+    /**
+     * Run a shortened version of Test01Relaxation, or of Test05CustomForce if requested.
+     *
+     * @param pMethod the numerical method to use, or nullptr for the Chaste default (forward Euler)
+     * @param outputDirectory the output directory
+     * @param endTime the end time of the simulation
+     * @param dt the time step
+     * @param customForce whether to run the Test05CustomForce scenario
+     * @return a summary of the end state
+     */
+    ScenarioResult RunScenario(boost::shared_ptr<AbstractNumericalMethod<2, 2> > pMethod,
+                               const std::string& outputDirectory,
+                               double endTime,
+                               double dt,
+                               bool customForce=false)
+    {
+        SimulationTime::Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+        RandomNumberGenerator::Instance()->Reseed(1);
+
+        VoronoiVertexMeshGenerator generator(customForce ? 9 : 6, customForce ? 9 : 6, customForce ? 2 : 1);
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+        p_mesh->SetDistanceForT3SwapChecking(1.0);
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(DifferentiatedCellProliferativeType, p_cell_type);
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumElements(), p_cell_type);
+
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        OffLatticeSimulation<2> simulation(cell_population);
+        simulation.SetOutputDirectory(outputDirectory);
+        simulation.SetEndTime(endTime);
+        simulation.SetDt(dt);
+        simulation.SetSamplingTimestepMultiple(100);
+
+        MAKE_PTR(FarhadifarForce<2>, p_force);
+        if (!customForce)
+        {
+            p_force->SetAreaElasticityParameter(1.0);
+            p_force->SetPerimeterContractilityParameter(0.04);
+            p_force->SetLineTensionParameter(0.12);
+            p_force->SetBoundaryLineTensionParameter(0.12);
+        }
+        simulation.AddForce(p_force);
+
+        if (customForce)
+        {
+            MAKE_PTR(SillyForce<2>, p_silly_force);
+            p_silly_force->SetStrengthMultiplier(0.15);
+            simulation.AddForce(p_silly_force);
+        }
+
+        MAKE_PTR(ForceEvaluationCounter, p_counter);
+        simulation.AddForce(p_counter);
+
+        if (pMethod)
+        {
+            simulation.SetNumericalMethod(pMethod);
+        }
+
+        simulation.Solve();
+
+        ScenarioResult result;
+        result.numForceEvaluations = p_counter->GetNumEvaluations();
+
+        c_vector<double, 2> centroid = zero_vector<double>(2);
+        for (unsigned i = 0; i < cell_population.GetNumNodes(); ++i)
+        {
+            result.locations.push_back(cell_population.GetNode(i)->rGetLocation());
+            centroid += result.locations.back();
+        }
+        centroid /= result.locations.size();
+
+        for (const auto& r_location : result.locations)
+        {
+            result.radiusOfGyration += inner_prod(r_location - centroid, r_location - centroid);
+        }
+        result.radiusOfGyration = sqrt(result.radiusOfGyration / result.locations.size());
+
+        for (auto elem_iter = p_mesh->GetElementIteratorBegin(); elem_iter != p_mesh->GetElementIteratorEnd(); ++elem_iter)
+        {
+            result.meanArea += p_mesh->GetVolumeOfElement(elem_iter->GetIndex());
+        }
+        result.meanArea /= p_mesh->GetNumElements();
+
+        return result;
+    }
+
+    /**
+     * Run a shortened version of Test03CellSorting, using LabelPairDifferentialAdhesionForce.
+     *
+     * @param pMethod the numerical method to use, or nullptr for the Chaste default (forward Euler)
+     * @param outputDirectory the output directory
+     * @param endTime the end time of the simulation
+     * @return a summary of the end state; the number of force evaluations is not recorded
+     */
+    ScenarioResult RunCellSortingScenario(boost::shared_ptr<AbstractNumericalMethod<2, 2> > pMethod,
+                                          const std::string& outputDirectory,
+                                          double endTime)
+    {
+        SimulationTime::Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+        RandomNumberGenerator::Instance()->Reseed(1);
+
+        VoronoiVertexMeshGenerator generator(9, 9, 1);
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+        p_mesh->SetDistanceForT3SwapChecking(1.0);
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(DifferentiatedCellProliferativeType, p_cell_type);
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumElements(), p_cell_type);
+
+        MAKE_PTR(CellLabel, p_cell_label);
+        CounterBasedRandomNumberGenerator::Instance()->LabelCells(cells, p_cell_label, 0.5);
+
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        OffLatticeSimulation<2> simulation(cell_population);
+        simulation.SetOutputDirectory(outputDirectory);
+        simulation.SetEndTime(endTime);
+        simulation.SetDt(0.01);
+        simulation.SetSamplingTimestepMultiple(100);
+
+        MAKE_PTR(LabelPairDifferentialAdhesionForce<2>, p_force);
+        p_force->SetNagaiHondaDeformationEnergyParameter(55.0);
+        p_force->SetNagaiHondaMembraneSurfaceEnergyParameter(0.0);
+        p_force->SetNagaiHondaCellCellAdhesionEnergyParameter(1.0);
+        p_force->SetNagaiHondaLabelledCellCellAdhesionEnergyParameter(6.0);
+        p_force->SetNagaiHondaLabelledCellLabelledCellAdhesionEnergyParameter(3.0);
+        p_force->SetNagaiHondaCellBoundaryAdhesionEnergyParameter(12.0);
+        p_force->SetNagaiHondaLabelledCellBoundaryAdhesionEnergyParameter(40.0);
+        simulation.AddForce(p_force);
+
+        if (pMethod)
+        {
+            simulation.SetNumericalMethod(pMethod);
+        }
+
+        simulation.Solve();
+
+        ScenarioResult result;
+
+        c_vector<double, 2> centroid = zero_vector<double>(2);
+        for (unsigned i = 0; i < cell_population.GetNumNodes(); ++i)
+        {
+            result.locations.push_back(cell_population.GetNode(i)->rGetLocation());
+            centroid += result.locations.back();
+        }
+        centroid /= result.locations.size();
+
+        for (const auto& r_location : result.locations)
+        {
+            result.radiusOfGyration += inner_prod(r_location - centroid, r_location - centroid);
+        }
+        result.radiusOfGyration = sqrt(result.radiusOfGyration / result.locations.size());
+
+        for (auto elem_iter = p_mesh->GetElementIteratorBegin(); elem_iter != p_mesh->GetElementIteratorEnd(); ++elem_iter)
+        {
+            result.meanArea += p_mesh->GetVolumeOfElement(elem_iter->GetIndex());
+        }
+        result.meanArea /= p_mesh->GetNumElements();
+
+        return result;
+    }
+
+public:
+
+    void TestVectorisedForwardEulerMatchesForwardEuler()
+    {
+        std::vector<c_vector<double, 2> > reference = RunScenario(nullptr, "TestVectorisedForwardEuler/Reference", 10.0, 0.01).locations;
+
+        MAKE_PTR(VectorisedForwardEulerNumericalMethod<2>, p_method);
+        std::vector<c_vector<double, 2> > vectorised = RunScenario(p_method, "TestVectorisedForwardEuler/Vectorised", 10.0, 0.01).locations;
+
+        // The results must be identical, not just close
+        TS_ASSERT_EQUALS(vectorised.size(), reference.size());
+        for (unsigned i = 0; i < std::min(vectorised.size(), reference.size()); ++i)
+        {
+            TS_ASSERT_EQUALS(vectorised[i][0], reference[i][0]);
+            TS_ASSERT_EQUALS(vectorised[i][1], reference[i][1]);
+        }
+    }
+
+    void TestVectorisedForwardEulerSinglePrecision()
+    {
+        ScenarioResult reference = RunScenario(nullptr, "TestVectorisedForwardEulerSinglePrecision/Reference", 10.0, 0.01);
+
+        MAKE_PTR(VectorisedForwardEulerNumericalMethod<2>, p_method);
+        p_method->SetUseSinglePrecision(true);
+        TS_ASSERT_EQUALS(p_method->GetUseSinglePrecision(), true);
+        ScenarioResult single = RunScenario(p_method, "TestVectorisedForwardEulerSinglePrecision/Single", 10.0, 0.01);
+
+        double max_distance = 0.0;
+        TS_ASSERT_EQUALS(single.locations.size(), reference.locations.size());
+        for (unsigned i = 0; i < std::min(single.locations.size(), reference.locations.size()); ++i)
+        {
+            max_distance = std::max(max_distance, norm_2(single.locations[i] - reference.locations[i]));
+        }
+        std::cout << "Single precision relaxation: largest node distance from double precision " << max_distance << "\n";
+
+        // Rounding each location to single precision must not change the relaxed state
+        TS_ASSERT_LESS_THAN(max_distance, 1e-3);
+        TS_ASSERT_DELTA(single.meanArea, reference.meanArea, 1e-4 * reference.meanArea);
+        TS_ASSERT_DELTA(single.radiusOfGyration, reference.radiusOfGyration, 1e-4 * reference.radiusOfGyration);
+    }
+
+    void TestLargerTimeStepsReachSameEndState()
+    {
+        for (bool custom_force : {false, true})
+        {
+            const std::string directory = custom_force ? "TestLargerTimeSteps/CustomForce/" : "TestLargerTimeSteps/Relaxation/";
+
+            // The reference is forward Euler at the time step used in TestCustomVertexSimulations
+            ScenarioResult reference = RunScenario(nullptr, directory + "ForwardEuler", 10.0, 0.01, custom_force);
+
+            MAKE_PTR(RungeKutta2NumericalMethod<2>, p_rk2);
+            ScenarioResult rk2 = RunScenario(p_rk2, directory + "RungeKutta2", 10.0, 0.05, custom_force);
+
+            MAKE_PTR(RK4NumericalMethod<2>, p_rk4);
+            ScenarioResult rk4 = RunScenario(p_rk4, directory + "RungeKutta4", 10.0, 0.1, custom_force);
+
+            MAKE_PTR(SemiImplicitAreaNumericalMethod<2>, p_semi_implicit);
+            ScenarioResult semi_implicit = RunScenario(p_semi_implicit, directory + "SemiImplicitArea", 10.0, 0.05, custom_force);
+
+            std::cout << directory << " force evaluations (mean area, radius of gyration):\n"
+                      << "  forward Euler     " << reference.numForceEvaluations << " (" << reference.meanArea << ", " << reference.radiusOfGyration << ")\n"
+                      << "  RK2               " << rk2.numForceEvaluations << " (" << rk2.meanArea << ", " << rk2.radiusOfGyration << ")\n"
+                      << "  RK4               " << rk4.numForceEvaluations << " (" << rk4.meanArea << ", " << rk4.radiusOfGyration << ")\n"
+                      << "  semi-implicit     " << semi_implicit.numForceEvaluations << " (" << semi_implicit.meanArea << ", " << semi_implicit.radiusOfGyration << ")\n";
+
+            for (const ScenarioResult& r_result : {rk2, rk4, semi_implicit})
+            {
+                TS_ASSERT_LESS_THAN(2 * r_result.numForceEvaluations, reference.numForceEvaluations);
+                TS_ASSERT_DELTA(r_result.meanArea, reference.meanArea, 0.02 * reference.meanArea);
+                TS_ASSERT_DELTA(r_result.radiusOfGyration, reference.radiusOfGyration, 0.02 * reference.radiusOfGyration);
+            }
+        }
+    }
+
+    void TestMultiRateNumericalMethod()
+    {
+        // A force that cannot be evaluated on a subset of nodes reduces the method to forward Euler
+        std::vector<c_vector<double, 2> > reference = RunScenario(nullptr, "TestMultiRateNumericalMethod/ForwardEuler", 2.0, 0.01).locations;
+
+        MAKE_PTR(MultiRateNumericalMethod<2>, p_fallback_method);
+        std::vector<c_vector<double, 2> > fallback = RunScenario(p_fallback_method, "TestMultiRateNumericalMethod/Fallback", 2.0, 0.01).locations;
+
+        TS_ASSERT_EQUALS(fallback.size(), reference.size());
+        for (unsigned i = 0; i < std::min(fallback.size(), reference.size()); ++i)
+        {
+            TS_ASSERT_EQUALS(fallback[i][0], reference[i][0]);
+            TS_ASSERT_EQUALS(fallback[i][1], reference[i][1]);
+        }
+        TS_ASSERT_EQUALS(p_fallback_method->GetSyncInterval(), 1u);
+        TS_ASSERT_EQUALS(p_fallback_method->GetNumFullEvaluations(), 200u);
+        TS_ASSERT_EQUALS(p_fallback_method->GetNumNodeForceEvaluations(), p_fallback_method->GetNumNodeUpdates());
+
+        // Cell sorting, in which every force can be evaluated on a subset of nodes
+        ScenarioResult sorting_reference = RunCellSortingScenario(nullptr, "TestMultiRateNumericalMethod/CellSortingForwardEuler", 10.0);
+
+        MAKE_PTR(MultiRateNumericalMethod<2>, p_method);
+        p_method->SetSyncInterval(100);
+        ScenarioResult multi_rate = RunCellSortingScenario(p_method, "TestMultiRateNumericalMethod/CellSortingMultiRate", 10.0);
+
+        std::cout << "Cell sorting, node force evaluations (mean area, radius of gyration):\n"
+                  << "  forward Euler     " << p_method->GetNumNodeUpdates() << " (" << sorting_reference.meanArea << ", " << sorting_reference.radiusOfGyration << ")\n"
+                  << "  multi-rate        " << p_method->GetNumNodeForceEvaluations() << " (" << multi_rate.meanArea << ", " << multi_rate.radiusOfGyration << ")\n";
+
+        TS_ASSERT_LESS_THAN(p_method->GetNumNodeForceEvaluations(), p_method->GetNumNodeUpdates());
+        TS_ASSERT_LESS_THAN_EQUALS(125u, p_method->GetNumFullEvaluations());
+        TS_ASSERT_DELTA(multi_rate.meanArea, sorting_reference.meanArea, 0.02 * sorting_reference.meanArea);
+        TS_ASSERT_DELTA(multi_rate.radiusOfGyration, sorting_reference.radiusOfGyration, 0.02 * sorting_reference.radiusOfGyration);
+
+        const std::vector<unsigned char>& r_rate_classes = p_method->rGetRateClasses();
+        TS_ASSERT_EQUALS(r_rate_classes.size(), multi_rate.locations.size());
+        TS_ASSERT_LESS_THAN(*std::max_element(r_rate_classes.begin(), r_rate_classes.end()), 4u);
+
+        TS_ASSERT_THROWS_THIS(p_method->SetNumRateClasses(0), "The number of rate classes must be between 1 and 16");
+        TS_ASSERT_THROWS_THIS(p_method->SetQuiescentSpeed(-1.0), "The quiescent speed must be non-negative");
+
+        // Left at its default sync interval, the method would silently be forward Euler, so refuses to run
+        MAKE_PTR(MultiRateNumericalMethod<2>, p_unsynced_method);
+        TS_ASSERT_THROWS_CONTAINS(RunCellSortingScenario(p_unsynced_method, "TestMultiRateNumericalMethod/Unsynced", 0.1),
+                                  "MultiRateNumericalMethod would evaluate every force on every step with a sync interval of 1");
+    }
+};
+
+#endif /* TESTPROJECTNUMERICALMETHODS_HPP_ */
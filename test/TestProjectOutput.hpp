@@ -0,0 +1,687 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTPROJECTOUTPUT_HPP_
+#define TESTPROJECTOUTPUT_HPP_
+
+// These first headers relate to the Chaste infrastructure and can be found at the top of every test suite
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "CheckpointArchiveTypes.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <unistd.h>
+
+#include "FileFinder.hpp"
+#include "OutputFileHandler.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "SmartPointers.hpp"
+
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "VoronoiVertexMeshGenerator.hpp"
+
+#include "Cell.hpp"
+#include "CellLabel.hpp"
+#include "CellsGenerator.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "NoCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+#include "FarhadifarForce.hpp"
+#include "NagaiHondaDifferentialAdhesionForce.hpp"
+#include "OffLatticeSimulation.hpp"
+
+// Custom headers from this user project
+#include "AppendedVtuWriter.hpp"
+#include "CounterBasedRandomNumberGenerator.hpp"
+#include "NodeTrajectoryOutputModifier.hpp"
+#include "NodeTrajectoryReader.hpp"
+#include "NodeTrajectoryWriter.hpp"
+#include "ParallelVtuOutputModifier.hpp"
+#include "SharedMemoryExportModifier.hpp"
+#include "SharedMemoryTissueReader.hpp"
+#include "SharedMemoryTissueWriter.hpp"
+#include "ThreadedLoop.hpp"
+
+#ifdef CHASTE_VTK
+#define _BACKWARD_BACKWARD_WARNING_H 1 //Cut out the vtk deprecated warning
+#include <vtkSmartPointer.h>
+#include <vtkZLibDataCompressor.h>
+#endif //CHASTE_VTK
+
+// Finally, we include a header that enforces running this test only on one process
+#include "FakePetscSetup.hpp"
+
+/**
+ * Read a data array from an appended VTU file, as written by AppendedVtuWriter, decompressing it if necessary.
+ *
+ * @param rContents the contents of the file
+ * @param rName the name of the array, or empty for the point coordinates
+ * @return the values of the array
+ */
+template <typename T>
+std::vector<T> ReadAppendedArray(const std::string& rContents, const std::string& rName)
+{
+    const std::size_t name_position = rContents.find(rName.empty() ? "<Points>" : "Name=\"" + rName + "\"");
+    const std::size_t offset_position = rContents.find("offset=\"", name_position) + 8;
+    const std::size_t offset = std::stoul(rContents.substr(offset_position, rContents.find('"', offset_position) - offset_position));
+    const std::size_t data_start = rContents.find('_', rContents.find("<AppendedData")) + 1;
+    const char* p_header = rContents.data() + data_start + offset;
+
+    std::vector<char> bytes;
+    if (rContents.find("compressor=\"vtkZLibDataCompressor\"") == std::string::npos)
+    {
+        uint64_t num_bytes;
+        memcpy(&num_bytes, p_header, sizeof(num_bytes));
+        bytes.assign(p_header + sizeof(num_bytes), p_header + sizeof(num_bytes) + num_bytes);
+    }
+    else
+    {
+#ifdef CHASTE_VTK
+        // The header gives the number of blocks, the size of a full block and of the last block, and the compressed
+        // size of each block
+        uint64_t sizes[3];
+        memcpy(sizes, p_header, sizeof(sizes));
+        std::vector<uint64_t> compressed_sizes(sizes[0]);
+        memcpy(compressed_sizes.data(), p_header + sizeof(sizes), sizes[0] * sizeof(uint64_t));
+        const unsigned char* p_block = reinterpret_cast<const unsigned char*>(p_header + sizeof(sizes) + sizes[0] * sizeof(uint64_t));
+
+        vtkSmartPointer<vtkZLibDataCompressor> p_compressor = vtkSmartPointer<vtkZLibDataCompressor>::New();
+        for (uint64_t block = 0; block < sizes[0]; ++block)
+        {
+            const uint64_t block_size = (block + 1 == sizes[0] && sizes[2] != 0) ? sizes[2] : sizes[1];
+            const std::size_t start = bytes.size();
+            bytes.resize(start + block_size);
+            p_compressor->Uncompress(p_block, compressed_sizes[block],
+                                     reinterpret_cast<unsigned char*>(bytes.data() + start), block_size);
+            p_block += compressed_sizes[block];
+        }
+#endif //CHASTE_VTK
+    }
+
+    std::vector<T> values(bytes.size() / sizeof(T));
+    memcpy(values.data(), bytes.data(), bytes.size());
+    return values;
+}
+
+/**
+ * A modifier that holds a simulation at the end of its first time step until a reader on another thread has read a
+ * frame, so that the reader is known to follow the simulation from its start.
+ */
+class ReaderGateModifier : public AbstractCellBasedSimulationModifier<2, 2>
+{
+private:
+
+    /** Set by the reader once it has read a frame. */
+    std::atomic<bool>* mpReaderReady = nullptr;
+
+    /** Whether the reader was ready before the time out. */
+    bool mReaderWasReady = false;
+
+    friend class boost::serialization::access;
+    template <class Archive>
+    void serialize(Archive& archive, const unsigned int version)
+    {
+        archive& boost::serialization::base_object<AbstractCellBasedSimulationModifier<2, 2> >(*this);
+    }
+
+public:
+
+    ReaderGateModifier(std::atomic<bool>* pReaderReady = nullptr)
+        : mpReaderReady(pReaderReady)
+    {
+    }
+
+    bool GetReaderWasReady() const
+    {
+        return mReaderWasReady;
+    }
+
+    void UpdateAtEndOfTimeStep(AbstractCellPopulation<2, 2>& rCellPopulation)
+    {
+        if (SimulationTime::Instance()->GetTimeStepsElapsed() != 1u)
+        {
+            return;
+        }
+
+        // Time out rather than hang if the reader never manages to open the segment
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (!*mpReaderReady && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        mReaderWasReady = *mpReaderReady;
+    }
+
+    void SetupSolve(AbstractCellPopulation<2, 2>& rCellPopulation, std::string outputDirectory)
+    {
+    }
+
+    void OutputSimulationModifierParameters(out_stream& rParamsFile)
+    {
+        AbstractCellBasedSimulationModifier<2, 2>::OutputSimulationModifierParameters(rParamsFile);
+    }
+};
+
+#include "SerializationExportWrapper.hpp"
+CHASTE_CLASS_EXPORT(ReaderGateModifier)
+#include "SerializationExportWrapperForCpp.hpp"
+CHASTE_CLASS_EXPORT(ReaderGateModifier)
+
+/**
+ * Tests of the project output classes.
+ */
+class TestProjectOutput : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestNodeTrajectoryWriterAndReader()
+    {
+        OutputFileHandler handler("TestNodeTrajectoryWriterAndReader");
+        const std::string file_path = handler.GetOutputDirectoryFullPath() + "nodetrajectory.ctrj";
+        const double quantum = 1e-6;
+
+        // Nodes drift slowly, and two nodes are added after the 13th sample
+        std::vector<std::vector<double> > samples;
+        std::vector<double> coordinates(2 * 100);
+        for (double& r_coordinate : coordinates)
+        {
+            r_coordinate = 10.0 * RandomNumberGenerator::Instance()->ranf();
+        }
+        for (unsigned sample = 0; sample < 25; ++sample)
+        {
+            if (sample == 13)
+            {
+                coordinates.insert(coordinates.end(), {1.5, 2.5, -3.5, 4.5});
+            }
+            for (double& r_coordinate : coordinates)
+            {
+                r_coordinate += 1e-3 * (RandomNumberGenerator::Instance()->ranf() - 0.5);
+            }
+            samples.push_back(coordinates);
+        }
+
+        {
+            NodeTrajectoryWriter writer(file_path, 2, 5, quantum);
+            for (unsigned sample = 0; sample < samples.size(); ++sample)
+            {
+                writer.WriteSample(0.1 * sample, samples[sample]);
+            }
+            TS_ASSERT_EQUALS(writer.GetNumSamples(), 25u);
+
+            // Deltas of a few hundred quanta take two bytes, rather than the eight of a double
+            TS_ASSERT_LESS_THAN(writer.GetNumBytesWritten(), 25u * 204u * 8u / 2u);
+        }
+
+        NodeTrajectoryReader reader(file_path);
+        TS_ASSERT_EQUALS(reader.GetSpaceDimension(), 2u);
+        TS_ASSERT_DELTA(reader.GetQuantum(), quantum, 1e-12);
+        TS_ASSERT_EQUALS(reader.GetNumSamples(), 25u);
+
+        // Keyframes every 5 samples, restarting when the number of nodes changes
+        TS_ASSERT_EQUALS(reader.GetNumKeyframes(), 6u);
+        TS_ASSERT_EQUALS(reader.GetKeyframeSample(2), 10u);
+        TS_ASSERT_EQUALS(reader.GetKeyframeSample(3), 13u);
+        TS_ASSERT_EQUALS(reader.GetKeyframeSample(4), 18u);
+        TS_ASSERT_DELTA(reader.GetKeyframeTime(3), 1.3, 1e-12);
+
+        // Read the samples out of order, to exercise random access
+        std::vector<double> read_coordinates;
+        for (unsigned sample : {24u, 0u, 12u, 13u, 7u, 17u})
+        {
+            TS_ASSERT_DELTA(reader.ReadSample(sample, read_coordinates), 0.1 * sample, 1e-12);
+            TS_ASSERT_EQUALS(read_coordinates.size(), samples[sample].size());
+            for (unsigned i = 0; i < read_coordinates.size(); ++i)
+            {
+                TS_ASSERT_DELTA(read_coordinates[i], samples[sample][i], 0.5 * quantum + 1e-12);
+            }
+        }
+        TS_ASSERT_THROWS_CONTAINS(reader.ReadSample(25, read_coordinates), "with 25 samples");
+    }
+
+    void TestNodeTrajectoryOutputModifier()
+    {
+        RandomNumberGenerator::Instance()->Reseed(1);
+        VoronoiVertexMeshGenerator generator(6, 6, 1);
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+        p_mesh->SetDistanceForT3SwapChecking(1.0);
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(DifferentiatedCellProliferativeType, p_cell_type);
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumElements(), p_cell_type);
+
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        OffLatticeSimulation<2> simulation(cell_population);
+        simulation.SetOutputDirectory("TestNodeTrajectoryOutputModifier");
+        simulation.SetEndTime(2.0);
+        simulation.SetDt(0.01);
+        simulation.SetSamplingTimestepMultiple(10);
+
+        MAKE_PTR(FarhadifarForce<2>, p_force);
+        simulation.AddForce(p_force);
+
+        MAKE_PTR(NodeTrajectoryOutputModifier<2>, p_modifier);
+        p_modifier->SetKeyframeInterval(8);
+        TS_ASSERT_EQUALS(p_modifier->GetKeyframeInterval(), 8u);
+        TS_ASSERT_DELTA(p_modifier->GetQuantum(), 1e-6, 1e-12);
+        simulation.AddSimulationModifier(p_modifier);
+
+        simulation.Solve();
+
+        FileFinder trajectory_file("TestNodeTrajectoryOutputModifier/nodetrajectory.ctrj", RelativeTo::ChasteTestOutput);
+        TS_ASSERT(trajectory_file.Exists());
+
+        // One sample at the start, then one per output time step
+        NodeTrajectoryReader reader(trajectory_file.GetAbsolutePath());
+        TS_ASSERT_EQUALS(reader.GetNumSamples(), 21u);
+        TS_ASSERT_EQUALS(reader.GetNumKeyframes(), 3u);
+
+        // The last sample matches the final node locations to within half a quantum
+        std::vector<double> coordinates;
+        TS_ASSERT_DELTA(reader.ReadSample(20, coordinates), 2.0, 1e-12);
+        TS_ASSERT_EQUALS(coordinates.size(), 2 * p_mesh->GetNumNodes());
+        unsigned coordinate = 0;
+        for (auto node_iter = p_mesh->GetNodeIteratorBegin(); node_iter != p_mesh->GetNodeIteratorEnd(); ++node_iter)
+        {
+            TS_ASSERT_DELTA(coordinates[coordinate++], node_iter->rGetLocation()[0], 0.5e-6 + 1e-12);
+            TS_ASSERT_DELTA(coordinates[coordinate++], node_iter->rGetLocation()[1], 0.5e-6 + 1e-12);
+        }
+    }
+
+    void TestParallelVtuOutputModifier()
+    {
+        RandomNumberGenerator::Instance()->Reseed(1);
+        VoronoiVertexMeshGenerator generator(6, 6, 1);
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+        p_mesh->SetDistanceForT3SwapChecking(1.0);
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(DifferentiatedCellProliferativeType, p_cell_type);
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumElements(), p_cell_type);
+
+        MAKE_PTR(CellLabel, p_cell_label);
+        for (unsigned i = 0; i < cells.size(); i += 3)
+        {
+            cells[i]->AddCellProperty(p_cell_label);
+        }
+
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        OffLatticeSimulation<2> simulation(cell_population);
+        simulation.SetOutputDirectory("TestParallelVtuOutputModifier");
+        simulation.SetEndTime(0.5);
+        simulation.SetDt(0.01);
+        simulation.SetSamplingTimestepMultiple(10);
+
+        MAKE_PTR(FarhadifarForce<2>, p_force);
+        simulation.AddForce(p_force);
+
+        // Write uncompressed files, so that they can be checked here, using several threads
+        MAKE_PTR(ParallelVtuOutputModifier<2>, p_modifier);
+        p_modifier->SetCompress(false);
+        TS_ASSERT_EQUALS(p_modifier->GetCompress(), false);
+        simulation.AddSimulationModifier(p_modifier);
+
+        ThreadedLoop::SetNumThreads(3);
+        simulation.Solve();
+        ThreadedLoop::SetNumThreads(0);
+
+        // The PVD file lists one file at the start and one per output time step
+        FileFinder pvd_file("TestParallelVtuOutputModifier/mesh.pvd", RelativeTo::ChasteTestOutput);
+        std::ifstream pvd_stream(pvd_file.GetAbsolutePath());
+        const std::string pvd_contents((std::istreambuf_iterator<char>(pvd_stream)), std::istreambuf_iterator<char>());
+        TS_ASSERT_DIFFERS(pvd_contents.find("timestep=\"0\" group=\"\" part=\"0\" file=\"mesh_0.vtu\""), std::string::npos);
+        TS_ASSERT_DIFFERS(pvd_contents.find("timestep=\"0.5\" group=\"\" part=\"0\" file=\"mesh_50.vtu\""), std::string::npos);
+
+        FileFinder vtu_file("TestParallelVtuOutputModifier/mesh_50.vtu", RelativeTo::ChasteTestOutput);
+        std::ifstream vtu_stream(vtu_file.GetAbsolutePath(), std::ios::binary);
+        const std::string vtu_contents((std::istreambuf_iterator<char>(vtu_stream)), std::istreambuf_iterator<char>());
+        TS_ASSERT_DIFFERS(vtu_contents.find("NumberOfPoints=\"" + std::to_string(p_mesh->GetNumNodes()) + "\" NumberOfCells=\"36\""),
+                          std::string::npos);
+
+        // The cell data match the final state of the cell population
+        const std::vector<double> volumes = ReadAppendedArray<double>(vtu_contents, "Cell volumes");
+        const std::vector<int32_t> labels = ReadAppendedArray<int32_t>(vtu_contents, "Cell labels");
+        const std::vector<int64_t> offsets = ReadAppendedArray<int64_t>(vtu_contents, "offsets");
+        TS_ASSERT_EQUALS(volumes.size(), 36u);
+        TS_ASSERT_EQUALS(labels.size(), 36u);
+
+        unsigned i = 0;
+        for (auto cell_iter = cell_population.Begin(); cell_iter != cell_population.End(); ++cell_iter, ++i)
+        {
+            const unsigned element_index = cell_population.GetLocationIndexUsingCell(*cell_iter);
+            TS_ASSERT_DELTA(volumes[i], p_mesh->GetVolumeOfElement(element_index), 1e-12);
+            TS_ASSERT_EQUALS(labels[i], cell_iter->HasCellProperty<CellLabel>() ? static_cast<int32_t>(p_cell_label->GetColour()) : 0);
+            TS_ASSERT_EQUALS(offsets[i] - (i == 0 ? 0 : offsets[i - 1]),
+                             static_cast<int64_t>(p_mesh->GetElement(element_index)->GetNumNodes()));
+        }
+
+        // Compression is used by default whenever Chaste was built with VTK
+        AppendedVtuWriter writer;
+        TS_ASSERT_EQUALS(writer.IsCompressing(), AppendedVtuWriter::IsCompressionAvailable());
+        TS_ASSERT_THROWS_THIS(writer.Write(vtu_file.GetAbsolutePath()),
+                              "SetPoints() and SetPolygons() must be called before writing a VTU file");
+    }
+
+    void TestParallelVtuOutputModifierOnSeveralThreads()
+    {
+        // A tissue large enough for the point coordinates to span several compression blocks
+        HoneycombVertexMeshGenerator generator(40, 40);
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(DifferentiatedCellProliferativeType, p_cell_type);
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumElements(), p_cell_type);
+
+        MAKE_PTR(CellLabel, p_cell_label);
+        for (unsigned i = 0; i < cells.size(); i += 3)
+        {
+            cells[i]->AddCellProperty(p_cell_label);
+        }
+
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        // Write the initial mesh uncompressed on one thread, then compressed on four threads with every loop split
+        std::vector<std::string> contents;
+        for (bool on_threads : {false, true})
+        {
+            MAKE_PTR(ParallelVtuOutputModifier<2>, p_modifier);
+            p_modifier->SetCompress(on_threads);
+            if (on_threads)
+            {
+                p_modifier->SetMinCellsPerThread(1);
+            }
+            TS_ASSERT_EQUALS(p_modifier->GetMinCellsPerThread(), on_threads ? 1u : 1024u);
+
+            const std::string directory = on_threads ? "TestParallelVtuOutputModifierOnSeveralThreads/threaded"
+                                                     : "TestParallelVtuOutputModifierOnSeveralThreads/serial";
+            ThreadedLoop::SetNumThreads(on_threads ? 4 : 1);
+            p_modifier->SetupSolve(cell_population, directory);
+            ThreadedLoop::SetNumThreads(0);
+
+            FileFinder vtu_file(directory + "/mesh_0.vtu", RelativeTo::ChasteTestOutput);
+            std::ifstream vtu_stream(vtu_file.GetAbsolutePath(), std::ios::binary);
+            contents.emplace_back((std::istreambuf_iterator<char>(vtu_stream)), std::istreambuf_iterator<char>());
+        }
+
+        const bool compressed = (contents[1].find("compressor=\"vtkZLibDataCompressor\"") != std::string::npos);
+        TS_ASSERT_EQUALS(compressed, AppendedVtuWriter::IsCompressionAvailable());
+        TS_ASSERT_DIFFERS(contents[1].find("NumberOfCells=\"1600\""), std::string::npos);
+
+        // Both files hold the same data
+        const std::vector<double> points = ReadAppendedArray<double>(contents[0], "");
+        TS_ASSERT_EQUALS(points.size(), 3 * p_mesh->GetNumNodes());
+        TS_ASSERT_LESS_THAN(AppendedVtuWriter::BLOCK_SIZE, points.size() * sizeof(double));
+        TS_ASSERT_EQUALS(ReadAppendedArray<double>(contents[1], ""), points);
+        for (const std::string name : {"connectivity", "offsets"})
+        {
+            TS_ASSERT_EQUALS(ReadAppendedArray<int64_t>(contents[1], name), ReadAppendedArray<int64_t>(contents[0], name));
+        }
+        TS_ASSERT_EQUALS(ReadAppendedArray<double>(contents[1], "Cell volumes"), ReadAppendedArray<double>(contents[0], "Cell volumes"));
+        for (const std::string name : {"Cell labels", "Cell types"})
+        {
+            const std::vector<int32_t> values = ReadAppendedArray<int32_t>(contents[0], name);
+            TS_ASSERT_EQUALS(values.size(), 1600u);
+            TS_ASSERT_EQUALS(ReadAppendedArray<int32_t>(contents[1], name), values);
+        }
+    }
+
+    void TestSharedMemoryTissueWriterAndReader()
+    {
+        const std::string name = "/TestSharedMemoryTissue_" + std::to_string(getpid());
+
+        // Three triangles sharing a central node, published six times into a ring of four slots
+        SharedMemoryTissueWriter writer(name, 2, 4, 4, 3, 9);
+        SharedMemoryTissueReader reader(name);
+        TS_ASSERT_EQUALS(reader.GetSpaceDimension(), 2u);
+        TS_ASSERT_EQUALS(reader.GetNumSlots(), 4u);
+        TS_ASSERT_EQUALS(reader.GetNumFramesPublished(), 0u);
+
+        SharedMemoryTissueReader::Frame frame;
+        TS_ASSERT_EQUALS(reader.ReadLatestFrame(frame), false);
+
+        for (unsigned frame_index = 0; frame_index < 6; ++frame_index)
+        {
+            SharedMemoryTissueWriter::FrameBuffers buffers;
+            TS_ASSERT(writer.BeginFrame(0.1 * frame_index, 4, 3, 9, buffers));
+            for (unsigned i = 0; i < 8; ++i)
+            {
+                buffers.mpNodeLocations[i] = frame_index + 0.5 * i;
+            }
+            for (unsigned element = 0; element < 3; ++element)
+            {
+                buffers.mpCellVolumes[element] = 1.0 + element + frame_index;
+                buffers.mpCellLabels[element] = element % 2;
+                buffers.mpElementOffsets[element] = 3 * element;
+                buffers.mpElementNodes[3 * element] = 0;
+                buffers.mpElementNodes[3 * element + 1] = 1 + element;
+                buffers.mpElementNodes[3 * element + 2] = 1 + (element + 1) % 3;
+            }
+            buffers.mpElementOffsets[3] = 9;
+            writer.EndFrame();
+        }
+        TS_ASSERT_EQUALS(writer.GetNumFramesPublished(), 6u);
+        TS_ASSERT_EQUALS(reader.GetNumFramesPublished(), 6u);
+
+        // The first two frames have been overwritten, and the seventh has not been published
+        TS_ASSERT_EQUALS(reader.ReadFrame(0, frame), false);
+        TS_ASSERT_EQUALS(reader.ReadFrame(1, frame), false);
+        TS_ASSERT_EQUALS(reader.ReadFrame(6, frame), false);
+        TS_ASSERT(reader.ReadFrame(2, frame));
+        TS_ASSERT_DELTA(frame.mTime, 0.2, 1e-12);
+
+        TS_ASSERT(reader.ReadLatestFrame(frame));
+        TS_ASSERT_EQUALS(frame.mFrameIndex, 5u);
+        TS_ASSERT_DELTA(frame.mTime, 0.5, 1e-12);
+        TS_ASSERT_EQUALS(frame.GetNumElements(), 3u);
+        TS_ASSERT_EQUALS(frame.mNodeLocations.size(), 8u);
+        TS_ASSERT_DELTA(frame.mNodeLocations[7], 8.5, 1e-12);
+        TS_ASSERT_DELTA(frame.mCellVolumes[2], 8.0, 1e-12);
+        TS_ASSERT_EQUALS(frame.mCellLabels[1], 1u);
+        TS_ASSERT_EQUALS(frame.mElementOffsets[3], 9u);
+        TS_ASSERT_EQUALS(frame.mElementNodes[8], 1u);
+
+        // Frames larger than the capacity of a slot are refused, without disturbing the ring
+        SharedMemoryTissueWriter::FrameBuffers buffers;
+        TS_ASSERT_EQUALS(writer.BeginFrame(0.6, 5, 3, 9, buffers), false);
+        TS_ASSERT_EQUALS(writer.BeginFrame(0.6, 4, 3, 10, buffers), false);
+        TS_ASSERT(reader.ReadFrame(5, frame));
+
+        // Closing the writer marks the segment finished and removes its name, but existing readers can still read
+        TS_ASSERT_EQUALS(reader.IsFinished(), false);
+        writer.Close();
+        TS_ASSERT(reader.IsFinished());
+        TS_ASSERT(reader.ReadFrame(5, frame));
+        TS_ASSERT_THROWS_CONTAINS(SharedMemoryTissueReader another_reader(name), "Could not open shared memory segment");
+        TS_ASSERT_THROWS_THIS(writer.BeginFrame(0.6, 4, 3, 9, buffers),
+                              "Cannot write to a shared memory tissue segment that has been closed");
+    }
+
+    void TestSharedMemoryExportModifier()
+    {
+        // A cell sorting simulation as in Test03CellSorting, followed live by a reader on another thread
+        RandomNumberGenerator::Instance()->Reseed(1);
+        VoronoiVertexMeshGenerator generator(9, 9, 1);
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+        p_mesh->SetDistanceForT3SwapChecking(1.0);
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(DifferentiatedCellProliferativeType, p_cell_type);
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumElements(), p_cell_type);
+
+        MAKE_PTR(CellLabel, p_cell_label);
+        const unsigned num_labelled = CounterBasedRandomNumberGenerator::Instance()->LabelCells(cells, p_cell_label, 0.5);
+
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        OffLatticeSimulation<2> simulation(cell_population);
+        simulation.SetOutputDirectory("TestSharedMemoryExportModifier");
+        simulation.SetEndTime(2.0);
+        simulation.SetDt(0.01);
+        simulation.SetSamplingTimestepMultiple(10);
+
+        MAKE_PTR(NagaiHondaDifferentialAdhesionForce<2>, p_force);
+        p_force->SetNagaiHondaDeformationEnergyParameter(55.0);
+        p_force->SetNagaiHondaMembraneSurfaceEnergyParameter(0.0);
+        p_force->SetNagaiHondaCellCellAdhesionEnergyParameter(1.0);
+        p_force->SetNagaiHondaLabelledCellCellAdhesionEnergyParameter(6.0);
+        p_force->SetNagaiHondaLabelledCellLabelledCellAdhesionEnergyParameter(3.0);
+        p_force->SetNagaiHondaCellBoundaryAdhesionEnergyParameter(12.0);
+        p_force->SetNagaiHondaLabelledCellBoundaryAdhesionEnergyParameter(40.0);
+        simulation.AddForce(p_force);
+
+        const std::string name = "/TestSharedMemoryExportModifier_" + std::to_string(getpid());
+        MAKE_PTR(SharedMemoryExportModifier<2>, p_modifier);
+        TS_ASSERT_THROWS_THIS(p_modifier->SetSharedMemoryName("no_slash"),
+                              "A shared memory name must start with '/' and contain no other '/'");
+        p_modifier->SetSharedMemoryName(name);
+        TS_ASSERT_EQUALS(p_modifier->rGetSharedMemoryName(), name);
+        TS_ASSERT_EQUALS(p_modifier->GetNumSlots(), 4u);
+        TS_ASSERT_DELTA(p_modifier->GetCapacityFactor(), 4.0, 1e-12);
+        simulation.AddSimulationModifier(p_modifier);
+
+        // The first frame is published before the first time step, at which the simulation then waits for the reader
+        std::atomic<bool> reader_ready(false);
+        MAKE_PTR_ARGS(ReaderGateModifier, p_gate, (&reader_ready));
+        simulation.AddSimulationModifier(p_gate);
+
+        // The reader checks every frame it manages to read is self-consistent; it cannot assert from its own thread
+        std::atomic<bool> simulation_finished(false);
+        unsigned num_frames_read = 0;
+        unsigned num_inconsistent_frames = 0;
+        uint64_t last_frame_index = 0;
+        std::thread reader_thread([&]()
+        {
+            std::unique_ptr<SharedMemoryTissueReader> p_reader;
+            while (!p_reader && !simulation_finished)
+            {
+                try
+                {
+                    p_reader.reset(new SharedMemoryTissueReader(name));
+                }
+                catch (const Exception&)
+                {
+                    std::this_thread::yield();
+                }
+            }
+
+            SharedMemoryTissueReader::Frame frame;
+            auto read_latest_frame = [&]()
+            {
+                if (!p_reader->ReadLatestFrame(frame) || (num_frames_read > 0 && frame.mFrameIndex <= last_frame_index))
+                {
+                    return false;
+                }
+
+                const unsigned num_nodes = frame.mNodeLocations.size() / 2;
+                bool consistent = frame.GetNumElements() == 81u
+                                  && frame.mElementOffsets.back() == frame.mElementNodes.size()
+                                  && static_cast<unsigned>(std::count(frame.mCellLabels.begin(), frame.mCellLabels.end(), 1u)) == num_labelled;
+                for (unsigned node_index : frame.mElementNodes)
+                {
+                    consistent = consistent && node_index < num_nodes;
+                }
+                for (double volume : frame.mCellVolumes)
+                {
+                    consistent = consistent && volume > 0.0;
+                }
+                num_inconsistent_frames += consistent ? 0 : 1;
+                last_frame_index = frame.mFrameIndex;
+                ++num_frames_read;
+                reader_ready = true;
+                return true;
+            };
+
+            while (p_reader)
+            {
+                if (p_reader->IsFinished() || simulation_finished)
+                {
+                    // Nothing is published after the segment is marked finished, so one more read gets the last frame
+                    read_latest_frame();
+                    break;
+                }
+                if (!read_latest_frame())
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        try
+        {
+            simulation.Solve();
+        }
+        catch (...)
+        {
+            simulation_finished = true;
+            reader_thread.join();
+            throw;
+        }
+        simulation_finished = true;
+        reader_thread.join();
+
+        // One frame at the start, then one per output time step; the reader follows from the start and sees the last
+        TS_ASSERT(p_gate->GetReaderWasReady());
+        TS_ASSERT_EQUALS(p_modifier->rGetActiveSharedMemoryName(), name);
+        TS_ASSERT_EQUALS(p_modifier->GetNumFramesPublished(), 21u);
+        TS_ASSERT_EQUALS(p_modifier->GetNumFramesSkipped(), 0u);
+        TS_ASSERT_LESS_THAN(1u, num_frames_read);
+        TS_ASSERT_EQUALS(num_inconsistent_frames, 0u);
+        TS_ASSERT_EQUALS(last_frame_index, 20u);
+
+        // The name of the segment is recorded with the output, and the segment is removed at the end
+        FileFinder name_file("TestSharedMemoryExportModifier/sharedmemory.txt", RelativeTo::ChasteTestOutput);
+        std::ifstream name_stream(name_file.GetAbsolutePath());
+        std::string recorded_name;
+        name_stream >> recorded_name;
+        TS_ASSERT_EQUALS(recorded_name, name);
+        TS_ASSERT_THROWS_CONTAINS(SharedMemoryTissueReader reader(name), "Could not open shared memory segment");
+    }
+};
+
+#endif /* TESTPROJECTOUTPUT_HPP_ */
@@ -0,0 +1,261 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTPROJECTRANDOMNUMBERS_HPP_
+#define TESTPROJECTRANDOMNUMBERS_HPP_
+
+// These first headers relate to the Chaste infrastructure and can be found at the top of every test suite
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "CheckpointArchiveTypes.hpp"
+
+#include <cmath>
+
+#include "RandomNumberGenerator.hpp"
+#include "SmartPointers.hpp"
+
+#include "VoronoiVertexMeshGenerator.hpp"
+
+#include "Cell.hpp"
+#include "CellLabel.hpp"
+#include "CellsGenerator.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "NoCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+// Custom headers from this user project
+#include "CounterBasedRandomNumberGenerator.hpp"
+#include "ReproducibleVonMisesVertexBasedDivisionRule.hpp"
+#include "ThreadedLoop.hpp"
+
+// Finally, we include a header that enforces running this test only on one process
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests of the project random number generation.
+ */
+class TestProjectRandomNumbers : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Draw a few numbers from the stream of every cell in parallel.
+     *
+     * @param numThreads the number of threads to use
+     * @return the numbers, cell by cell
+     */
+    std::vector<double> DrawInParallel(unsigned numThreads)
+    {
+        const unsigned num_cells = 10000;
+        std::vector<double> values(3 * num_cells);
+
+        ThreadedLoop::SetNumThreads(numThreads);
+        ThreadedLoop::Run(num_cells, [&](unsigned begin, unsigned end, unsigned thread)
+        {
+            // Visit the cells in reverse order, to check the order makes no difference
+            for (unsigned cell_id = end; cell_id-- > begin;)
+            {
+                CounterBasedRandomStream stream = CounterBasedRandomNumberGenerator::Instance()->GetStream(cell_id, 17);
+                values[3 * cell_id] = stream.ranf();
+                values[3 * cell_id + 1] = stream.StandardNormalRandomDeviate();
+                values[3 * cell_id + 2] = stream.VonMisesRandomDeviate(0.0, 2.0);
+            }
+        });
+        ThreadedLoop::SetNumThreads(0);
+
+        return values;
+    }
+
+public:
+
+    void TestPhiloxKnownAnswers()
+    {
+        // Known-answer tests from the Random123 distribution
+        std::array<uint32_t, 4> result = CounterBasedRandomStream::Philox4x32({{0u, 0u, 0u, 0u}}, {{0u, 0u}});
+        TS_ASSERT_EQUALS(result[0], 0x6627e8d5u);
+        TS_ASSERT_EQUALS(result[1], 0xe169c58du);
+        TS_ASSERT_EQUALS(result[2], 0xbc57ac4cu);
+        TS_ASSERT_EQUALS(result[3], 0x9b00dbd8u);
+
+        result = CounterBasedRandomStream::Philox4x32({{0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}},
+                                                      {{0xa4093822u, 0x299f31d0u}});
+        TS_ASSERT_EQUALS(result[0], 0xd16cfe09u);
+        TS_ASSERT_EQUALS(result[1], 0x94fdccebu);
+        TS_ASSERT_EQUALS(result[2], 0x5001e420u);
+        TS_ASSERT_EQUALS(result[3], 0x24126ea1u);
+    }
+
+    void TestStreamsAreIndependentOfThreadCountAndOrder()
+    {
+        CounterBasedRandomNumberGenerator::Instance()->Reseed(12345);
+        TS_ASSERT_EQUALS(CounterBasedRandomNumberGenerator::Instance()->GetSeed(), 12345u);
+
+        const std::vector<double> serial_values = DrawInParallel(1);
+        const std::vector<double> parallel_values = DrawInParallel(4);
+        for (unsigned i = 0; i < serial_values.size(); ++i)
+        {
+            TS_ASSERT_EQUALS(serial_values[i], parallel_values[i]);
+        }
+
+        // Streams for different purposes, time steps and seeds differ
+        CounterBasedRandomNumberGenerator* p_gen = CounterBasedRandomNumberGenerator::Instance();
+        const double value = p_gen->GetStream(3, 4).ranf();
+        TS_ASSERT_EQUALS(p_gen->GetStream(3, 4, CounterBasedRandomNumberGenerator::GENERAL_STREAM).ranf(), value);
+        TS_ASSERT_DIFFERS(p_gen->GetStream(3, 4, CounterBasedRandomNumberGenerator::LABELLING_STREAM).ranf(), value);
+        TS_ASSERT_DIFFERS(p_gen->GetStream(3, 5).ranf(), value);
+        TS_ASSERT_DIFFERS(p_gen->GetStream(4, 4).ranf(), value);
+        p_gen->Reseed(12346);
+        TS_ASSERT_DIFFERS(p_gen->GetStream(3, 4).ranf(), value);
+
+        CounterBasedRandomNumberGenerator::Destroy();
+        TS_ASSERT_EQUALS(CounterBasedRandomNumberGenerator::Instance()->GetSeed(), 0u);
+    }
+
+    void TestDistributions()
+    {
+        const unsigned num_samples = 100000;
+        double sum_uniform = 0.0;
+        double sum_normal = 0.0;
+        double sum_squared_normal = 0.0;
+        double sum_exponential = 0.0;
+        double sum_cos_von_mises = 0.0;
+        double min_uniform = 1.0;
+        double max_uniform = 0.0;
+
+        for (unsigned i = 0; i < num_samples; ++i)
+        {
+            CounterBasedRandomStream stream = CounterBasedRandomNumberGenerator::Instance()->GetStream(i, 0);
+            const double uniform = stream.ranf();
+            sum_uniform += uniform;
+            min_uniform = std::min(min_uniform, uniform);
+            max_uniform = std::max(max_uniform, uniform);
+
+            const double normal = stream.NormalRandomDeviate(1.0, 2.0);
+            sum_normal += normal;
+            sum_squared_normal += (normal - 1.0) * (normal - 1.0);
+
+            sum_exponential += stream.ExponentialRandomDeviate(3.0);
+            sum_cos_von_mises += std::cos(stream.VonMisesRandomDeviate(0.5, 4.0) - 0.5);
+        }
+
+        TS_ASSERT_LESS_THAN(0.0, min_uniform);
+        TS_ASSERT_LESS_THAN(max_uniform, 1.0);
+        TS_ASSERT_DELTA(sum_uniform / num_samples, 0.5, 0.01);
+        TS_ASSERT_DELTA(sum_normal / num_samples, 1.0, 0.03);
+        TS_ASSERT_DELTA(sum_squared_normal / num_samples, 4.0, 0.1);
+        TS_ASSERT_DELTA(sum_exponential / num_samples, 3.0, 0.05);
+
+        // The mean resultant length of a von Mises distribution is I_1(kappa) / I_0(kappa)
+        TS_ASSERT_DELTA(sum_cos_von_mises / num_samples, 0.8635, 0.01);
+    }
+
+    void TestLabelCellsIsIndependentOfOrder()
+    {
+        CounterBasedRandomNumberGenerator::Instance()->Reseed(1);
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(DifferentiatedCellProliferativeType, p_cell_type);
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, 1000, p_cell_type);
+
+        MAKE_PTR(CellLabel, p_cell_label);
+        const unsigned num_labelled = CounterBasedRandomNumberGenerator::Instance()->LabelCells(cells, p_cell_label, 0.5);
+        TS_ASSERT_LESS_THAN(400u, num_labelled);
+        TS_ASSERT_LESS_THAN(num_labelled, 600u);
+
+        std::vector<bool> is_labelled;
+        for (auto& p_cell : cells)
+        {
+            is_labelled.push_back(p_cell->HasCellProperty<CellLabel>());
+            p_cell->RemoveCellProperty<CellLabel>();
+        }
+
+        // Visiting the cells in reverse, after drawing from RandomNumberGenerator, labels the same cells
+        RandomNumberGenerator::Instance()->ranf();
+        const std::vector<CellPtr> reversed_cells(cells.rbegin(), cells.rend());
+        TS_ASSERT_EQUALS(CounterBasedRandomNumberGenerator::Instance()->LabelCells(reversed_cells, p_cell_label, 0.5), num_labelled);
+        for (unsigned i = 0; i < cells.size(); ++i)
+        {
+            TS_ASSERT_EQUALS(cells[i]->HasCellProperty<CellLabel>(), is_labelled[i]);
+        }
+
+        CounterBasedRandomNumberGenerator::Destroy();
+    }
+
+    void TestReproducibleVonMisesDivisionRule()
+    {
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 10);
+
+        RandomNumberGenerator::Instance()->Reseed(1);
+        VoronoiVertexMeshGenerator generator(6, 6, 1);
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(DifferentiatedCellProliferativeType, p_cell_type);
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumElements(), p_cell_type);
+
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        ReproducibleVonMisesVertexBasedDivisionRule<2> division_rule;
+        division_rule.SetMeanParameter(0.25 * M_PI);
+        division_rule.SetConcentrationParameter(50.0);
+        TS_ASSERT_DELTA(division_rule.GetMeanParameter(), 0.25 * M_PI, 1e-12);
+        TS_ASSERT_DELTA(division_rule.GetConcentrationParameter(), 50.0, 1e-12);
+
+        // The vector for each cell does not depend on which other cells were asked for theirs first
+        std::vector<c_vector<double, 2> > forward_vectors;
+        for (auto& p_cell : cells)
+        {
+            forward_vectors.push_back(division_rule.CalculateCellDivisionVector(p_cell, cell_population));
+        }
+        for (unsigned i = cells.size(); i-- > 0;)
+        {
+            c_vector<double, 2> vector = division_rule.CalculateCellDivisionVector(cells[i], cell_population);
+            TS_ASSERT_EQUALS(vector[0], forward_vectors[i][0]);
+            TS_ASSERT_EQUALS(vector[1], forward_vectors[i][1]);
+
+            TS_ASSERT_DELTA(norm_2(vector), 1.0, 1e-12);
+            TS_ASSERT_DELTA(std::atan2(vector[1], vector[0]), 0.25 * M_PI, 0.6);
+        }
+        TS_ASSERT_DIFFERS(forward_vectors[0][0], forward_vectors[1][0]);
+
+        // but does depend on the time step
+        SimulationTime::Instance()->IncrementTimeOneStep();
+        TS_ASSERT_DIFFERS(division_rule.CalculateCellDivisionVector(cells[0], cell_population)[0], forward_vectors[0][0]);
+    }
+};
+
+#endif /* TESTPROJECTRANDOMNUMBERS_HPP_ */
@@ -0,0 +1,666 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTPROJECTSIMULATIONMODIFIERS_HPP_
+#define TESTPROJECTSIMULATIONMODIFIERS_HPP_
+
+// These first headers relate to the Chaste infrastructure and can be found at the top of every test suite
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "CheckpointArchiveTypes.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "FileFinder.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "SmartPointers.hpp"
+#include "Warnings.hpp"
+
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "VoronoiVertexMeshGenerator.hpp"
+
+#include "Cell.hpp"
+#include "CellLabel.hpp"
+#include "CellsGenerator.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "NoCellCycleModel.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+#include "FarhadifarForce.hpp"
+#include "OffLatticeSimulation.hpp"
+
+// Custom headers from this user project
+#include "CounterBasedBernoulliTrialCellCycleModel.hpp"
+#include "CounterBasedRandomNumberGenerator.hpp"
+#include "HardwareCounterProfiler.hpp"
+#include "HardwareCounterProfilerModifier.hpp"
+#include "HilbertRenumberingModifier.hpp"
+#include "InSituStatisticsModifier.hpp"
+#include "LiveMetricsModifier.hpp"
+#include "MemoryAccountingModifier.hpp"
+#include "NodeTrajectoryOutputModifier.hpp"
+#include "SillyForce.hpp"
+#include "SillySimulationModifier.hpp"
+#include "SillyVertexBasedDivisionRule.hpp"
+#include "ThreadedLoop.hpp"
+
+// Finally, we include a header that enforces running this test only on one process
+#include "FakePetscSetup.hpp"
+
+/**
+ * A modifier that, part way through a simulation, requests the metrics served by a LiveMetricsModifier, just as a
+ * job scheduler would.
+ */
+class MetricsProbeModifier : public AbstractCellBasedSimulationModifier<2, 2>
+{
+private:
+
+    /** The modifier serving the metrics. */
+    LiveMetricsModifier<2>* mpMetricsModifier = nullptr;
+
+    /** The time step at which to request the metrics. */
+    unsigned mProbeTimeStep = 0u;
+
+    /** The response received. */
+    std::string mResponse;
+
+    friend class boost::serialization::access;
+    template <class Archive>
+    void serialize(Archive& archive, const unsigned int version)
+    {
+        archive& boost::serialization::base_object<AbstractCellBasedSimulationModifier<2, 2> >(*this);
+    }
+
+public:
+
+    MetricsProbeModifier(LiveMetricsModifier<2>* pMetricsModifier = nullptr, unsigned probeTimeStep = 0u)
+        : mpMetricsModifier(pMetricsModifier),
+          mProbeTimeStep(probeTimeStep)
+    {
+    }
+
+    const std::string& rGetResponse()
+    {
+        return mResponse;
+    }
+
+    void UpdateAtEndOfTimeStep(AbstractCellPopulation<2, 2>& rCellPopulation)
+    {
+        if (SimulationTime::Instance()->GetTimeStepsElapsed() != mProbeTimeStep)
+        {
+            return;
+        }
+
+        sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, mpMetricsModifier->rGetActiveSocketPath().c_str(), sizeof(address.sun_path) - 1);
+
+        const int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+        TS_ASSERT_EQUALS(connect(connection, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+
+        const std::string request = "GET /metrics HTTP/1.0\r\n\r\n";
+        TS_ASSERT_EQUALS(send(connection, request.data(), request.size(), 0), static_cast<ssize_t>(request.size()));
+
+        char buffer[4096];
+        ssize_t num_received;
+        while ((num_received = recv(connection, buffer, sizeof(buffer), 0)) > 0)
+        {
+            mResponse.append(buffer, num_received);
+        }
+        close(connection);
+    }
+
+    void SetupSolve(AbstractCellPopulation<2, 2>& rCellPopulation, std::string outputDirectory)
+    {
+    }
+
+    void OutputSimulationModifierParameters(out_stream& rParamsFile)
+    {
+        AbstractCellBasedSimulationModifier<2, 2>::OutputSimulationModifierParameters(rParamsFile);
+    }
+};
+
+#include "SerializationExportWrapper.hpp"
+CHASTE_CLASS_EXPORT(MetricsProbeModifier)
+#include "SerializationExportWrapperForCpp.hpp"
+CHASTE_CLASS_EXPORT(MetricsProbeModifier)
+
+/**
+ * Tests of the project simulation modifiers, run on the scenarios from TestCustomVertexSimulations.
+ */
+class TestProjectSimulationModifiers : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestLiveMetricsModifier()
+    {
+        RandomNumberGenerator::Instance()->Reseed(1);
+        VoronoiVertexMeshGenerator generator(6, 6, 1);
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(DifferentiatedCellProliferativeType, p_cell_type);
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumElements(), p_cell_type);
+
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        OffLatticeSimulation<2> simulation(cell_population);
+        simulation.SetOutputDirectory("TestLiveMetricsModifier");
+        simulation.SetEndTime(1.0);
+        simulation.SetDt(0.01);
+        simulation.SetSamplingTimestepMultiple(10);
+
+        MAKE_PTR(FarhadifarForce<2>, p_force);
+        simulation.AddForce(p_force);
+
+        MAKE_PTR(LiveMetricsModifier<2>, p_metrics_modifier);
+        p_metrics_modifier->SetPhaseSampleInterval(10);
+        simulation.AddSimulationModifier(p_metrics_modifier);
+
+        // The probe runs after the metrics modifier, so sees the metrics for the current time step
+        boost::shared_ptr<MetricsProbeModifier> p_probe(new MetricsProbeModifier(p_metrics_modifier.get(), 50));
+        simulation.AddSimulationModifier(p_probe);
+
+        simulation.Solve();
+
+        const std::string& r_response = p_probe->rGetResponse();
+        TS_ASSERT_EQUALS(r_response.substr(0, 15), "HTTP/1.0 200 OK");
+        TS_ASSERT_DIFFERS(r_response.find("chaste_time_steps_elapsed 50\n"), std::string::npos);
+        TS_ASSERT_DIFFERS(r_response.find("chaste_time_steps_total 100\n"), std::string::npos);
+        TS_ASSERT_DIFFERS(r_response.find("chaste_num_cells 36\n"), std::string::npos);
+        TS_ASSERT_DIFFERS(r_response.find("chaste_phase_time_share{phase=\"force\"}"), std::string::npos);
+        TS_ASSERT_DIFFERS(r_response.find("chaste_eta_seconds"), std::string::npos);
+        TS_ASSERT_DIFFERS(r_response.find("chaste_finished 0\n"), std::string::npos);
+
+        // The socket is removed when the simulation finishes
+        TS_ASSERT_DIFFERS(access(p_metrics_modifier->rGetActiveSocketPath().c_str(), F_OK), 0);
+    }
+
+    void TestMemoryAccountingModifier()
+    {
+        RandomNumberGenerator::Instance()->Reseed(1);
+        VoronoiVertexMeshGenerator generator(6, 6, 1);
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+
+        // A proliferating tissue, as in Test02OrientedCellDivision, but growing faster
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_cell_type);
+        CellsGenerator<CounterBasedBernoulliTrialCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumElements(), p_cell_type);
+        for (auto& p_cell : cells)
+        {
+            static_cast<CounterBasedBernoulliTrialCellCycleModel*>(p_cell->GetCellCycleModel())->SetDivisionProbability(0.5);
+        }
+
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        OffLatticeSimulation<2> simulation(cell_population);
+        simulation.SetOutputDirectory("TestMemoryAccountingModifier");
+        simulation.SetEndTime(5.0);
+        simulation.SetDt(0.01);
+        simulation.SetSamplingTimestepMultiple(50);
+
+        MAKE_PTR(FarhadifarForce<2>, p_force);
+        simulation.AddForce(p_force);
+
+        typedef MemoryAccountingModifier<2> Accounting;
+        MAKE_PTR(Accounting, p_modifier);
+        simulation.AddSimulationModifier(p_modifier);
+
+        simulation.Solve();
+
+        TS_ASSERT_LESS_THAN(0u, p_modifier->GetLatestBytes(Accounting::NODES));
+        TS_ASSERT_LESS_THAN(0u, p_modifier->GetLatestBytes(Accounting::ELEMENTS));
+
+        // No cells die, so as the tissue grows the peaks of the cell quantities are their final values
+        TS_ASSERT_LESS_THAN(36u, cell_population.GetNumRealCells());
+        for (unsigned subsystem : {Accounting::CELLS, Accounting::CELL_CYCLE_MODELS})
+        {
+            TS_ASSERT_EQUALS(p_modifier->GetPeakBytes(subsystem), p_modifier->GetLatestBytes(subsystem));
+            TS_ASSERT_DELTA(p_modifier->GetPeakTime(subsystem), 5.0, 1e-9);
+        }
+        TS_ASSERT_LESS_THAN(cell_population.GetNumRealCells() * (sizeof(Cell) + sizeof(CounterBasedBernoulliTrialCellCycleModel)),
+                            p_modifier->GetLatestBytes(Accounting::CELLS) + p_modifier->GetLatestBytes(Accounting::CELL_CYCLE_MODELS));
+        TS_ASSERT_LESS_THAN(0u, p_modifier->GetLatestBytes(Accounting::OUTPUT_ON_DISK));
+        TS_ASSERT_LESS_THAN(0u, p_modifier->GetPeakBytes(Accounting::PEAK_RESIDENT_SET));
+
+        // The timeline has a header and a line for the start and each of the ten output time steps
+        FileFinder timeline_file("TestMemoryAccountingModifier/memoryusage.dat", RelativeTo::ChasteTestOutput);
+        std::ifstream timeline_stream(timeline_file.GetAbsolutePath());
+        unsigned num_lines = 0;
+        for (std::string line; std::getline(timeline_stream, line);)
+        {
+            ++num_lines;
+        }
+        TS_ASSERT_EQUALS(num_lines, 12u);
+
+        FileFinder summary_file("TestMemoryAccountingModifier/memorysummary.txt", RelativeTo::ChasteTestOutput);
+        TS_ASSERT(summary_file.Exists());
+        TS_ASSERT_EQUALS(Accounting::GetSubsystemName(Accounting::CELL_CYCLE_MODELS), "cell_cycle_models");
+        TS_ASSERT_THROWS_CONTAINS(Accounting::GetSubsystemName(Accounting::NUM_MEMORY_SUBSYSTEMS), "Unknown memory subsystem");
+    }
+
+    void TestHilbertRenumberingModifier()
+    {
+        // Relax the same tissue with and without renumbering, keeping the final area of each cell
+        std::map<unsigned, double> areas[2];
+        double final_locality_metrics[2];
+        for (unsigned renumber = 0; renumber < 2; ++renumber)
+        {
+            SimulationTime::Destroy();
+            SimulationTime::Instance()->SetStartTime(0.0);
+            CellId::ResetMaxCellId();
+            RandomNumberGenerator::Instance()->Reseed(1);
+
+            VoronoiVertexMeshGenerator generator(6, 6, 1);
+            boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+
+            std::vector<CellPtr> cells;
+            MAKE_PTR(DifferentiatedCellProliferativeType, p_cell_type);
+            CellsGenerator<NoCellCycleModel, 2> cells_generator;
+            cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumElements(), p_cell_type);
+
+            VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+            OffLatticeSimulation<2> simulation(cell_population);
+            simulation.SetOutputDirectory(renumber ? "TestHilbertRenumberingModifier" : "TestHilbertRenumberingModifierReference");
+            simulation.SetEndTime(1.0);
+            simulation.SetDt(0.01);
+            simulation.SetSamplingTimestepMultiple(100);
+
+            MAKE_PTR(FarhadifarForce<2>, p_force);
+            simulation.AddForce(p_force);
+
+            MAKE_PTR(HilbertRenumberingModifier<2>, p_modifier);
+            p_modifier->SetRenumberingInterval(10);
+            if (renumber)
+            {
+                simulation.AddSimulationModifier(p_modifier);
+            }
+
+            simulation.Solve();
+
+            for (auto cell_iter = cell_population.Begin(); cell_iter != cell_population.End(); ++cell_iter)
+            {
+                areas[renumber][cell_iter->GetCellId()] = cell_population.GetVolumeOfCell(*cell_iter);
+            }
+            final_locality_metrics[renumber] = HilbertRenumberingModifier<2>::CalculateLocalityMetric(*p_mesh);
+
+            if (renumber)
+            {
+                // Renumbered at the start and at each of the ten multiples of ten time steps
+                TS_ASSERT_EQUALS(p_modifier->GetNumRenumberings(), 11u);
+
+                // Indices match storage order and the elements containing each node, and each cell is in its element
+                for (unsigned node_index = 0; node_index < p_mesh->GetNumNodes(); ++node_index)
+                {
+                    TS_ASSERT_EQUALS(p_mesh->GetNode(node_index)->GetIndex(), node_index);
+                }
+                for (unsigned elem_index = 0; elem_index < p_mesh->GetNumElements(); ++elem_index)
+                {
+                    VertexElement<2, 2>* p_element = p_mesh->GetElement(elem_index);
+                    TS_ASSERT_EQUALS(p_element->GetIndex(), elem_index);
+                    for (unsigned local_index = 0; local_index < p_element->GetNumNodes(); ++local_index)
+                    {
+                        TS_ASSERT_EQUALS(p_element->GetNode(local_index)->rGetContainingElementIndices().count(elem_index), 1u);
+                    }
+                    CellPtr p_cell = cell_population.GetCellUsingLocationIndex(elem_index);
+                    TS_ASSERT_EQUALS(cell_population.GetLocationIndexUsingCell(p_cell), elem_index);
+                }
+            }
+        }
+
+        // Renumbering changes only the order of the floating point sums
+        TS_ASSERT_EQUALS(areas[0].size(), areas[1].size());
+        for (const auto& r_area : areas[0])
+        {
+            TS_ASSERT_DELTA(areas[1][r_area.first], r_area.second, 1e-8);
+        }
+        TS_ASSERT_LESS_THAN_EQUALS(final_locality_metrics[1], final_locality_metrics[0]);
+
+        HilbertRenumberingModifier<2> modifier;
+        TS_ASSERT_EQUALS(modifier.GetRenumberingInterval(), 0u);
+        TS_ASSERT_EQUALS(modifier.GetLocalityCheckInterval(), 100u);
+        TS_ASSERT_DELTA(modifier.GetDegradationThreshold(), 1.5, 1e-12);
+
+        // The Hilbert curve starts at the origin, moves between neighbouring points and ends at the far corner of the x axis
+        TS_ASSERT_EQUALS(HilbertRenumberingModifier<2>::CalculateHilbertIndex(0, 0), 0u);
+        TS_ASSERT_EQUALS(HilbertRenumberingModifier<2>::CalculateHilbertIndex(1, 0), 1u);
+        TS_ASSERT_EQUALS(HilbertRenumberingModifier<2>::CalculateHilbertIndex(1, 1), 2u);
+        TS_ASSERT_EQUALS(HilbertRenumberingModifier<2>::CalculateHilbertIndex(0, 1), 3u);
+        TS_ASSERT_EQUALS(HilbertRenumberingModifier<2>::CalculateHilbertIndex(65535, 0), (1ull << 32) - 1);
+    }
+
+    void TestInSituStatisticsModifier()
+    {
+        // Sorting of labelled cells, as in Test03CellSorting, with the spiral of Test05CustomForce
+        typedef InSituStatisticsModifier<2> Statistics;
+        std::vector<boost::shared_ptr<Statistics> > modifiers;
+        for (unsigned num_threads : {1u, 4u})
+        {
+            SimulationTime::Destroy();
+            SimulationTime::Instance()->SetStartTime(0.0);
+            CellId::ResetMaxCellId();
+            RandomNumberGenerator::Instance()->Reseed(1);
+
+            VoronoiVertexMeshGenerator generator(6, 6, 1);
+            boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+
+            std::vector<CellPtr> cells;
+            MAKE_PTR(DifferentiatedCellProliferativeType, p_cell_type);
+            CellsGenerator<NoCellCycleModel, 2> cells_generator;
+            cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumElements(), p_cell_type);
+
+            MAKE_PTR(CellLabel, p_cell_label);
+            CounterBasedRandomNumberGenerator::Instance()->LabelCells(cells, p_cell_label, 0.5);
+
+            VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+            OffLatticeSimulation<2> simulation(cell_population);
+            simulation.SetOutputDirectory("TestInSituStatisticsModifier");
+            simulation.SetEndTime(1.0);
+            simulation.SetDt(0.01);
+            simulation.SetSamplingTimestepMultiple(10);
+
+            MAKE_PTR(FarhadifarForce<2>, p_force);
+            simulation.AddForce(p_force);
+            MAKE_PTR(SillyForce<2>, p_silly_force);
+            p_silly_force->SetStrengthMultiplier(0.15);
+            simulation.AddForce(p_silly_force);
+
+            MAKE_PTR(Statistics, p_modifier);
+            simulation.AddSimulationModifier(p_modifier);
+            modifiers.push_back(p_modifier);
+
+            ThreadedLoop::SetNumThreads(num_threads);
+            simulation.Solve();
+            ThreadedLoop::SetNumThreads(0);
+
+            // The statistics agree with the final state of the population
+            TS_ASSERT_EQUALS(p_modifier->GetNumCells(), 36u);
+            double total_area = 0.0;
+            for (auto cell_iter = cell_population.Begin(); cell_iter != cell_population.End(); ++cell_iter)
+            {
+                total_area += cell_population.GetVolumeOfCell(*cell_iter);
+            }
+            TS_ASSERT_DELTA(p_modifier->GetMeanArea(), total_area / 36.0, 1e-10);
+            TS_ASSERT_LESS_THAN(0.0, p_modifier->GetAreaStandardDeviation());
+
+            const std::vector<unsigned>& r_histogram = p_modifier->rGetAreaHistogram();
+            TS_ASSERT_EQUALS(r_histogram.size(), 20u);
+            TS_ASSERT_EQUALS(std::accumulate(r_histogram.begin(), r_histogram.end(), 0u), 36u);
+
+            const std::vector<unsigned>& r_polygon_classes = p_modifier->rGetPolygonClassCounts();
+            TS_ASSERT_EQUALS(r_polygon_classes.size(), 11u);
+            TS_ASSERT_EQUALS(std::accumulate(r_polygon_classes.begin(), r_polygon_classes.end(), 0u), 36u);
+            TS_ASSERT_EQUALS(r_polygon_classes[0], 0u);
+
+            TS_ASSERT_LESS_THAN(0.0, p_modifier->GetHeterotypicBoundaryFraction());
+            TS_ASSERT_LESS_THAN(p_modifier->GetHeterotypicBoundaryFraction(), 1.0);
+            TS_ASSERT_LESS_THAN(0.0, norm_2(p_modifier->rGetCentroidDrift()));
+        }
+
+        // Splitting the work across threads changes only the order of floating point sums
+        TS_ASSERT_EQUALS(modifiers[1]->rGetAreaHistogram(), modifiers[0]->rGetAreaHistogram());
+        TS_ASSERT_EQUALS(modifiers[1]->rGetPolygonClassCounts(), modifiers[0]->rGetPolygonClassCounts());
+        TS_ASSERT_DELTA(modifiers[1]->GetMeanArea(), modifiers[0]->GetMeanArea(), 1e-12);
+        TS_ASSERT_DELTA(modifiers[1]->GetHeterotypicBoundaryFraction(), modifiers[0]->GetHeterotypicBoundaryFraction(), 1e-12);
+        TS_ASSERT_DELTA(modifiers[1]->rGetCentroidDrift()[0], modifiers[0]->rGetCentroidDrift()[0], 1e-12);
+
+        // The file has a header, and a line of 38 columns for the start and each of the ten output time steps
+        FileFinder statistics_file("TestInSituStatisticsModifier/insitustatistics.dat", RelativeTo::ChasteTestOutput);
+        std::ifstream statistics_stream(statistics_file.GetAbsolutePath());
+        std::string line;
+        std::getline(statistics_stream, line);
+        TS_ASSERT_EQUALS(line.substr(0, 34), "# time\tnum_cells\tmean_area\tarea_sd");
+        unsigned num_lines = 0;
+        while (std::getline(statistics_stream, line))
+        {
+            TS_ASSERT_EQUALS(std::count(line.begin(), line.end(), '\t'), 37);
+            ++num_lines;
+        }
+        TS_ASSERT_EQUALS(num_lines, 11u);
+    }
+
+    void TestHardwareCounterProfilerModifier()
+    {
+        RandomNumberGenerator::Instance()->Reseed(1);
+        VoronoiVertexMeshGenerator generator(6, 6, 1);
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+
+        // A proliferating tissue exercising each of the phases marked in the project classes
+        std::vector<CellPtr> cells;
+        MAKE_PTR(TransitCellProliferativeType, p_cell_type);
+        CellsGenerator<CounterBasedBernoulliTrialCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumElements(), p_cell_type);
+        for (auto& p_cell : cells)
+        {
+            static_cast<CounterBasedBernoulliTrialCellCycleModel*>(p_cell->GetCellCycleModel())->SetDivisionProbability(0.1);
+        }
+
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        MAKE_PTR(SillyVertexBasedDivisionRule<2>, p_division_rule);
+        cell_population.SetVertexBasedDivisionRule(p_division_rule);
+
+        OffLatticeSimulation<2> simulation(cell_population);
+        simulation.SetOutputDirectory("TestHardwareCounterProfilerModifier");
+        simulation.SetEndTime(12.0);
+        simulation.SetDt(0.01);
+        simulation.SetSamplingTimestepMultiple(100);
+
+        MAKE_PTR(FarhadifarForce<2>, p_force);
+        simulation.AddForce(p_force);
+        MAKE_PTR(SillyForce<2>, p_silly_force);
+        p_silly_force->SetStrengthMultiplier(0.15);
+        simulation.AddForce(p_silly_force);
+
+        MAKE_PTR(SillySimulationModifier<2>, p_silly_modifier);
+        simulation.AddSimulationModifier(p_silly_modifier);
+        MAKE_PTR(NodeTrajectoryOutputModifier<2>, p_trajectory_modifier);
+        simulation.AddSimulationModifier(p_trajectory_modifier);
+
+        // To measure output, the profiler modifier must be added last and told of the simulation
+        MAKE_PTR(HardwareCounterProfilerModifier<2>, p_modifier);
+        p_modifier->SetPrintReport(false);
+        TS_ASSERT_EQUALS(p_modifier->GetPrintReport(), false);
+        simulation.AddSimulationModifier(p_modifier);
+        p_modifier->SetSimulation(&simulation);
+
+        HardwareCounterProfiler* p_profiler = HardwareCounterProfiler::Instance();
+        TS_ASSERT_EQUALS(p_profiler->IsEnabled(), false);
+
+        // The counters that can be opened here, which the simulation will use too
+        bool counter_available[HardwareCounterProfiler::NUM_COUNTERS];
+        p_profiler->Enable();
+        for (unsigned counter = 0; counter < HardwareCounterProfiler::NUM_COUNTERS; ++counter)
+        {
+            counter_available[counter] = p_profiler->IsCounterAvailable(counter);
+            TS_ASSERT_EQUALS(p_profiler->WasCounterOpened(counter), counter_available[counter]);
+        }
+        p_profiler->Disable();
+
+        const unsigned num_warnings = Warnings::Instance()->GetNumWarnings();
+        simulation.Solve();
+
+        // The profiler is switched off again, closing the counters, but the totals remain available
+        TS_ASSERT_EQUALS(p_profiler->IsEnabled(), false);
+        for (unsigned counter = 0; counter < HardwareCounterProfiler::NUM_COUNTERS; ++counter)
+        {
+            TS_ASSERT_EQUALS(p_profiler->IsCounterAvailable(counter), false);
+            TS_ASSERT_EQUALS(p_profiler->WasCounterOpened(counter), counter_available[counter]);
+        }
+        TS_ASSERT_EQUALS(Warnings::Instance()->GetNumWarnings(), num_warnings);
+        TS_ASSERT_EQUALS(p_profiler->rGetPhase("Solve").mNumCalls, 1u);
+        TS_ASSERT_LESS_THAN(0.0, p_profiler->rGetPhase("Solve").mWallTime);
+
+        // The forces are computed once per time step, and the tissue is squashed once, at time 10
+        TS_ASSERT_EQUALS(p_profiler->rGetPhase("SillyForce::AddForceContribution").mNumCalls, 1200u);
+        TS_ASSERT_EQUALS(p_profiler->rGetPhase("SillySimulationModifier::Squash").mNumCalls, 1u);
+
+        // Each division calls the division rule once; cells may also be lost to T2 swaps
+        const unsigned num_divisions = p_profiler->rGetPhase("SillyVertexBasedDivisionRule::CalculateCellDivisionVector").mNumCalls;
+        TS_ASSERT_LESS_THAN(0u, num_divisions);
+        TS_ASSERT_LESS_THAN_EQUALS(cell_population.GetNumRealCells(), 36u + num_divisions);
+
+        // Trajectories are sampled at the start, before the profiler is enabled, and at each of the twelve output
+        // time steps; the first output time step is not included in "Output"
+        TS_ASSERT_EQUALS(p_profiler->rGetPhase("NodeTrajectoryOutputModifier::WriteSample").mNumCalls, 12u);
+        TS_ASSERT_EQUALS(p_profiler->rGetPhase("Output").mNumCalls, 11u);
+        TS_ASSERT_EQUALS(p_profiler->HasPhase("ParallelVtuOutputModifier::WriteVtuFile"), false);
+        TS_ASSERT_THROWS_CONTAINS(p_profiler->rGetPhase("ParallelVtuOutputModifier::WriteVtuFile"),
+                                  "No hardware counter totals for phase");
+
+        for (const auto& r_phase : p_profiler->rGetPhases())
+        {
+            TS_ASSERT_LESS_THAN_EQUALS(r_phase.mWallTime, p_profiler->rGetPhase("Solve").mWallTime);
+        }
+
+        // Counters can only be checked where perf events are permitted
+        if (p_profiler->WasCounterOpened(HardwareCounterProfiler::INSTRUCTIONS))
+        {
+            const double force_instructions = p_profiler->rGetPhase("SillyForce::AddForceContribution").mCounts[HardwareCounterProfiler::INSTRUCTIONS];
+            TS_ASSERT_LESS_THAN(0.0, force_instructions);
+            TS_ASSERT_LESS_THAN(force_instructions, p_profiler->rGetPhase("Solve").mCounts[HardwareCounterProfiler::INSTRUCTIONS]);
+        }
+
+        // Phases are not recorded while the profiler is disabled
+        {
+            HardwareCounterProfiler::ScopedPhase phase("Disabled");
+        }
+        TS_ASSERT_EQUALS(p_profiler->HasPhase("Disabled"), false);
+
+        // The report has a header and a line for each phase
+        FileFinder report_file("TestHardwareCounterProfilerModifier/hardwarecounters.dat", RelativeTo::ChasteTestOutput);
+        std::ifstream report_stream(report_file.GetAbsolutePath());
+        std::string line;
+        std::getline(report_stream, line);
+        TS_ASSERT_EQUALS(line.substr(0, 30), "# phase\tcalls\twall_time\tcycles");
+        unsigned num_lines = 0;
+        while (std::getline(report_stream, line))
+        {
+            ++num_lines;
+
+            // The counters that were open are reported, although they are now closed
+            if (counter_available[HardwareCounterProfiler::CYCLES] && counter_available[HardwareCounterProfiler::INSTRUCTIONS])
+            {
+                TS_ASSERT_EQUALS(line.find("n/a"), std::string::npos);
+            }
+        }
+        TS_ASSERT_EQUALS(num_lines, p_profiler->rGetPhases().size());
+
+        // Phases that run work on ThreadedLoop workers are labelled, as only the main thread is counted
+        TS_ASSERT_EQUALS(p_profiler->rGetPhase("Solve").mUsedWorkerThreads, false);
+        ThreadedLoop::SetNumThreads(2);
+        p_profiler->Enable();
+        p_profiler->Reset();
+        {
+            HardwareCounterProfiler::ScopedPhase outer_phase("Threaded");
+            {
+                HardwareCounterProfiler::ScopedPhase inner_phase("Unthreaded");
+            }
+            ThreadedLoop::Run(10u, [](unsigned, unsigned, unsigned) {});
+        }
+        p_profiler->Disable();
+        ThreadedLoop::SetNumThreads(0);
+        TS_ASSERT_EQUALS(p_profiler->rGetPhase("Threaded").mUsedWorkerThreads, true);
+        TS_ASSERT_EQUALS(p_profiler->rGetPhase("Unthreaded").mUsedWorkerThreads, false);
+        std::ostringstream report;
+        p_profiler->WriteReport(report);
+        TS_ASSERT_DIFFERS(report.str().find("\tmain_thread_only\n"), std::string::npos);
+        TS_ASSERT_DIFFERS(report.str().find("\tall\n"), std::string::npos);
+
+        TS_ASSERT_EQUALS(HardwareCounterProfiler::GetCounterName(HardwareCounterProfiler::LLC_MISSES), "llc_misses");
+        TS_ASSERT_THROWS_CONTAINS(HardwareCounterProfiler::GetCounterName(HardwareCounterProfiler::NUM_COUNTERS),
+                                  "Unknown hardware counter");
+        HardwareCounterProfiler::Destroy();
+    }
+
+    void TestHardwareCounterProfilerModifierWarnsOfUnexpectedOutput()
+    {
+        HoneycombVertexMeshGenerator generator(2, 2);
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+        std::vector<CellPtr> cells;
+        MAKE_PTR(DifferentiatedCellProliferativeType, p_cell_type);
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumElements(), p_cell_type);
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        // Output is only measured if the modifier is the last one in the simulation
+        OffLatticeSimulation<2> simulation(cell_population);
+        MAKE_PTR(HardwareCounterProfilerModifier<2>, p_modifier);
+        HardwareCounterProfilerModifier<2>& modifier = *p_modifier;
+        modifier.SetPrintReport(false);
+        modifier.SetSimulation(&simulation);
+        simulation.AddSimulationModifier(p_modifier);
+        MAKE_PTR(SillySimulationModifier<2>, p_silly_modifier);
+        simulation.AddSimulationModifier(p_silly_modifier);
+        TS_ASSERT_THROWS_THIS(modifier.SetupSolve(cell_population, "TestHardwareCounterProfilerModifierWarnsOfUnexpectedOutput"),
+                              "HardwareCounterProfilerModifier must be the last modifier added to the simulation to measure its output");
+        simulation.GetSimulationModifiers()->pop_back();
+
+        // Call the modifier as a simulation would, with output at time steps 10 and 20 and then, unexpectedly, 25
+        Warnings::QuietDestroy();
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 100);
+        modifier.SetupSolve(cell_population, "TestHardwareCounterProfilerModifierWarnsOfUnexpectedOutput");
+        for (unsigned time_step = 1; time_step <= 25; ++time_step)
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            modifier.UpdateAtEndOfTimeStep(cell_population);
+            if (time_step % 10u == 0u || time_step == 25u)
+            {
+                modifier.UpdateAtEndOfOutputTimeStep(cell_population);
+            }
+            TS_ASSERT_EQUALS(Warnings::Instance()->GetNumWarnings(), (time_step < 25u) ? 0u : 1u);
+        }
+        TS_ASSERT_DIFFERS(Warnings::Instance()->GetNextWarningMessage().find("did not expect output"), std::string::npos);
+
+        // Only the expected output at time step 20 is measured
+        modifier.UpdateAtEndOfSolve(cell_population);
+        TS_ASSERT_EQUALS(HardwareCounterProfiler::Instance()->rGetPhase("Output").mNumCalls, 1u);
+
+        Warnings::QuietDestroy();
+        HardwareCounterProfiler::Destroy();
+    }
+};
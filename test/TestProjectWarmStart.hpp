@@ -0,0 +1,231 @@
+/*
+
+Copyright (c) 2005-2023, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTPROJECTWARMSTART_HPP_
+#define TESTPROJECTWARMSTART_HPP_
+
+// These first headers relate to the Chaste infrastructure and can be found at the top of every test suite
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "CheckpointArchiveTypes.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "FileFinder.hpp"
+#include "OutputFileHandler.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "SmartPointers.hpp"
+
+#include "VoronoiVertexMeshGenerator.hpp"
+
+#include "CellsGenerator.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "NoCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+#include "FarhadifarForce.hpp"
+#include "OffLatticeSimulation.hpp"
+
+// Custom headers from this user project
+#include "SillyForce.hpp"
+#include "ThreadedLoop.hpp"
+#include "WarmStartForker.hpp"
+
+// Finally, we include a header that enforces running this test only on one process
+#include "FakePetscSetup.hpp"
+
+/**
+ * Tests of running variants of a simulation from a shared warmed-up state.
+ */
+class TestProjectWarmStart : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * @param rMesh a mesh
+     * @return the node locations of the mesh, written to full precision
+     */
+    std::string WriteNodeLocations(MutableVertexMesh<2, 2>& rMesh)
+    {
+        std::ostringstream locations;
+        locations.precision(17);
+        for (auto node_iter = rMesh.GetNodeIteratorBegin(); node_iter != rMesh.GetNodeIteratorEnd(); ++node_iter)
+        {
+            locations << node_iter->rGetLocation()[0] << " " << node_iter->rGetLocation()[1] << "\n";
+        }
+        return locations.str();
+    }
+
+    /**
+     * @param rVariantName the name of a variant run by TestWarmStartForker
+     * @return the final node locations written by the variant
+     */
+    std::string ReadVariantNodeLocations(const std::string& rVariantName)
+    {
+        FileFinder locations_file("TestWarmStartForker/" + rVariantName + "/final_locations.dat", RelativeTo::ChasteTestOutput);
+        std::ifstream locations_stream(locations_file.GetAbsolutePath());
+        std::ostringstream locations;
+        locations << locations_stream.rdbuf();
+        return locations.str();
+    }
+
+public:
+
+    void TestWarmStartForker()
+    {
+        // Warm up by relaxing a tissue, as in Test01Relaxation
+        RandomNumberGenerator::Instance()->Reseed(1);
+        VoronoiVertexMeshGenerator generator(4, 4, 1);
+        boost::shared_ptr<MutableVertexMesh<2, 2> > p_mesh = generator.GetMesh();
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(DifferentiatedCellProliferativeType, p_cell_type);
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasicRandom(cells, p_mesh->GetNumElements(), p_cell_type);
+
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        OffLatticeSimulation<2> simulation(cell_population);
+        simulation.SetOutputDirectory("TestWarmStartForker/WarmUp");
+        simulation.SetEndTime(0.5);
+        simulation.SetDt(0.01);
+        simulation.SetSamplingTimestepMultiple(10);
+
+        MAKE_PTR(FarhadifarForce<2>, p_force);
+        simulation.AddForce(p_force);
+
+        simulation.Solve();
+        const std::string warm_up_locations = WriteNodeLocations(*p_mesh);
+
+        // Each variant continues the simulation and writes its final node locations
+        auto continue_to_end = [&](const std::string& rName)
+        {
+            simulation.SetOutputDirectory("TestWarmStartForker/" + rName);
+            simulation.SetEndTime(1.0);
+            simulation.Solve();
+
+            OutputFileHandler handler("TestWarmStartForker/" + rName, false);
+            out_stream p_file = handler.OpenOutputFile("final_locations.dat");
+            *p_file << WriteNodeLocations(*p_mesh);
+            p_file->close();
+        };
+
+        WarmStartForker forker(2);
+        forker.AddVariant("ReferenceA", 1u, [&]() { continue_to_end("ReferenceA"); });
+        forker.AddVariant("ReferenceB", 1u, [&]() { continue_to_end("ReferenceB"); });
+        forker.AddVariant("SillyForce", 2u, [&]()
+        {
+            MAKE_PTR(SillyForce<2>, p_silly_force);
+            simulation.AddForce(p_silly_force);
+            continue_to_end("SillyForce");
+        });
+        forker.AddVariant("Failing", 3u, [&]()
+        {
+            EXCEPTION("This variant fails");
+        });
+        forker.AddVariant("ThrowingOther", 4u, [&]()
+        {
+            throw 4;
+        });
+
+        // Worker threads left waiting by parallel loops in this process are replaced in each variant
+        forker.AddVariant("Threaded", 5u, [&]()
+        {
+            std::atomic<unsigned> num_items(0u);
+            ThreadedLoop::Run(100, [&](unsigned begin, unsigned end, unsigned thread)
+            {
+                num_items += end - begin;
+            });
+            if (num_items != 100u)
+            {
+                EXCEPTION("The parallel loop missed some items");
+            }
+        });
+        ThreadedLoop::SetNumThreads(4);
+        ThreadedLoop::Run(100, [](unsigned begin, unsigned end, unsigned thread) {});
+        TS_ASSERT_EQUALS(forker.GetNumVariants(), 6u);
+        TS_ASSERT_EQUALS(forker.rGetVariantName(2), "SillyForce");
+        TS_ASSERT_EQUALS(forker.GetMaxConcurrentVariants(), 2u);
+
+        std::vector<int> exit_statuses = forker.RunVariants();
+        TS_ASSERT_EQUALS(exit_statuses.size(), 6u);
+        TS_ASSERT_EQUALS(exit_statuses[0], 0);
+        TS_ASSERT_EQUALS(exit_statuses[1], 0);
+        TS_ASSERT_EQUALS(exit_statuses[2], 0);
+        TS_ASSERT_EQUALS(exit_statuses[3], 1);
+        TS_ASSERT_EQUALS(exit_statuses[4], 1);
+        TS_ASSERT_EQUALS(exit_statuses[5], 0);
+
+        // The variants did not change the warmed-up state
+        TS_ASSERT_DELTA(SimulationTime::Instance()->GetTime(), 0.5, 1e-12);
+        TS_ASSERT_EQUALS(WriteNodeLocations(*p_mesh), warm_up_locations);
+        TS_ASSERT_EQUALS(simulation.rGetForceCollection().size(), 1u);
+
+        // Identical variants give identical results, and each variant continued from the warmed-up state
+        const std::string reference_locations = ReadVariantNodeLocations("ReferenceA");
+        TS_ASSERT(!reference_locations.empty());
+        TS_ASSERT_EQUALS(ReadVariantNodeLocations("ReferenceB"), reference_locations);
+        TS_ASSERT_DIFFERS(reference_locations, warm_up_locations);
+        TS_ASSERT_DIFFERS(ReadVariantNodeLocations("SillyForce"), reference_locations);
+
+        // Variants can also be run one at a time, and other children of this process are not waited for
+        const pid_t other_child = fork();
+        if (other_child == 0)
+        {
+            _exit(7);
+        }
+        forker.SetMaxConcurrentVariants(1);
+        exit_statuses = forker.RunVariants();
+        ThreadedLoop::SetNumThreads(0);
+        TS_ASSERT_EQUALS(exit_statuses[0], 0);
+        TS_ASSERT_EQUALS(exit_statuses[3], 1);
+        TS_ASSERT_EQUALS(exit_statuses[4], 1);
+        TS_ASSERT_EQUALS(ReadVariantNodeLocations("ReferenceA"), reference_locations);
+
+        int other_status;
+        TS_ASSERT_EQUALS(waitpid(other_child, &other_status, 0), other_child);
+        TS_ASSERT(WIFEXITED(other_status));
+        TS_ASSERT_EQUALS(WEXITSTATUS(other_status), 7);
+
+        forker.SetMaxConcurrentVariants(0);
+        TS_ASSERT_THROWS_THIS(forker.RunVariants(), "The maximum number of concurrent variants must be positive");
+    }
+};
+
+#endif /* TESTPROJECTWARMSTART_HPP_ */